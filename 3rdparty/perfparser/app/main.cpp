@@ -34,11 +34,13 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QScopedPointer>
 #include <QTcpSocket>
 #include <QTimer>
 #include <QtEndian>
 
+#include <algorithm>
 #include <cstring>
 
 #ifdef Q_OS_LINUX
@@ -100,7 +102,8 @@ int main(int argc, char *argv[])
 
     QCommandLineOption input(QLatin1String("input"),
                              QCoreApplication::translate(
-                                 "main", "Read perf data from <file> instead of stdin."),
+                                 "main", "Read perf data from <file> instead of stdin. <file> can"
+                                 " also be the directory written by perf record --threads."),
                              QLatin1String("file"));
     parser.addOption(input);
 
@@ -269,7 +272,10 @@ int main(int argc, char *argv[])
         infile.reset(socket);
     } else {
         if (parser.isSet(input)) {
-            infile.reset(new QFile(parser.value(input)));
+            // perf record --threads writes a directory, the header is in its "data" file
+            const QFileInfo inputInfo(parser.value(input));
+            infile.reset(new QFile(inputInfo.isDir() ? QDir(inputInfo.filePath()).filePath(QLatin1String("data"))
+                                                     : inputInfo.filePath()));
         } else {
 #ifdef Q_OS_WIN
             _setmode(fileno(stdin), O_BINARY);
@@ -365,6 +371,24 @@ int main(int argc, char *argv[])
         }
 
         data.setSource(infile.data());
+        const QFile *inputFile = qobject_cast<QFile *>(infile.data());
+        if (inputFile && parser.isSet(input) && header.hasFeature(PerfHeader::DIR_FORMAT)) {
+            // the events of every recording thread are in a data.N file next to the header
+            const QDir dir = QFileInfo(inputFile->fileName()).dir();
+            QStringList dataFiles = dir.entryList({QLatin1String("data.*")}, QDir::Files);
+            std::sort(dataFiles.begin(), dataFiles.end(), [](const QString &lhs, const QString &rhs) {
+                return lhs.midRef(5).toInt() < rhs.midRef(5).toInt();
+            });
+            for (const QString &fileName : dataFiles) {
+                QFile *dataFile = new QFile(dir.filePath(fileName), &data);
+                if (!dataFile->open(QIODevice::ReadOnly)) {
+                    qWarning() << "Failed to open" << dataFile->fileName();
+                    qApp->exit(CannotOpen);
+                    return;
+                }
+                data.addDataFile(dataFile);
+            }
+        }
         QObject::connect(infile.data(), &QIODevice::aboutToClose, &data, &PerfData::finishReading);
         QObject::connect(&data, &PerfData::finished, infile.data(), [&](){ infile->disconnect(); });
         QObject::connect(infile.data(), &QIODevice::readyRead, &data, &PerfData::read);
@@ -38,6 +38,11 @@ void PerfData::setSource(QIODevice *source)
     m_source = source;
 }
 
+void PerfData::addDataFile(QIODevice *dataFile)
+{
+    m_dataFiles.append(dataFile);
+}
+
 PerfData::ReadStatus PerfData::processEvents(QDataStream &stream)
 {
     const quint16 headerSize = PerfEventHeader::fixedLength();
@@ -242,6 +247,8 @@ PerfData::ReadStatus PerfData::doRead()
     } else if (!m_source->seek(m_header->dataOffset())) {
         qWarning() << "cannot seek to" << m_header->dataOffset();
         returnCode = SignalError;
+    } else if (!m_dataFiles.isEmpty()) {
+        returnCode = doReadDataFiles();
     } else {
         const auto dataOffset = m_header->dataOffset();
         const auto dataSize = m_header->dataSize();
@@ -266,6 +273,130 @@ PerfData::ReadStatus PerfData::doRead()
     return returnCode;
 }
 
+PerfData::ReadStatus PerfData::doReadDataFiles()
+{
+    struct Reader
+    {
+        QIODevice *device;
+        qint64 begin;
+        qint64 end;
+        quint64 time;
+    };
+
+    QVector<Reader> readers;
+    readers.reserve(m_dataFiles.size() + 1);
+    readers.append({m_source, m_header->dataOffset(), m_header->dataOffset() + m_header->dataSize(), 0});
+    for (QIODevice *dataFile : m_dataFiles)
+        readers.append({dataFile, 0, dataFile->size(), 0});
+
+    qint64 dataSize = 0;
+    for (Reader &reader : readers) {
+        if (!reader.device->seek(reader.begin)) {
+            qWarning() << "cannot seek to" << reader.begin;
+            return SignalError;
+        }
+        dataSize += reader.end - reader.begin;
+        if (reader.begin < reader.end)
+            reader.time = peekTime(reader.device, 0);
+    }
+
+    const qint64 posDeltaBetweenProgress = dataSize / 100;
+    qint64 dataRead = 0;
+    qint64 nextProgressAt = posDeltaBetweenProgress;
+    m_destination->sendProgress(0);
+
+    // Every file holds the events of some CPUs roughly in order of time. Always continue with the file
+    // whose next event is the oldest one, so that the event buffer of the unwinder doesn't need to hold
+    // more events than for a single file. Linear search is fine, there are as many files as CPUs at most.
+    while (true) {
+        Reader *next = nullptr;
+        for (Reader &reader : readers) {
+            if (reader.device->pos() < reader.end && (!next || reader.time < next->time))
+                next = &reader;
+        }
+        if (!next)
+            break;
+
+        const qint64 oldPos = next->device->pos();
+        QDataStream stream(next->device);
+        stream.setByteOrder(m_header->byteOrder());
+        if (processEvents(stream) != SignalFinished)
+            return SignalError;
+
+        if (next->device->pos() < next->end)
+            next->time = peekTime(next->device, next->time);
+
+        dataRead += next->device->pos() - oldPos;
+        if (dataRead >= nextProgressAt) {
+            m_destination->sendProgress(float(dataRead) / dataSize);
+            nextProgressAt += posDeltaBetweenProgress;
+        }
+    }
+
+    return SignalFinished;
+}
+
+quint64 PerfData::peekTime(QIODevice *device, quint64 previousTime) const
+{
+    const quint16 headerSize = PerfEventHeader::fixedLength();
+    const QByteArray headerData = device->peek(headerSize);
+    if (headerData.size() < headerSize)
+        return previousTime;
+
+    PerfEventHeader eventHeader;
+    QDataStream headerStream(headerData);
+    headerStream.setByteOrder(m_header->byteOrder());
+    headerStream >> eventHeader;
+
+    const PerfEventAttributes &attrs = m_attributes->globalAttributes();
+    const QByteArray record = device->peek(eventHeader.size);
+    QDataStream stream(record);
+    stream.setByteOrder(m_header->byteOrder());
+
+    qint64 timeOffset = -1;
+    if (eventHeader.type == PERF_RECORD_SAMPLE) {
+        quint64 sampleType = attrs.sampleType();
+        const int idOffset = attrs.sampleIdOffset();
+        if (attrs.sampleIdAll() && idOffset >= 0 && headerSize + idOffset + 8 <= record.size()) {
+            quint64 id;
+            stream.device()->seek(headerSize + idOffset);
+            stream >> id;
+            sampleType = m_attributes->attributes(id).sampleType();
+        }
+        if (sampleType & PerfEventAttributes::SAMPLE_TIME) {
+            timeOffset = headerSize;
+            if (sampleType & PerfEventAttributes::SAMPLE_IDENTIFIER)
+                timeOffset += sizeof(quint64);
+            if (sampleType & PerfEventAttributes::SAMPLE_IP)
+                timeOffset += sizeof(quint64);
+            if (sampleType & PerfEventAttributes::SAMPLE_TID)
+                timeOffset += sizeof(quint32) + sizeof(quint32);
+        }
+    } else if (eventHeader.type < PERF_RECORD_USER_TYPE_START && attrs.sampleIdAll()
+               && (attrs.sampleType() & PerfEventAttributes::SAMPLE_TIME)) {
+        // the sample_id trails the record, find the time from its end
+        const quint64 sampleType = attrs.sampleType();
+        timeOffset = record.size() - qint64(sizeof(quint64));
+        const PerfEventAttributes::SampleFormat trailing[] = {
+            PerfEventAttributes::SAMPLE_ID, PerfEventAttributes::SAMPLE_STREAM_ID,
+            PerfEventAttributes::SAMPLE_CPU, PerfEventAttributes::SAMPLE_IDENTIFIER
+        };
+        for (const auto format : trailing) {
+            if (sampleType & format)
+                timeOffset -= sizeof(quint64);
+        }
+    }
+
+    // events without time, e.g. FINISHED_ROUND, stay where they are in their file
+    if (timeOffset < headerSize || timeOffset + qint64(sizeof(quint64)) > record.size())
+        return previousTime;
+
+    quint64 time;
+    stream.device()->seek(timeOffset);
+    stream >> time;
+    return time;
+}
+
 void PerfData::read()
 {
     ReadStatus returnCode = doRead();
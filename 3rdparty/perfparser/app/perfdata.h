@@ -25,6 +25,7 @@
 #include "perfheader.h"
 
 #include <QIODevice>
+#include <QVector>
 
 
 enum PerfEventType {
@@ -331,6 +332,8 @@ enum perf_event_sample_format {
 
 enum PERF_RECORD_MISC {
     PERF_RECORD_MISC_SWITCH_OUT     = (1 << 13),
+    // only set for context switches out, when the task was still runnable, since Linux 4.17
+    PERF_RECORD_MISC_SWITCH_OUT_PREEMPT = (1 << 14),
 };
 
 class PerfRecordSample;
@@ -456,6 +459,7 @@ class PerfRecordLost : public PerfRecord {
 public:
     PerfRecordLost(PerfEventHeader *header = nullptr, quint64 sampleType = 0,
                    bool sampleIdAll = false);
+    quint64 lost() const { return m_lost; }
 private:
     quint64 m_id;
     quint64 m_lost;
@@ -612,6 +616,9 @@ class PerfData : public QObject
 public:
     PerfData(PerfUnwind *destination, const PerfHeader *header, PerfAttributes *attributes);
     void setSource(QIODevice *source);
+    // Add one of the data.N files of a directory recorded with perf record --threads. Their events
+    // are merged with the ones of the source by time.
+    void addDataFile(QIODevice *dataFile);
 
 public slots:
     void read();
@@ -636,7 +643,10 @@ private:
     PerfAttributes *m_attributes;
     PerfEventHeader m_eventHeader;
     PerfTracingData m_tracingData;
+    QVector<QIODevice *> m_dataFiles;
 
     ReadStatus processEvents(QDataStream &stream);
     ReadStatus doRead();
+    ReadStatus doReadDataFiles();
+    quint64 peekTime(QIODevice *device, quint64 previousTime) const;
 };
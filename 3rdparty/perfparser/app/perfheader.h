@@ -52,6 +52,8 @@ public:
         PMU_MAPPINGS,
         GROUP_DESC,
         LAST_FEATURE,
+        // not read, only checked for: the events are split into data.N files next to the header
+        DIR_FORMAT     = 24,
         FEAT_BITS      = 256,
     };
     Q_ENUM(Feature)
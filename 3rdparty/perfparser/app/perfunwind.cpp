@@ -28,6 +28,7 @@
 #include <QtEndian>
 
 #include <cstring>
+#include <limits>
 
 const qint32 PerfUnwind::s_kernelPid = -1;
 
@@ -280,6 +281,34 @@ void PerfUnwind::sendAttributes(qint32 id, const PerfEventAttributes &attributes
     sendBuffer(buffer);
 }
 
+static quint32 tracePointFieldSize(const FormatField &field)
+{
+    if (field.flags & FIELD_IS_STRING)
+        return 1;
+    return (field.flags & FIELD_IS_ARRAY) ? field.elementsize : field.size;
+}
+
+static PerfUnwind::TracePointFieldType tracePointFieldType(const FormatField &field)
+{
+    if (field.flags & FIELD_IS_STRING)
+        return PerfUnwind::TracePointFieldString;
+
+    switch (tracePointFieldSize(field)) {
+    case 1:
+    case 2:
+    case 4:
+    case 8:
+        break;
+    default:
+        return PerfUnwind::TracePointFieldUnsupported;
+    }
+
+    const bool isSigned = field.flags & FIELD_IS_SIGNED;
+    if (field.flags & FIELD_IS_ARRAY)
+        return isSigned ? PerfUnwind::TracePointFieldSignedArray : PerfUnwind::TracePointFieldUnsignedArray;
+    return isSigned ? PerfUnwind::TracePointFieldSigned : PerfUnwind::TracePointFieldUnsigned;
+}
+
 void PerfUnwind::sendEventFormat(qint32 id, const EventFormat &format)
 {
     const qint32 systemId = resolveString(format.system);
@@ -288,19 +317,33 @@ void PerfUnwind::sendEventFormat(qint32 id, const EventFormat &format)
     for (const FormatField &field : format.commonFields)
         resolveString(field.name);
 
+    QVector<qint32> fieldNameIds;
+    fieldNameIds.reserve(format.fields.size());
     for (const FormatField &field : format.fields)
-        resolveString(field.name);
+        fieldNameIds.append(resolveString(field.name));
 
     QByteArray buffer;
-    QDataStream(&buffer, QIODevice::WriteOnly) << static_cast<quint8>(TracePointFormat) << id
-                                               << systemId << nameId << format.flags;
+    QDataStream stream(&buffer, QIODevice::WriteOnly);
+    stream << static_cast<quint8>(TracePointFormat) << id << systemId << nameId << format.flags;
+
+    // the values of the fields follow in this order in every TracePointSample of this format
+    stream << static_cast<quint32>(format.fields.size());
+    for (int i = 0, c = format.fields.size(); i < c; ++i) {
+        const FormatField &field = format.fields.at(i);
+        stream << fieldNameIds.at(i) << static_cast<quint8>(tracePointFieldType(field))
+               << static_cast<quint8>(tracePointFieldSize(field));
+    }
     sendBuffer(buffer);
 }
 
 void PerfUnwind::lost(const PerfRecordLost &lost)
 {
-    bufferEvent(TaskEvent{lost.pid(), lost.tid(), lost.time(), lost.cpu(),
-                          0, LostDefinition},
+    // without the cpu in the sample id, we only know how many events got lost
+    const bool hasCpu = (lost.type() & PerfEventAttributes::SAMPLE_ID_ALL)
+            && (lost.type() & PerfEventAttributes::SAMPLE_CPU);
+    bufferEvent(TaskEvent{lost.pid(), lost.tid(), lost.time(),
+                          hasCpu ? lost.cpu() : std::numeric_limits<quint32>::max(),
+                          static_cast<qint64>(lost.lost()), LostDefinition},
                 &m_taskEventsBuffer, &m_stats.numTaskEventsInRound);
 }
 
@@ -446,9 +489,13 @@ void PerfUnwind::resolveCallchain()
     bool addedUserFrames = false;
     PerfSymbolTable *symbols = symbolTable(m_currentUnwind.sample->pid());
 
-    auto reportIp = [&](quint64 ip, bool branchStack) -> bool {
+    auto lookupIp = [&](quint64 ip) -> int {
         symbols->attachDwfl(&m_currentUnwind);
-        int frame = symbols->lookupFrame(ip, isKernel, &m_currentUnwind.isInterworking);
+        return symbols->lookupFrame(ip, isKernel, &m_currentUnwind.isInterworking);
+    };
+
+    auto reportIp = [&](quint64 ip, bool branchStack) -> bool {
+        int frame = lookupIp(ip);
         if (branchStack) {
             m_currentUnwind.frames.append(frame);
         } else {
@@ -528,6 +575,13 @@ void PerfUnwind::resolveCallchain()
             return;
         if (!reportIp(entry.from, hasBranchStack))
             return;
+
+        // the taken branch itself, for the edge and basic block counts
+        const int from = m_currentUnwind.frames.last();
+        const int to = i == 0 ? m_currentUnwind.frames.at(m_currentUnwind.frames.size() - 2) : lookupIp(entry.to);
+        if (symbols->cacheIsDirty())
+            return;
+        m_currentUnwind.branchFrames << from << to;
     }
 }
 
@@ -543,61 +597,85 @@ Number readFromArray(const QByteArray &data, quint32 offset, bool byteSwap)
     return byteSwap ? qbswap(number) : number;
 }
 
-QVariant readTraceItem(const QByteArray &data, quint32 offset, quint32 size, bool isSigned,
-                       bool byteSwap)
+static bool isInRange(const QByteArray &data, quint32 offset, quint32 size)
 {
-    if (isSigned) {
-        switch (size) {
-        case 1: return readFromArray<qint8>(data, offset, byteSwap);
-        case 2: return readFromArray<qint16>(data, offset, byteSwap);
-        case 4: return readFromArray<qint32>(data, offset, byteSwap);
-        case 8: return readFromArray<qint64>(data, offset, byteSwap);
-        default: return QVariant::Invalid;
-        }
-    } else {
-        switch (size) {
-        case 1: return readFromArray<quint8>(data, offset, byteSwap);
-        case 2: return readFromArray<quint16>(data, offset, byteSwap);
-        case 4: return readFromArray<quint32>(data, offset, byteSwap);
-        case 8: return readFromArray<quint64>(data, offset, byteSwap);
-        default: return QVariant::Invalid;
-        }
-    }
+    return offset <= quint32(std::numeric_limits<int>::max())
+            && size <= quint32(std::numeric_limits<int>::max())
+            && offset + size <= quint32(std::numeric_limits<int>::max())
+            && static_cast<int>(offset + size) <= data.length();
 }
 
-QVariant PerfUnwind::readTraceData(const QByteArray &data, const FormatField &field, bool byteSwap)
+// an unreadable item is written as zero, to keep the stream in sync with the format
+template<typename Number>
+void writeTraceItem(QDataStream &stream, const QByteArray &data, quint32 offset, bool isValid,
+                    bool byteSwap)
 {
-    // TODO: validate that it actually works like this.
-    if (field.offset > quint32(std::numeric_limits<int>::max())
-            || field.size > quint32(std::numeric_limits<int>::max())
-            || field.offset + field.size > quint32(std::numeric_limits<int>::max())
-            || static_cast<int>(field.offset + field.size) > data.length()) {
-        return QVariant::Invalid;
+    stream << (isValid ? readFromArray<Number>(data, offset, byteSwap) : Number(0));
+}
+
+static void writeTraceItem(QDataStream &stream, const QByteArray &data, quint32 offset,
+                           quint32 size, bool isSigned, bool isValid, bool byteSwap)
+{
+    switch (size) {
+    case 1:
+        return isSigned ? writeTraceItem<qint8>(stream, data, offset, isValid, byteSwap)
+                        : writeTraceItem<quint8>(stream, data, offset, isValid, byteSwap);
+    case 2:
+        return isSigned ? writeTraceItem<qint16>(stream, data, offset, isValid, byteSwap)
+                        : writeTraceItem<quint16>(stream, data, offset, isValid, byteSwap);
+    case 4:
+        return isSigned ? writeTraceItem<qint32>(stream, data, offset, isValid, byteSwap)
+                        : writeTraceItem<quint32>(stream, data, offset, isValid, byteSwap);
+    case 8:
+        return isSigned ? writeTraceItem<qint64>(stream, data, offset, isValid, byteSwap)
+                        : writeTraceItem<quint64>(stream, data, offset, isValid, byteSwap);
     }
+}
+
+void PerfUnwind::writeTraceData(QDataStream &stream, const QByteArray &data,
+                                const FormatField &field, bool byteSwap) const
+{
+    const TracePointFieldType type = tracePointFieldType(field);
+    if (type == TracePointFieldUnsupported)
+        return;
 
-    if (field.flags & FIELD_IS_ARRAY) {
-        if (field.flags & FIELD_IS_DYNAMIC) {
-            const quint32 dynamicOffsetAndSize = readTraceItem(data, field.offset, field.size,
-                                                               false, byteSwap).toUInt();
-            FormatField newField = field;
-            newField.offset = dynamicOffsetAndSize & 0xffff;
-            newField.size = dynamicOffsetAndSize >> 16;
-            newField.flags = field.flags & (~FIELD_IS_DYNAMIC);
-            return readTraceData(data, newField, byteSwap);
+    quint32 offset = field.offset;
+    quint32 size = field.size;
+    bool isValid = isInRange(data, offset, size);
+    if (isValid && (field.flags & FIELD_IS_DYNAMIC)) {
+        // the field only holds the location of the data within the sample
+        isValid = field.size == sizeof(quint32);
+        if (isValid) {
+            const quint32 dynamicOffsetAndSize = readFromArray<quint32>(data, offset, byteSwap);
+            offset = dynamicOffsetAndSize & 0xffff;
+            size = dynamicOffsetAndSize >> 16;
+            isValid = isInRange(data, offset, size);
         }
-        if (field.flags & FIELD_IS_STRING) {
-            return data.mid(static_cast<int>(field.offset), static_cast<int>(field.size));
-        } else {
-            QList<QVariant> result;
-            for (quint32 i = 0; i < field.size; i += field.elementsize) {
-                result.append(readTraceItem(data, field.offset + i, field.elementsize,
-                                            field.flags & FIELD_IS_SIGNED, byteSwap));
-            }
-            return result;
+    }
+
+    switch (type) {
+    case TracePointFieldSigned:
+    case TracePointFieldUnsigned:
+        writeTraceItem(stream, data, offset, size, type == TracePointFieldSigned, isValid, byteSwap);
+        break;
+    case TracePointFieldString:
+        stream << (isValid ? data.mid(static_cast<int>(offset),
+                                      static_cast<int>(qstrnlen(data.constData() + offset, size)))
+                           : QByteArray());
+        break;
+    case TracePointFieldSignedArray:
+    case TracePointFieldUnsignedArray: {
+        const quint32 elementSize = field.elementsize;
+        const quint32 count = isValid ? size / elementSize : 0;
+        stream << count;
+        for (quint32 i = 0; i < count; ++i) {
+            writeTraceItem(stream, data, offset + i * elementSize, elementSize,
+                           type == TracePointFieldSignedArray, true, byteSwap);
         }
-    } else {
-        return readTraceItem(data, field.offset, field.size, field.flags & FIELD_IS_SIGNED,
-                             byteSwap);
+        break;
+    }
+    case TracePointFieldUnsupported:
+        break;
     }
 }
 
@@ -615,6 +693,7 @@ void PerfUnwind::analyze(const PerfRecordSample &sample)
         m_currentUnwind.sample = &sample;
         m_currentUnwind.frames.clear();
         m_currentUnwind.disasmFrames.clear();
+        m_currentUnwind.branchFrames.clear();
         m_currentUnwind.isIncompleteCallchain = false;
 
         userSymbols->updatePerfMap();
@@ -690,17 +769,16 @@ void PerfUnwind::analyze(const PerfRecordSample &sample)
     QDataStream stream(&buffer, QIODevice::WriteOnly);
     stream << static_cast<quint8>(type) << sample.pid()
            << sample.tid() << sample.time() << sample.cpu() << m_currentUnwind.frames << m_currentUnwind.disasmFrames
+           << m_currentUnwind.branchFrames
            << numGuessedFrames << values << m_currentUnwind.isIncompleteCallchain;
 
     if (type == TracePointSample) {
-        QHash<qint32, QVariant> traceData;
+        // the values only, their names and types got sent once with the TracePointFormat
         const QByteArray &data = sample.rawData();
         const EventFormat &format = m_tracingData.eventFormat(eventFormatId);
-        for (const FormatField &field : format.fields) {
-            traceData[lookupString(field.name)]
-                    = readTraceData(data, field, m_byteOrder != QSysInfo::ByteOrder);
-        }
-        stream << traceData;
+        const bool byteSwap = m_byteOrder != QSysInfo::ByteOrder;
+        for (const FormatField &field : format.fields)
+            writeTraceData(stream, data, field, byteSwap);
     }
 
     sendBuffer(buffer);
@@ -1048,7 +1126,8 @@ void PerfUnwind::contextSwitch(const PerfRecordContextSwitch& contextSwitch)
 {
     bufferEvent(TaskEvent{contextSwitch.pid(), contextSwitch.tid(),
                 contextSwitch.time(), contextSwitch.cpu(),
-                contextSwitch.misc() & PERF_RECORD_MISC_SWITCH_OUT, ContextSwitchDefinition},
+                contextSwitch.misc() & (PERF_RECORD_MISC_SWITCH_OUT | PERF_RECORD_MISC_SWITCH_OUT_PREEMPT),
+                ContextSwitchDefinition},
                 &m_taskEventsBuffer, &m_stats.numTaskEventsInRound);
 }
 
@@ -1061,9 +1140,12 @@ void PerfUnwind::sendTaskEvent(const TaskEvent& taskEvent)
            << taskEvent.m_time << taskEvent.m_cpu;
 
     if (taskEvent.m_type == ContextSwitchDefinition)
-        stream << static_cast<bool>(taskEvent.m_payload);
+        stream << static_cast<bool>(taskEvent.m_payload & PERF_RECORD_MISC_SWITCH_OUT)
+               << static_cast<bool>(taskEvent.m_payload & PERF_RECORD_MISC_SWITCH_OUT_PREEMPT);
     else if (taskEvent.m_type == Command)
-        stream << taskEvent.m_payload;
+        stream << static_cast<qint32>(taskEvent.m_payload);
+    else if (taskEvent.m_type == LostDefinition)
+        stream << static_cast<quint64>(taskEvent.m_payload);
 
     sendBuffer(buffer);
 }
@@ -63,6 +63,21 @@ public:
         InvalidType
     };
 
+    // How the value of a tracepoint field is encoded in a TracePointSample. The type and size of
+    // every field are sent once with its TracePointFormat, the samples then only carry the values.
+    enum TracePointFieldType : quint8 {
+        // no value is sent
+        TracePointFieldUnsupported,
+        // an integer of the field size
+        TracePointFieldSigned,
+        TracePointFieldUnsigned,
+        // a QByteArray, without the terminating null bytes
+        TracePointFieldString,
+        // a quint32 count followed by that many integers of the field size
+        TracePointFieldSignedArray,
+        TracePointFieldUnsignedArray
+    };
+
     struct Location {
         explicit Location(quint64 address = 0, quint64 relAddr = 0, qint32 file = -1,
                           quint32 pid = 0, qint32 line = 0, qint32 column = 0,
@@ -95,12 +110,14 @@ public:
     };
 
     struct UnwindInfo {
-        UnwindInfo() : frames(0), disasmFrames(0), unwind(nullptr), sample(nullptr), maxFrames(64), maxStack(127),
+        UnwindInfo() : frames(0), disasmFrames(0), branchFrames(0), unwind(nullptr), sample(nullptr), maxFrames(64), maxStack(127),
             branchTraverse(false), firstGuessedFrame(-1), isInterworking(false), isIncompleteCallchain(false) {}
 
         QHash<qint32, QHash<quint64, Dwarf_Word>> stackValues;
         QVector<qint32> frames;
         QVector<qint32> disasmFrames;
+        // from and to of the taken branches in the branch stack, most recent first
+        QVector<qint32> branchFrames;
         PerfUnwind *unwind;
         const PerfRecordSample *sample;
         int maxFrames;
@@ -295,7 +312,7 @@ private:
         qint32 m_tid;
         quint64 m_time;
         quint32 m_cpu;
-        qint32 m_payload;
+        qint64 m_payload;
         EventType m_type;
 
         quint64 time() const { return m_time; }
@@ -341,7 +358,8 @@ private:
     void bufferEvent(const Event &event, QList<Event> *buffer, uint *eventCounter);
     void flushEventBuffer(uint desiredBufferSize);
 
-    QVariant readTraceData(const QByteArray &data, const FormatField &field, bool byteSwap);
+    void writeTraceData(QDataStream &stream, const QByteArray &data, const FormatField &field,
+                        bool byteSwap) const;
     void forwardMmapBuffer(QList<PerfRecordMmap>::Iterator &it,
                            const QList<PerfRecordMmap>::Iterator &mmapEnd,
                            quint64 timestamp);
@@ -0,0 +1,307 @@
+/*
+    batchexport.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "batchexport.h"
+
+#include <algorithm>
+
+#include <QDir>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include "flamegraphexport.h"
+#include "parsers/perf/perfparser.h"
+#include "util.h"
+
+namespace {
+QString csvField(const QString& value)
+{
+    auto escaped = value;
+    escaped.replace(QLatin1Char('"'), QLatin1String("\"\""));
+    return QLatin1Char('"') + escaped + QLatin1Char('"');
+}
+
+template<typename Writer>
+bool writeTextFile(const QString& fileName, Writer writer)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    {
+        QTextStream stream(&file);
+        writer(stream);
+    }
+    return file.commit();
+}
+
+void writeCostHeader(QTextStream& stream, const Data::Costs& costs, const QString& prefix)
+{
+    for (int i = 0; i < costs.numTypes(); ++i) {
+        stream << ',' << csvField(prefix + costs.typeName(i));
+    }
+}
+
+void writeCosts(QTextStream& stream, const Data::Costs& costs, quint32 id)
+{
+    for (int i = 0; i < costs.numTypes(); ++i) {
+        stream << ',' << costs.cost(i, id);
+    }
+}
+}
+
+BatchExporter::BatchExporter(const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_parser(new PerfParser(this))
+{
+    connect(m_parser, &PerfParser::summaryDataAvailable, this,
+            [this](const Data::Summary& data) { m_summary = data; });
+    connect(m_parser, &PerfParser::bottomUpDataAvailable, this,
+            [this](const Data::BottomUpResults& data) { m_bottomUp = data; });
+    connect(m_parser, &PerfParser::topDownDataAvailable, this,
+            [this](const Data::TopDownResults& data) { m_topDown = data; });
+    connect(m_parser, &PerfParser::callerCalleeDataAvailable, this,
+            [this](const Data::CallerCalleeResults& data) { m_callerCallee = data; });
+    connect(m_parser, &PerfParser::eventsAvailable, this,
+            [this](const Data::EventResults& data) { m_events = data; });
+    connect(m_parser, &PerfParser::parsingFailed, this, &BatchExporter::fail);
+    connect(m_parser, &PerfParser::parsingFinished, this, [this]() {
+        if (hasFilter() && !m_filterApplied) {
+            // the filtered results arrive through the same signals, the summary stays untouched
+            m_filterApplied = true;
+            m_filter = filterAction();
+            m_parser->filterResults(m_filter);
+            return;
+        }
+        writeResults();
+    });
+}
+
+BatchExporter::~BatchExporter() = default;
+
+void BatchExporter::start(const QString& fileName)
+{
+    m_fileName = fileName;
+    if (!QDir().mkpath(m_options.outputDirectory)) {
+        fail(tr("Failed to create output directory %1.").arg(m_options.outputDirectory));
+        return;
+    }
+
+    m_parser->startParseFile(fileName, m_options.sysroot, m_options.kallsyms, m_options.debugPaths,
+                             m_options.extraLibPaths, m_options.appPath, m_options.targetRoot, m_options.arch,
+                             m_options.disasmApproach, m_options.verbose, m_options.maxStack,
+                             m_options.branchTraverse);
+}
+
+bool BatchExporter::hasFilter() const
+{
+    return m_options.filterStartTime >= 0 || m_options.filterEndTime >= 0
+        || m_options.filterProcessId != Data::INVALID_PID || m_options.filterCpuId != Data::INVALID_CPU_ID;
+}
+
+Data::FilterAction BatchExporter::filterAction() const
+{
+    Data::FilterAction filter;
+    filter.processId = m_options.filterProcessId;
+    filter.cpuId = m_options.filterCpuId;
+
+    if (m_options.filterStartTime >= 0 || m_options.filterEndTime >= 0) {
+        Data::TimeRange range;
+        for (const auto& thread : m_events.threads) {
+            range.start = range.start ? std::min(range.start, thread.time.start) : thread.time.start;
+            range.end = std::max(range.end, thread.time.end);
+        }
+        const auto toTime = [&range](double seconds) {
+            return range.start + static_cast<quint64>(seconds * 1E9);
+        };
+        filter.time.start = m_options.filterStartTime >= 0 ? toTime(m_options.filterStartTime) : range.start;
+        filter.time.end = m_options.filterEndTime >= 0 ? toTime(m_options.filterEndTime) : range.end;
+    }
+    return filter;
+}
+
+void BatchExporter::fail(const QString& errorMessage)
+{
+    QTextStream(stderr) << tr("Failed to export %1: %2").arg(m_fileName, errorMessage) << endl;
+    emit finished(1);
+}
+
+void BatchExporter::writeResults()
+{
+    const QDir dir(m_options.outputDirectory);
+    if (!writeSummary(dir.filePath(QStringLiteral("summary.txt")))) {
+        fail(tr("Failed to write the summary."));
+    } else if (!writeBottomUp(dir.filePath(QStringLiteral("bottomup.csv")))) {
+        fail(tr("Failed to write the bottom-up table."));
+    } else if (!writeCallerCallee(dir.filePath(QStringLiteral("callercallee.csv")))) {
+        fail(tr("Failed to write the caller/callee table."));
+    } else if (!writeFlameGraphs()) {
+        fail(tr("Failed to write the flame graphs."));
+    } else {
+        emit finished(0);
+    }
+}
+
+bool BatchExporter::writeSummary(const QString& fileName) const
+{
+    return writeTextFile(fileName, [this](QTextStream& stream) {
+        stream << "file: " << m_fileName << '\n';
+        stream << "command: " << m_summary.command << '\n';
+        stream << "run time: " << Util::formatTimeString(m_summary.applicationRunningTime) << '\n';
+        if (m_summary.offCpuTime || m_summary.onCpuTime) {
+            stream << "on-CPU time: " << Util::formatTimeString(m_summary.onCpuTime) << '\n';
+            stream << "off-CPU time: " << Util::formatTimeString(m_summary.offCpuTime) << '\n';
+        }
+        stream << "processes: " << m_summary.processCount << '\n';
+        stream << "threads: " << m_summary.threadCount << '\n';
+        stream << "samples: " << m_summary.sampleCount << '\n';
+        stream << "lost chunks: " << m_summary.lostChunks << '\n';
+        if (m_summary.lostEvents) {
+            stream << "lost events: " << m_summary.lostEvents << '\n';
+            for (const auto& losses : m_summary.lostPerCpu) {
+                stream << "lost events: cpu " << losses.cpuId << ": " << losses.lostEvents << " in "
+                       << losses.lostChunks << " chunks, " << losses.sampleCount << " samples\n";
+            }
+        }
+        for (const auto& cost : m_summary.costs) {
+            stream << "cost: " << cost.label << ": " << cost.sampleCount << " samples, "
+                   << Data::Costs::formatCost(cost.unit, cost.totalPeriod) << " total\n";
+        }
+        stream << "host: " << m_summary.hostName << '\n';
+        stream << "kernel: " << m_summary.linuxKernelVersion << '\n';
+        stream << "perf: " << m_summary.perfVersion << '\n';
+        stream << "cpu: " << m_summary.cpuDescription << " (" << m_summary.cpuArchitecture << ", "
+               << m_summary.cpusOnline << "/" << m_summary.cpusAvailable << " online)\n";
+        if (hasFilter()) {
+            const auto& filter = m_filter;
+            stream << "filter:";
+            if (filter.time.isValid()) {
+                stream << " time " << filter.time.start << '-' << filter.time.end;
+            }
+            if (filter.processId != Data::INVALID_PID) {
+                stream << " pid " << filter.processId;
+            }
+            if (filter.cpuId != Data::INVALID_CPU_ID) {
+                stream << " cpu " << filter.cpuId;
+            }
+            stream << " (applies to all files but this summary)\n";
+        }
+        for (const auto& error : m_summary.errors) {
+            stream << "error: " << error << '\n';
+        }
+    });
+}
+
+bool BatchExporter::writeBottomUp(const QString& fileName) const
+{
+    // the direct children of the bottom-up root carry the self cost of each symbol
+    QVector<const Data::BottomUp*> rows;
+    rows.reserve(m_bottomUp.root.children.size());
+    for (const auto& row : m_bottomUp.root.children) {
+        rows.append(&row);
+    }
+    const auto& costs = m_bottomUp.costs;
+    const auto count = costs.numTypes() ? std::min(rows.size(), m_options.topCount) : 0;
+    std::partial_sort(rows.begin(), rows.begin() + count, rows.end(),
+                      [&costs](const Data::BottomUp* lhs, const Data::BottomUp* rhs) {
+                          return costs.cost(0, lhs->id) > costs.cost(0, rhs->id);
+                      });
+
+    return writeTextFile(fileName, [&](QTextStream& stream) {
+        stream << "symbol,binary";
+        writeCostHeader(stream, costs, {});
+        stream << '\n';
+        for (int i = 0; i < count; ++i) {
+            const auto* row = rows.at(i);
+            stream << csvField(Util::formatSymbol(row->symbol)) << ',' << csvField(row->symbol.binary);
+            writeCosts(stream, costs, row->id);
+            stream << '\n';
+        }
+    });
+}
+
+bool BatchExporter::writeCallerCallee(const QString& fileName) const
+{
+    using Entry = Data::CallerCalleeEntryMap::const_iterator;
+    QVector<Entry> entries;
+    entries.reserve(m_callerCallee.entries.size());
+    for (auto it = m_callerCallee.entries.cbegin(), end = m_callerCallee.entries.cend(); it != end; ++it) {
+        entries.append(it);
+    }
+    const auto& selfCosts = m_callerCallee.selfCosts;
+    const auto& inclusiveCosts = m_callerCallee.inclusiveCosts;
+    const auto count = inclusiveCosts.numTypes() ? std::min(entries.size(), m_options.topCount) : 0;
+    std::partial_sort(entries.begin(), entries.begin() + count, entries.end(),
+                      [&inclusiveCosts](Entry lhs, Entry rhs) {
+                          return inclusiveCosts.cost(0, lhs->id) > inclusiveCosts.cost(0, rhs->id);
+                      });
+
+    return writeTextFile(fileName, [&](QTextStream& stream) {
+        stream << "symbol,binary,relation,other symbol";
+        writeCostHeader(stream, selfCosts, QStringLiteral("self "));
+        writeCostHeader(stream, inclusiveCosts, QStringLiteral("inclusive "));
+        stream << '\n';
+
+        const auto writeRelations = [&stream](const QString& prefix, const char* relation,
+                                              const Data::SymbolCostMap& map) {
+            for (auto it = map.cbegin(), end = map.cend(); it != end; ++it) {
+                stream << prefix << ',' << relation << ',' << csvField(Util::formatSymbol(it.key()));
+                // callers and callees only know their inclusive cost
+                for (size_t i = 0; i < it.value().size(); ++i) {
+                    stream << ',';
+                }
+                for (size_t i = 0; i < it.value().size(); ++i) {
+                    stream << ',' << it.value()[i];
+                }
+                stream << '\n';
+            }
+        };
+
+        for (int i = 0; i < count; ++i) {
+            const auto entry = entries.at(i);
+            const auto prefix = csvField(Util::formatSymbol(entry.key())) + QLatin1Char(',')
+                + csvField(entry.key().binary);
+            stream << prefix << ",self,";
+            writeCosts(stream, selfCosts, entry->id);
+            writeCosts(stream, inclusiveCosts, entry->id);
+            stream << '\n';
+            writeRelations(prefix, "caller", entry->callers);
+            writeRelations(prefix, "callee", entry->callees);
+        }
+    });
+}
+
+bool BatchExporter::writeFlameGraphs()
+{
+    const QDir dir(m_options.outputDirectory);
+    for (int type = 0; type < m_topDown.inclusiveCosts.numTypes(); ++type) {
+        const auto baseName = dir.filePath(QStringLiteral("flamegraph.%1").arg(type));
+        FlameGraphExport::SvgOptions options;
+        options.minWidth = m_options.flameGraphMinWidth;
+        options.title = tr("Top Down FlameGraph: %1").arg(m_topDown.inclusiveCosts.typeName(type));
+        if (!FlameGraphExport::writeSvg(m_topDown, type, options, baseName + QLatin1String(".svg"))
+            || !FlameGraphExport::writeCollapsedStacks(m_topDown, type, baseName + QLatin1String(".collapsed"))) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+/*
+    batchexport.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QObject>
+
+#include "models/data.h"
+
+class PerfParser;
+
+/**
+ * Parse a perf.data file without any GUI and write the results into a directory.
+ *
+ * This drives the same PerfParser as the main window does, but only depends on
+ * QtCore at runtime and thus works on machines without a display server.
+ */
+class BatchExporter : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options
+    {
+        QString outputDirectory;
+        // number of rows written to the bottom-up and caller/callee tables
+        int topCount = 50;
+        // frames of the flame graphs narrower than this many pixels are skipped
+        double flameGraphMinWidth = 0.1;
+
+        // relative to the first event, in seconds, only used when valid
+        double filterStartTime = -1;
+        double filterEndTime = -1;
+        qint32 filterProcessId = Data::INVALID_PID;
+        quint32 filterCpuId = Data::INVALID_CPU_ID;
+
+        // forwarded to PerfParser::startParseFile
+        QString sysroot;
+        QString kallsyms;
+        QString debugPaths;
+        QString extraLibPaths;
+        QString appPath;
+        QString targetRoot;
+        QString arch;
+        QString disasmApproach;
+        QString verbose;
+        QString maxStack;
+        QString branchTraverse;
+    };
+
+    explicit BatchExporter(const Options& options, QObject* parent = nullptr);
+    ~BatchExporter();
+
+    void start(const QString& fileName);
+
+signals:
+    /// emitted once all files got written or when parsing failed, @p exitCode is suitable for QCoreApplication::exit
+    void finished(int exitCode);
+
+private:
+    bool hasFilter() const;
+    Data::FilterAction filterAction() const;
+    void fail(const QString& errorMessage);
+    void writeResults();
+    bool writeSummary(const QString& fileName) const;
+    bool writeBottomUp(const QString& fileName) const;
+    bool writeCallerCallee(const QString& fileName) const;
+    bool writeFlameGraphs();
+
+    Options m_options;
+    PerfParser* m_parser;
+    bool m_filterApplied = false;
+    Data::FilterAction m_filter;
+    QString m_fileName;
+
+    Data::Summary m_summary;
+    Data::BottomUpResults m_bottomUp;
+    Data::TopDownResults m_topDown;
+    Data::CallerCalleeResults m_callerCallee;
+    Data::EventResults m_events;
+};
@@ -28,6 +28,7 @@
 #include "flamegraph.h"
 
 #include <cmath>
+#include <cstdlib>
 
 #include <QAction>
 #include <QCheckBox>
@@ -55,6 +56,7 @@
 #include <KStandardAction>
 #include <ThreadWeaver/ThreadWeaver>
 
+#include "flamegraphexport.h"
 #include "models/filterandzoomstack.h"
 #include "resultsutil.h"
 #include "settings.h"
@@ -75,6 +77,9 @@ public:
 
     qint64 cost() const;
     void setCost(qint64 cost);
+    // for differential data: the compared minus the baseline cost
+    qint64 deltaCost() const;
+    void addDeltaCost(qint64 deltaCost);
     Data::Symbol symbol() const;
 
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
@@ -88,6 +93,8 @@ protected:
 
 private:
     qint64 m_cost;
+    qint64 m_deltaCost = 0;
+    bool m_hasDeltaCost = false;
     Data::Symbol m_symbol;
     bool m_isHovered;
     SearchMatchType m_searchMatch = NoSearch;
@@ -117,6 +124,17 @@ void FrameGraphicsItem::setCost(qint64 cost)
     m_cost = cost;
 }
 
+qint64 FrameGraphicsItem::deltaCost() const
+{
+    return m_deltaCost;
+}
+
+void FrameGraphicsItem::addDeltaCost(qint64 deltaCost)
+{
+    m_deltaCost += deltaCost;
+    m_hasDeltaCost = true;
+}
+
 Data::Symbol FrameGraphicsItem::symbol() const
 {
     return m_symbol;
@@ -206,6 +224,17 @@ QString FrameGraphicsItem::description() const
         return symbol;
     }
 
+    if (m_hasDeltaCost) {
+        const auto baselineCost = m_cost - m_deltaCost;
+        return i18nc("%1: aggregated sample costs, %2: relative number, %3: function label, %4: binary, "
+                     "%5: cost difference, %6: relative difference",
+                     "%1 (%2%) aggregated sample costs in %3 (%4) and below, %5 (%6%) compared to the baseline.",
+                     Data::Costs::formatCost(m_unit, m_cost), Util::formatCostRelative(m_cost, totalCost), symbol,
+                     m_symbol.binary,
+                     (m_deltaCost > 0 ? QStringLiteral("+") : QString()) + Data::Costs::formatCost(m_unit, m_deltaCost),
+                     baselineCost ? QString::number(100. * m_deltaCost / baselineCost, 'G', 3) : QString(QChar(0x221E)));
+    }
+
     return i18nc("%1: aggregated sample costs, %2: relative number, %3: function label, %4: binary",
                  "%1 (%2%) aggregated sample costs in %3 (%4) and below.", Data::Costs::formatCost(m_unit, m_cost),
                  Util::formatCostRelative(m_cost, totalCost), symbol, m_symbol.binary);
@@ -270,10 +299,45 @@ QBrush brush(const T& entry, BrushType type)
     return brushImpl(qHash(entry), type);
 }
 
+/**
+ * Color differential flame graphs: red for regressions, blue for improvements, the stronger the bigger the change.
+ */
+void applyDiffBrushes(FrameGraphicsItem* parent)
+{
+    foreach (auto child, parent->childItems()) {
+        auto frameChild = static_cast<FrameGraphicsItem*>(child);
+        const auto delta = frameChild->deltaCost();
+        const auto cost = std::max(frameChild->cost(), std::abs(delta));
+        const auto strength = cost ? static_cast<double>(std::abs(delta)) / cost : 0.;
+        const int other = 230 - static_cast<int>(180 * strength);
+        if (delta > 0) {
+            frameChild->setBrush(QColor(255, other, other, 180));
+        } else if (delta < 0) {
+            frameChild->setBrush(QColor(other, other, 255, 180));
+        } else {
+            frameChild->setBrush(QColor(230, 230, 230, 180));
+        }
+        applyDiffBrushes(frameChild);
+    }
+}
+
+/**
+ * Keys used to tag a root item with the settings it was built for, see QGraphicsItem::setData.
+ */
+enum RootItemDataKey
+{
+    CacheKeyData,
+    CostThresholdData,
+    GenerationData
+};
+
 /**
  * Layout the flame graph and hide tiny items.
+ *
+ * Items whose cost does not exceed @p costThreshold are shown without their children,
+ * which allows us to reuse a graph that was built for a lower threshold.
  */
-void layoutItems(FrameGraphicsItem* parent)
+void layoutItems(FrameGraphicsItem* parent, qint64 costThreshold)
 {
     const auto& parentRect = parent->rect();
     const auto pos = parentRect.topLeft();
@@ -296,7 +360,13 @@ void layoutItems(FrameGraphicsItem* parent)
         frameChild->setVisible(w > 1);
         if (frameChild->isVisible()) {
             frameChild->setRect(QRectF(x, y, w, h));
-            layoutItems(frameChild);
+            if (frameChild->cost() > costThreshold) {
+                layoutItems(frameChild, costThreshold);
+            } else {
+                foreach (auto grandChild, frameChild->childItems()) {
+                    grandChild->setVisible(false);
+                }
+            }
             x += w;
         }
     }
@@ -320,6 +390,7 @@ template<typename Tree>
 void toGraphicsItems(const Data::Costs& costs, int type, const QVector<Tree>& data, FrameGraphicsItem* parent,
                      const double costThreshold, bool collapseRecursion)
 {
+    const auto deltaType = costs.deltaType(type);
     foreach (const auto& row, data) {
         if (collapseRecursion && !row.symbol.symbol.isEmpty() && row.symbol == parent->symbol()) {
             if (costs.cost(type, row.id) > costThreshold) {
@@ -335,12 +406,25 @@ void toGraphicsItems(const Data::Costs& costs, int type, const QVector<Tree>& da
         } else {
             item->setCost(item->cost() + costs.cost(type, row.id));
         }
+        if (deltaType != -1) {
+            item->addDeltaCost(costs.cost(deltaType, row.id));
+        }
         if (item->cost() > costThreshold) {
             toGraphicsItems(costs, type, row.children, item, costThreshold, collapseRecursion);
         }
     }
 }
 
+int cacheKey(int type, bool showBottomUpData, bool collapseRecursion)
+{
+    return (type << 2) | (showBottomUpData ? 2 : 0) | (collapseRecursion ? 1 : 0);
+}
+
+qint64 absoluteCostThreshold(const FrameGraphicsItem* rootItem, double costThreshold)
+{
+    return static_cast<qint64>(static_cast<double>(rootItem->cost()) * costThreshold / 100.);
+}
+
 template<typename Tree>
 FrameGraphicsItem* parseData(const Data::Costs& costs, int type, const QVector<Tree>& topDownData, double costThreshold,
                              bool collapseRecursion)
@@ -355,6 +439,9 @@ FrameGraphicsItem* parseData(const Data::Costs& costs, int type, const QVector<T
     rootItem->setBrush(scheme.background());
     rootItem->setPen(pen);
     toGraphicsItems(costs, type, topDownData, rootItem, static_cast<double>(totalCost) * costThreshold / 100., collapseRecursion);
+    if (costs.deltaType(type) != -1) {
+        applyDiffBrushes(rootItem);
+    }
     return rootItem;
 }
 
@@ -517,7 +604,10 @@ FlameGraph::FlameGraph(QWidget* parent, Qt::WindowFlags flags)
     updateNavigationActions();
 }
 
-FlameGraph::~FlameGraph() = default;
+FlameGraph::~FlameGraph()
+{
+    clearLayoutCache();
+}
 
 void FlameGraph::setFilterStack(FilterAndZoomStack* filterStack)
 {
@@ -596,6 +686,7 @@ bool FlameGraph::eventFilter(QObject* object, QEvent* event)
 void FlameGraph::setTopDownData(const Data::TopDownResults& topDownData)
 {
     m_topDownData = topDownData;
+    clearLayoutCache();
 
     if (isVisible()) {
         showData();
@@ -607,14 +698,30 @@ void FlameGraph::setTopDownData(const Data::TopDownResults& topDownData)
 void FlameGraph::setBottomUpData(const Data::BottomUpResults& bottomUpData)
 {
     m_bottomUpData = bottomUpData;
+    clearLayoutCache();
 
     disconnect(m_costSource, nullptr, this, nullptr);
     ResultsUtil::fillEventSourceComboBox(m_costSource, bottomUpData.costs,
                                          ki18n("Show a flame graph over the aggregated %1 sample costs."));
+    // differential data: the delta is visualized via the colors of the baseline and compared graphs
+    for (int i = m_costSource->count() - 1; i >= 0; --i) {
+        const auto type = m_costSource->itemData(i).value<int>();
+        if (bottomUpData.costs.deltaType(type) == type) {
+            m_costSource->removeItem(i);
+        }
+    }
     connect(m_costSource, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
             &FlameGraph::showData);
 }
 
+void FlameGraph::selectCostType(int type)
+{
+    const auto index = m_costSource->findData(type);
+    if (index != -1) {
+        m_costSource->setCurrentIndex(index);
+    }
+}
+
 void FlameGraph::clear()
 {
     emit uiResetRequested();
@@ -664,6 +771,23 @@ void FlameGraph::saveSvg(const QString &fileName) const
     m_rootItem->setBrush(oldBrush);
 }
 
+bool FlameGraph::saveCompleteSvg(const QString& fileName, double minWidth, QString* errorMessage) const
+{
+    // unlike saveSvg, this ignores zooming and the cost threshold and streams all frames wide enough to be seen
+    FlameGraphExport::SvgOptions options;
+    options.minWidth = minWidth;
+    options.title = tr("Top Down FlameGraph: %1")
+                        .arg(m_topDownData.inclusiveCosts.typeName(m_costSource->currentData().value<int>()));
+    return FlameGraphExport::writeSvg(m_topDownData, m_costSource->currentData().value<int>(), options, fileName,
+                                      errorMessage);
+}
+
+bool FlameGraph::saveCollapsedStacks(const QString& fileName, QString* errorMessage) const
+{
+    return FlameGraphExport::writeCollapsedStacks(m_topDownData, m_costSource->currentData().value<int>(), fileName,
+                                                  errorMessage);
+}
+
 void FlameGraph::showData()
 {
     auto showBottomUpData = m_showBottomUpData;
@@ -673,16 +797,29 @@ void FlameGraph::showData()
         return;
     }
 
+    bool collapseRecursion = m_collapseRecursion;
+    auto type = m_costSource->currentData().value<int>();
+    auto threshold = m_costThreshold;
+    const auto key = cacheKey(type, showBottomUpData, collapseRecursion);
+
+    // a graph built for a lower threshold contains everything we need, only the layout has to be redone
+    if (auto cachedItem = m_layoutCache.value(key)) {
+        if (cachedItem->data(CostThresholdData).toDouble() <= threshold) {
+            setData(cachedItem);
+            updateNavigationActions();
+            return;
+        }
+    }
+
     setData(nullptr);
 
     m_buildingScene = true;
     using namespace ThreadWeaver;
     auto bottomUpData = m_bottomUpData;
     auto topDownData = m_topDownData;
-    bool collapseRecursion = m_collapseRecursion;
-    auto type = m_costSource->currentData().value<int>();
-    auto threshold = m_costThreshold;
-    stream() << make_job([showBottomUpData, bottomUpData, topDownData, type, threshold, collapseRecursion, this]() {
+    auto generation = m_dataGeneration;
+    stream() << make_job([showBottomUpData, bottomUpData, topDownData, type, threshold, collapseRecursion, key,
+                          generation, this]() {
         FrameGraphicsItem* parsedData = nullptr;
         if (showBottomUpData) {
             parsedData = parseData(bottomUpData.costs, type, bottomUpData.root.children, threshold, collapseRecursion);
@@ -690,11 +827,38 @@ void FlameGraph::showData()
             parsedData =
                 parseData(topDownData.inclusiveCosts, type, topDownData.root.children, threshold, collapseRecursion);
         }
+        parsedData->setData(CacheKeyData, key);
+        parsedData->setData(CostThresholdData, threshold);
+        parsedData->setData(GenerationData, generation);
         QMetaObject::invokeMethod(this, "setData", Qt::QueuedConnection, Q_ARG(FrameGraphicsItem*, parsedData));
     });
     updateNavigationActions();
 }
 
+void FlameGraph::clearLayoutCache()
+{
+    // the current root item is owned by the scene and will be deleted by it
+    for (auto item : qAsConst(m_layoutCache)) {
+        if (item != m_rootItem) {
+            delete item;
+        }
+    }
+    m_layoutCache.clear();
+    ++m_dataGeneration;
+}
+
+bool FlameGraph::isCached(const FrameGraphicsItem* rootItem) const
+{
+    return rootItem && m_layoutCache.value(rootItem->data(CacheKeyData).toInt()) == rootItem;
+}
+
+bool FlameGraph::matchesCurrentSettings(const FrameGraphicsItem* rootItem) const
+{
+    const auto key = cacheKey(m_costSource->currentData().value<int>(), m_showBottomUpData, m_collapseRecursion);
+    return rootItem->data(CacheKeyData).toInt() == key
+        && rootItem->data(CostThresholdData).toDouble() <= m_costThreshold;
+}
+
 void FlameGraph::setTooltipItem(const FrameGraphicsItem* item)
 {
     if (!item && m_selectedItem != -1 && m_selectionHistory.at(m_selectedItem)) {
@@ -717,7 +881,36 @@ void FlameGraph::updateTooltip()
 
 void FlameGraph::setData(FrameGraphicsItem* rootItem)
 {
+    if (rootItem && rootItem->data(GenerationData).toUInt() != m_dataGeneration) {
+        // built from data that got replaced in the meantime
+        delete rootItem;
+        return;
+    } else if (rootItem && !matchesCurrentSettings(rootItem)) {
+        // result of a superseded job, keep it if it is more detailed than what we have cached already
+        auto& cachedItem = m_layoutCache[rootItem->data(CacheKeyData).toInt()];
+        if (!cachedItem
+            || (cachedItem != m_rootItem
+                && cachedItem->data(CostThresholdData).toDouble() > rootItem->data(CostThresholdData).toDouble())) {
+            delete cachedItem;
+            cachedItem = rootItem;
+        } else {
+            delete rootItem;
+        }
+        return;
+    }
+
+    // keep cached graphs alive, all other items get deleted by the scene
+    if (isCached(m_rootItem)) {
+        m_scene->removeItem(m_rootItem);
+    }
     m_scene->clear();
+    if (rootItem) {
+        auto& cachedItem = m_layoutCache[rootItem->data(CacheKeyData).toInt()];
+        if (cachedItem != rootItem) {
+            delete cachedItem;
+            cachedItem = rootItem;
+        }
+    }
     m_buildingScene = false;
     m_tooltipItem = nullptr;
     m_rootItem = rootItem;
@@ -736,9 +929,8 @@ void FlameGraph::setData(FrameGraphicsItem* rootItem)
     rootItem->setRect(0, 0, 800, m_view->fontMetrics().height() + 4);
     m_scene->addItem(rootItem);
 
-    if (!m_searchInput->text().isEmpty()) {
-        setSearchValue(m_searchInput->text());
-    }
+    // always apply the search, a cached graph may still carry the matches of an older search
+    setSearchValue(m_searchInput->text());
 
     if (isVisible()) {
         selectItem(m_rootItem);
@@ -778,7 +970,7 @@ void FlameGraph::selectItem(FrameGraphicsItem* item)
     }
 
     // then layout all items below the selected on
-    layoutItems(item);
+    layoutItems(item, absoluteCostThreshold(m_rootItem, m_costThreshold));
 
     // Triggers a refresh of the scene's bounding rect without going via the
     // event loop. This makes the centerOn call below work as expected in all cases.
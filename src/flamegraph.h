@@ -28,6 +28,7 @@
 #ifndef FLAMEGRAPH_H
 #define FLAMEGRAPH_H
 
+#include <QHash>
 #include <QVector>
 #include <QWidget>
 
@@ -53,10 +54,15 @@ public:
     void setFilterStack(FilterAndZoomStack *filterStack);
     void setTopDownData(const Data::TopDownResults& topDownData);
     void setBottomUpData(const Data::BottomUpResults& bottomUpData);
+    // show the costs of @p type, if the data has any
+    void selectCostType(int type);
     void clear();
 
     QImage toImage() const;
     void saveSvg(const QString &fileName) const;
+    // frames narrower than @p minWidth pixels are skipped, see FlameGraphExport::SvgOptions
+    bool saveCompleteSvg(const QString& fileName, double minWidth, QString* errorMessage) const;
+    bool saveCollapsedStacks(const QString& fileName, QString* errorMessage) const;
 
 protected:
     bool eventFilter(QObject* object, QEvent* event) override;
@@ -78,6 +84,9 @@ private:
     void selectItem(int item);
     void selectItem(FrameGraphicsItem* item);
     void updateNavigationActions();
+    void clearLayoutCache();
+    bool isCached(const FrameGraphicsItem* rootItem) const;
+    bool matchesCurrentSettings(const FrameGraphicsItem* rootItem) const;
 
     Data::TopDownResults m_topDownData;
     Data::BottomUpResults m_bottomUpData;
@@ -96,6 +105,10 @@ private:
     QPushButton* m_forwardButton = nullptr;
     const FrameGraphicsItem* m_tooltipItem = nullptr;
     FrameGraphicsItem* m_rootItem = nullptr;
+    // graphs that were built already, keyed by cost type and view options, see cacheKey()
+    QHash<int, FrameGraphicsItem*> m_layoutCache;
+    // bumped whenever new data arrives, to discard results of outdated jobs
+    uint m_dataGeneration = 0;
     QVector<FrameGraphicsItem*> m_selectionHistory;
     int m_selectedItem = -1;
     int m_minRootWidth = 0;
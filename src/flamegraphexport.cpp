@@ -0,0 +1,257 @@
+/*
+    flamegraphexport.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "flamegraphexport.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QXmlStreamWriter>
+
+#include "util.h"
+
+namespace {
+
+// rough width of a character of the monospace font used in the SVG
+const double CHAR_WIDTH = 7.;
+const int PADDING = 10;
+const int TITLE_HEIGHT = 30;
+
+QString frameLabel(const Data::Symbol& symbol)
+{
+    const auto label = Util::formatSymbol(symbol, false);
+    if (label.isEmpty()) {
+        return QStringLiteral("?? [%1]").arg(Util::formatString(symbol.binary));
+    }
+    return label;
+}
+
+/**
+ * Children sorted by symbol, to get the same ordering as the interactive flame graph.
+ */
+QVector<const Data::TopDown*> sortedChildren(const Data::TopDown& parent)
+{
+    QVector<const Data::TopDown*> children;
+    children.reserve(parent.children.size());
+    for (const auto& child : parent.children) {
+        children.append(&child);
+    }
+    std::sort(children.begin(), children.end(),
+              [](const Data::TopDown* lhs, const Data::TopDown* rhs) { return lhs->symbol < rhs->symbol; });
+    return children;
+}
+
+void writeCollapsed(const Data::Costs& selfCosts, int costType, const Data::TopDown& parent, QStringList* stack,
+                    QTextStream& stream)
+{
+    for (const auto& child : parent.children) {
+        auto frame = frameLabel(child.symbol);
+        // semicolons separate the frames, spaces the cost
+        frame.replace(QLatin1Char(';'), QLatin1Char(':'));
+        frame.replace(QLatin1Char('\n'), QLatin1Char(' '));
+        stack->append(frame);
+
+        const auto cost = selfCosts.cost(costType, child.id);
+        if (cost > 0) {
+            stream << stack->join(QLatin1Char(';')) << ' ' << cost << '\n';
+        }
+        writeCollapsed(selfCosts, costType, child, stack, stream);
+
+        stack->removeLast();
+    }
+}
+
+int maxVisibleDepth(const Data::Costs& inclusiveCosts, int costType, const Data::TopDown& parent, double scale,
+                    double minWidth)
+{
+    int depth = 0;
+    for (const auto& child : parent.children) {
+        if (inclusiveCosts.cost(costType, child.id) * scale < minWidth) {
+            continue;
+        }
+        depth = std::max(depth, 1 + maxVisibleDepth(inclusiveCosts, costType, child, scale, minWidth));
+    }
+    return depth;
+}
+
+QString frameColor(const QString& label)
+{
+    // the "hot" color space of flamegraph.pl, but stable across exports
+    const auto hash = qHash(label);
+    return QStringLiteral("rgb(%1,%2,%3)").arg(205 + hash % 50).arg((hash / 50) % 230).arg((hash / 11500) % 55);
+}
+
+struct SvgWriter
+{
+    const Data::Costs& costs;
+    int costType;
+    const FlameGraphExport::SvgOptions& options;
+    double scale;
+    int maxDepth;
+    QXmlStreamWriter& xml;
+
+    void writeFrame(const QString& label, qint64 cost, double x, int depth)
+    {
+        const auto width = cost * scale;
+        const auto y = TITLE_HEIGHT + (maxDepth - depth) * options.frameHeight;
+        const auto totalCost = costs.totalCost(costType);
+
+        xml.writeStartElement(QStringLiteral("g"));
+        xml.writeTextElement(QStringLiteral("title"),
+                             QStringLiteral("%1 (%2, %3%)")
+                                 .arg(label, costs.formatCost(costType, cost),
+                                      Util::formatCostRelative(cost, totalCost)));
+        xml.writeEmptyElement(QStringLiteral("rect"));
+        xml.writeAttribute(QStringLiteral("x"), QString::number(x, 'f', 1));
+        xml.writeAttribute(QStringLiteral("y"), QString::number(y));
+        xml.writeAttribute(QStringLiteral("width"), QString::number(width, 'f', 1));
+        xml.writeAttribute(QStringLiteral("height"), QString::number(options.frameHeight - 1));
+        xml.writeAttribute(QStringLiteral("fill"), depth ? frameColor(label) : QStringLiteral("rgb(240,240,240)"));
+        xml.writeAttribute(QStringLiteral("rx"), QStringLiteral("2"));
+
+        const int maxChars = static_cast<int>(width / CHAR_WIDTH);
+        if (maxChars >= 3) {
+            xml.writeStartElement(QStringLiteral("text"));
+            xml.writeAttribute(QStringLiteral("x"), QString::number(x + 3, 'f', 1));
+            xml.writeAttribute(QStringLiteral("y"), QString::number(y + options.frameHeight - 4));
+            xml.writeCharacters(label.size() <= maxChars ? label : (label.left(maxChars - 2) + QLatin1String("..")));
+            xml.writeEndElement();
+        }
+        xml.writeEndElement();
+    }
+
+    void writeChildren(const Data::TopDown& parent, double x, int depth)
+    {
+        for (const auto* child : sortedChildren(parent)) {
+            const auto cost = costs.cost(costType, child->id);
+            const auto width = cost * scale;
+            if (width < options.minWidth) {
+                x += width;
+                continue;
+            }
+            writeFrame(frameLabel(child->symbol), cost, x, depth);
+            writeChildren(*child, x, depth + 1);
+            x += width;
+        }
+    }
+};
+
+template<typename Writer>
+bool writeToFile(const QString& fileName, QString* errorMessage, Writer writer)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+    if (!writer(&file) || !file.commit()) {
+        if (errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+}
+
+bool FlameGraphExport::writeCollapsedStacks(const Data::TopDownResults& data, int costType, QIODevice* device)
+{
+    if (costType < 0 || costType >= data.selfCosts.numTypes()) {
+        return false;
+    }
+
+    QTextStream stream(device);
+    QStringList stack;
+    writeCollapsed(data.selfCosts, costType, data.root, &stack, stream);
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
+
+bool FlameGraphExport::writeCollapsedStacks(const Data::TopDownResults& data, int costType, const QString& fileName,
+                                            QString* errorMessage)
+{
+    return writeToFile(fileName, errorMessage,
+                       [&](QIODevice* device) { return writeCollapsedStacks(data, costType, device); });
+}
+
+bool FlameGraphExport::writeSvg(const Data::TopDownResults& data, int costType, const SvgOptions& options,
+                                QIODevice* device)
+{
+    const auto& costs = data.inclusiveCosts;
+    if (costType < 0 || costType >= costs.numTypes()) {
+        return false;
+    }
+
+    const auto totalCost = costs.totalCost(costType);
+    const auto graphWidth = options.width - 2 * PADDING;
+    const auto scale = totalCost ? static_cast<double>(graphWidth) / totalCost : 0.;
+    const auto maxDepth = maxVisibleDepth(costs, costType, data.root, scale, options.minWidth);
+    const auto height = TITLE_HEIGHT + (maxDepth + 1) * options.frameHeight + PADDING;
+
+    QXmlStreamWriter xml(device);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement(QStringLiteral("svg"));
+    xml.writeDefaultNamespace(QStringLiteral("http://www.w3.org/2000/svg"));
+    xml.writeAttribute(QStringLiteral("version"), QStringLiteral("1.1"));
+    xml.writeAttribute(QStringLiteral("width"), QString::number(options.width));
+    xml.writeAttribute(QStringLiteral("height"), QString::number(height));
+    xml.writeAttribute(QStringLiteral("viewBox"), QStringLiteral("0 0 %1 %2").arg(options.width).arg(height));
+    xml.writeAttribute(QStringLiteral("font-family"), QStringLiteral("monospace"));
+    xml.writeAttribute(QStringLiteral("font-size"), QStringLiteral("12"));
+
+    xml.writeEmptyElement(QStringLiteral("rect"));
+    xml.writeAttribute(QStringLiteral("width"), QStringLiteral("100%"));
+    xml.writeAttribute(QStringLiteral("height"), QStringLiteral("100%"));
+    xml.writeAttribute(QStringLiteral("fill"), QStringLiteral("white"));
+
+    const auto title = options.title.isEmpty()
+        ? QCoreApplication::translate("FlameGraphExport", "Top Down FlameGraph: %1").arg(costs.typeName(costType))
+        : options.title;
+    xml.writeStartElement(QStringLiteral("text"));
+    xml.writeAttribute(QStringLiteral("x"), QString::number(options.width / 2));
+    xml.writeAttribute(QStringLiteral("y"), QString::number(TITLE_HEIGHT / 2 + 4));
+    xml.writeAttribute(QStringLiteral("text-anchor"), QStringLiteral("middle"));
+    xml.writeAttribute(QStringLiteral("font-size"), QStringLiteral("16"));
+    xml.writeCharacters(title);
+    xml.writeEndElement();
+
+    SvgWriter writer {costs, costType, options, scale, maxDepth, xml};
+    writer.writeFrame(QCoreApplication::translate("FlameGraphExport", "%1 aggregated %2 cost in total")
+                          .arg(costs.formatCost(costType, totalCost), costs.typeName(costType)),
+                      totalCost, PADDING, 0);
+    writer.writeChildren(data.root, PADDING, 1);
+
+    xml.writeEndElement();
+    xml.writeEndDocument();
+    return !xml.hasError();
+}
+
+bool FlameGraphExport::writeSvg(const Data::TopDownResults& data, int costType, const SvgOptions& options,
+                                const QString& fileName, QString* errorMessage)
+{
+    return writeToFile(fileName, errorMessage,
+                       [&](QIODevice* device) { return writeSvg(data, costType, options, device); });
+}
@@ -0,0 +1,64 @@
+/*
+    flamegraphexport.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QString>
+
+#include "models/data.h"
+
+class QIODevice;
+
+/**
+ * Export flame graphs straight from the top-down tree.
+ *
+ * Unlike FlameGraph::saveSvg, this doesn't need a graphics scene and only
+ * keeps the current stack in memory, which makes it usable for huge data
+ * sets as well as in headless mode.
+ */
+namespace FlameGraphExport {
+
+struct SvgOptions
+{
+    // width of the whole graph in pixels
+    int width = 1200;
+    // height of a single frame in pixels
+    int frameHeight = 16;
+    // frames narrower than this are skipped together with their children
+    double minWidth = 0.1;
+    QString title;
+};
+
+/**
+ * Write the stacks in the collapsed format of Brendan Gregg's stackcollapse
+ * scripts, i.e. one line "caller;callee;... cost" per stack with a non-zero self cost.
+ */
+bool writeCollapsedStacks(const Data::TopDownResults& data, int costType, QIODevice* device);
+bool writeCollapsedStacks(const Data::TopDownResults& data, int costType, const QString& fileName,
+                          QString* errorMessage = nullptr);
+
+/**
+ * Write an SVG flame graph with the root at the bottom, similar to flamegraph.pl.
+ */
+bool writeSvg(const Data::TopDownResults& data, int costType, const SvgOptions& options, QIODevice* device);
+bool writeSvg(const Data::TopDownResults& data, int costType, const SvgOptions& options, const QString& fileName,
+              QString* errorMessage = nullptr);
+}
@@ -29,7 +29,9 @@
 #include <QCommandLineParser>
 #include <QProcessEnvironment>
 #include <QFile>
+#include <QTimer>
 
+#include "batchexport.h"
 #include "hotspot-config.h"
 #include "mainwindow.h"
 #include "models/data.h"
@@ -38,6 +40,21 @@
 #include <ThreadWeaver/ThreadWeaver>
 #include <QThread>
 
+#include <cstring>
+
+namespace {
+// we need to know this before the application object gets created, to not require a display in batch mode
+bool isBatchMode(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--export") || !strncmp(argv[i], "--export=", 9)) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
 int main(int argc, char** argv)
 {
     QCoreApplication::setOrganizationName(QStringLiteral("KDAB"));
@@ -45,7 +62,8 @@ int main(int argc, char** argv)
     QCoreApplication::setApplicationName(QStringLiteral("hotspot"));
     QCoreApplication::setApplicationVersion(QStringLiteral(HOTSPOT_VERSION_STRING));
 
-    QApplication app(argc, argv);
+    const bool batchMode = isBatchMode(argc, argv);
+    QScopedPointer<QCoreApplication> app(batchMode ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
 
     // init
     Util::appImageEnvironment();
@@ -60,8 +78,11 @@ int main(int argc, char** argv)
     qputenv("LD_LIBRARY_PATH", LD_LIBRARY_PATH);
 #endif
 
-    app.setWindowIcon(QIcon(QStringLiteral(":/images/icons/512-hotspot_app_icon.png")));
+    if (!batchMode) {
+        QApplication::setWindowIcon(QIcon(QStringLiteral(":/images/icons/512-hotspot_app_icon.png")));
+    }
     qRegisterMetaType<Data::DisassemblyResult>();
+    qRegisterMetaType<Data::DisassemblyEntry>();
     qRegisterMetaType<Data::Summary>();
     qRegisterMetaType<Data::BottomUp>();
     qRegisterMetaType<Data::TopDown>();
@@ -69,11 +90,17 @@ int main(int argc, char** argv)
     qRegisterMetaType<Data::BottomUpResults>();
     qRegisterMetaType<Data::TopDownResults>();
     qRegisterMetaType<Data::CallerCalleeResults>();
+    qRegisterMetaType<Data::OffCpuResults>();
+    qRegisterMetaType<Data::ParallelismResults>();
+    qRegisterMetaType<Data::LockContentionResults>();
+    qRegisterMetaType<Data::CriticalPath>();
     qRegisterMetaType<Data::EventResults>();
 
 #if APPIMAGE_BUILD
-    QIcon::setThemeSearchPaths({app.applicationDirPath() + QLatin1String("/../share/icons/")});
-    QIcon::setThemeName(QStringLiteral("breeze"));
+    if (!batchMode) {
+        QIcon::setThemeSearchPaths({QCoreApplication::applicationDirPath() + QLatin1String("/../share/icons/")});
+        QIcon::setThemeName(QStringLiteral("breeze"));
+    }
 #endif
 
     QCommandLineParser parser;
@@ -146,15 +173,130 @@ int main(int argc, char** argv)
                                       "Short branchStack resolveCallchain traverse. Concerns lbr."));
     parser.addOption(branchTraverse);
 
+    QCommandLineOption exportDir(QLatin1String("export"),
+                                 QCoreApplication::translate("main",
+                                 "Don't show the GUI, instead parse the given file and write the summary,"
+                                 " bottom-up and caller/callee tables as well as flame graphs into the directory."),
+                                 QLatin1String("directory"));
+    parser.addOption(exportDir);
+
+    QCommandLineOption exportTop(QLatin1String("export-top"),
+                                 QCoreApplication::translate("main",
+                                 "Number of symbols written to the exported tables, defaults to 50."),
+                                 QLatin1String("count"));
+    parser.addOption(exportTop);
+
+    QCommandLineOption exportMinWidth(QLatin1String("export-min-width"),
+                                      QCoreApplication::translate("main",
+                                      "Skip the frames of the exported flame graphs that are narrower than the"
+                                      " given number of pixels, defaults to 0.1."),
+                                      QLatin1String("pixels"));
+    parser.addOption(exportMinWidth);
+
+    QCommandLineOption filterTime(QLatin1String("filter-time"),
+                                  QCoreApplication::translate("main",
+                                  "Only export events within the time range, given in seconds relative to the"
+                                  " first event. Either side may be omitted, e.g. '1.5,' or ',3'."),
+                                  QLatin1String("start,end"));
+    parser.addOption(filterTime);
+
+    QCommandLineOption filterPid(QLatin1String("filter-pid"),
+                                 QCoreApplication::translate("main", "Only export events of the given process."),
+                                 QLatin1String("pid"));
+    parser.addOption(filterPid);
+
+    QCommandLineOption filterCpu(QLatin1String("filter-cpu"),
+                                 QCoreApplication::translate("main", "Only export events of the given CPU."),
+                                 QLatin1String("cpu"));
+    parser.addOption(filterCpu);
+
     parser.addPositionalArgument(
         QStringLiteral("files"),
         QCoreApplication::translate("main", "Optional input files to open on startup, i.e. perf.data files."),
         QStringLiteral("[files...]"));
 
-    parser.process(app);
+    parser.process(*app);
 
     ThreadWeaver::Queue::instance()->setMaximumNumberOfThreads(QThread::idealThreadCount());
 
+    if (batchMode) {
+        const auto files = parser.positionalArguments();
+        if (files.size() > 1) {
+            qWarning("only a single file can be exported at once");
+            return 1;
+        }
+
+        BatchExporter::Options options;
+        options.outputDirectory = parser.value(exportDir);
+        if (parser.isSet(exportTop)) {
+            bool ok = false;
+            options.topCount = parser.value(exportTop).toInt(&ok);
+            if (!ok || options.topCount <= 0) {
+                qWarning("invalid count passed to --export-top");
+                return 1;
+            }
+        }
+        if (parser.isSet(exportMinWidth)) {
+            bool ok = false;
+            options.flameGraphMinWidth = parser.value(exportMinWidth).toDouble(&ok);
+            if (!ok || options.flameGraphMinWidth < 0) {
+                qWarning("invalid width passed to --export-min-width");
+                return 1;
+            }
+        }
+        if (parser.isSet(filterTime)) {
+            const auto range = parser.value(filterTime).split(QLatin1Char(','));
+            bool ok = true;
+            if (!range.value(0).isEmpty()) {
+                options.filterStartTime = range.value(0).toDouble(&ok);
+            }
+            if (ok && !range.value(1).isEmpty()) {
+                options.filterEndTime = range.value(1).toDouble(&ok);
+            }
+            if (!ok || range.size() > 2) {
+                qWarning("invalid time range passed to --filter-time");
+                return 1;
+            }
+        }
+        if (parser.isSet(filterPid)) {
+            bool ok = false;
+            options.filterProcessId = parser.value(filterPid).toInt(&ok);
+            if (!ok || options.filterProcessId < 0) {
+                qWarning("invalid process id passed to --filter-pid");
+                return 1;
+            }
+        }
+        if (parser.isSet(filterCpu)) {
+            bool ok = false;
+            options.filterCpuId = parser.value(filterCpu).toUInt(&ok);
+            if (!ok || options.filterCpuId == Data::INVALID_CPU_ID) {
+                qWarning("invalid cpu passed to --filter-cpu");
+                return 1;
+            }
+        }
+        options.sysroot = parser.value(sysroot);
+        options.kallsyms = parser.value(kallsyms);
+        options.debugPaths = parser.value(debugPaths);
+        options.extraLibPaths = parser.value(extraLibPaths);
+        options.appPath = parser.value(appPath);
+        options.targetRoot = parser.value(targetRoot);
+        options.arch = parser.value(arch);
+        options.disasmApproach = parser.value(disasmApproach);
+        options.verbose = parser.value(verbose);
+        options.maxStack = parser.value(maxStack);
+        if (parser.isSet(branchTraverse)) {
+            options.branchTraverse = branchTraverse.names().at(0);
+        }
+
+        const auto file = files.isEmpty() ? QStringLiteral("perf.data") : files.first();
+        BatchExporter exporter(options);
+        QObject::connect(&exporter, &BatchExporter::finished, app.data(),
+                         [](int exitCode) { QCoreApplication::exit(exitCode); });
+        // start from within the event loop, such that early failures can quit it
+        QTimer::singleShot(0, &exporter, [&exporter, file]() { exporter.start(file); });
+        return app->exec();
+    }
+
     auto applyCliArgs = [&](MainWindow* window) {
         if (parser.isSet(sysroot)) {
             window->setSysroot(parser.value(sysroot));
@@ -213,5 +355,5 @@ int main(int argc, char** argv)
         window->show();
     }
 
-    return app.exec();
+    return app->exec();
 }
@@ -28,6 +28,7 @@
 #include "mainwindow.h"
 #include "recordpage.h"
 #include "resultspage.h"
+#include "segmentwatcher.h"
 #include "settings.h"
 #include "startpage.h"
 #include "ui_mainwindow.h"
@@ -60,6 +61,7 @@
 #include "parsers/perf/perfparser.h"
 
 #include <functional>
+#include <memory>
 
 namespace {
 struct IdeSettings
@@ -113,6 +115,7 @@ MainWindow::MainWindow(QWidget* parent)
     , m_startPage(new StartPage(this))
     , m_recordPage(new RecordPage(this))
     , m_resultsPage(new ResultsPage(m_parser, this))
+    , m_segmentWatcher(new SegmentWatcher(this))
 {
     ui->setupUi(this);
 
@@ -126,6 +129,7 @@ MainWindow::MainWindow(QWidget* parent)
 
     connect(this, &MainWindow::sysrootChanged, m_resultsPage, &ResultsPage::setSysroot);
     connect(this, &MainWindow::appPathChanged, m_resultsPage, &ResultsPage::setAppPath);
+    connect(this, &MainWindow::sourcePathMapChanged, m_resultsPage, &ResultsPage::setSourcePathMap);
     connect(m_startPage, &StartPage::pathsAndArchSettingsButtonClicked, this, &MainWindow::onPathsAndArchSettingsButtonClicked);
 
     connect(m_startPage, &StartPage::openFileButtonClicked, this, &MainWindow::onOpenFileButtonClicked);
@@ -136,8 +140,24 @@ MainWindow::MainWindow(QWidget* parent)
     connect(m_recordPage, &RecordPage::homeButtonClicked, this, &MainWindow::onHomeButtonClicked);
     connect(m_recordPage, &RecordPage::openFile, this,
             static_cast<void (MainWindow::*)(const QString&)>(&MainWindow::openFile));
+    connect(m_recordPage, &RecordPage::liveRecordingStarted, this, &MainWindow::openLiveRecording);
+    connect(m_recordPage, &RecordPage::liveRecordingData, m_parser, &PerfParser::addLiveInput);
+    connect(m_recordPage, &RecordPage::liveRecordingFinished, m_parser, &PerfParser::finishLiveInput);
+    connect(m_recordPage, &RecordPage::liveRecordingFinished, this,
+            [this]() { m_stopLiveRecordingAction->setEnabled(false); });
+    connect(m_parser, &PerfParser::liveSnapshotStarted, this, [this]() {
+        // the results are shown as soon as the first snapshot arrives
+        if (m_pageStack->currentWidget() == m_recordPage) {
+            m_pageStack->setCurrentWidget(m_resultsPage);
+        }
+    });
+
+    connect(m_segmentWatcher, &SegmentWatcher::segmentsAdded, this, &MainWindow::appendSegments);
 
-    connect(m_parser, &PerfParser::parsingFinished, this, [this]() { m_pageStack->setCurrentWidget(m_resultsPage); });
+    connect(m_parser, &PerfParser::parsingFinished, this, [this]() {
+        m_pageStack->setCurrentWidget(m_resultsPage);
+        m_compareAction->setEnabled(true);
+    });
     connect(m_parser, &PerfParser::parsingFailed, this,
             [this](const QString& errorMessage) { emit openFileError(errorMessage); });
 
@@ -148,7 +168,18 @@ MainWindow::MainWindow(QWidget* parent)
     ui->fileMenu->addAction(recordDataAction);
     connect(recordDataAction, &QAction::triggered, this, &MainWindow::onRecordButtonClicked);
 
+    m_stopLiveRecordingAction = new QAction(QIcon::fromTheme(QStringLiteral("media-playback-stop")),
+                                            tr("&Stop Live Recording"), this);
+    m_stopLiveRecordingAction->setToolTip(tr("Stop the recording that is analyzed live, the results stay shown."));
+    m_stopLiveRecordingAction->setEnabled(false);
+    connect(m_stopLiveRecordingAction, &QAction::triggered, m_recordPage, &RecordPage::stopRecording);
+    ui->fileMenu->addAction(m_stopLiveRecordingAction);
+
     connect(m_resultsPage, &ResultsPage::navigateToCode, this, &MainWindow::navigateToCode);
+    connect(m_resultsPage, &ResultsPage::recordWithFewerLosses, this, [this](double lostFraction) {
+        onRecordButtonClicked();
+        m_recordPage->reduceLostEvents(lostFraction);
+    });
     ui->fileMenu->addAction(KStandardAction::open(this, SLOT(onOpenFileButtonClicked()), this));
     m_recentFilesAction = KStandardAction::openRecent(this, SLOT(openFile(QUrl)), this);
     m_recentFilesAction->loadEntries(m_config->group("RecentFiles"));
@@ -156,6 +187,20 @@ MainWindow::MainWindow(QWidget* parent)
     m_reloadAction = KStandardAction::redisplay(this, SLOT(reload()), this);
     m_reloadAction->setText(tr("Reload"));
     ui->fileMenu->addAction(m_reloadAction);
+    m_compareAction = new QAction(QIcon::fromTheme(QStringLiteral("kompare")), tr("&Compare With..."), this);
+    m_compareAction->setToolTip(tr("Compare the opened file with another one, to find regressions and improvements."));
+    m_compareAction->setEnabled(false);
+    connect(m_compareAction, &QAction::triggered, this, &MainWindow::onCompareFileButtonClicked);
+    ui->fileMenu->addAction(m_compareAction);
+    auto aggregateAction = new QAction(QIcon::fromTheme(QStringLiteral("document-open")), tr("&Aggregate Files..."), this);
+    aggregateAction->setToolTip(tr("Open multiple files at once and sum up their costs, e.g. from repeated runs or many machines."));
+    connect(aggregateAction, &QAction::triggered, this, &MainWindow::onAggregateFilesButtonClicked);
+    ui->fileMenu->addAction(aggregateAction);
+    auto watchAction = new QAction(QIcon::fromTheme(QStringLiteral("folder-open")), tr("&Watch Directory..."), this);
+    watchAction->setToolTip(tr("Open the segments rotated by 'perf record --switch-output' in a directory as one profile,"
+                               " that grows whenever a new segment appears."));
+    connect(watchAction, &QAction::triggered, this, &MainWindow::onWatchDirectoryButtonClicked);
+    ui->fileMenu->addAction(watchAction);
     ui->fileMenu->addAction(KStandardAction::close(this, SLOT(clear()), this));
     ui->fileMenu->addAction(KStandardAction::quit(this, SLOT(close()), this));
     connect(ui->actionAbout_Qt, &QAction::triggered, qApp, &QApplication::aboutQt);
@@ -164,6 +209,8 @@ MainWindow::MainWindow(QWidget* parent)
     connect(ui->actionAbout_Hotspot, &QAction::triggered, this, &MainWindow::aboutHotspot);
 
     setupFilterDisassemblyMenu();
+    setupDisassemblyPrefetchMenu();
+    setupLiveAnalysisMenu();
     setupViewMenu();
 
     setupCodeNavigationMenu();
@@ -280,6 +327,12 @@ void MainWindow::setBranchTraverse(const QString& branchTraverse)
     m_branchTraverse = branchTraverse;
 }
 
+void MainWindow::setSourcePathMap(const QString& pathMap)
+{
+    m_sourcePathMap = pathMap;
+    emit sourcePathMapChanged(m_sourcePathMap);
+}
+
 QString MainWindow::getSysroot() const {
     return m_sysroot;
 }
@@ -338,6 +391,92 @@ void MainWindow::onOpenFileButtonClicked()
     openFile(fileName);
 }
 
+void MainWindow::onCompareFileButtonClicked()
+{
+    const auto fileName = QFileDialog::getOpenFileName(this, tr("Compare With File"), QDir::currentPath(),
+                                                       tr("Data Files (perf*.data perf.data.*);;All Files (*)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    const QStringList normalizations = {tr("Total cost (period)"), tr("Sample count"), tr("None")};
+    bool ok = false;
+    const auto normalization = QInputDialog::getItem(this, tr("Compare With File"),
+                                                     tr("Normalize the compared costs by:"), normalizations, 0,
+                                                     false, &ok);
+    if (!ok) {
+        return;
+    }
+
+    switch (normalizations.indexOf(normalization)) {
+    case 0:
+        compareFile(fileName, Data::DiffNormalization::TotalCost);
+        break;
+    case 1:
+        compareFile(fileName, Data::DiffNormalization::SampleCount);
+        break;
+    default:
+        compareFile(fileName, Data::DiffNormalization::None);
+        break;
+    }
+}
+
+void MainWindow::onAggregateFilesButtonClicked()
+{
+    const auto fileNames = QFileDialog::getOpenFileNames(this, tr("Aggregate Files"), QDir::currentPath(),
+                                                         tr("Data Files (perf*.data perf.data.*);;All Files (*)"));
+    if (fileNames.isEmpty()) {
+        return;
+    }
+
+    openFiles(fileNames);
+}
+
+void MainWindow::onWatchDirectoryButtonClicked()
+{
+    const auto directory = QFileDialog::getExistingDirectory(this, tr("Watch Directory"), QDir::currentPath());
+    if (directory.isEmpty()) {
+        return;
+    }
+
+    watchDirectory(directory);
+}
+
+void MainWindow::compareFile(const QString& path, Data::DiffNormalization normalization)
+{
+    // the compared file is parsed with the same settings, the results then get diffed against the opened file
+    struct ComparedData
+    {
+        Data::Summary summary;
+        Data::BottomUpResults bottomUp;
+    };
+    auto comparedData = std::make_shared<ComparedData>();
+    auto comparedParser = new PerfParser(this);
+    // only the bottom-up data is needed for the comparison
+    comparedParser->setWatchedViews({});
+    connect(comparedParser, &PerfParser::summaryDataAvailable, this,
+            [comparedData](const Data::Summary& data) { comparedData->summary = data; });
+    connect(comparedParser, &PerfParser::bottomUpDataAvailable, this,
+            [comparedData](const Data::BottomUpResults& data) { comparedData->bottomUp = data; });
+    connect(comparedParser, &PerfParser::parsingFinished, this,
+            [this, comparedParser, comparedData, normalization, path]() {
+                comparedParser->deleteLater();
+                setWindowTitle(tr("%1 vs. %2 - Hotspot")
+                                   .arg(QFileInfo(m_reloadAction->data().toStringList().value(0)).fileName(),
+                                        QFileInfo(path).fileName()));
+                m_parser->compareWith(comparedData->bottomUp, comparedData->summary, normalization);
+            });
+    connect(comparedParser, &PerfParser::parsingFailed, this, [this, comparedParser](const QString& errorMessage) {
+        comparedParser->deleteLater();
+        m_compareAction->setEnabled(true);
+        QMessageBox::warning(this, tr("Comparison Failed"), errorMessage);
+    });
+
+    m_compareAction->setEnabled(false);
+    comparedParser->startParseFile(path, m_sysroot, m_kallsyms, m_debugPaths, m_extraLibPaths, m_appPath,
+                                   m_targetRoot, m_arch, m_disasmApproach, m_verbose, m_maxStack, m_branchTraverse);
+}
+
 void MainWindow::onPathsAndArchSettingsButtonClicked()
 {
     openSettingsDialog();
@@ -359,6 +498,7 @@ void MainWindow::onRecordButtonClicked()
 
 void MainWindow::clear()
 {
+    m_segmentWatcher->stop();
     m_parser->stop();
     setWindowTitle(tr("Hotspot"));
     m_startPage->showStartPage();
@@ -367,6 +507,7 @@ void MainWindow::clear()
     m_resultsPage->selectSummaryTab();
     m_resultsPage->clear();
     m_reloadAction->setEnabled(false);
+    m_compareAction->setEnabled(false);
 }
 
 void MainWindow::openFile(const QString& path)
@@ -392,6 +533,21 @@ void MainWindow::openFile(const QString& path)
     m_config->sync();
 }
 
+void MainWindow::openLiveRecording()
+{
+    // unlike clear(), this keeps the recording running
+    m_parser->stop();
+    setWindowTitle(tr("Live Recording - Hotspot"));
+    m_resultsPage->selectSummaryTab();
+    m_resultsPage->clear();
+    m_reloadAction->setEnabled(false);
+    m_compareAction->setEnabled(false);
+    m_stopLiveRecordingAction->setEnabled(true);
+
+    m_parser->startParseLive(m_sysroot, m_kallsyms, m_debugPaths, m_extraLibPaths, m_appPath, m_targetRoot, m_arch,
+                             m_disasmApproach, m_verbose, m_maxStack, m_branchTraverse);
+}
+
 void MainWindow::openFile(const QUrl& url)
 {
     if (!url.isLocalFile()) {
@@ -401,9 +557,52 @@ void MainWindow::openFile(const QUrl& url)
     openFile(url.toLocalFile());
 }
 
+void MainWindow::openFiles(const QStringList& paths)
+{
+    if (paths.size() == 1) {
+        openFile(paths.first());
+        return;
+    }
+
+    clear();
+
+    setWindowTitle(tr("%1 and %2 more - Hotspot").arg(QFileInfo(paths.first()).fileName()).arg(paths.size() - 1));
+
+    m_startPage->showParseFileProgress();
+    m_pageStack->setCurrentWidget(m_startPage);
+
+    // the files are parsed in parallel and merged into a single result, without events and disassembly
+    m_parser->startParseFiles(paths, m_sysroot, m_kallsyms, m_debugPaths, m_extraLibPaths, m_appPath, m_targetRoot,
+                              m_arch, m_disasmApproach, m_verbose, m_maxStack, m_branchTraverse);
+    m_reloadAction->setEnabled(true);
+    m_reloadAction->setData(paths);
+}
+
+void MainWindow::watchDirectory(const QString& path)
+{
+    clear();
+
+    setWindowTitle(tr("%1 - Hotspot").arg(QDir(path).dirName()));
+
+    m_startPage->showParseFileProgress();
+    m_pageStack->setCurrentWidget(m_startPage);
+
+    // the segments that are there already are reported right away, the results are shown once they got merged
+    if (!m_segmentWatcher->watch(path)) {
+        emit openFileError(tr("Cannot watch directory %1.").arg(path));
+    }
+}
+
+void MainWindow::appendSegments(const QStringList& paths)
+{
+    // merged into the segments parsed before, those are not parsed again
+    m_parser->appendParseFiles(paths, m_sysroot, m_kallsyms, m_debugPaths, m_extraLibPaths, m_appPath, m_targetRoot,
+                               m_arch, m_disasmApproach, m_verbose, m_maxStack, m_branchTraverse);
+}
+
 void MainWindow::reload()
 {
-    openFile(m_reloadAction->data().toString());
+    openFiles(m_reloadAction->data().toStringList());
 }
 
 void MainWindow::aboutKDAB()
@@ -488,6 +687,9 @@ void MainWindow::setupPathSettingsMenu()
                   tr("auto-detect"), tr("Path to the kernel symbol mapping."));
     addPathAction(tr("Architecture:"), &MainWindow::setArch, &MainWindow::archChanged,
                   tr("auto-detect"), tr("System architecture, e.g. x86_64, arm, aarch64 etc."));
+    addPathAction(tr("Source Path Map:"), &MainWindow::setSourcePathMap, &MainWindow::sourcePathMapChanged,
+                  tr("empty"), tr("List of colon-separated old=new path prefixes, to find the sources of binaries "
+                                  "that were built elsewhere."));
     m_startPage->setPathSettingsMenu(menu);
 }
 
@@ -509,6 +711,67 @@ void MainWindow::setupFilterDisassemblyMenu() {
     ui->viewMenu->addMenu(filterDisassemblyMenu);
 }
 
+void MainWindow::setupDisassemblyPrefetchMenu() {
+    QMenu *prefetchMenu = new QMenu(tr("Disassembly Prefetch"));
+    prefetchMenu->setToolTip(tr("Disassemble the hottest symbols in the background once a file is parsed, "
+                                "so that their Disassembly is shown at once."));
+
+    const auto *settings = Settings::instance();
+    addSettingChoices(prefetchMenu, "Disassembly", tr("Hottest Symbols"), "prefetchSymbols", {0, 10, 50},
+                      [](int value) { return value ? tr("%1 symbols").arg(value) : tr("Off"); },
+                      settings->prefetchSymbols(), &Settings::setPrefetchSymbols);
+    addSettingChoices(prefetchMenu, "Disassembly", tr("Parallel Processes"), "prefetchProcesses", {1, 2, 4},
+                      [](int value) { return tr("%1 at once").arg(value); },
+                      settings->prefetchProcesses(), &Settings::setPrefetchProcesses);
+    addSettingChoices(prefetchMenu, "Disassembly", tr("Output Cache"), "disassemblyCacheSize", {32, 128, 512},
+                      [](int value) { return tr("%1 MiB").arg(value); },
+                      settings->disassemblyCacheSize(), &Settings::setDisassemblyCacheSize);
+
+    ui->viewMenu->addMenu(prefetchMenu);
+}
+
+void MainWindow::setupLiveAnalysisMenu() {
+    QMenu *liveMenu = new QMenu(tr("Live Analysis"));
+    liveMenu->setToolTip(tr("How the results of a recording that is analyzed live get updated."));
+
+    const auto *settings = Settings::instance();
+    addSettingChoices(liveMenu, "LiveAnalysis", tr("Update Interval"), "updateInterval", {500, 1000, 5000},
+                      [](int value) { return tr("%1 s").arg(value / 1000.); },
+                      settings->liveUpdateInterval(), &Settings::setLiveUpdateInterval);
+    addSettingChoices(liveMenu, "LiveAnalysis", tr("Timeline Window"), "window", {10, 60, 300},
+                      [](int value) { return tr("Last %1 s").arg(value); },
+                      settings->liveWindow(), &Settings::setLiveWindow);
+    addSettingChoices(liveMenu, "LiveAnalysis", tr("Costs"), "costWindow", {0, 300, 3600},
+                      [](int value) { return value ? tr("Last %1 min").arg(value / 60) : tr("Whole Recording"); },
+                      settings->liveCostWindow(), &Settings::setLiveCostWindow);
+
+    ui->viewMenu->addMenu(liveMenu);
+}
+
+void MainWindow::addSettingChoices(QMenu *menu, const char *group, const QString &title, const char *entry,
+                                   const QVector<int> &values, std::function<QString(int)> format, int current,
+                                   void (Settings::*setter)(int)) {
+    // Each setting is a group of exclusive choices, the chosen value is restored on the next start
+    const int value = m_config->group(group).readEntry(entry, current);
+    (Settings::instance()->*setter)(value);
+
+    menu->addSection(title);
+    auto actionGroup = new QActionGroup(menu);
+    actionGroup->setExclusive(true);
+    for (int choice : values) {
+        auto *action = menu->addAction(format(choice));
+        action->setCheckable(true);
+        action->setChecked(choice == value);
+        action->setData(choice);
+        actionGroup->addAction(action);
+    }
+    connect(actionGroup, &QActionGroup::triggered, this, [this, group, entry, setter](QAction *action) {
+        const int value = action->data().toInt();
+        (Settings::instance()->*setter)(value);
+        m_config->group(group).writeEntry(entry, value);
+    });
+}
+
 void MainWindow::setupViewMenu() {
     auto *switchDisassemblySyntaxAction = ui->viewMenu->addAction(tr("Assembly in Intel Syntax"));
     switchDisassemblySyntaxAction->setCheckable(true);
@@ -522,6 +785,14 @@ void MainWindow::setupViewMenu() {
     switchDisassemblyMethodAction->setShortcut(tr("Ctrl+D"));
     connect(switchDisassemblyMethodAction, &QAction::toggled, m_resultsPage, &ResultsPage::switchDisassemblyMethod);
 
+    auto *showBasicBlockCostsAction = ui->viewMenu->addAction(tr("Basic Block and Loop Costs"));
+    showBasicBlockCostsAction->setCheckable(true);
+    showBasicBlockCostsAction->setChecked(false);
+    showBasicBlockCostsAction->setToolTip(
+            tr("Sum up the costs of the instructions of each basic block and loop in Disassembly (objdump), "
+               "these are less affected by skid than the costs of single instructions."));
+    connect(showBasicBlockCostsAction, &QAction::toggled, m_resultsPage, &ResultsPage::showBasicBlockCosts);
+
     auto *showTimelineAction = ui->viewMenu->addAction(tr("Show Timeline"));
     showTimelineAction->setCheckable(true);
     showTimelineAction->setChecked(true);
@@ -33,18 +33,25 @@
 
 #include <KSharedConfig>
 
+#include <functional>
+
+#include "models/data.h"
+
 namespace Ui {
 class MainWindow;
 }
 
 class PerfParser;
+class QMenu;
 class QStackedWidget;
+class Settings;
 
 class KRecentFilesAction;
 
 class StartPage;
 class ResultsPage;
 class RecordPage;
+class SegmentWatcher;
 
 class MainWindow : public QMainWindow
 {
@@ -79,13 +86,23 @@ public slots:
     void setVerbose(const QString& verbose);
     void setMaxStack(const QString& maxStack);
     void setBranchTraverse(const QString& branchTraverse);
+    void setSourcePathMap(const QString& pathMap);
 
     void clear();
     void openFile(const QString& path);
     void openFile(const QUrl& url);
+    void openFiles(const QStringList& paths);
+    // merge the segments rotated into @p path by 'perf record --switch-output' as they appear
+    void watchDirectory(const QString& path);
     void reload();
+    // analyze the perf data of the recording that was just started on the record page while it is recorded
+    void openLiveRecording();
+    void compareFile(const QString& path, Data::DiffNormalization normalization);
 
     void onOpenFileButtonClicked();
+    void onCompareFileButtonClicked();
+    void onAggregateFilesButtonClicked();
+    void onWatchDirectoryButtonClicked();
     void onPathsAndArchSettingsButtonClicked();
     void onRecordButtonClicked();
     void onHomeButtonClicked();
@@ -105,14 +122,22 @@ signals:
     void extraLibPathsChanged(const QString& paths);
     void appPathChanged(const QString& path);
     void archChanged(const QString& arch);
+    void sourcePathMapChanged(const QString& pathMap);
 
 private:
     void closeEvent(QCloseEvent* event) override;
     void setupCodeNavigationMenu();
     void setupPathSettingsMenu();
     void setupFilterDisassemblyMenu();
+    void setupDisassemblyPrefetchMenu();
+    void setupLiveAnalysisMenu();
+    // add the exclusive @p values of an int setting to @p menu, the chosen value is restored on the next start
+    void addSettingChoices(QMenu* menu, const char* group, const QString& title, const char* entry,
+                           const QVector<int>& values, std::function<QString(int)> format, int current,
+                           void (Settings::*setter)(int));
 
     void setupViewMenu();
+    void appendSegments(const QStringList& paths);
 
     QScopedPointer<Ui::MainWindow> ui;
     PerfParser* m_parser;
@@ -121,6 +146,7 @@ private:
     StartPage* m_startPage;
     RecordPage* m_recordPage;
     ResultsPage* m_resultsPage;
+    SegmentWatcher* m_segmentWatcher;
 
     QString m_sysroot;
     QString m_kallsyms;
@@ -135,6 +161,8 @@ private:
     QString m_targetRoot;
     // Architecture
     QString m_arch;
+    // Colon-separated list of old=new path prefixes to find sources that were built elsewhere
+    QString m_sourcePathMap;
     // Disassembly approach code: 'symbol' - by function symbol, 'address' or default - by addresses range
     QString m_disasmApproach;
     // 'warning' - display warnings on the console, 'debug' - display debug information, 'all' - display both,
@@ -146,4 +174,6 @@ private:
     QString m_branchTraverse;
     KRecentFilesAction* m_recentFilesAction = nullptr;
     QAction* m_reloadAction = nullptr;
+    QAction* m_compareAction = nullptr;
+    QAction* m_stopLiveRecordingAction = nullptr;
 };
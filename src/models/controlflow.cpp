@@ -0,0 +1,154 @@
+/*
+    controlflow.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "controlflow.h"
+
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+
+#include <algorithm>
+
+namespace {
+bool isPrefix(const QString& token)
+{
+    return token == QLatin1String("bnd") || token == QLatin1String("notrack") || token == QLatin1String("lock")
+        || token.startsWith(QLatin1String("rep")) || token.startsWith(QLatin1String("data16"));
+}
+
+bool isArmBranch(QString mnemonic)
+{
+    // Thumb width suffixes, e.g. bne.n or b.w
+    if (mnemonic.endsWith(QLatin1String(".n")) || mnemonic.endsWith(QLatin1String(".w"))) {
+        mnemonic.chop(2);
+    }
+    if (mnemonic == QLatin1String("b") || mnemonic.startsWith(QLatin1String("b."))) {
+        return true;
+    }
+    static const QSet<QString> branches = {
+        QStringLiteral("beq"), QStringLiteral("bne"), QStringLiteral("bcs"), QStringLiteral("bcc"),
+        QStringLiteral("bhs"), QStringLiteral("blo"), QStringLiteral("bmi"), QStringLiteral("bpl"),
+        QStringLiteral("bvs"), QStringLiteral("bvc"), QStringLiteral("bhi"), QStringLiteral("bls"),
+        QStringLiteral("bge"), QStringLiteral("blt"), QStringLiteral("bgt"), QStringLiteral("ble"),
+        QStringLiteral("bal"), QStringLiteral("bx"),  QStringLiteral("br"),  QStringLiteral("cbz"),
+        QStringLiteral("cbnz"), QStringLiteral("tbz"), QStringLiteral("tbnz")};
+    return branches.contains(mnemonic);
+}
+
+quint64 parseAddress(QString token)
+{
+    if (token.endsWith(QLatin1Char(','))) {
+        token.chop(1);
+    }
+    if (token.startsWith(QLatin1String("0x"))) {
+        token.remove(0, 2);
+    }
+    bool ok = false;
+    const quint64 address = token.toULongLong(&ok, 16);
+    return ok ? address : 0;
+}
+}
+
+ControlFlow::Instruction ControlFlow::parseInstruction(quint64 address, const QString& text, bool arm)
+{
+    Instruction instruction = {address, 0, false};
+
+    const auto tokens = text.simplified().split(QLatin1Char(' '), QString::SkipEmptyParts);
+    int i = 0;
+    while (i < tokens.size() && isPrefix(tokens.at(i))) {
+        ++i;
+    }
+    if (i == tokens.size()) {
+        return instruction;
+    }
+
+    const auto mnemonic = tokens.at(i).toLower();
+    const bool isBranch = arm ? isArmBranch(mnemonic) : mnemonic.startsWith(QLatin1Char('j'));
+    instruction.endsBlock = isBranch || mnemonic.startsWith(QLatin1String("ret"));
+    if (!isBranch) {
+        return instruction;
+    }
+
+    // direct branches name their target like "401020 <main+0x20>", anything after '#' is a comment
+    for (int j = i + 2; j < tokens.size() && !tokens.at(j - 1).startsWith(QLatin1Char('#')); ++j) {
+        if (tokens.at(j).startsWith(QLatin1Char('<'))) {
+            instruction.target = parseAddress(tokens.at(j - 1));
+            break;
+        }
+    }
+    return instruction;
+}
+
+QVector<ControlFlow::Block> ControlFlow::basicBlocks(const QVector<Instruction>& instructions)
+{
+    QSet<quint64> targets;
+    for (const auto& instruction : instructions) {
+        if (instruction.target) {
+            targets.insert(instruction.target);
+        }
+    }
+
+    QVector<Block> blocks;
+    int first = 0;
+    for (int i = 0; i < instructions.size(); ++i) {
+        if (i > first && targets.contains(instructions.at(i).address)) {
+            blocks.append({first, i - 1});
+            first = i;
+        }
+        if (instructions.at(i).endsBlock) {
+            blocks.append({first, i});
+            first = i + 1;
+        }
+    }
+    if (first < instructions.size()) {
+        blocks.append({first, instructions.size() - 1});
+    }
+    return blocks;
+}
+
+QVector<ControlFlow::Loop> ControlFlow::loops(const QVector<Instruction>& instructions)
+{
+    QHash<quint64, int> indexByAddress;
+    indexByAddress.reserve(instructions.size());
+    for (int i = 0; i < instructions.size(); ++i) {
+        indexByAddress.insert(instructions.at(i).address, i);
+    }
+
+    QMap<int, int> latchByHeader;
+    for (int i = 0; i < instructions.size(); ++i) {
+        const auto& instruction = instructions.at(i);
+        if (!instruction.target || instruction.target > instruction.address) {
+            continue;
+        }
+        const int header = indexByAddress.value(instruction.target, -1);
+        if (header >= 0) {
+            latchByHeader[header] = std::max(latchByHeader.value(header, -1), i);
+        }
+    }
+
+    QVector<Loop> result;
+    result.reserve(latchByHeader.size());
+    for (auto it = latchByHeader.constBegin(), end = latchByHeader.constEnd(); it != end; ++it) {
+        result.append({it.key(), it.value()});
+    }
+    return result;
+}
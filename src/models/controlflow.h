@@ -0,0 +1,68 @@
+/*
+    controlflow.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+/**
+ * Basic blocks and loops of a disassembled function.
+ *
+ * Instruction level costs are blurred by skid, their sums over basic blocks and loops are not.
+ */
+namespace ControlFlow {
+struct Instruction
+{
+    quint64 address;
+    // Address of the branch target, zero when the instruction is no branch or its target is unknown
+    quint64 target;
+    // Branches and returns end a basic block, calls do not
+    bool endsBlock;
+};
+
+// Instructions [first, last] by their index
+struct Block
+{
+    int first;
+    int last;
+};
+
+// Instructions [header, latch] by their index, the latch branches back to the header
+struct Loop
+{
+    int header;
+    int latch;
+};
+
+/**
+ * Parse the instruction text of an 'objdump' line, e.g. "jne    401020 <main+0x20>", into @p instruction.
+ *
+ * @p arm selects the branch mnemonics of ARM rather than x86.
+ */
+Instruction parseInstruction(quint64 address, const QString& text, bool arm);
+
+/// split @p instructions into basic blocks: they start at branch targets and after branches
+QVector<Block> basicBlocks(const QVector<Instruction>& instructions);
+
+/// loops formed by back-edges, loops with a common header are merged, sorted by header
+QVector<Loop> loops(const QVector<Instruction>& instructions);
+}
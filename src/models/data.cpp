@@ -27,13 +27,26 @@
 
 #include "data.h"
 
+#include <QCoreApplication>
 #include <QDebug>
 #include <QSet>
 
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <cmath>
+#include <cstring>
+
 using namespace Data;
 
 namespace {
 
+// differential data can contain negative costs, so we can't just check the sum
+bool hasCost(const ItemCost& cost)
+{
+    return std::any_of(std::begin(cost), std::end(cost), [](qint64 c) { return c != 0; });
+}
+
 ItemCost buildTopDownResult(const BottomUp& bottomUpData, const Costs& bottomUpCosts, TopDown* topDownData,
                             Costs* inclusiveCosts, Costs* selfCosts, quint32* maxId)
 {
@@ -44,7 +57,7 @@ ItemCost buildTopDownResult(const BottomUp& bottomUpData, const Costs& bottomUpC
         const auto childCost = buildTopDownResult(row, bottomUpCosts, topDownData, inclusiveCosts, selfCosts, maxId);
         const auto rowCost = bottomUpCosts.itemCost(row.id);
         const auto diff = rowCost - childCost;
-        if (diff.sum() != 0) {
+        if (hasCost(diff)) {
             // this row is (partially) a leaf
             // bubble up the parent chain to build a top-down tree
             auto node = &row;
@@ -86,7 +99,7 @@ ItemCost buildCallerCalleeResult(const BottomUp& data, const Costs& bottomUpCost
         const auto childCost = buildCallerCalleeResult(row, bottomUpCosts, results);
         const auto rowCost = bottomUpCosts.itemCost(row.id);
         const auto diff = rowCost - childCost;
-        if (diff.sum() != 0) {
+        if (hasCost(diff)) {
             // this row is (partially) a leaf
 
             // leaf node found, bubble up the parent chain to add cost for all frames
@@ -134,6 +147,51 @@ ItemCost buildCallerCalleeResult(const BottomUp& data, const Costs& bottomUpCost
     return totalCost;
 }
 
+struct DiffSourceType
+{
+    int sourceType;
+    int targetType;
+    double scale;
+};
+
+template<typename SymbolMapper>
+void mergeBottomUp(const BottomUp& source, const BottomUpResults& sourceResults,
+                   const QVector<DiffSourceType>& types, BottomUp* target, Costs* targetCosts,
+                   IncompleteCallchains* incompleteCallchains, quint32* maxId, const SymbolMapper& mapSymbol)
+{
+    for (const auto& row : source.children) {
+        auto entry = target->entryForSymbol(mapSymbol(row.symbol), maxId);
+        for (const auto& type : types) {
+            const auto cost = sourceResults.costs.cost(type.sourceType, row.id);
+            if (cost) {
+                targetCosts->add(type.targetType, entry->id, std::llround(cost * type.scale));
+            }
+        }
+        if (sourceResults.incompleteCallchains.isIncomplete(row.id)) {
+            incompleteCallchains->markAsIncomplete(entry->id);
+        }
+        mergeBottomUp(row, sourceResults, types, entry, targetCosts, incompleteCallchains, maxId, mapSymbol);
+    }
+}
+
+Symbol identity(const Symbol& symbol)
+{
+    return symbol;
+}
+
+void addDeltaCosts(const BottomUp& data, const QVector<QPair<int, int>>& baselineAndComparedTypes, Costs* costs)
+{
+    for (const auto& row : data.children) {
+        for (const auto& types : baselineAndComparedTypes) {
+            const auto delta = costs->cost(types.second, row.id) - costs->cost(types.first, row.id);
+            if (delta) {
+                costs->add(costs->deltaType(types.first), row.id, delta);
+            }
+        }
+        addDeltaCosts(row, baselineAndComparedTypes, costs);
+    }
+}
+
 static int findSameDepth(const QStringRef& str, int offset, QChar ch, bool returnNext = false)
 {
     const int size = str.size();
@@ -292,6 +350,224 @@ TopDownResults TopDownResults::fromBottomUp(const BottomUpResults& bottomUpData)
     return results;
 }
 
+BottomUpResults BottomUpResults::diff(const BottomUpResults& baseline, const BottomUpResults& compared,
+                                      DiffNormalization normalization,
+                                      const QVector<CostSummary>& baselineSummary,
+                                      const QVector<CostSummary>& comparedSummary)
+{
+    BottomUpResults results;
+    results.root.symbol = baseline.root.symbol;
+
+    // types are aligned by name, types only available in one of the inputs are compared against zero
+    QStringList typeNames;
+    for (int i = 0; i < baseline.costs.numTypes(); ++i) {
+        typeNames.append(baseline.costs.typeName(i));
+    }
+    for (int i = 0; i < compared.costs.numTypes(); ++i) {
+        if (!typeNames.contains(compared.costs.typeName(i))) {
+            typeNames.append(compared.costs.typeName(i));
+        }
+    }
+
+    auto findType = [](const Costs& costs, const QString& name) {
+        for (int i = 0; i < costs.numTypes(); ++i) {
+            if (costs.typeName(i) == name) {
+                return i;
+            }
+        }
+        return -1;
+    };
+
+    QVector<DiffSourceType> baselineTypes;
+    QVector<DiffSourceType> comparedTypes;
+    QVector<QPair<int, int>> baselineAndComparedTypes;
+    for (const auto& name : typeNames) {
+        const auto baselineType = findType(baseline.costs, name);
+        const auto comparedType = findType(compared.costs, name);
+        const auto unit = baselineType != -1 ? baseline.costs.unit(baselineType) : compared.costs.unit(comparedType);
+        const auto baselineTotal = baselineType != -1 ? baseline.costs.totalCost(baselineType) : 0;
+        const auto comparedTotal = comparedType != -1 ? compared.costs.totalCost(comparedType) : 0;
+
+        double scale = 1.;
+        if (baselineType != -1 && comparedType != -1) {
+            if (normalization == DiffNormalization::TotalCost && baselineTotal && comparedTotal) {
+                scale = static_cast<double>(baselineTotal) / comparedTotal;
+            } else if (normalization == DiffNormalization::SampleCount) {
+                const auto baselineSamples = baselineSummary.value(baselineType).sampleCount;
+                const auto comparedSamples = comparedSummary.value(comparedType).sampleCount;
+                if (baselineSamples && comparedSamples) {
+                    scale = static_cast<double>(baselineSamples) / comparedSamples;
+                }
+            }
+        }
+
+        const int targetType = results.costs.numTypes();
+        results.costs.addType(targetType, QCoreApplication::translate("Data", "%1 (baseline)").arg(name), unit);
+        results.costs.addType(targetType + 1, QCoreApplication::translate("Data", "%1 (compared)").arg(name), unit);
+        results.costs.addType(targetType + 2, QCoreApplication::translate("Data", "%1 (delta)").arg(name), unit);
+        for (int i = 0; i < 3; ++i) {
+            results.costs.setDeltaType(targetType + i, targetType + 2);
+        }
+
+        const auto scaledComparedTotal = std::llround(comparedTotal * scale);
+        results.costs.addTotalCost(targetType, baselineTotal);
+        results.costs.addTotalCost(targetType + 1, scaledComparedTotal);
+        results.costs.addTotalCost(targetType + 2, scaledComparedTotal - baselineTotal);
+
+        if (baselineType != -1) {
+            baselineTypes.append({baselineType, targetType, 1.});
+        }
+        if (comparedType != -1) {
+            comparedTypes.append({comparedType, targetType + 1, scale});
+        }
+        baselineAndComparedTypes.append({targetType, targetType + 1});
+    }
+
+    mergeBottomUp(baseline.root, baseline, baselineTypes, &results.root, &results.costs,
+                  &results.incompleteCallchains, &results.maxBottomUpId, identity);
+    mergeBottomUp(compared.root, compared, comparedTypes, &results.root, &results.costs,
+                  &results.incompleteCallchains, &results.maxBottomUpId, identity);
+    addDeltaCosts(results.root, baselineAndComparedTypes, &results.costs);
+
+    BottomUp::initializeParents(&results.root);
+    return results;
+}
+
+void BottomUpResults::merge(const BottomUpResults& other, const std::function<Symbol(const Symbol&)>& mapSymbol)
+{
+    // types are aligned by name, new types get appended
+    QVector<DiffSourceType> types;
+    for (int i = 0; i < other.costs.numTypes(); ++i) {
+        const auto& name = other.costs.typeName(i);
+        int type = 0;
+        while (type < costs.numTypes() && costs.typeName(type) != name) {
+            ++type;
+        }
+        if (type == costs.numTypes()) {
+            costs.addType(type, name, other.costs.unit(i));
+        }
+        costs.addTotalCost(type, other.costs.totalCost(i));
+        types.append({i, type, 1.});
+    }
+
+    if (mapSymbol) {
+        mergeBottomUp(other.root, other, types, &root, &costs, &incompleteCallchains, &maxBottomUpId, mapSymbol);
+    } else {
+        mergeBottomUp(other.root, other, types, &root, &costs, &incompleteCallchains, &maxBottomUpId, identity);
+    }
+    BottomUp::initializeParents(&root);
+}
+
+namespace {
+// costs are inclusive, so the children of an entry without costs have none either
+void removeEmptyChildren(BottomUp* entry, const Costs& costs, QVector<qint32>* newIds, qint32* nextId)
+{
+    auto isEmpty = [&costs](const BottomUp& child) {
+        for (int i = 0; i < costs.numTypes(); ++i) {
+            if (costs.cost(i, child.id)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto& children = entry->children;
+    children.erase(std::remove_if(children.begin(), children.end(), isEmpty), children.end());
+    for (auto& child : children) {
+        (*newIds)[child.id] = *nextId;
+        child.id = (*nextId)++;
+        removeEmptyChildren(&child, costs, newIds, nextId);
+    }
+}
+
+template<typename T>
+QVector<T> remapped(const QVector<T>& values, const QVector<qint32>& newIds, T defaultValue)
+{
+    const int numIds = std::count_if(newIds.begin(), newIds.end(), [](qint32 id) { return id >= 0; });
+    QVector<T> result(numIds, defaultValue);
+    for (int id = 0, c = std::min(values.size(), newIds.size()); id < c; ++id) {
+        if (newIds[id] >= 0) {
+            result[newIds[id]] = values[id];
+        }
+    }
+    return result;
+}
+}
+
+QVector<qint32> BottomUpResults::removeEmptyEntries()
+{
+    QVector<qint32> newIds(maxBottomUpId, -1);
+    qint32 nextId = 0;
+    removeEmptyChildren(&root, costs, &newIds, &nextId);
+    costs.remap(newIds);
+    incompleteCallchains.remap(newIds);
+    maxBottomUpId = nextId;
+    BottomUp::initializeParents(&root);
+    return newIds;
+}
+
+void Costs::subtract(const Costs& rhs)
+{
+    for (int type = 0, c = std::min(numTypes(), rhs.numTypes()); type < c; ++type) {
+        const auto& costs = rhs.m_costs[type];
+        for (int id = 0; id < costs.size(); ++id) {
+            if (costs[id]) {
+                add(type, id, -costs[id]);
+            }
+        }
+        m_totalCosts[type] -= rhs.m_totalCosts[type];
+    }
+}
+
+void Costs::remap(const QVector<qint32>& newIds)
+{
+    for (auto& costs : m_costs) {
+        costs = remapped(costs, newIds, qint64(0));
+    }
+}
+
+void IncompleteCallchains::remap(const QVector<qint32>& newIds)
+{
+    m_incompleteFlags = remapped(m_incompleteFlags, newIds, false);
+}
+
+RollingCosts::RollingCosts(quint64 sliceDuration, int maxSlices)
+    : m_sliceDuration(sliceDuration)
+    , m_maxSlices(maxSlices)
+{
+}
+
+void RollingCosts::update(quint64 time, BottomUpResults* bottomUp)
+{
+    if (!m_sliceDuration || m_maxSlices <= 0) {
+        return;
+    } else if (m_slices.isEmpty()) {
+        // the costs up to now belong to the first slice
+        m_slices.append({time, {}});
+        return;
+    } else if (time < m_slices.last().start + m_sliceDuration) {
+        return;
+    }
+
+    m_slices.append({time, bottomUp->costs});
+    if (m_slices.size() <= m_maxSlices) {
+        return;
+    }
+
+    // the costs added by the oldest slice are the ones at the start of the next slice
+    m_slices.removeFirst();
+    const auto evicted = m_slices.first().costs;
+    m_slices.first().costs = {};
+    bottomUp->costs.subtract(evicted);
+    for (auto& slice : m_slices) {
+        slice.costs.subtract(evicted);
+    }
+
+    const auto newIds = bottomUp->removeEmptyEntries();
+    for (auto& slice : m_slices) {
+        slice.costs.remap(newIds);
+    }
+}
+
 void Data::callerCalleesFromBottomUpData(const BottomUpResults& bottomUpData, CallerCalleeResults* results)
 {
     results->inclusiveCosts.initializeCostsFrom(bottomUpData.costs);
@@ -299,6 +575,677 @@ void Data::callerCalleesFromBottomUpData(const BottomUpResults& bottomUpData, Ca
     buildCallerCalleeResult(bottomUpData.root, bottomUpData.costs, results);
 }
 
+Data::OffCpuResults Data::offCpuResultsFromEvents(const BottomUpResults& bottomUpData, const EventResults& events)
+{
+    OffCpuResults results;
+    auto& bottomUp = results.bottomUp;
+    bottomUp.symbols = bottomUpData.symbols;
+    bottomUp.locations = bottomUpData.locations;
+    bottomUp.costs.addType(OffCpuResults::BlockedTime, QCoreApplication::translate("Data", "Blocked Time"),
+                           Costs::Unit::Time);
+    bottomUp.costs.addType(OffCpuResults::PreemptedTime, QCoreApplication::translate("Data", "Preempted Time"),
+                           Costs::Unit::Time);
+
+    if (events.offCpuTimeCostId != -1) {
+        // the call site of every stack, looked up once per stack rather than per event
+        QVector<int> stackCallSites(events.stacks.size(), -1);
+        QHash<Symbol, int> callSiteIndices;
+        auto callSite = [&](qint32 stackId) -> OffCpuCallSite& {
+            int index = stackCallSites.value(stackId, -1);
+            if (index == -1) {
+                Symbol symbol;
+                if (stackId >= 0 && stackId < events.stacks.size()) {
+                    // the leaf frames lie within the scheduler, the thread waited in its innermost user space frame
+                    bool isFirst = true;
+                    bottomUp.foreachFrame(events.stacks.at(stackId),
+                                          [&symbol, &isFirst](const Symbol& frameSymbol, const Location&) {
+                                              if (isFirst || !frameSymbol.isKernel) {
+                                                  symbol = frameSymbol;
+                                              }
+                                              isFirst = false;
+                                              return symbol.isKernel;
+                                          });
+                }
+                auto it = callSiteIndices.find(symbol);
+                if (it == callSiteIndices.end()) {
+                    it = callSiteIndices.insert(symbol, results.callSites.size());
+                    OffCpuCallSite site;
+                    site.symbol = symbol;
+                    results.callSites.append(site);
+                }
+                index = it.value();
+                if (stackId >= 0 && stackId < stackCallSites.size()) {
+                    stackCallSites[stackId] = index;
+                }
+            }
+            return results.callSites[index];
+        };
+
+        for (const auto& thread : events.threads) {
+            for (const auto& event : thread.events) {
+                if (event.type != events.offCpuTimeCostId) {
+                    continue;
+                }
+                const auto type = event.preempted ? OffCpuResults::PreemptedTime : OffCpuResults::BlockedTime;
+                bottomUp.addEvent(type, event.cost, events.stacks.value(event.stackId), false,
+                                  [](const Symbol&, const Location&) {});
+
+                auto& site = callSite(event.stackId);
+                if (event.preempted) {
+                    site.preemptedTime += event.cost;
+                } else {
+                    site.blockedTime += event.cost;
+                    ++site.blockedCount;
+                    site.longestBlockedTime = std::max(site.longestBlockedTime, event.cost);
+                }
+            }
+        }
+    }
+
+    Data::BottomUp::initializeParents(&bottomUp.root);
+    results.topDown = TopDownResults::fromBottomUp(bottomUp);
+    std::sort(results.callSites.begin(), results.callSites.end(),
+              [](const OffCpuCallSite& lhs, const OffCpuCallSite& rhs) {
+                  return std::tie(lhs.blockedTime, lhs.preemptedTime) > std::tie(rhs.blockedTime, rhs.preemptedTime);
+              });
+    return results;
+}
+
+quint64 Data::ParallelismResults::busyTime() const
+{
+    return std::accumulate(timeAtParallelism.begin() + std::min(timeAtParallelism.size(), 1), timeAtParallelism.end(),
+                           quint64(0));
+}
+
+double Data::ParallelismResults::averageParallelism() const
+{
+    const auto busy = busyTime();
+    if (!busy) {
+        return 0;
+    }
+    double threadTime = 0;
+    for (int i = 1, c = timeAtParallelism.size(); i < c; ++i) {
+        threadTime += double(i) * timeAtParallelism[i];
+    }
+    return threadTime / busy;
+}
+
+double Data::ParallelismResults::serialFraction() const
+{
+    const auto busy = busyTime();
+    return busy ? double(timeAtParallelism.value(1)) / busy : 0;
+}
+
+qint32 Data::ParallelismResults::costType(int sampleType, qint32 runningThreads) const
+{
+    if (sampleType < 0 || sampleType >= sampleTypeNames.size() || runningThreads < 1) {
+        return -1;
+    }
+    // the cost types of a sample type are consecutive, one per number of running threads
+    const auto typesPerSampleType = bottomUp.costs.numTypes() / sampleTypeNames.size();
+    return runningThreads <= typesPerSampleType ? sampleType * typesPerSampleType + runningThreads - 1 : -1;
+}
+
+namespace {
+struct RunningThreadsChange
+{
+    quint64 time;
+    qint32 delta;
+};
+
+void addRunningSpan(quint64 start, quint64 end, QVector<RunningThreadsChange>* changes)
+{
+    if (start < end) {
+        changes->append({start, 1});
+        changes->append({end, -1});
+    }
+}
+
+// the median time between two samples of a thread, i.e. the sampling period
+quint64 typicalSampleGap(const Data::EventResults& events)
+{
+    QVector<quint64> gaps;
+    for (const auto& thread : events.threads) {
+        quint64 lastTime = 0;
+        bool hasLast = false;
+        for (const auto& event : thread.events) {
+            if (event.type == events.offCpuTimeCostId) {
+                continue;
+            }
+            if (hasLast && event.time > lastTime) {
+                gaps.append(event.time - lastTime);
+            }
+            lastTime = event.time;
+            hasLast = true;
+        }
+    }
+    if (gaps.isEmpty()) {
+        return 0;
+    }
+    auto median = gaps.begin() + gaps.size() / 2;
+    std::nth_element(gaps.begin(), median, gaps.end());
+    return *median;
+}
+}
+
+Data::ParallelismResults Data::parallelismResultsFromEvents(const BottomUpResults& bottomUpData,
+                                                            const EventResults& events)
+{
+    ParallelismResults results;
+
+    // the thread lifetimes are not limited by a time filter, only the events are
+    quint64 start = MAX_TIME;
+    quint64 end = 0;
+    for (const auto& thread : events.threads) {
+        for (const auto& event : thread.events) {
+            start = std::min(start, event.time);
+            end = std::max(end, event.type == events.offCpuTimeCostId ? event.time + event.cost : event.time);
+        }
+    }
+    for (const auto& cpu : events.cpus) {
+        if (!cpu.events.isEmpty()) {
+            ++results.numCpus;
+        }
+    }
+
+    QVector<RunningThreadsChange> changes;
+    if (start <= end) {
+        results.time = {start, end};
+
+        const bool hasContextSwitches = events.offCpuTimeCostId != -1;
+        const auto sampleGap = hasContextSwitches ? 0 : typicalSampleGap(events);
+        for (const auto& thread : events.threads) {
+            if (thread.events.isEmpty()) {
+                // no sign that the thread ran at all
+                continue;
+            }
+
+            if (hasContextSwitches) {
+                auto runningSince = std::max(thread.time.start, start);
+                auto runningUntil = std::min(thread.time.end, end);
+                // the thread got switched out for good
+                if (thread.state == ThreadEvents::OffCpu && thread.lastSwitchTime >= runningSince
+                    && thread.lastSwitchTime < runningUntil) {
+                    runningUntil = thread.lastSwitchTime;
+                }
+                for (const auto& event : thread.events) {
+                    if (event.type != events.offCpuTimeCostId || event.time < runningSince) {
+                        continue;
+                    }
+                    addRunningSpan(runningSince, std::min(event.time, runningUntil), &changes);
+                    runningSince = event.time + event.cost;
+                }
+                addRunningSpan(runningSince, runningUntil, &changes);
+            } else {
+                quint64 runningSince = 0;
+                quint64 runningUntil = 0;
+                for (const auto& event : thread.events) {
+                    if (event.time > runningUntil) {
+                        addRunningSpan(runningSince, runningUntil, &changes);
+                        runningSince = event.time;
+                    }
+                    runningUntil = event.time + sampleGap;
+                }
+                addRunningSpan(runningSince, runningUntil, &changes);
+            }
+        }
+    }
+
+    std::sort(changes.begin(), changes.end(), [](const RunningThreadsChange& lhs, const RunningThreadsChange& rhs) {
+        return lhs.time < rhs.time;
+    });
+    qint32 running = 0;
+    for (int i = 0, c = changes.size(); i < c;) {
+        const auto time = changes[i].time;
+        for (; i < c && changes[i].time == time; ++i) {
+            running += changes[i].delta;
+        }
+        if (results.steps.isEmpty() || results.steps.constLast().runningThreads != running) {
+            ParallelismStep step;
+            step.time = time;
+            step.runningThreads = running;
+            results.steps.append(step);
+        }
+    }
+
+    if (!results.steps.isEmpty()) {
+        // the last sample of a thread may span beyond the last event
+        results.time.end = std::max(results.time.end, results.steps.constLast().time);
+        results.timeAtParallelism.append(results.steps.constFirst().time - results.time.start);
+    }
+    for (int i = 0, c = results.steps.size(); i < c; ++i) {
+        const auto& step = results.steps[i];
+        const auto stepEnd = i + 1 < c ? results.steps[i + 1].time : results.time.end;
+        if (results.timeAtParallelism.size() <= step.runningThreads) {
+            results.timeAtParallelism.resize(step.runningThreads + 1);
+        }
+        results.timeAtParallelism[step.runningThreads] += stepEnd - step.time;
+    }
+
+    // attribute the samples of every type to the number of threads that ran when they got taken, at least their own
+    auto& bottomUp = results.bottomUp;
+    bottomUp.symbols = bottomUpData.symbols;
+    bottomUp.locations = bottomUpData.locations;
+    const auto typesPerSampleType = std::max(results.maxParallelism(), 1);
+    QVector<int> sampleTypes(bottomUpData.costs.numTypes(), -1);
+    for (int type = 0, c = bottomUpData.costs.numTypes(); type < c; ++type) {
+        if (type == events.offCpuTimeCostId) {
+            continue;
+        }
+        const auto name = bottomUpData.costs.typeName(type);
+        const auto unit = bottomUpData.costs.unit(type);
+        sampleTypes[type] = results.sampleTypeNames.size();
+        results.sampleTypeNames.append(name);
+        for (int i = 1; i <= typesPerSampleType; ++i) {
+            bottomUp.costs.addType(bottomUp.costs.numTypes(),
+                                   QCoreApplication::translate("Data", "%1 (%2 Running Threads)").arg(name).arg(i),
+                                   unit);
+        }
+    }
+    for (const auto& thread : events.threads) {
+        for (const auto& event : thread.events) {
+            const auto sampleType = sampleTypes.value(event.type, -1);
+            if (sampleType == -1) {
+                continue;
+            }
+            auto step = std::upper_bound(results.steps.constBegin(), results.steps.constEnd(), event.time,
+                                         [](quint64 time, const ParallelismStep& step) { return time < step.time; });
+            const auto runningThreads =
+                step == results.steps.constBegin() ? 0 : std::prev(step)->runningThreads;
+            const auto type = results.costType(sampleType, std::min(std::max(runningThreads, 1), typesPerSampleType));
+            bottomUp.addEvent(type, event.cost, events.stacks.value(event.stackId), false,
+                              [](const Symbol&, const Location&) {});
+        }
+    }
+
+    Data::BottomUp::initializeParents(&bottomUp.root);
+    results.topDown = TopDownResults::fromBottomUp(bottomUp);
+    return results;
+}
+
+int Data::LockContentionResults::bucketForDuration(quint64 duration)
+{
+    int bucket = 0;
+    for (quint64 start = 1000; duration >= start && bucket < 63; start *= 2) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+quint64 Data::LockContentionResults::bucketStart(int bucket)
+{
+    return bucket <= 0 ? 0 : quint64(1000) << (bucket - 1);
+}
+
+namespace {
+// the frames of the kernel, the C library and the C++ standard library that take part in waiting for a lock
+bool isLockFrame(const QString& symbol)
+{
+    static const char* const patterns[] = {"futex",
+                                           "lll_lock",
+                                           "pthread_mutex_",
+                                           "pthread_cond_",
+                                           "pthread_rwlock_",
+                                           "sem_wait",
+                                           "sem_timedwait",
+                                           "sem_clockwait",
+                                           "__gthread_",
+                                           "std::mutex::",
+                                           "std::recursive_mutex::",
+                                           "std::timed_mutex::",
+                                           "std::shared_mutex::",
+                                           "std::unique_lock<",
+                                           "std::lock_guard<",
+                                           "std::scoped_lock<",
+                                           "std::condition_variable::"};
+    for (const auto* pattern : patterns) {
+        if (symbol.contains(QLatin1String(pattern))) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+Data::LockContentionResults Data::lockContentionFromEvents(const BottomUpResults& bottomUpData,
+                                                           const EventResults& events)
+{
+    LockContentionResults results;
+    if (events.offCpuTimeCostId == -1) {
+        return results;
+    }
+
+    // whether a stack waits for a lock and where, looked up once per stack rather than per event
+    enum StackKind : qint8
+    {
+        UnknownStack,
+        LockWaitStack,
+        OtherStack
+    };
+    QVector<qint8> stackKinds(events.stacks.size(), UnknownStack);
+    QHash<qint32, Symbol> callSites;
+    auto isLockWait = [&](qint32 stackId) {
+        if (stackId < 0 || stackId >= stackKinds.size()) {
+            return false;
+        }
+        if (stackKinds[stackId] == UnknownStack) {
+            bool waitsForLock = false;
+            Symbol callSite;
+            bottomUpData.foreachFrame(events.stacks.at(stackId),
+                                      [&waitsForLock, &callSite](const Symbol& symbol, const Location&) {
+                                          if (isLockFrame(symbol.symbol)) {
+                                              waitsForLock = true;
+                                              return true;
+                                          } else if (symbol.isKernel) {
+                                              return true;
+                                          }
+                                          callSite = symbol;
+                                          return false;
+                                      });
+            stackKinds[stackId] = waitsForLock ? LockWaitStack : OtherStack;
+            if (waitsForLock) {
+                callSites.insert(stackId, callSite);
+            }
+        }
+        return stackKinds[stackId] == LockWaitStack;
+    };
+
+    QHash<QPair<Symbol, quint64>, int> siteIndices;
+    QVector<QVector<quint64>> waits;
+    for (const auto& thread : events.threads) {
+        results.hasLockAddresses |= !thread.futexWaits.isEmpty();
+        quint64 lastSwitchIn = 0;
+        for (const auto& event : thread.events) {
+            if (event.type != events.offCpuTimeCostId) {
+                continue;
+            }
+
+            if (isLockWait(event.stackId)) {
+                // the futex syscall that preceded the switch out, unless the thread ran in between
+                quint64 address = 0;
+                auto futexWait = std::upper_bound(
+                    thread.futexWaits.begin(), thread.futexWaits.end(), event.time,
+                    [](quint64 time, const FutexWait& futexWait) { return time < futexWait.time; });
+                if (futexWait != thread.futexWaits.begin() && std::prev(futexWait)->time >= lastSwitchIn) {
+                    address = std::prev(futexWait)->address;
+                }
+
+                const auto key = qMakePair(callSites.value(event.stackId), address);
+                auto it = siteIndices.find(key);
+                if (it == siteIndices.end()) {
+                    it = siteIndices.insert(key, results.sites.size());
+                    LockWaitSite site;
+                    site.symbol = key.first;
+                    site.lockAddress = address;
+                    results.sites.append(site);
+                    waits.append(QVector<quint64>());
+                }
+
+                auto& site = results.sites[it.value()];
+                site.waitTime += event.cost;
+                ++site.waitCount;
+                site.longestWait = std::max(site.longestWait, event.cost);
+                waits[it.value()].append(event.cost);
+                results.totalWaitTime += event.cost;
+            }
+
+            lastSwitchIn = event.time + event.cost;
+        }
+    }
+
+    for (int i = 0, c = results.sites.size(); i < c; ++i) {
+        auto& site = results.sites[i];
+        auto& siteWaits = waits[i];
+        std::sort(siteWaits.begin(), siteWaits.end());
+        // nearest rank
+        site.p99Wait = siteWaits.at((siteWaits.size() * 99 + 99) / 100 - 1);
+        for (const auto wait : siteWaits) {
+            const auto bucket = LockContentionResults::bucketForDuration(wait);
+            if (site.histogram.size() <= bucket) {
+                site.histogram.resize(bucket + 1);
+            }
+            ++site.histogram[bucket];
+        }
+    }
+
+    std::sort(results.sites.begin(), results.sites.end(), [](const LockWaitSite& lhs, const LockWaitSite& rhs) {
+        return lhs.waitTime > rhs.waitTime;
+    });
+    return results;
+}
+
+quint64 Data::CriticalPath::timeIn(CriticalPathSegment::Kind kind) const
+{
+    return std::accumulate(segments.begin(), segments.end(), quint64(0),
+                           [kind](quint64 sum, const CriticalPathSegment& segment) {
+                               return segment.kind == kind ? sum + segment.time.delta() : sum;
+                           });
+}
+
+int Data::CriticalPath::numThreads() const
+{
+    QSet<qint32> threads;
+    for (const auto& segment : segments) {
+        threads.insert(segment.tid);
+    }
+    return threads.size();
+}
+
+Data::CriticalPath Data::criticalPathFromEvents(const BottomUpResults& bottomUpData, const EventResults& events,
+                                                qint32 pid, qint32 tid, const TimeRange& time)
+{
+    CriticalPath path;
+    path.pid = pid;
+    path.tid = tid;
+    path.time = time;
+
+    const auto* thread = events.findThread(pid, tid);
+    if (!thread || events.offCpuTimeCostId == -1 || time.isEmpty()) {
+        return path;
+    }
+
+    // the wakeups are recorded by the waking thread, but looked up by the woken one
+    struct WakeupSource
+    {
+        const ThreadEvents* waker;
+        const Wakeup* wakeup;
+    };
+    QHash<qint32, QVector<WakeupSource>> wakeupSources;
+    for (const auto& waker : events.threads) {
+        for (const auto& wakeup : waker.wakeups) {
+            wakeupSources[wakeup.wokenTid].append({&waker, &wakeup});
+        }
+    }
+    for (auto& sources : wakeupSources) {
+        std::sort(sources.begin(), sources.end(), [](const WakeupSource& lhs, const WakeupSource& rhs) {
+            return lhs.wakeup->time < rhs.wakeup->time;
+        });
+    }
+
+    // like the off-CPU call sites: the innermost user space frame, or the leaf frame when there is none
+    auto symbolOfStack = [&bottomUpData, &events](qint32 stackId) {
+        Symbol symbol;
+        if (stackId >= 0 && stackId < events.stacks.size()) {
+            bool isFirst = true;
+            bottomUpData.foreachFrame(events.stacks.at(stackId),
+                                      [&symbol, &isFirst](const Symbol& frameSymbol, const Location&) {
+                                          if (isFirst || !frameSymbol.isKernel) {
+                                              symbol = frameSymbol;
+                                          }
+                                          isFirst = false;
+                                          return symbol.isKernel;
+                                      });
+        }
+        return symbol;
+    };
+
+    // walk the path backwards in time, from the end of the range to its start
+    const auto* current = thread;
+    auto end = time.end;
+    // how the path reached the current thread, labels its last running segment
+    const WakeupSource* pendingWakeup = nullptr;
+    // bounds the walk, even when the wakeups of several threads happen at the same time
+    const int maxSteps = 100000;
+    for (int step = 0; end > time.start && step < maxSteps; ++step) {
+        CriticalPathSegment segment;
+        segment.pid = current->pid;
+        segment.tid = current->tid;
+
+        // the last wait that started before the end
+        const Event* offCpu = nullptr;
+        auto it = std::lower_bound(current->events.begin(), current->events.end(), end,
+                                   [](const Event& event, quint64 time) { return event.time < time; });
+        while (it != current->events.begin()) {
+            --it;
+            if (it->type == events.offCpuTimeCostId) {
+                offCpu = &(*it);
+                break;
+            }
+        }
+
+        const auto switchIn = offCpu ? offCpu->time + offCpu->cost : std::max(time.start, current->time.start);
+        if (switchIn < end) {
+            segment.kind = CriticalPathSegment::Running;
+            segment.time = {std::max(switchIn, time.start), end};
+            if (pendingWakeup) {
+                segment.cpuId = pendingWakeup->wakeup->cpuId;
+                segment.symbol = symbolOfStack(pendingWakeup->wakeup->stackId);
+                segment.wokenTid = pendingWakeup->wakeup->wokenTid;
+            }
+            path.segments.append(segment);
+            end = segment.time.start;
+        }
+        pendingWakeup = nullptr;
+        if (!offCpu || end <= time.start) {
+            break;
+        }
+
+        // the thread waited until the end, find out who woke it up
+        const WakeupSource* source = nullptr;
+        if (!offCpu->preempted) {
+            auto sources = wakeupSources.constFind(current->tid);
+            if (sources != wakeupSources.constEnd()) {
+                auto next = std::upper_bound(sources->begin(), sources->end(), end,
+                                             [](quint64 time, const WakeupSource& source) {
+                                                 return time < source.wakeup->time;
+                                             });
+                if (next != sources->begin() && std::prev(next)->wakeup->time >= offCpu->time) {
+                    source = &(*std::prev(next));
+                }
+            }
+        }
+
+        // the idle task wakes up the threads from interrupts, e.g. for timers or I/O, the path ends with the wait then
+        if (source && source->waker != current && source->waker->tid != 0) {
+            if (source->wakeup->time < end) {
+                segment.kind = CriticalPathSegment::Runnable;
+                segment.time = {std::max(source->wakeup->time, time.start), end};
+                segment.cpuId = INVALID_CPU_ID;
+                segment.symbol = {};
+                segment.wokenTid = INVALID_TID;
+                path.segments.append(segment);
+            }
+            current = source->waker;
+            end = source->wakeup->time;
+            pendingWakeup = source;
+        } else {
+            segment.kind = offCpu->preempted ? CriticalPathSegment::Preempted : CriticalPathSegment::Blocked;
+            segment.time = {std::max(offCpu->time, time.start), end};
+            segment.cpuId = offCpu->cpuId;
+            segment.symbol = symbolOfStack(offCpu->stackId);
+            segment.wokenTid = INVALID_TID;
+            path.segments.append(segment);
+            end = offCpu->time;
+        }
+    }
+
+    std::reverse(path.segments.begin(), path.segments.end());
+    return path;
+}
+
+Data::DisassemblyEntry Data::disassemblyEntryFromEvents(const Symbol& symbol, const BottomUpResults& bottomUpData,
+                                                        const EventResults& events)
+{
+    const auto numCosts = bottomUpData.costs.numTypes();
+
+    // the index into locations of the leaf frame of every stack, or -1 when it lies outside of the symbol
+    QVector<int> stackLocations(events.stacks.size(), -1);
+    QVector<Location> locations;
+    QHash<Location, int> locationIndices;
+    for (int stackId = 0, c = events.stacks.size(); stackId < c; ++stackId) {
+        bottomUpData.foreachFrame(events.stacks.at(stackId), [&](const Symbol& frameSymbol, const Location& location) {
+            if (frameSymbol.size > 0 && location.relAddr > frameSymbol.relAddr + frameSymbol.size) {
+                // not within the symbol range, the next frame is the leaf then
+                return true;
+            }
+            if (frameSymbol == symbol) {
+                auto it = locationIndices.find(location);
+                if (it == locationIndices.end()) {
+                    it = locationIndices.insert(location, locations.size());
+                    locations.append(location);
+                }
+                stackLocations[stackId] = it.value();
+            }
+            return false;
+        });
+    }
+
+    QVector<LocationCost> costs(locations.size(), LocationCost(numCosts));
+    if (!locations.isEmpty()) {
+        for (const auto& thread : events.threads) {
+            for (const auto& event : thread.events) {
+                if (event.type < 0 || event.stackId < 0 || event.type == events.offCpuTimeCostId) {
+                    continue;
+                }
+                const auto index = stackLocations.value(event.stackId, -1);
+                if (index != -1) {
+                    costs[index].selfCost[event.type] += event.cost;
+                }
+            }
+        }
+    }
+
+    DisassemblyEntry entry;
+    entry.relSourceMap.reserve(locations.size());
+    for (int i = 0; i < locations.size(); ++i) {
+        entry.relSourceMap.insert(locations.at(i), costs.at(i));
+    }
+    return entry;
+}
+
+void Data::addBranchCounts(const Symbol& symbol, const BottomUpResults& bottomUpData,
+                           const DisassemblyResult& disassembly, DisassemblyEntry* entry)
+{
+    // the location may be inlined into the symbol, then one of its parents belongs to it
+    auto relAddrInSymbol = [&](qint32 locationId, quint64* relAddr) {
+        while (locationId != -1) {
+            const auto& location = bottomUpData.locations.value(locationId);
+            if (bottomUpData.symbols.value(locationId) == symbol) {
+                *relAddr = location.location.relAddr;
+                return true;
+            }
+            locationId = location.parentLocationId;
+        }
+        return false;
+    };
+
+    for (auto it = disassembly.branchEdges.cbegin(), end = disassembly.branchEdges.cend(); it != end; ++it) {
+        quint64 from = 0;
+        quint64 to = 0;
+        if (relAddrInSymbol(it.key().first, &from) && relAddrInSymbol(it.key().second, &to)) {
+            entry->branchEdges[qMakePair(from, to)] += it.value();
+        }
+    }
+
+    for (auto it = disassembly.branchRanges.cbegin(), end = disassembly.branchRanges.cend(); it != end; ++it) {
+        quint64 start = 0;
+        quint64 last = 0;
+        if (relAddrInSymbol(it.key().first, &start) && relAddrInSymbol(it.key().second, &last) && start <= last) {
+            entry->branchRanges[qMakePair(start, last)] += it.value();
+        }
+    }
+}
+
 QDebug Data::operator<<(QDebug stream, const Symbol& symbol)
 {
     stream.noquote().nospace() << "Symbol{"
@@ -354,3 +1301,128 @@ const Data::ThreadEvents* Data::EventResults::findThread(qint32 pid, qint32 tid)
 {
     return const_cast<Data::EventResults*>(this)->findThread(pid, tid);
 }
+
+const Data::TracePointSamples* Data::EventResults::findTracePoint(qint32 costId) const
+{
+    for (const auto& tracePoint : tracePoints) {
+        if (tracePoint.costId == costId) {
+            return &tracePoint;
+        }
+    }
+    return nullptr;
+}
+
+int Data::TracePointField::columnWidth() const
+{
+    switch (type) {
+    case Signed:
+    case Unsigned:
+        return size;
+    case String:
+    case SignedArray:
+    case UnsignedArray:
+        return sizeof(qint32);
+    case Unsupported:
+        break;
+    }
+    return 0;
+}
+
+namespace {
+template<typename Number>
+Number readColumn(const QByteArray& column, int row)
+{
+    Number number;
+    std::memcpy(&number, column.constData() + row * sizeof(Number), sizeof(Number));
+    return number;
+}
+}
+
+QVariant Data::TracePointSamples::value(int field, int row) const
+{
+    const auto& definition = fields.at(field);
+    const auto& column = columns.at(field);
+    switch (definition.type) {
+    case TracePointField::Signed:
+        switch (definition.size) {
+        case 1:
+            return static_cast<qint64>(readColumn<qint8>(column, row));
+        case 2:
+            return static_cast<qint64>(readColumn<qint16>(column, row));
+        case 4:
+            return static_cast<qint64>(readColumn<qint32>(column, row));
+        case 8:
+            return readColumn<qint64>(column, row);
+        }
+        break;
+    case TracePointField::Unsigned:
+        switch (definition.size) {
+        case 1:
+            return static_cast<quint64>(readColumn<quint8>(column, row));
+        case 2:
+            return static_cast<quint64>(readColumn<quint16>(column, row));
+        case 4:
+            return static_cast<quint64>(readColumn<quint32>(column, row));
+        case 8:
+            return readColumn<quint64>(column, row);
+        }
+        break;
+    case TracePointField::String:
+    case TracePointField::SignedArray:
+    case TracePointField::UnsignedArray:
+        return strings.value(readColumn<qint32>(column, row));
+    case TracePointField::Unsupported:
+        break;
+    }
+    return {};
+}
+
+QString Data::TracePointSamples::displayValue(int field, int row) const
+{
+    const auto value = this->value(field, row);
+    if (fields.at(field).type == TracePointField::Unsigned && fields.at(field).size == 8) {
+        // mostly addresses and other ids
+        return QLatin1String("0x") + QString::number(value.toULongLong(), 16);
+    }
+    return value.toString();
+}
+
+int Data::TracePointSamples::fieldIndex(const QString& fieldName) const
+{
+    for (int i = 0, c = fields.size(); i < c; ++i) {
+        if (fields.at(i).name == fieldName) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+Data::TracePointSamples Data::TracePointSamples::selected(const QVector<int>& rows) const
+{
+    TracePointSamples result;
+    result.name = name;
+    result.costId = costId;
+    result.fields = fields;
+    result.strings = strings;
+    result.times.reserve(rows.size());
+    result.pids.reserve(rows.size());
+    result.tids.reserve(rows.size());
+    result.cpuIds.reserve(rows.size());
+    for (int row : rows) {
+        result.times.append(times.at(row));
+        result.pids.append(pids.at(row));
+        result.tids.append(tids.at(row));
+        result.cpuIds.append(cpuIds.at(row));
+    }
+
+    result.columns.resize(columns.size());
+    for (int i = 0, c = columns.size(); i < c; ++i) {
+        const int width = fields.at(i).columnWidth();
+        auto& column = result.columns[i];
+        column.reserve(rows.size() * width);
+        for (int row : rows) {
+            column.append(columns.at(i).constData() + row * width, width);
+        }
+    }
+    return result;
+}
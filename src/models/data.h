@@ -31,6 +31,7 @@
 #include <QMetaType>
 #include <QString>
 #include <QTypeInfo>
+#include <QVariant>
 #include <QVector>
 #include <QSet>
 
@@ -41,6 +42,8 @@
 #include <tuple>
 #include <valarray>
 
+class QDataStream;
+
 namespace Data {
 QString prettifySymbol(const QString& symbol);
 
@@ -71,6 +74,8 @@ struct Symbol
     QString path;
     // prettified function name
     QString prettySymbol;
+    // the function lies within the kernel or a kernel module
+    bool isKernel = false;
 
     bool operator<(const Symbol& rhs) const
     {
@@ -273,17 +278,22 @@ public:
     {
         m_typeNames = rhs.m_typeNames;
         m_units = rhs.m_units;
+        m_deltaTypes = rhs.m_deltaTypes;
         m_costs.resize(rhs.m_costs.size());
         m_totalCosts = rhs.m_totalCosts;
     }
 
-    QString formatCost(int type, quint64 cost) const
+    QString formatCost(int type, qint64 cost) const
     {
         return formatCost(m_units[type], cost);
     }
 
-    static QString formatCost(Unit unit, quint64 cost)
+    static QString formatCost(Unit unit, qint64 cost)
     {
+        // differential data can contain negative costs
+        if (cost < 0) {
+            return QLatin1Char('-') + formatCost(unit, -cost);
+        }
         switch (unit) {
         case Unit::Time:
             return Util::formatTimeString(cost);
@@ -298,7 +308,31 @@ public:
         return m_units[type];
     }
 
+    // for differential data, the type that holds the compared minus the baseline cost of @p type, or -1
+    int deltaType(int type) const
+    {
+        return m_deltaTypes.value(type, -1);
+    }
+
+    void setDeltaType(int type, int deltaType)
+    {
+        while (m_deltaTypes.size() <= type) {
+            m_deltaTypes.append(-1);
+        }
+        m_deltaTypes[type] = deltaType;
+    }
+
+    // subtract the costs of @p rhs, e.g. an earlier state of these costs, types missing in @p rhs are kept as is
+    void subtract(const Costs& rhs);
+
+    // move the cost of every id to newIds[id], ids that are mapped to -1 get dropped
+    void remap(const QVector<qint32>& newIds);
+
 private:
+    // for the results cache, see resultscache.h
+    friend QDataStream& operator<<(QDataStream& stream, const Costs& costs);
+    friend QDataStream& operator>>(QDataStream& stream, Costs& costs);
+
     void ensureSpaceAvailable(int type, quint32 id)
     {
         while (static_cast<quint32>(m_costs[type].size()) <= id) {
@@ -310,6 +344,7 @@ private:
     QVector<QVector<qint64>> m_costs;
     QVector<qint64> m_totalCosts;
     QVector<Unit> m_units;
+    QVector<int> m_deltaTypes;
 };
 
 
@@ -336,7 +371,13 @@ public:
         m_incompleteFlags = rhs.m_incompleteFlags;
     }
 
+    // see Costs::remap
+    void remap(const QVector<qint32>& newIds);
+
 private:
+    friend QDataStream& operator<<(QDataStream& stream, const IncompleteCallchains& incompleteCallchains);
+    friend QDataStream& operator>>(QDataStream& stream, IncompleteCallchains& incompleteCallchains);
+
     void ensureSpaceAvailable(quint32 id)
     {
         while (static_cast<quint32>(m_incompleteFlags.size()) <= id) {
@@ -424,6 +465,18 @@ struct BottomUp : SymbolTree<BottomUp>
     quint32 id;
 };
 
+struct CostSummary;
+
+// how the costs of a compared data set get scaled before subtracting the baseline costs
+enum class DiffNormalization
+{
+    None,
+    // scale such that the total cost per type matches the baseline, i.e. compare by period
+    TotalCost,
+    // scale by the ratio of the number of samples per type
+    SampleCount
+};
+
 struct BottomUpResults
 {
     BottomUp root;
@@ -476,7 +529,37 @@ struct BottomUpResults
         return parent;
     }
 
+    /**
+     * Add the costs of @p other to this data set, aligning the trees by symbol and the cost types by name.
+     *
+     * @p mapSymbol can be used to unify symbols, e.g. of the same binary found at different paths.
+     * Note that the stack based data, i.e. symbols and locations, is not merged.
+     */
+    void merge(const BottomUpResults& other, const std::function<Symbol(const Symbol&)>& mapSymbol = {});
+
+    /**
+     * Align @p compared with @p baseline by symbol and build a differential data set from them.
+     *
+     * For every cost type of the inputs, three types get added to the result: the baseline cost,
+     * the (normalized) compared cost and the delta between them, see Costs::deltaType.
+     * The summaries are only used for DiffNormalization::SampleCount and may be empty otherwise.
+     */
+    static BottomUpResults diff(const BottomUpResults& baseline, const BottomUpResults& compared,
+                                DiffNormalization normalization, const QVector<CostSummary>& baselineSummary,
+                                const QVector<CostSummary>& comparedSummary);
+
+    /**
+     * Remove the entries without any cost and number the remaining ones consecutively again.
+     *
+     * Returns the new id of every old id, -1 for the removed entries, to remap other costs of the same tree.
+     */
+    QVector<qint32> removeEmptyEntries();
+
 private:
+    // for the results cache, see resultscache.h
+    friend QDataStream& operator<<(QDataStream& stream, const BottomUpResults& results);
+    friend QDataStream& operator>>(QDataStream& stream, BottomUpResults& results);
+
     quint32 maxBottomUpId = 0;
 
     template<typename FrameCallback>
@@ -509,6 +592,45 @@ private:
     }
 };
 
+/**
+ * Limits the costs of a bottom-up tree that keeps growing, e.g. while recording live, to its last time slices.
+ *
+ * The costs at the start of every slice are kept. Evicting the oldest slice subtracts the costs it added from
+ * the tree and the newer slices, then the entries without costs are removed. The memory thus depends on the
+ * call paths seen in the window rather than on the length of the recording.
+ */
+class RollingCosts
+{
+public:
+    explicit RollingCosts(quint64 sliceDuration = 0, int maxSlices = 0);
+
+    /// start a new slice at @p time once the current one is complete, evicting the oldest one from @p bottomUp
+    void update(quint64 time, BottomUpResults* bottomUp);
+
+    int numSlices() const
+    {
+        return m_slices.size();
+    }
+
+    /// the time since which the costs are kept
+    quint64 windowStart() const
+    {
+        return m_slices.isEmpty() ? 0 : m_slices.first().start;
+    }
+
+private:
+    struct Slice
+    {
+        quint64 start;
+        // the costs of the tree at the start of the slice, minus those of the evicted slices
+        Costs costs;
+    };
+
+    quint64 m_sliceDuration;
+    int m_maxSlices;
+    QVector<Slice> m_slices;
+};
+
 struct TopDown : SymbolTree<TopDown>
 {
     quint32 id;
@@ -621,6 +743,10 @@ struct DisassemblyEntry {
     }
 
     RelLocationCostMap relSourceMap;
+    // taken branches (from, to) and the instruction ranges (start, end) executed in between them within the symbol,
+    // by relative address, with the number of times they were recorded in LBR branch stacks
+    QHash<QPair<quint64, quint64>, quint64> branchEdges;
+    QHash<QPair<quint64, quint64>, quint64> branchRanges;
 };
 
 using DisassemblyEntryMap = QHash<Symbol, DisassemblyEntry>;
@@ -674,9 +800,32 @@ struct DisassemblyResult {
         }
     }
 
+    // only filled for branch stacks, otherwise the costs are computed per symbol on demand
     DisassemblyEntryMap entries;
     Costs selfCosts;
     Costs inclusiveCosts;
+    // all symbols with samples, i.e. the callees that can be disassembled
+    QSet<Symbol> symbols;
+    // taken branches of the LBR branch stacks as (from, to) location ids and the instruction ranges executed in
+    // between two of them as (start, end) location ids, with the number of their occurrences
+    QHash<QPair<qint32, qint32>, quint64> branchEdges;
+    QHash<QPair<qint32, qint32>, quint64> branchRanges;
+
+    // Count the taken branches of a branch stack, given as pairs of from and to location ids, most recent first
+    void addBranchStack(const QVector<qint32> &branchFrames) {
+        for (int i = 0; i + 1 < branchFrames.size(); i += 2) {
+            const auto from = branchFrames.at(i);
+            const auto to = branchFrames.at(i + 1);
+            if (from >= 0 && to >= 0) {
+                ++branchEdges[qMakePair(from, to)];
+            }
+            // the older branch landed at the start of the range, this one left it at its end
+            const auto start = branchFrames.value(i + 3, -1);
+            if (start >= 0 && from >= 0) {
+                ++branchRanges[qMakePair(start, from)];
+            }
+        }
+    }
 
     // Return entry connecting symbol with set of locations inside it
     DisassemblyEntry &entry(const Symbol &symbol) {
@@ -700,11 +849,13 @@ struct Event
     qint32 type = -1;
     qint32 stackId = -1;
     quint32 cpuId = INVALID_CPU_ID;
+    // only for off-CPU time: the thread got preempted rather than blocked, see ThreadEvents::preempted
+    bool preempted = false;
 
     bool operator==(const Event& rhs) const
     {
-        return std::tie(time, cost, type, stackId, cpuId)
-            == std::tie(rhs.time, rhs.cost, rhs.type, rhs.stackId, rhs.cpuId);
+        return std::tie(time, cost, type, stackId, cpuId, preempted)
+            == std::tie(rhs.time, rhs.cost, rhs.type, rhs.stackId, rhs.cpuId, rhs.preempted);
     }
 };
 
@@ -763,6 +914,33 @@ struct TimeRange
 const constexpr auto MAX_TIME = std::numeric_limits<quint64>::max();
 const constexpr auto MAX_TIME_RANGE = TimeRange {0, MAX_TIME};
 
+// a thread entered the kernel to wait for the futex at address, e.g. to lock a contended mutex
+struct FutexWait
+{
+    quint64 time = 0;
+    quint64 address = 0;
+
+    bool operator==(const FutexWait& rhs) const
+    {
+        return std::tie(time, address) == std::tie(rhs.time, rhs.address);
+    }
+};
+
+// a thread woke up the thread wokenTid, e.g. by unlocking a mutex the other one waited for
+struct Wakeup
+{
+    quint64 time = 0;
+    qint32 wokenTid = INVALID_TID;
+    // the stack of the waking thread
+    qint32 stackId = -1;
+    quint32 cpuId = INVALID_CPU_ID;
+
+    bool operator==(const Wakeup& rhs) const
+    {
+        return std::tie(time, wokenTid, stackId, cpuId) == std::tie(rhs.time, rhs.wokenTid, rhs.stackId, rhs.cpuId);
+    }
+};
+
 struct ThreadEvents
 {
     qint32 pid = INVALID_PID;
@@ -779,12 +957,33 @@ struct ThreadEvents
         OffCpu
     };
     State state = Unknown;
+    // the stack of the last sched_switch sample, the off-CPU time that follows it gets attributed to it
+    qint32 lastSwitchStackId = -1;
+    // the thread was still runnable when it got switched out the last time, otherwise it blocked
+    bool preempted = false;
+    // from syscalls:sys_enter_futex tracepoints, sorted by time
+    QVector<FutexWait> futexWaits;
+    // the threads this thread woke up, from sched:sched_wakeup or sched:sched_waking tracepoints, sorted by time
+    QVector<Wakeup> wakeups;
 
     bool operator==(const ThreadEvents& rhs) const
     {
-        return std::tie(pid, tid, time, events, name, lastSwitchTime, offCpuTime, state)
+        return std::tie(pid, tid, time, events, name, lastSwitchTime, offCpuTime, state, lastSwitchStackId, preempted,
+                        futexWaits, wakeups)
             == std::tie(rhs.pid, rhs.tid, rhs.time, rhs.events, rhs.name, rhs.lastSwitchTime, rhs.offCpuTime,
-                        rhs.state);
+                        rhs.state, rhs.lastSwitchStackId, rhs.preempted, rhs.futexWaits, rhs.wakeups);
+    }
+};
+
+// events perf could not write to its ring buffer, lost somewhere within time
+struct LostEvents
+{
+    TimeRange time;
+    quint64 count = 0;
+
+    bool operator==(const LostEvents& rhs) const
+    {
+        return std::tie(time, count) == std::tie(rhs.time, rhs.count);
     }
 };
 
@@ -792,10 +991,11 @@ struct CpuEvents
 {
     quint32 cpuId = INVALID_CPU_ID;
     QVector<Event> events;
+    QVector<LostEvents> lost;
 
     bool operator==(const CpuEvents& rhs) const
     {
-        return std::tie(cpuId, events) == std::tie(rhs.cpuId, rhs.events);
+        return std::tie(cpuId, events, lost) == std::tie(rhs.cpuId, rhs.events, rhs.lost);
     }
 };
 
@@ -823,6 +1023,21 @@ struct CostSummary
 
 QDebug operator<<(QDebug stream, const CostSummary& symbol);
 
+struct CpuLosses
+{
+    quint32 cpuId = INVALID_CPU_ID;
+    quint64 lostChunks = 0;
+    quint64 lostEvents = 0;
+    // samples that made it to the ring buffer of this cpu, to put the losses into relation
+    quint64 sampleCount = 0;
+
+    bool operator==(const CpuLosses& rhs) const
+    {
+        return std::tie(cpuId, lostChunks, lostEvents, sampleCount)
+            == std::tie(rhs.cpuId, rhs.lostChunks, rhs.lostEvents, rhs.sampleCount);
+    }
+};
+
 struct Summary
 {
     quint64 applicationRunningTime = 0;
@@ -830,6 +1045,9 @@ struct Summary
     quint32 processCount = 0;
     QString command;
     quint64 lostChunks = 0;
+    quint64 lostEvents = 0;
+    // only cpus that lost events, sorted by cpu id
+    QVector<CpuLosses> lostPerCpu;
     QString hostName;
     QString linuxKernelVersion;
     QString perfVersion;
@@ -841,6 +1059,8 @@ struct Summary
     QString cpuSiblingCores;
     QString cpuSiblingThreads;
     quint64 totalMemoryInKiB = 0;
+    // build-ids of the binaries involved, keyed by their path
+    QHash<QString, QByteArray> buildIds;
     // only non-zero when perf record --switch-events was used
     quint64 onCpuTime = 0;
     quint64 offCpuTime = 0;
@@ -852,6 +1072,80 @@ struct Summary
     QStringList errors;
 };
 
+// a field of the payload of a tracepoint, as described by the format of the tracepoint
+struct TracePointField
+{
+    // the values match PerfUnwind::TracePointFieldType of perfparser
+    enum Type : quint8
+    {
+        Unsupported,
+        Signed,
+        Unsigned,
+        String,
+        SignedArray,
+        UnsignedArray
+    };
+
+    QString name;
+    Type type = Unsupported;
+    // in bytes, of a single element for arrays
+    quint8 size = 0;
+
+    bool isNumber() const
+    {
+        return type == Signed || type == Unsigned;
+    }
+
+    // the bytes a value of this field takes in TracePointSamples::columns
+    int columnWidth() const;
+
+    bool operator==(const TracePointField& rhs) const
+    {
+        return std::tie(name, type, size) == std::tie(rhs.name, rhs.type, rhs.size);
+    }
+};
+
+/**
+ * The payloads of the samples of one tracepoint, stored column by column.
+ *
+ * Numbers are packed at the size of their field, strings and arrays are interned into strings and
+ * referenced by a qint32 index. The rows are sorted by time.
+ */
+struct TracePointSamples
+{
+    // e.g. "sched:sched_wakeup"
+    QString name;
+    qint32 costId = -1;
+    QVector<TracePointField> fields;
+    QVector<quint64> times;
+    QVector<qint32> pids;
+    QVector<qint32> tids;
+    QVector<quint32> cpuIds;
+    // one per field
+    QVector<QByteArray> columns;
+    QVector<QString> strings;
+
+    int size() const
+    {
+        return times.size();
+    }
+
+    // a qint64 or quint64 for numbers, a QString for strings and arrays, invalid for unsupported fields
+    QVariant value(int field, int row) const;
+    QString displayValue(int field, int row) const;
+    int fieldIndex(const QString& fieldName) const;
+
+    // the rows at the sorted indices @p rows, the strings are shared
+    TracePointSamples selected(const QVector<int>& rows) const;
+
+    bool operator==(const TracePointSamples& rhs) const
+    {
+        return std::tie(name, costId, fields, times, pids, tids, cpuIds, columns, strings)
+            == std::tie(rhs.name, rhs.costId, rhs.fields, rhs.times, rhs.pids, rhs.tids, rhs.cpuIds, rhs.columns,
+                        rhs.strings);
+    }
+};
+
 struct EventResults
 {
     QVector<ThreadEvents> threads;
@@ -859,17 +1153,232 @@ struct EventResults
     QVector<QVector<qint32>> stacks;
     QVector<CostSummary> totalCosts;
     qint32 offCpuTimeCostId = -1;
+    // one per tracepoint that had samples with a known format
+    QVector<TracePointSamples> tracePoints;
 
     ThreadEvents* findThread(qint32 pid, qint32 tid);
     const ThreadEvents* findThread(qint32 pid, qint32 tid) const;
+    const TracePointSamples* findTracePoint(qint32 costId) const;
 
     bool operator==(const EventResults& rhs) const
     {
-        return std::tie(threads, cpus, stacks, totalCosts, offCpuTimeCostId)
-            == std::tie(rhs.threads, rhs.cpus, rhs.stacks, rhs.totalCosts, rhs.offCpuTimeCostId);
+        return std::tie(threads, cpus, stacks, totalCosts, offCpuTimeCostId, tracePoints)
+            == std::tie(rhs.threads, rhs.cpus, rhs.stacks, rhs.totalCosts, rhs.offCpuTimeCostId, rhs.tracePoints);
     }
 };
 
+// where threads waited off-CPU, the innermost user space frame of their sched_switch stacks
+struct OffCpuCallSite
+{
+    Symbol symbol;
+    quint64 blockedTime = 0;
+    quint64 preemptedTime = 0;
+    // how often threads blocked here
+    quint64 blockedCount = 0;
+    quint64 longestBlockedTime = 0;
+
+    bool operator==(const OffCpuCallSite& rhs) const
+    {
+        return std::tie(symbol, blockedTime, preemptedTime, blockedCount, longestBlockedTime)
+            == std::tie(rhs.symbol, rhs.blockedTime, rhs.preemptedTime, rhs.blockedCount, rhs.longestBlockedTime);
+    }
+};
+
+struct OffCpuResults
+{
+    // cost types of bottomUp and topDown
+    enum CostType
+    {
+        BlockedTime = 0,
+        PreemptedTime = 1,
+    };
+
+    // the off-CPU time attributed to the stacks of the sched_switch samples that preceded it
+    BottomUpResults bottomUp;
+    TopDownResults topDown;
+    // sorted by blocked time, longest first
+    QVector<OffCpuCallSite> callSites;
+};
+
+/**
+ * The off-CPU time of @p events, split by whether the threads blocked or got preempted.
+ *
+ * Only available for recordings with context switch events, the stacks need sched:sched_switch samples.
+ * Off-CPU time without such a sample is accounted to an invalid call site.
+ */
+OffCpuResults offCpuResultsFromEvents(const BottomUpResults& bottomUpData, const EventResults& events);
+
+// the number of threads that ran at once from time on, until the time of the next step
+struct ParallelismStep
+{
+    quint64 time = 0;
+    qint32 runningThreads = 0;
+
+    bool operator==(const ParallelismStep& rhs) const
+    {
+        return std::tie(time, runningThreads) == std::tie(rhs.time, rhs.runningThreads);
+    }
+};
+
+struct ParallelismResults
+{
+    // the span of the events, no thread ran before the first step
+    TimeRange time;
+    QVector<ParallelismStep> steps;
+    // how long exactly N threads ran at once, indexed by N
+    QVector<quint64> timeAtParallelism;
+    // the number of CPUs that received samples, i.e. how many threads could have run at once
+    qint32 numCpus = 0;
+    // the cost types of the samples, i.e. all but the off-CPU time, see costType
+    QStringList sampleTypeNames;
+    // the samples of every sample type, split by the number of threads that ran when they got taken
+    BottomUpResults bottomUp;
+    TopDownResults topDown;
+
+    qint32 maxParallelism() const
+    {
+        return std::max(timeAtParallelism.size() - 1, 0);
+    }
+
+    // the cost type of bottomUp that holds the samples of sampleTypeNames[sampleType] taken while
+    // runningThreads ran, or -1 if there is none
+    qint32 costType(int sampleType, qint32 runningThreads) const;
+
+    // the time in which any thread ran
+    quint64 busyTime() const;
+    // the average number of running threads during busyTime
+    double averageParallelism() const;
+    // the fraction of busyTime in which only one thread ran, i.e. the serial part in terms of Amdahl's law
+    double serialFraction() const;
+};
+
+/**
+ * How many threads of @p events ran at once over time.
+ *
+ * A thread runs from its start until its end, except for its off-CPU time. Without context switch events,
+ * each sample is taken to span the typical time between the samples of a thread instead, or less when the next
+ * sample of the thread follows sooner.
+ */
+ParallelismResults parallelismResultsFromEvents(const BottomUpResults& bottomUpData, const EventResults& events);
+
+// the waits for a lock at one call site, i.e. the innermost frame outside of the lock implementation
+struct LockWaitSite
+{
+    Symbol symbol;
+    // the futex the threads waited for, 0 when unknown
+    quint64 lockAddress = 0;
+    quint64 waitTime = 0;
+    quint64 waitCount = 0;
+    quint64 longestWait = 0;
+    // 99% of the waits were at most this long
+    quint64 p99Wait = 0;
+    // the number of waits per duration, see LockContentionResults::bucketForDuration
+    QVector<quint64> histogram;
+
+    bool operator==(const LockWaitSite& rhs) const
+    {
+        return std::tie(symbol, lockAddress, waitTime, waitCount, longestWait, p99Wait, histogram)
+            == std::tie(rhs.symbol, rhs.lockAddress, rhs.waitTime, rhs.waitCount, rhs.longestWait, rhs.p99Wait,
+                        rhs.histogram);
+    }
+};
+
+struct LockContentionResults
+{
+    // sorted by wait time, longest first
+    QVector<LockWaitSite> sites;
+    quint64 totalWaitTime = 0;
+    // whether syscalls:sys_enter_futex got recorded, otherwise the lock addresses are unknown
+    bool hasLockAddresses = false;
+
+    // bucket 0 holds the waits below 1us, bucket N the ones from 2^(N-1)us up to 2^Nus
+    static int bucketForDuration(quint64 duration);
+    static quint64 bucketStart(int bucket);
+};
+
+/**
+ * The off-CPU time of @p events whose stacks wait for a futex, e.g. in pthread_mutex_lock, grouped by call site.
+ *
+ * Needs the stacks of sched:sched_switch samples, the lock addresses need syscalls:sys_enter_futex samples.
+ */
+LockContentionResults lockContentionFromEvents(const BottomUpResults& bottomUpData, const EventResults& events);
+
+// a span of time on the critical path, during which the given thread held up the end of the path
+struct CriticalPathSegment
+{
+    enum Kind : qint8
+    {
+        Running,
+        // woken up, but no CPU was free yet
+        Runnable,
+        // waited for something that did not get woken up by a recorded thread, e.g. a timer or I/O
+        Blocked,
+        Preempted
+    };
+
+    TimeRange time;
+    qint32 pid = INVALID_PID;
+    qint32 tid = INVALID_TID;
+    quint32 cpuId = INVALID_CPU_ID;
+    Kind kind = Running;
+    // where the thread was, i.e. where it woke up the next thread on the path or where it waited
+    Symbol symbol;
+    // for running segments: the thread that got woken up at the end of the segment, if any
+    qint32 wokenTid = INVALID_TID;
+
+    bool operator==(const CriticalPathSegment& rhs) const
+    {
+        return std::tie(time, pid, tid, cpuId, kind, symbol, wokenTid)
+            == std::tie(rhs.time, rhs.pid, rhs.tid, rhs.cpuId, rhs.kind, rhs.symbol, rhs.wokenTid);
+    }
+};
+
+struct CriticalPath
+{
+    qint32 pid = INVALID_PID;
+    qint32 tid = INVALID_TID;
+    TimeRange time;
+    // sorted by time, without gaps from the first segment on
+    QVector<CriticalPathSegment> segments;
+
+    bool isEmpty() const
+    {
+        return segments.isEmpty();
+    }
+
+    quint64 timeIn(CriticalPathSegment::Kind kind) const;
+    // the number of distinct threads on the path
+    int numThreads() const;
+};
+
+/**
+ * What kept thread @p tid of process @p pid from finishing earlier within @p time.
+ *
+ * Starting from the end of @p time, the path follows the thread back to where it got switched in. When another
+ * thread woke it up before, the path continues with the waking thread at the time of the wakeup, otherwise the
+ * thread waited for something that was not recorded and the path continues with it at the time it got switched out.
+ * Needs context switches and the sched:sched_wakeup or sched:sched_waking tracepoints.
+ */
+CriticalPath criticalPathFromEvents(const BottomUpResults& bottomUpData, const EventResults& events, qint32 pid,
+                                    qint32 tid, const TimeRange& time);
+
+/**
+ * The self costs of the instructions of @p symbol, i.e. of all events whose leaf frame lies within it.
+ *
+ * Only the stacks are checked for the symbol, the events then just look up the location of their stack.
+ * Context switches don't contribute to the instruction costs.
+ */
+DisassemblyEntry disassemblyEntryFromEvents(const Symbol& symbol, const BottomUpResults& bottomUpData,
+                                            const EventResults& events);
+
+/**
+ * Add the taken branches and executed instruction ranges of @p disassembly that lie within @p symbol to @p entry.
+ *
+ * Branches that leave or enter the symbol are skipped, as are ranges that cross it.
+ */
+void addBranchCounts(const Symbol& symbol, const BottomUpResults& bottomUpData, const DisassemblyResult& disassembly,
+                     DisassemblyEntry* entry);
+
 struct FilterAction
 {
     TimeRange time;
@@ -909,6 +1418,9 @@ Q_DECLARE_TYPEINFO(Data::Symbol, Q_MOVABLE_TYPE);
 Q_DECLARE_METATYPE(Data::DisassemblyResult)
 Q_DECLARE_TYPEINFO(Data::DisassemblyResult, Q_MOVABLE_TYPE);
 
+Q_DECLARE_METATYPE(Data::DisassemblyEntry)
+Q_DECLARE_TYPEINFO(Data::DisassemblyEntry, Q_MOVABLE_TYPE);
+
 Q_DECLARE_METATYPE(Data::Location)
 Q_DECLARE_TYPEINFO(Data::Location, Q_MOVABLE_TYPE);
 
@@ -947,6 +1459,42 @@ Q_DECLARE_TYPEINFO(Data::ThreadEvents, Q_MOVABLE_TYPE);
 Q_DECLARE_METATYPE(Data::CpuEvents)
 Q_DECLARE_TYPEINFO(Data::CpuEvents, Q_MOVABLE_TYPE);
 
+Q_DECLARE_METATYPE(Data::OffCpuResults)
+Q_DECLARE_TYPEINFO(Data::OffCpuResults, Q_MOVABLE_TYPE);
+
+Q_DECLARE_METATYPE(Data::ParallelismResults)
+Q_DECLARE_TYPEINFO(Data::ParallelismResults, Q_MOVABLE_TYPE);
+
+Q_DECLARE_METATYPE(QVector<Data::ParallelismStep>)
+Q_DECLARE_TYPEINFO(Data::ParallelismStep, Q_MOVABLE_TYPE);
+
+Q_DECLARE_METATYPE(Data::LockContentionResults)
+Q_DECLARE_TYPEINFO(Data::LockContentionResults, Q_MOVABLE_TYPE);
+
+Q_DECLARE_METATYPE(Data::LockWaitSite)
+Q_DECLARE_TYPEINFO(Data::LockWaitSite, Q_MOVABLE_TYPE);
+
+Q_DECLARE_TYPEINFO(Data::FutexWait, Q_MOVABLE_TYPE);
+
+Q_DECLARE_TYPEINFO(Data::Wakeup, Q_MOVABLE_TYPE);
+
+Q_DECLARE_METATYPE(Data::CriticalPath)
+Q_DECLARE_TYPEINFO(Data::CriticalPath, Q_MOVABLE_TYPE);
+
+Q_DECLARE_TYPEINFO(Data::CriticalPathSegment, Q_MOVABLE_TYPE);
+
+Q_DECLARE_TYPEINFO(Data::OffCpuCallSite, Q_MOVABLE_TYPE);
+
+Q_DECLARE_TYPEINFO(Data::TracePointField, Q_MOVABLE_TYPE);
+
+Q_DECLARE_METATYPE(Data::TracePointSamples)
+Q_DECLARE_TYPEINFO(Data::TracePointSamples, Q_MOVABLE_TYPE);
+
+Q_DECLARE_METATYPE(Data::LostEvents)
+Q_DECLARE_TYPEINFO(Data::LostEvents, Q_MOVABLE_TYPE);
+
+Q_DECLARE_TYPEINFO(Data::CpuLosses, Q_MOVABLE_TYPE);
+
 Q_DECLARE_METATYPE(Data::Summary)
 Q_DECLARE_TYPEINFO(Data::Summary, Q_MOVABLE_TYPE);
 
@@ -0,0 +1,147 @@
+/*
+    disassemblyindex.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "disassemblyindex.h"
+
+#include <algorithm>
+
+/**
+ *  Index the complete lines of output, the incomplete last line is kept until more output arrives
+ * @param output
+ */
+void DisassemblyIndex::append(const QByteArray &output) {
+    m_tail += output;
+    int lineStart = 0;
+    int lineEnd;
+    while ((lineEnd = m_tail.indexOf('\n', lineStart)) != -1) {
+        indexLine(m_tail.constData() + lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+    }
+    m_tail.remove(0, lineStart);
+}
+
+/**
+ *  Index the last line of output, when it is not terminated by a newline
+ */
+void DisassemblyIndex::finish() {
+    if (!m_tail.isEmpty()) {
+        indexLine(m_tail.constData(), m_tail.size());
+        m_tail.clear();
+    }
+    m_text.squeeze();
+    m_instructions.squeeze();
+}
+
+/**
+ *  Keep the line when it is an instruction, i.e. it starts with its hexadecimal address followed by ':' and a tab.
+ *  Headers of sections and symbols are dropped, as are instructions that are not in ascending address order
+ * @param line
+ * @param length
+ */
+void DisassemblyIndex::indexLine(const char *line, int length) {
+    if (length > 0 && line[length - 1] == '\r')
+        length--;
+
+    int pos = 0;
+    while (pos < length && line[pos] == ' ')
+        pos++;
+
+    quint64 address = 0;
+    const int addressStart = pos;
+    for (; pos < length; pos++) {
+        const char c = line[pos];
+        int digit;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            digit = c - 'A' + 10;
+        else
+            break;
+        address = address * 16 + digit;
+    }
+    if (pos == addressStart || pos + 1 >= length || line[pos] != ':' || line[pos + 1] != '\t')
+        return;
+    if (!m_instructions.isEmpty() && address <= m_instructions.last().address)
+        return;
+
+    Instruction instruction;
+    instruction.address = address;
+    instruction.offset = m_text.size();
+    instruction.length = length;
+    m_instructions.append(instruction);
+    m_text.append(line, length);
+    m_text.append('\n');
+}
+
+/**
+ *  First instruction at or after address
+ * @param address
+ * @return
+ */
+QVector<DisassemblyIndex::Instruction>::const_iterator DisassemblyIndex::lowerBound(quint64 address) const {
+    return std::lower_bound(m_instructions.constBegin(), m_instructions.constEnd(), address,
+                            [](const Instruction &instruction, quint64 value) {
+                                return instruction.address < value;
+                            });
+}
+
+/**
+ *  Return the instruction lines within [start, end)
+ * @param start
+ * @param end
+ * @return
+ */
+QByteArray DisassemblyIndex::lines(quint64 start, quint64 end) const {
+    const auto first = lowerBound(start);
+    const auto last = lowerBound(end);
+    if (first == last)
+        return {};
+    const auto &lastInstruction = *(last - 1);
+    return m_text.mid(first->offset, lastInstruction.offset + lastInstruction.length + 1 - first->offset);
+}
+
+/**
+ *  Return true when an instruction starts at address
+ * @param address
+ * @return
+ */
+bool DisassemblyIndex::contains(quint64 address) const {
+    const auto it = lowerBound(address);
+    return it != m_instructions.constEnd() && it->address == address;
+}
+
+/**
+ *  Number of indexed instructions
+ * @return
+ */
+int DisassemblyIndex::instructionCount() const {
+    return m_instructions.size();
+}
+
+/**
+ *  Memory used by the index in bytes
+ * @return
+ */
+int DisassemblyIndex::size() const {
+    return m_text.size() + m_tail.size() + m_instructions.size() * static_cast<int>(sizeof(Instruction));
+}
@@ -0,0 +1,59 @@
+/*
+    disassemblyindex.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * Instructions of a whole binary disassembled by 'objdump -d' once.
+ *
+ * Only the instruction lines are kept, in address order, so the instructions of any address range
+ * are a single span of the text that is found by binary search.
+ */
+class DisassemblyIndex {
+public:
+    // Index the complete lines of output, the output may be appended in chunks while objdump is running
+    void append(const QByteArray &output);
+    // Index the last incomplete line
+    void finish();
+    // Instruction lines within [start, end), each terminated by a newline
+    QByteArray lines(quint64 start, quint64 end) const;
+    bool contains(quint64 address) const;
+    int instructionCount() const;
+    // Memory used by the index in bytes
+    int size() const;
+private:
+    struct Instruction {
+        quint64 address;
+        // Line of the instruction in m_text
+        int offset;
+        int length;
+    };
+    void indexLine(const char *line, int length);
+    QVector<Instruction>::const_iterator lowerBound(quint64 address) const;
+    // Instruction lines separated by newlines
+    QByteArray m_text;
+    QVector<Instruction> m_instructions;
+    // Incomplete last line of the output
+    QByteArray m_tail;
+};
@@ -44,4 +44,43 @@ QVariant DisassemblyModel::data(const QModelIndex &index, int role) const {
         }
     }
     return QStandardItemModel::data(index, role);
-}
\ No newline at end of file
+}
+
+/**
+ *  Replace the contents of the model with a single reset instead of a change notification per cell
+ * @param headerLabels
+ * @param rows
+ */
+void DisassemblyModel::setRows(const QStringList &headerLabels, const QVector<QStringList> &rows) {
+    beginResetModel();
+    {
+        const QSignalBlocker blocker(this);
+        clear();
+        setHorizontalHeaderLabels(headerLabels);
+        setRowCount(rows.size());
+        for (int row = 0; row < rows.size(); row++) {
+            const QStringList &cells = rows.at(row);
+            for (int column = 0; column < cells.size(); column++) {
+                // The instruction column always has an item, the page reads its text
+                if (column == 0 || !cells.at(column).isEmpty()) {
+                    setItem(row, column, new QStandardItem(cells.at(column)));
+                }
+            }
+        }
+    }
+    endResetModel();
+}
+
+/**
+ *  Append rows to the model, one change notification per row
+ * @param rows
+ */
+void DisassemblyModel::appendRows(const QVector<QStringList> &rows) {
+    for (const QStringList &cells : rows) {
+        QList<QStandardItem *> items;
+        for (int column = 0; column < cells.size(); column++) {
+            items.append(new QStandardItem(cells.at(column)));
+        }
+        appendRow(items);
+    }
+}
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <QStandardItemModel>
+#include <QVector>
 
 enum Roles {
     SortRole = Qt::UserRole,
@@ -34,5 +35,9 @@ Q_OBJECT
 public:
     ~DisassemblyModel();
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    // Replace all rows at once, empty cells don't get an item
+    void setRows(const QStringList &headerLabels, const QVector<QStringList> &rows);
+    // Append rows while the output is still loading
+    void appendRows(const QVector<QStringList> &rows);
 private:
 };
@@ -153,6 +153,8 @@ QVariant EventModel::data(const QModelIndex& index, int role) const
         return QVariant::fromValue(m_data.totalCosts);
     } else if (role == EventResultsRole) {
         return QVariant::fromValue(m_data);
+    } else if (role == MaxRunningThreadsRole) {
+        return m_maxRunningThreads;
     }
 
     auto tag = dataTag(index);
@@ -167,10 +169,13 @@ QVariant EventModel::data(const QModelIndex& index, int role) const
                 return tr("Event timelines for all CPUs. This shows you which, and how many CPUs where leveraged."
                           "Note that this feature relies on perf data files recorded with <tt>--sample-cpu</tt>.");
             } else {
-                return tr("Event timelines for the individual threads and processes.");
+                return tr("Event timelines for the individual threads and processes. The lane of this row shows "
+                          "how many of the threads ran at once, relative to the number of CPUs.");
             }
         } else if (role == SortRole) {
             return index.row();
+        } else if (role == RunningThreadsRole && index.row() == 1) {
+            return QVariant::fromValue(m_runningThreads);
         }
         return {};
     } else if (tag == Tag::Processes) {
@@ -247,6 +252,8 @@ QVariant EventModel::data(const QModelIndex& index, int role) const
         return cpu ? cpu->cpuId : Data::INVALID_CPU_ID;
     } else if (role == EventsRole) {
         return QVariant::fromValue(thread ? thread->events : cpu->events);
+    } else if (role == LostEventsRole) {
+        return QVariant::fromValue(cpu ? cpu->lost : QVector<Data::LostEvents>());
     } else if (role == SortRole) {
         if (index.column() == ThreadColumn)
             return thread ? thread->tid : cpu->cpuId;
@@ -281,6 +288,13 @@ QVariant EventModel::data(const QModelIndex& index, int role) const
             const auto numEvents = thread ? thread->events.size() : cpu->events.size();
             tooltip += tr("Number of Events: %1 (%2% of the total)")
                            .arg(QString::number(numEvents), Util::formatCostRelative(numEvents, m_totalEvents));
+            if (cpu && !cpu->lost.isEmpty()) {
+                quint64 numLost = 0;
+                for (const auto& lost : cpu->lost) {
+                    numLost += lost.count;
+                }
+                tooltip += tr("\nLost Events: %1 in %2 chunks").arg(QString::number(numLost), QString::number(cpu->lost.size()));
+            }
             return tooltip;
         }
         break;
@@ -334,14 +348,25 @@ void EventModel::setData(const Data::EventResults& data)
             }
         }
 
-        // don't show timeline for CPU cores that did not receive any events
-        auto it = std::remove_if(m_data.cpus.begin(), m_data.cpus.end(),
-                                 [](const Data::CpuEvents& cpuEvents) { return cpuEvents.events.isEmpty(); });
+        // don't show timeline for CPU cores that did not receive any events, unless they lost some
+        auto it = std::remove_if(m_data.cpus.begin(), m_data.cpus.end(), [](const Data::CpuEvents& cpuEvents) {
+            return cpuEvents.events.isEmpty() && cpuEvents.lost.isEmpty();
+        });
         m_data.cpus.erase(it, m_data.cpus.end());
     }
     endResetModel();
 }
 
+void EventModel::setParallelism(const Data::ParallelismResults& parallelism)
+{
+    m_runningThreads = parallelism.steps;
+    m_maxRunningThreads = std::max(parallelism.numCpus, parallelism.maxParallelism());
+    const auto processes = index(1, EventsColumn);
+    if (processes.isValid()) {
+        emit dataChanged(processes, processes, {RunningThreadsRole, MaxRunningThreadsRole});
+    }
+}
+
 QModelIndex EventModel::index(int row, int column, const QModelIndex& parent) const
 {
     if (row < 0 || row >= rowCount(parent) || column < 0 || column >= NUM_COLUMNS) {
@@ -62,6 +62,12 @@ public:
         SortRole,
         TotalCostsRole,
         EventResultsRole,
+        // the spans in which a cpu lost events, empty for threads
+        LostEventsRole,
+        // how many threads ran at once over time, only for the processes overview, see setParallelism
+        RunningThreadsRole,
+        // the number of running threads that fills the lane, i.e. the number of CPUs or more
+        MaxRunningThreadsRole,
     };
 
     int rowCount(const QModelIndex& parent = {}) const override;
@@ -76,6 +82,9 @@ public:
     using QAbstractItemModel::setData;
     void setData(const Data::EventResults& data);
 
+    // the running threads of the events, kept when setData gets called with the events they got computed from
+    void setParallelism(const Data::ParallelismResults& parallelism);
+
     struct Process
     {
         Process(qint32 pid = Data::INVALID_PID, const QVector<qint32> threads = {}, const QString &name = {})
@@ -95,6 +104,8 @@ private:
     quint64 m_totalOffCpuTime = 0;
     quint64 m_totalEvents = 0;
     quint64 m_maxCost = 0;
+    QVector<Data::ParallelismStep> m_runningThreads;
+    qint32 m_maxRunningThreads = 0;
 };
 
 Q_DECLARE_TYPEINFO(EventModel::Process, Q_MOVABLE_TYPE);
@@ -0,0 +1,282 @@
+/*
+    lockcontentionmodel.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "lockcontentionmodel.h"
+
+#include <QFont>
+
+#include "../util.h"
+
+namespace {
+QString formatAddress(quint64 address)
+{
+    return address ? (QLatin1String("0x") + QString::number(address, 16)) : QString();
+}
+}
+
+LockContentionModel::LockContentionModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+LockContentionModel::~LockContentionModel() = default;
+
+void LockContentionModel::setData(const Data::LockContentionResults& data)
+{
+    beginResetModel();
+    m_sites = data.sites;
+    m_totalWaitTime = data.totalWaitTime;
+    endResetModel();
+}
+
+int LockContentionModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_sites.size();
+}
+
+int LockContentionModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : NUM_COLUMNS;
+}
+
+QVariant LockContentionModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || section < 0 || section >= NUM_COLUMNS) {
+        return {};
+    }
+
+    if (role == Qt::InitialSortOrderRole && section >= WaitTime) {
+        return Qt::DescendingOrder;
+    } else if (role == Qt::DisplayRole) {
+        switch (static_cast<Columns>(section)) {
+        case Symbol:
+            return tr("Call Site");
+        case Binary:
+            return tr("Binary");
+        case Lock:
+            return tr("Lock");
+        case WaitTime:
+            return tr("Wait Time");
+        case WaitCount:
+            return tr("Waits");
+        case LongestWait:
+            return tr("Longest Wait");
+        case P99Wait:
+            return tr("P99 Wait");
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::ToolTipRole) {
+        switch (static_cast<Columns>(section)) {
+        case Symbol:
+            return tr("The innermost function that called into the lock, e.g. the caller of pthread_mutex_lock.");
+        case Binary:
+            return tr("The name of the executable the function resides in.");
+        case Lock:
+            return tr("The address of the futex the threads waited for. Requires syscalls:sys_enter_futex samples.");
+        case WaitTime:
+            return tr("The time the threads waited here for the lock.");
+        case WaitCount:
+            return tr("How often the threads waited here for the lock.");
+        case LongestWait:
+            return tr("The longest time a thread waited here at once.");
+        case P99Wait:
+            return tr("99% of the waits here were at most this long.");
+        case NUM_COLUMNS:
+            break;
+        }
+    }
+
+    return {};
+}
+
+QVariant LockContentionModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount()) {
+        return {};
+    }
+
+    const auto& site = m_sites.at(index.row());
+
+    if (role == SymbolRole) {
+        return QVariant::fromValue(site.symbol);
+    } else if (role == SiteRole) {
+        return QVariant::fromValue(site);
+    } else if (role == FilterRole) {
+        return site.symbol.symbol;
+    } else if (role == SortRole) {
+        switch (static_cast<Columns>(index.column())) {
+        case Symbol:
+            return Util::formatSymbol(site.symbol);
+        case Binary:
+            return site.symbol.binary;
+        case Lock:
+            return site.lockAddress;
+        case WaitTime:
+            return site.waitTime;
+        case WaitCount:
+            return site.waitCount;
+        case LongestWait:
+            return site.longestWait;
+        case P99Wait:
+            return site.p99Wait;
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::DisplayRole) {
+        switch (static_cast<Columns>(index.column())) {
+        case Symbol:
+            return Util::formatSymbol(site.symbol);
+        case Binary:
+            return Util::formatString(site.symbol.binary);
+        case Lock:
+            return formatAddress(site.lockAddress);
+        case WaitTime:
+            return tr("%1 (%2%)").arg(Util::formatTimeString(site.waitTime),
+                                      Util::formatCostRelative(site.waitTime, m_totalWaitTime));
+        case WaitCount:
+            return site.waitCount;
+        case LongestWait:
+            return Util::formatTimeString(site.longestWait);
+        case P99Wait:
+            return Util::formatTimeString(site.p99Wait);
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::ToolTipRole) {
+        auto toolTip = tr("%1\nwaited %2 times for %3 in total, %4 at most, 99% of the waits took at most %5")
+                           .arg(Util::formatSymbol(site.symbol), QString::number(site.waitCount),
+                                Util::formatTimeString(site.waitTime), Util::formatTimeString(site.longestWait),
+                                Util::formatTimeString(site.p99Wait));
+        if (site.lockAddress) {
+            toolTip += QLatin1Char('\n') + tr("for the lock at %1").arg(formatAddress(site.lockAddress));
+        }
+        return toolTip;
+    }
+
+    return {};
+}
+
+LockWaitHistogramModel::LockWaitHistogramModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+LockWaitHistogramModel::~LockWaitHistogramModel() = default;
+
+void LockWaitHistogramModel::setSite(const Data::LockWaitSite& site)
+{
+    beginResetModel();
+    m_site = site;
+    endResetModel();
+}
+
+int LockWaitHistogramModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_site.histogram.size();
+}
+
+int LockWaitHistogramModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : NUM_COLUMNS;
+}
+
+QVariant LockWaitHistogramModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || section < 0 || section >= NUM_COLUMNS) {
+        return {};
+    }
+
+    if (role == Qt::DisplayRole) {
+        switch (static_cast<Columns>(section)) {
+        case Duration:
+            return tr("Duration");
+        case Waits:
+            return tr("Waits");
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::ToolTipRole) {
+        switch (static_cast<Columns>(section)) {
+        case Duration:
+            return tr("How long the waits took. The bold row holds the 99th percentile.");
+        case Waits:
+            return tr("How many waits took this long.");
+        case NUM_COLUMNS:
+            break;
+        }
+    }
+
+    return {};
+}
+
+QVariant LockWaitHistogramModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount()) {
+        return {};
+    }
+
+    const auto bucket = index.row();
+    const auto waits = m_site.histogram.at(bucket);
+    const bool isP99Bucket = bucket == Data::LockContentionResults::bucketForDuration(m_site.p99Wait);
+
+    if (role == TotalCostRole) {
+        return m_site.waitCount;
+    } else if (role == SortRole) {
+        switch (static_cast<Columns>(index.column())) {
+        case Duration:
+            return bucket;
+        case Waits:
+            return waits;
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::DisplayRole) {
+        switch (static_cast<Columns>(index.column())) {
+        case Duration:
+            if (bucket == 0) {
+                return tr("< %1").arg(Util::formatTimeString(Data::LockContentionResults::bucketStart(1)));
+            }
+            return tr("%1 - %2").arg(Util::formatTimeString(Data::LockContentionResults::bucketStart(bucket)),
+                                     Util::formatTimeString(Data::LockContentionResults::bucketStart(bucket + 1)));
+        case Waits:
+            return waits;
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::FontRole && isP99Bucket) {
+        QFont font;
+        font.setBold(true);
+        return font;
+    } else if (role == Qt::ToolTipRole) {
+        auto toolTip = tr("%1 of %2 waits (%3%)")
+                           .arg(QString::number(waits), QString::number(m_site.waitCount),
+                                Util::formatCostRelative(waits, m_site.waitCount));
+        if (isP99Bucket) {
+            toolTip += QLatin1Char('\n') + tr("the 99th percentile wait of %1 falls into this range")
+                                               .arg(Util::formatTimeString(m_site.p99Wait));
+        }
+        return toolTip;
+    }
+
+    return {};
+}
@@ -0,0 +1,113 @@
+/*
+    lockcontentionmodel.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "data.h"
+
+/**
+ * The call sites in which threads waited for a lock, one row per site and lock, see Data::LockContentionResults.
+ */
+class LockContentionModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit LockContentionModel(QObject* parent = nullptr);
+    ~LockContentionModel();
+
+    enum Columns
+    {
+        Symbol = 0,
+        Binary,
+        Lock,
+        WaitTime,
+        WaitCount,
+        LongestWait,
+        P99Wait,
+        NUM_COLUMNS
+    };
+    enum
+    {
+        InitialSortColumn = WaitTime
+    };
+
+    enum Roles
+    {
+        SortRole = Qt::UserRole,
+        SymbolRole,
+        FilterRole,
+        // the Data::LockWaitSite of the row
+        SiteRole,
+    };
+
+    void setData(const Data::LockContentionResults& data);
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    QVector<Data::LockWaitSite> m_sites;
+    quint64 m_totalWaitTime = 0;
+};
+
+/**
+ * How long the threads waited at one call site, one row per bucket of Data::LockWaitSite::histogram.
+ */
+class LockWaitHistogramModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit LockWaitHistogramModel(QObject* parent = nullptr);
+    ~LockWaitHistogramModel();
+
+    enum Columns
+    {
+        Duration = 0,
+        Waits,
+        NUM_COLUMNS
+    };
+    enum
+    {
+        NUM_BASE_COLUMNS = Waits
+    };
+
+    enum Roles
+    {
+        SortRole = Qt::UserRole,
+        TotalCostRole,
+    };
+
+    void setSite(const Data::LockWaitSite& site);
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    Data::LockWaitSite m_site;
+};
@@ -0,0 +1,155 @@
+/*
+    offcpumodel.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "offcpumodel.h"
+
+#include "../util.h"
+
+OffCpuModel::OffCpuModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+OffCpuModel::~OffCpuModel() = default;
+
+void OffCpuModel::setData(const Data::OffCpuResults& data)
+{
+    beginResetModel();
+    m_callSites = data.callSites;
+    m_totalBlockedTime = data.bottomUp.costs.totalCost(Data::OffCpuResults::BlockedTime);
+    m_totalPreemptedTime = data.bottomUp.costs.totalCost(Data::OffCpuResults::PreemptedTime);
+    endResetModel();
+}
+
+int OffCpuModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_callSites.size();
+}
+
+int OffCpuModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : NUM_COLUMNS;
+}
+
+QVariant OffCpuModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || section < 0 || section >= NUM_COLUMNS) {
+        return {};
+    }
+
+    if (role == Qt::InitialSortOrderRole && section >= BlockedTime) {
+        return Qt::DescendingOrder;
+    } else if (role == Qt::DisplayRole) {
+        switch (static_cast<Columns>(section)) {
+        case Symbol:
+            return tr("Call Site");
+        case Binary:
+            return tr("Binary");
+        case BlockedTime:
+            return tr("Blocked Time");
+        case BlockedCount:
+            return tr("Waits");
+        case LongestBlockedTime:
+            return tr("Longest Wait");
+        case PreemptedTime:
+            return tr("Preempted Time");
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::ToolTipRole) {
+        switch (static_cast<Columns>(section)) {
+        case Symbol:
+            return tr("The innermost user space function of the stacks in which the threads got switched out.");
+        case Binary:
+            return tr("The name of the executable the function resides in.");
+        case BlockedTime:
+            return tr("The time the threads waited here for something, e.g. a lock, I/O or a sleep.");
+        case BlockedCount:
+            return tr("How often the threads blocked here.");
+        case LongestBlockedTime:
+            return tr("The longest time a thread blocked here at once.");
+        case PreemptedTime:
+            return tr("The time the threads could have run here, but the scheduler ran something else.");
+        case NUM_COLUMNS:
+            break;
+        }
+    }
+
+    return {};
+}
+
+QVariant OffCpuModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount()) {
+        return {};
+    }
+
+    const auto& callSite = m_callSites.at(index.row());
+
+    if (role == SymbolRole) {
+        return QVariant::fromValue(callSite.symbol);
+    } else if (role == FilterRole) {
+        return callSite.symbol.symbol;
+    } else if (role == SortRole) {
+        switch (static_cast<Columns>(index.column())) {
+        case Symbol:
+            return Util::formatSymbol(callSite.symbol);
+        case Binary:
+            return callSite.symbol.binary;
+        case BlockedTime:
+            return callSite.blockedTime;
+        case BlockedCount:
+            return callSite.blockedCount;
+        case LongestBlockedTime:
+            return callSite.longestBlockedTime;
+        case PreemptedTime:
+            return callSite.preemptedTime;
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::DisplayRole) {
+        switch (static_cast<Columns>(index.column())) {
+        case Symbol:
+            return Util::formatSymbol(callSite.symbol);
+        case Binary:
+            return Util::formatString(callSite.symbol.binary);
+        case BlockedTime:
+            return tr("%1 (%2%)").arg(Util::formatTimeString(callSite.blockedTime),
+                                      Util::formatCostRelative(callSite.blockedTime, m_totalBlockedTime));
+        case BlockedCount:
+            return callSite.blockedCount;
+        case LongestBlockedTime:
+            return Util::formatTimeString(callSite.longestBlockedTime);
+        case PreemptedTime:
+            return tr("%1 (%2%)").arg(Util::formatTimeString(callSite.preemptedTime),
+                                      Util::formatCostRelative(callSite.preemptedTime, m_totalPreemptedTime));
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::ToolTipRole) {
+        return tr("%1\nblocked %2 times for %3 in total, %4 at most\npreempted for %5")
+            .arg(Util::formatSymbol(callSite.symbol), QString::number(callSite.blockedCount),
+                 Util::formatTimeString(callSite.blockedTime), Util::formatTimeString(callSite.longestBlockedTime),
+                 Util::formatTimeString(callSite.preemptedTime));
+    }
+
+    return {};
+}
@@ -0,0 +1,72 @@
+/*
+    offcpumodel.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "data.h"
+
+/**
+ * The call sites in which threads waited off-CPU, one row per site, see Data::OffCpuResults::callSites.
+ */
+class OffCpuModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit OffCpuModel(QObject* parent = nullptr);
+    ~OffCpuModel();
+
+    enum Columns
+    {
+        Symbol = 0,
+        Binary,
+        BlockedTime,
+        BlockedCount,
+        LongestBlockedTime,
+        PreemptedTime,
+        NUM_COLUMNS
+    };
+    enum
+    {
+        InitialSortColumn = BlockedTime
+    };
+
+    enum Roles
+    {
+        SortRole = Qt::UserRole,
+        SymbolRole,
+        FilterRole,
+    };
+
+    void setData(const Data::OffCpuResults& data);
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    QVector<Data::OffCpuCallSite> m_callSites;
+    quint64 m_totalBlockedTime = 0;
+    quint64 m_totalPreemptedTime = 0;
+};
@@ -0,0 +1,143 @@
+/*
+    parallelismmodel.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "parallelismmodel.h"
+
+#include "../util.h"
+
+ParallelismModel::ParallelismModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+ParallelismModel::~ParallelismModel() = default;
+
+void ParallelismModel::setData(const Data::ParallelismResults& data)
+{
+    beginResetModel();
+    m_results = data;
+    m_totalTime = data.time.delta();
+    m_totalSampleCosts.fill(0, data.sampleTypeNames.size());
+    for (int sampleType = 0, c = data.sampleTypeNames.size(); sampleType < c; ++sampleType) {
+        for (int runningThreads = 1; data.costType(sampleType, runningThreads) != -1; ++runningThreads) {
+            m_totalSampleCosts[sampleType] += data.bottomUp.costs.totalCost(data.costType(sampleType, runningThreads));
+        }
+    }
+    endResetModel();
+}
+
+int ParallelismModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_results.timeAtParallelism.size();
+}
+
+int ParallelismModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : Samples + m_results.sampleTypeNames.size();
+}
+
+QVariant ParallelismModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || section < 0 || section >= columnCount()) {
+        return {};
+    }
+
+    if (role == Qt::InitialSortOrderRole) {
+        return section == RunningThreads ? Qt::AscendingOrder : Qt::DescendingOrder;
+    } else if (role == Qt::DisplayRole) {
+        switch (section) {
+        case RunningThreads:
+            return tr("Running Threads");
+        case Time:
+            return tr("Time");
+        default:
+            return m_results.sampleTypeNames.at(section - Samples);
+        }
+    } else if (role == Qt::ToolTipRole) {
+        switch (section) {
+        case RunningThreads:
+            return tr("The number of threads that ran at once.");
+        case Time:
+            return tr("How long exactly this many threads ran at once.");
+        default:
+            return tr("The cost of the %1 samples taken meanwhile, select a row to see their stacks.")
+                .arg(m_results.sampleTypeNames.at(section - Samples));
+        }
+    }
+
+    return {};
+}
+
+QVariant ParallelismModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount()) {
+        return {};
+    }
+
+    const auto runningThreads = index.row();
+    // the columns without samples show the stacks of the first sample type
+    const auto sampleType = std::max(index.column() - Samples, 0);
+    const auto costType = m_results.costType(sampleType, runningThreads);
+    const auto time = m_results.timeAtParallelism.at(runningThreads);
+    const auto sampleCost = costType == -1 ? 0 : m_results.bottomUp.costs.totalCost(costType);
+
+    if (role == CostTypeRole) {
+        return costType;
+    } else if (role == FilterRole) {
+        return QString::number(runningThreads);
+    } else if (role == TotalCostRole) {
+        switch (index.column()) {
+        case RunningThreads:
+            return {};
+        case Time:
+            return m_totalTime;
+        default:
+            return m_totalSampleCosts.at(sampleType);
+        }
+    } else if (role == SortRole) {
+        switch (index.column()) {
+        case RunningThreads:
+            return runningThreads;
+        case Time:
+            return time;
+        default:
+            return sampleCost;
+        }
+    } else if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case RunningThreads:
+            return runningThreads;
+        case Time:
+            return tr("%1 (%2%)").arg(Util::formatTimeString(time), Util::formatCostRelative(time, m_totalTime));
+        default:
+            if (costType == -1) {
+                return {};
+            }
+            return tr("%1 (%2%)").arg(m_results.bottomUp.costs.formatCost(costType, sampleCost),
+                                      Util::formatCostRelative(sampleCost, m_totalSampleCosts.at(sampleType)));
+        }
+    } else if (role == Qt::ToolTipRole) {
+        return tr("%n thread(s) ran at once for %1, %2% of the time", nullptr, runningThreads)
+            .arg(Util::formatTimeString(time), Util::formatCostRelative(time, m_totalTime));
+    }
+
+    return {};
+}
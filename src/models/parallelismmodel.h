@@ -0,0 +1,73 @@
+/*
+    parallelismmodel.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "data.h"
+
+/**
+ * The parallelism histogram, one row per number of threads that ran at once, see Data::ParallelismResults.
+ */
+class ParallelismModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit ParallelismModel(QObject* parent = nullptr);
+    ~ParallelismModel();
+
+    enum Columns
+    {
+        RunningThreads = 0,
+        Time,
+        // the first of the columns with the samples, one per sample type of Data::ParallelismResults
+        Samples
+    };
+    enum
+    {
+        InitialSortColumn = RunningThreads,
+        NUM_BASE_COLUMNS = Time
+    };
+
+    enum Roles
+    {
+        SortRole = Qt::UserRole,
+        TotalCostRole,
+        FilterRole,
+        // the cost type of Data::ParallelismResults::bottomUp that holds the samples of the row and column, or -1
+        CostTypeRole,
+    };
+
+    void setData(const Data::ParallelismResults& data);
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    Data::ParallelismResults m_results;
+    quint64 m_totalTime = 0;
+    // per sample type
+    QVector<qint64> m_totalSampleCosts;
+};
@@ -0,0 +1,703 @@
+/*
+    resultscache.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "resultscache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace {
+const quint32 MAGIC = 0x48535243; // "HSRC"
+// bump whenever the layout or the meaning of the cached data changes
+const quint32 VERSION = 7;
+const quint16 BYTE_ORDER_MARK = 0x0102;
+// the amount of data at the start and end of the perf.data file that goes into the cache key
+const qint64 KEY_BLOCK_SIZE = 1024 * 1024;
+
+void setCorrupt(QDataStream& stream)
+{
+    stream.resetStatus();
+    stream.setStatus(QDataStream::ReadCorruptData);
+}
+
+// guard against allocating huge amounts of memory for corrupt files
+bool checkSize(QDataStream& stream, quint32 count, quint64 minBytesPerItem)
+{
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    const auto* device = stream.device();
+    if (!device->isSequential() && count * minBytesPerItem > static_cast<quint64>(device->bytesAvailable())) {
+        setCorrupt(stream);
+        return false;
+    }
+    return true;
+}
+
+// bulk data is stored in host byte order as contiguous blocks, such that reading it is a plain memcpy
+template<typename T>
+void writeArray(QDataStream& stream, const T* data, size_t size)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only trivial types can be written as raw data");
+    stream << static_cast<quint32>(size);
+    if (size) {
+        stream.writeRawData(reinterpret_cast<const char*>(data), static_cast<int>(size * sizeof(T)));
+    }
+}
+
+template<typename T>
+void writeArray(QDataStream& stream, const QVector<T>& data)
+{
+    writeArray(stream, data.constData(), data.size());
+}
+
+void writeArray(QDataStream& stream, const Data::ItemCost& data)
+{
+    writeArray(stream, data.size() ? &data[0] : nullptr, data.size());
+}
+
+template<typename T, typename Resize>
+T* readArray(QDataStream& stream, Resize resize)
+{
+    quint32 size = 0;
+    stream >> size;
+    if (!checkSize(stream, size, sizeof(T))) {
+        return nullptr;
+    }
+    auto* data = resize(size);
+    if (size && stream.readRawData(reinterpret_cast<char*>(data), static_cast<int>(size * sizeof(T)))
+            != static_cast<int>(size * sizeof(T))) {
+        setCorrupt(stream);
+    }
+    return data;
+}
+
+template<typename T>
+void readArray(QDataStream& stream, QVector<T>* data)
+{
+    readArray<T>(stream, [data](quint32 size) {
+        data->resize(size);
+        return data->data();
+    });
+}
+
+void readArray(QDataStream& stream, Data::ItemCost* data)
+{
+    readArray<qint64>(stream, [data](quint32 size) {
+        data->resize(size);
+        return size ? &(*data)[0] : nullptr;
+    });
+}
+
+/**
+ * Symbols are stored once and referenced by index, they repeat a lot throughout the trees.
+ */
+class SymbolTable
+{
+public:
+    void add(const Data::Symbol& symbol)
+    {
+        if (!m_ids.contains(symbol)) {
+            m_ids.insert(symbol, m_symbols.size());
+            m_symbols.append(symbol);
+        }
+    }
+
+    void add(const Data::BottomUp& tree)
+    {
+        add(tree.symbol);
+        for (const auto& child : tree.children) {
+            add(child);
+        }
+    }
+
+    quint32 id(const Data::Symbol& symbol) const
+    {
+        return m_ids.value(symbol);
+    }
+
+    void write(QDataStream& stream) const
+    {
+        stream << static_cast<quint32>(m_symbols.size());
+        for (const auto& symbol : m_symbols) {
+            stream << symbol.symbol << symbol.mangled << symbol.relAddr << symbol.size << symbol.binary << symbol.path
+                   << symbol.prettySymbol << symbol.isKernel;
+        }
+    }
+
+    static bool read(QDataStream& stream, QVector<Data::Symbol>* symbols)
+    {
+        quint32 size = 0;
+        stream >> size;
+        // each symbol takes at least 7 fields
+        if (!checkSize(stream, size, 7 * sizeof(quint32))) {
+            return false;
+        }
+        symbols->resize(size);
+        for (auto& symbol : *symbols) {
+            // assign the prettified symbol directly, that's costly to compute
+            stream >> symbol.symbol >> symbol.mangled >> symbol.relAddr >> symbol.size >> symbol.binary
+                >> symbol.path >> symbol.prettySymbol >> symbol.isKernel;
+        }
+        return stream.status() == QDataStream::Ok;
+    }
+
+private:
+    QHash<Data::Symbol, quint32> m_ids;
+    QVector<Data::Symbol> m_symbols;
+};
+
+bool readSymbol(QDataStream& stream, const QVector<Data::Symbol>& symbols, Data::Symbol* symbol)
+{
+    quint32 id = 0;
+    stream >> id;
+    if (stream.status() != QDataStream::Ok || id >= static_cast<quint32>(symbols.size())) {
+        setCorrupt(stream);
+        return false;
+    }
+    *symbol = symbols[id];
+    return true;
+}
+
+void writeTree(QDataStream& stream, const Data::BottomUp& tree, const SymbolTable& symbols)
+{
+    stream << symbols.id(tree.symbol) << tree.id << static_cast<quint32>(tree.children.size());
+    for (const auto& child : tree.children) {
+        writeTree(stream, child, symbols);
+    }
+}
+
+bool readTree(QDataStream& stream, Data::BottomUp* tree, const QVector<Data::Symbol>& symbols)
+{
+    quint32 numChildren = 0;
+    if (!readSymbol(stream, symbols, &tree->symbol)) {
+        return false;
+    }
+    stream >> tree->id >> numChildren;
+    if (!checkSize(stream, numChildren, 3 * sizeof(quint32))) {
+        return false;
+    }
+    tree->children.resize(numChildren);
+    for (auto& child : tree->children) {
+        if (!readTree(stream, &child, symbols)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void writeCostSummaries(QDataStream& stream, const QVector<Data::CostSummary>& costs)
+{
+    stream << static_cast<quint32>(costs.size());
+    for (const auto& cost : costs) {
+        stream << cost.label << cost.sampleCount << cost.totalPeriod << static_cast<qint32>(cost.unit);
+    }
+}
+
+bool readCostSummaries(QDataStream& stream, QVector<Data::CostSummary>* costs)
+{
+    quint32 size = 0;
+    stream >> size;
+    if (!checkSize(stream, size, 4 * sizeof(quint32))) {
+        return false;
+    }
+    costs->resize(size);
+    for (auto& cost : *costs) {
+        qint32 unit = 0;
+        stream >> cost.label >> cost.sampleCount >> cost.totalPeriod >> unit;
+        cost.unit = static_cast<Data::Costs::Unit>(unit);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+void writeSummary(QDataStream& stream, const Data::Summary& summary)
+{
+    stream << summary.applicationRunningTime << summary.threadCount << summary.processCount << summary.command
+           << summary.lostChunks << summary.hostName << summary.linuxKernelVersion << summary.perfVersion
+           << summary.cpuDescription << summary.cpuId << summary.cpuArchitecture << summary.cpusOnline
+           << summary.cpusAvailable << summary.cpuSiblingCores << summary.cpuSiblingThreads
+           << summary.totalMemoryInKiB << summary.buildIds << summary.onCpuTime << summary.offCpuTime
+           << summary.sampleCount << summary.lostEvents;
+    writeArray(stream, summary.lostPerCpu);
+    writeCostSummaries(stream, summary.costs);
+    stream << summary.errors;
+}
+
+bool readSummary(QDataStream& stream, Data::Summary* summary)
+{
+    stream >> summary->applicationRunningTime >> summary->threadCount >> summary->processCount >> summary->command
+        >> summary->lostChunks >> summary->hostName >> summary->linuxKernelVersion >> summary->perfVersion
+        >> summary->cpuDescription >> summary->cpuId >> summary->cpuArchitecture >> summary->cpusOnline
+        >> summary->cpusAvailable >> summary->cpuSiblingCores >> summary->cpuSiblingThreads
+        >> summary->totalMemoryInKiB >> summary->buildIds >> summary->onCpuTime >> summary->offCpuTime
+        >> summary->sampleCount >> summary->lostEvents;
+    readArray(stream, &summary->lostPerCpu);
+    if (!readCostSummaries(stream, &summary->costs)) {
+        return false;
+    }
+    stream >> summary->errors;
+    return stream.status() == QDataStream::Ok;
+}
+
+void writeEvents(QDataStream& stream, const Data::EventResults& events)
+{
+    stream << static_cast<quint32>(events.threads.size());
+    for (const auto& thread : events.threads) {
+        stream << thread.pid << thread.tid << thread.time.start << thread.time.end << thread.name
+               << thread.lastSwitchTime << thread.offCpuTime << static_cast<qint32>(thread.state)
+               << thread.lastSwitchStackId << thread.preempted;
+        writeArray(stream, thread.events);
+        writeArray(stream, thread.futexWaits);
+        writeArray(stream, thread.wakeups);
+    }
+
+    stream << static_cast<quint32>(events.cpus.size());
+    for (const auto& cpu : events.cpus) {
+        stream << cpu.cpuId;
+        writeArray(stream, cpu.events);
+        writeArray(stream, cpu.lost);
+    }
+
+    stream << static_cast<quint32>(events.stacks.size());
+    for (const auto& stack : events.stacks) {
+        writeArray(stream, stack);
+    }
+
+    writeCostSummaries(stream, events.totalCosts);
+    stream << events.offCpuTimeCostId;
+
+    stream << static_cast<quint32>(events.tracePoints.size());
+    for (const auto& tracePoint : events.tracePoints) {
+        stream << tracePoint.name << tracePoint.costId << static_cast<quint32>(tracePoint.fields.size());
+        for (const auto& field : tracePoint.fields) {
+            stream << field.name << static_cast<quint8>(field.type) << field.size;
+        }
+        writeArray(stream, tracePoint.times);
+        writeArray(stream, tracePoint.pids);
+        writeArray(stream, tracePoint.tids);
+        writeArray(stream, tracePoint.cpuIds);
+        for (const auto& column : tracePoint.columns) {
+            stream << column;
+        }
+        stream << tracePoint.strings;
+    }
+}
+
+bool readEvents(QDataStream& stream, Data::EventResults* events)
+{
+    quint32 size = 0;
+    stream >> size;
+    if (!checkSize(stream, size, 8 * sizeof(quint32))) {
+        return false;
+    }
+    events->threads.resize(size);
+    for (auto& thread : events->threads) {
+        qint32 state = 0;
+        stream >> thread.pid >> thread.tid >> thread.time.start >> thread.time.end >> thread.name
+            >> thread.lastSwitchTime >> thread.offCpuTime >> state >> thread.lastSwitchStackId >> thread.preempted;
+        thread.state = static_cast<Data::ThreadEvents::State>(state);
+        readArray(stream, &thread.events);
+        readArray(stream, &thread.futexWaits);
+        readArray(stream, &thread.wakeups);
+    }
+
+    stream >> size;
+    if (!checkSize(stream, size, 2 * sizeof(quint32))) {
+        return false;
+    }
+    events->cpus.resize(size);
+    for (auto& cpu : events->cpus) {
+        stream >> cpu.cpuId;
+        readArray(stream, &cpu.events);
+        readArray(stream, &cpu.lost);
+    }
+
+    stream >> size;
+    if (!checkSize(stream, size, sizeof(quint32))) {
+        return false;
+    }
+    events->stacks.resize(size);
+    for (auto& stack : events->stacks) {
+        readArray(stream, &stack);
+    }
+
+    if (!readCostSummaries(stream, &events->totalCosts)) {
+        return false;
+    }
+    stream >> events->offCpuTimeCostId;
+
+    stream >> size;
+    if (!checkSize(stream, size, 8 * sizeof(quint32))) {
+        return false;
+    }
+    events->tracePoints.resize(size);
+    for (auto& tracePoint : events->tracePoints) {
+        quint32 numFields = 0;
+        stream >> tracePoint.name >> tracePoint.costId >> numFields;
+        if (!checkSize(stream, numFields, sizeof(quint32) + 2)) {
+            return false;
+        }
+        tracePoint.fields.resize(numFields);
+        for (auto& field : tracePoint.fields) {
+            quint8 type = 0;
+            stream >> field.name >> type >> field.size;
+            if (type > Data::TracePointField::UnsignedArray) {
+                setCorrupt(stream);
+                return false;
+            }
+            field.type = static_cast<Data::TracePointField::Type>(type);
+        }
+        readArray(stream, &tracePoint.times);
+        readArray(stream, &tracePoint.pids);
+        readArray(stream, &tracePoint.tids);
+        readArray(stream, &tracePoint.cpuIds);
+        const int rows = tracePoint.times.size();
+        if (tracePoint.pids.size() != rows || tracePoint.tids.size() != rows || tracePoint.cpuIds.size() != rows) {
+            setCorrupt(stream);
+            return false;
+        }
+        tracePoint.columns.resize(numFields);
+        for (int i = 0; i < tracePoint.columns.size(); ++i) {
+            auto& column = tracePoint.columns[i];
+            stream >> column;
+            // value() reads the columns without bounds checks
+            if (column.size() != rows * tracePoint.fields.at(i).columnWidth()) {
+                setCorrupt(stream);
+                return false;
+            }
+        }
+        stream >> tracePoint.strings;
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+void writeDisassembly(QDataStream& stream, const Data::DisassemblyResult& disassembly)
+{
+    SymbolTable symbols;
+    for (auto it = disassembly.entries.cbegin(), end = disassembly.entries.cend(); it != end; ++it) {
+        symbols.add(it.key());
+    }
+    symbols.write(stream);
+
+    stream << disassembly.arch << disassembly.appPath << disassembly.targetRoot << disassembly.extraLibPaths
+           << disassembly.perfDataPath << disassembly.disasmApproach << disassembly.branchTraverse
+           << disassembly.unwindMethod;
+
+    stream << static_cast<quint32>(disassembly.entries.size());
+    for (auto it = disassembly.entries.cbegin(), end = disassembly.entries.cend(); it != end; ++it) {
+        stream << symbols.id(it.key()) << it->id << static_cast<quint32>(it->relSourceMap.size());
+        for (auto source = it->relSourceMap.cbegin(), sourceEnd = it->relSourceMap.cend(); source != sourceEnd;
+             ++source) {
+            stream << source.key().address << source.key().relAddr << source.key().location;
+            writeArray(stream, source->selfCost);
+            writeArray(stream, source->inclusiveCost);
+        }
+    }
+
+    stream << disassembly.selfCosts << disassembly.inclusiveCosts;
+    stream << disassembly.branchEdges << disassembly.branchRanges;
+}
+
+bool readDisassembly(QDataStream& stream, Data::DisassemblyResult* disassembly)
+{
+    QVector<Data::Symbol> symbols;
+    if (!SymbolTable::read(stream, &symbols)) {
+        return false;
+    }
+    stream >> disassembly->arch >> disassembly->appPath >> disassembly->targetRoot >> disassembly->extraLibPaths
+        >> disassembly->perfDataPath >> disassembly->disasmApproach >> disassembly->branchTraverse
+        >> disassembly->unwindMethod;
+
+    quint32 size = 0;
+    stream >> size;
+    if (!checkSize(stream, size, 3 * sizeof(quint32))) {
+        return false;
+    }
+    disassembly->entries.reserve(size);
+    for (quint32 i = 0; i < size; ++i) {
+        Data::Symbol symbol;
+        if (!readSymbol(stream, symbols, &symbol)) {
+            return false;
+        }
+        auto& entry = disassembly->entries[symbol];
+        quint32 numSources = 0;
+        stream >> entry.id >> numSources;
+        if (!checkSize(stream, numSources, 5 * sizeof(quint32))) {
+            return false;
+        }
+        entry.relSourceMap.reserve(numSources);
+        for (quint32 j = 0; j < numSources; ++j) {
+            Data::Location location;
+            stream >> location.address >> location.relAddr >> location.location;
+            auto& cost = entry.relSourceMap[location];
+            readArray(stream, &cost.selfCost);
+            readArray(stream, &cost.inclusiveCost);
+        }
+    }
+
+    stream >> disassembly->selfCosts >> disassembly->inclusiveCosts;
+    stream >> disassembly->branchEdges >> disassembly->branchRanges;
+    return stream.status() == QDataStream::Ok;
+}
+
+QByteArray readBlock(QFile* file, qint64 offset)
+{
+    if (!file->seek(offset)) {
+        return {};
+    }
+    return file->read(KEY_BLOCK_SIZE);
+}
+
+QString cacheDirectory()
+{
+    const auto location = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (location.isEmpty()) {
+        return {};
+    }
+    return location + QLatin1String("/results");
+}
+}
+
+namespace Data {
+QDataStream& operator<<(QDataStream& stream, const Costs& costs)
+{
+    stream << costs.m_typeNames << static_cast<quint32>(costs.m_units.size());
+    for (auto unit : costs.m_units) {
+        stream << static_cast<qint32>(unit);
+    }
+    writeArray(stream, costs.m_deltaTypes);
+    writeArray(stream, costs.m_totalCosts);
+    stream << static_cast<quint32>(costs.m_costs.size());
+    for (const auto& typeCosts : costs.m_costs) {
+        writeArray(stream, typeCosts);
+    }
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, Costs& costs)
+{
+    quint32 size = 0;
+    stream >> costs.m_typeNames >> size;
+    if (!checkSize(stream, size, sizeof(qint32))) {
+        return stream;
+    }
+    costs.m_units.resize(size);
+    for (auto& unit : costs.m_units) {
+        qint32 value = 0;
+        stream >> value;
+        unit = static_cast<Costs::Unit>(value);
+    }
+    readArray(stream, &costs.m_deltaTypes);
+    readArray(stream, &costs.m_totalCosts);
+    stream >> size;
+    if (!checkSize(stream, size, sizeof(quint32))) {
+        return stream;
+    }
+    costs.m_costs.resize(size);
+    for (auto& typeCosts : costs.m_costs) {
+        readArray(stream, &typeCosts);
+    }
+    if (costs.m_typeNames.size() != costs.m_units.size() || costs.m_typeNames.size() != costs.m_costs.size()
+        || costs.m_typeNames.size() != costs.m_totalCosts.size()) {
+        setCorrupt(stream);
+    }
+    return stream;
+}
+
+QDataStream& operator<<(QDataStream& stream, const IncompleteCallchains& incompleteCallchains)
+{
+    writeArray(stream, incompleteCallchains.m_incompleteFlags);
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, IncompleteCallchains& incompleteCallchains)
+{
+    readArray(stream, &incompleteCallchains.m_incompleteFlags);
+    return stream;
+}
+
+QDataStream& operator<<(QDataStream& stream, const BottomUpResults& bottomUp)
+{
+    SymbolTable symbols;
+    symbols.add(bottomUp.root);
+    for (const auto& symbol : bottomUp.symbols) {
+        symbols.add(symbol);
+    }
+    symbols.write(stream);
+
+    writeTree(stream, bottomUp.root, symbols);
+    stream << bottomUp.costs << bottomUp.incompleteCallchains << bottomUp.maxBottomUpId;
+
+    stream << static_cast<quint32>(bottomUp.symbols.size());
+    for (const auto& symbol : bottomUp.symbols) {
+        stream << symbols.id(symbol);
+    }
+
+    stream << static_cast<quint32>(bottomUp.locations.size());
+    for (const auto& location : bottomUp.locations) {
+        stream << location.parentLocationId << location.location.address << location.location.relAddr
+               << location.location.location;
+    }
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, BottomUpResults& bottomUp)
+{
+    QVector<Symbol> symbols;
+    if (!SymbolTable::read(stream, &symbols) || !readTree(stream, &bottomUp.root, symbols)) {
+        return stream;
+    }
+    BottomUp::initializeParents(&bottomUp.root);
+    stream >> bottomUp.costs >> bottomUp.incompleteCallchains >> bottomUp.maxBottomUpId;
+
+    quint32 size = 0;
+    stream >> size;
+    if (!checkSize(stream, size, sizeof(quint32))) {
+        return stream;
+    }
+    bottomUp.symbols.resize(size);
+    for (auto& symbol : bottomUp.symbols) {
+        if (!readSymbol(stream, symbols, &symbol)) {
+            return stream;
+        }
+    }
+
+    stream >> size;
+    if (!checkSize(stream, size, 4 * sizeof(quint32))) {
+        return stream;
+    }
+    bottomUp.locations.resize(size);
+    for (auto& location : bottomUp.locations) {
+        stream >> location.parentLocationId >> location.location.address >> location.location.relAddr
+            >> location.location.location;
+    }
+    return stream;
+}
+}
+
+QString ResultsCache::cacheFile(const QString& perfDataPath, const QStringList& parserArgs)
+{
+    const auto directory = cacheDirectory();
+    QFile file(perfDataPath);
+    if (directory.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    // hashing the whole file would take about as long as parsing it, so only look at its identity,
+    // its header and its tail, the latter changes whenever perf appends new data
+    const QFileInfo info(file);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    hash.addData(readBlock(&file, 0));
+    hash.addData(readBlock(&file, std::max(Q_INT64_C(0), info.size() - KEY_BLOCK_SIZE)));
+    hash.addData(parserArgs.join(QLatin1Char('\0')).toUtf8());
+    hash.addData(QByteArray::number(VERSION));
+
+    return directory + QLatin1Char('/') + QString::fromLatin1(hash.result().toHex()) + QLatin1String(".cache");
+}
+
+bool ResultsCache::write(QIODevice* device, const Results& results)
+{
+    QDataStream stream(device);
+    stream.setVersion(QDataStream::Qt_5_7);
+    stream << MAGIC << VERSION;
+    stream.writeRawData(reinterpret_cast<const char*>(&BYTE_ORDER_MARK), sizeof(BYTE_ORDER_MARK));
+    stream << static_cast<quint32>(sizeof(Data::Event));
+
+    writeSummary(stream, results.summary);
+    stream << results.bottomUp;
+    writeEvents(stream, results.events);
+    writeDisassembly(stream, results.disassembly);
+    return stream.status() == QDataStream::Ok;
+}
+
+bool ResultsCache::write(const QString& fileName, const Results& results)
+{
+    if (!QDir().mkpath(QFileInfo(fileName).path())) {
+        return false;
+    }
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    if (!write(&file, results)) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+bool ResultsCache::read(QIODevice* device, Results* results)
+{
+    QDataStream stream(device);
+    stream.setVersion(QDataStream::Qt_5_7);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint16 byteOrderMark = 0;
+    quint32 eventSize = 0;
+    stream >> magic >> version;
+    stream.readRawData(reinterpret_cast<char*>(&byteOrderMark), sizeof(byteOrderMark));
+    stream >> eventSize;
+    if (stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION
+        || byteOrderMark != BYTE_ORDER_MARK || eventSize != sizeof(Data::Event)) {
+        return false;
+    }
+
+    if (!readSummary(stream, &results->summary)) {
+        return false;
+    }
+    stream >> results->bottomUp;
+    return stream.status() == QDataStream::Ok && readEvents(stream, &results->events)
+        && readDisassembly(stream, &results->disassembly);
+}
+
+bool ResultsCache::read(const QString& fileName, Results* results)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return read(&file, results);
+}
+
+void ResultsCache::prune(int maxFiles)
+{
+    const auto directory = cacheDirectory();
+    if (directory.isEmpty()) {
+        return;
+    }
+    const auto files = QDir(directory).entryInfoList({QStringLiteral("*.cache")}, QDir::Files, QDir::Time);
+    for (int i = maxFiles; i < files.size(); ++i) {
+        QFile::remove(files.at(i).absoluteFilePath());
+    }
+}
@@ -0,0 +1,60 @@
+/*
+    resultscache.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "data.h"
+
+class QIODevice;
+
+/**
+ * Binary cache for the parsed results of a perf.data file.
+ *
+ * Re-opening a file with the same parser settings can then skip the unwinding
+ * and aggregation done by hotspot-perfparser. The top-down and caller/callee
+ * data are cheap to derive from the bottom-up data and thus not stored.
+ */
+namespace ResultsCache {
+struct Results
+{
+    Data::Summary summary;
+    Data::BottomUpResults bottomUp;
+    Data::EventResults events;
+    Data::DisassemblyResult disassembly;
+};
+
+/**
+ * The cache file for @p perfDataPath, keyed by the identity of the file and the @p parserArgs.
+ *
+ * Returns an empty string when the file cannot be read or no cache directory is available.
+ */
+QString cacheFile(const QString& perfDataPath, const QStringList& parserArgs);
+
+bool write(QIODevice* device, const Results& results);
+bool write(const QString& fileName, const Results& results);
+
+/// returns false for missing, corrupt or outdated caches, @p results is undefined then
+bool read(QIODevice* device, Results* results);
+bool read(const QString& fileName, Results* results);
+
+/// remove all but the @p maxFiles most recently written cache files
+void prune(int maxFiles);
+}
@@ -0,0 +1,245 @@
+/*
+    sourcecodemodel.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "sourcecodemodel.h"
+
+#include <QFontDatabase>
+
+#include <algorithm>
+#include <cstring>
+
+#include "../util.h"
+
+SourceCodeModel::SourceCodeModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+SourceCodeModel::~SourceCodeModel() = default;
+
+bool SourceCodeModel::setSourceFile(const QString& path, const QString& fileName)
+{
+    beginResetModel();
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_lineStarts.clear();
+    m_lineCosts.clear();
+    m_lineSymbols.clear();
+
+    m_file.setFileName(path);
+    bool ok = !path.isEmpty() && m_file.open(QIODevice::ReadOnly);
+    const qint64 size = ok ? m_file.size() : 0;
+    if (ok && size > 0) {
+        m_data = m_file.map(0, size);
+        ok = m_data != nullptr;
+    }
+
+    if (ok) {
+        m_fileName = fileName;
+        m_lineStarts.append(0);
+        const auto text = reinterpret_cast<const char*>(m_data);
+        const char* end = text + size;
+        for (const char* it = text; it != end;) {
+            auto newline = static_cast<const char*>(std::memchr(it, '\n', end - it));
+            it = newline ? newline + 1 : end;
+            m_lineStarts.append(it - text);
+        }
+        m_lineStarts.squeeze();
+    } else {
+        m_file.close();
+        m_file.setFileName({});
+        m_fileName.clear();
+    }
+    endResetModel();
+    return ok;
+}
+
+void SourceCodeModel::setCosts(const Data::CallerCalleeResults& results)
+{
+    beginResetModel();
+    m_totalCosts = results.selfCosts;
+    m_lineCosts.clear();
+    m_lineSymbols.clear();
+
+    const int numTypes = m_totalCosts.numTypes();
+    const QString prefix = m_fileName + QLatin1Char(':');
+    for (auto entry = results.entries.cbegin(), end = results.entries.cend(); entry != end && !m_fileName.isEmpty();
+         ++entry) {
+        for (auto source = entry->sourceMap.cbegin(), sourceEnd = entry->sourceMap.cend(); source != sourceEnd;
+             ++source) {
+            if (!source.key().startsWith(prefix)) {
+                continue;
+            }
+            bool isNumber = false;
+            const int line = source.key().midRef(prefix.size()).toInt(&isNumber);
+            if (!isNumber || line <= 0) {
+                continue;
+            }
+
+            auto cost = m_lineCosts.find(line);
+            if (cost == m_lineCosts.end()) {
+                cost = m_lineCosts.insert(line, Data::LocationCost(numTypes));
+            }
+            for (int i = 0; i < numTypes && i < static_cast<int>(source->selfCost.size()); ++i) {
+                cost->selfCost[i] += source->selfCost[i];
+                cost->inclusiveCost[i] += source->inclusiveCost[i];
+            }
+
+            // code inlined from elsewhere in this file shows up with the symbol of the inlined function
+            auto& symbols = m_lineSymbols[line];
+            if (!symbols.contains(entry.key())) {
+                symbols.append(entry.key());
+            }
+        }
+    }
+    endResetModel();
+}
+
+void SourceCodeModel::clear()
+{
+    setSourceFile({}, {});
+}
+
+QString SourceCodeModel::path() const
+{
+    return m_file.fileName();
+}
+
+QString SourceCodeModel::fileName() const
+{
+    return m_fileName;
+}
+
+QString SourceCodeModel::lineText(int line) const
+{
+    if (line <= 0 || line >= m_lineStarts.size()) {
+        return {};
+    }
+    const qint64 start = m_lineStarts.at(line - 1);
+    qint64 end = m_lineStarts.at(line);
+    while (end > start && (m_data[end - 1] == '\n' || m_data[end - 1] == '\r')) {
+        --end;
+    }
+    return QString::fromUtf8(reinterpret_cast<const char*>(m_data + start), static_cast<int>(end - start));
+}
+
+int SourceCodeModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : std::max(0, m_lineStarts.size() - 1);
+}
+
+int SourceCodeModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : NUM_BASE_COLUMNS + m_totalCosts.numTypes() * 2;
+}
+
+QVariant SourceCodeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || section < 0 || section >= columnCount()) {
+        return {};
+    }
+
+    if (role == Qt::InitialSortOrderRole && section >= NUM_BASE_COLUMNS) {
+        return Qt::DescendingOrder;
+    } else if (role == Qt::DisplayRole) {
+        if (section == LineNumber) {
+            return tr("Line");
+        } else if (section == SourceCode) {
+            return tr("Source Code");
+        }
+        section -= NUM_BASE_COLUMNS;
+        if (section < m_totalCosts.numTypes()) {
+            return tr("%1 (self)").arg(m_totalCosts.typeName(section));
+        }
+        section -= m_totalCosts.numTypes();
+        return tr("%1 (incl.)").arg(m_totalCosts.typeName(section));
+    } else if (role == Qt::ToolTipRole) {
+        if (section == LineNumber || section == SourceCode) {
+            return tr("The lines of the source file %1.").arg(m_fileName);
+        }
+        section -= NUM_BASE_COLUMNS;
+        if (section < m_totalCosts.numTypes()) {
+            return tr("The aggregated sample costs directly attributed to this line.");
+        }
+        return tr("The aggregated sample costs attributed to this line, both directly and indirectly."
+                  " This includes the costs of all functions called from this line plus its self cost.");
+    }
+
+    return {};
+}
+
+QVariant SourceCodeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount()) {
+        return {};
+    }
+
+    const int line = index.row() + 1;
+    int column = index.column();
+
+    if (role == Qt::FontRole && column < NUM_BASE_COLUMNS) {
+        return QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    } else if (role == Qt::TextAlignmentRole && column == LineNumber) {
+        return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    } else if (role == Qt::DisplayRole && column == LineNumber) {
+        return line;
+    } else if (role == Qt::DisplayRole && column == SourceCode) {
+        return lineText(line).replace(QLatin1Char('\t'), QLatin1String("    "));
+    }
+
+    const auto cost = m_lineCosts.constFind(line);
+    if (cost == m_lineCosts.constEnd()) {
+        if (role == SortRole && column >= NUM_BASE_COLUMNS) {
+            return 0;
+        }
+        return {};
+    }
+
+    if (role == Qt::ToolTipRole) {
+        QString location = m_fileName + QLatin1Char(':') + QString::number(line);
+        for (const auto& symbol : m_lineSymbols.value(line)) {
+            location += QLatin1String("<br/>") + Util::formatSymbol(symbol).toHtmlEscaped();
+        }
+        return Util::formatTooltip(location, *cost, m_totalCosts);
+    }
+    if (column < NUM_BASE_COLUMNS) {
+        return {};
+    }
+
+    column -= NUM_BASE_COLUMNS;
+    const bool isSelfCost = column < m_totalCosts.numTypes();
+    if (!isSelfCost) {
+        column -= m_totalCosts.numTypes();
+    }
+    const auto value = isSelfCost ? cost->selfCost[column] : cost->inclusiveCost[column];
+    if (role == SortRole) {
+        return value;
+    } else if (role == TotalCostRole) {
+        return m_totalCosts.totalCost(column);
+    } else if (role == Qt::DisplayRole) {
+        return Util::formatCostRelative(value, m_totalCosts.totalCost(column), true);
+    }
+
+    return {};
+}
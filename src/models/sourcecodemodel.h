@@ -0,0 +1,91 @@
+/*
+    sourcecodemodel.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+
+#include "data.h"
+
+/**
+ * The lines of a source file with the costs measured on them, one row per line.
+ *
+ * The file is mapped into memory rather than read, only the offsets of its lines are kept, so that
+ * even huge generated files are shown at once. Costs are kept per line, lines without costs take no memory.
+ */
+class SourceCodeModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit SourceCodeModel(QObject* parent = nullptr);
+    ~SourceCodeModel();
+
+    enum Columns
+    {
+        LineNumber = 0,
+        SourceCode,
+    };
+    enum
+    {
+        NUM_BASE_COLUMNS = SourceCode + 1
+    };
+
+    enum Roles
+    {
+        SortRole = Qt::UserRole,
+        TotalCostRole,
+    };
+
+    /**
+     * Map the file at @p path into memory and index its lines.
+     *
+     * @p fileName is the name of the file as recorded in the debug information, i.e. the file part of the locations
+     * whose costs are shown. Returns false when the file cannot be mapped, the model is empty then.
+     */
+    bool setSourceFile(const QString& path, const QString& fileName);
+    /// the costs of all locations in the current file, self and inclusive, of all symbols in @p results
+    void setCosts(const Data::CallerCalleeResults& results);
+    void clear();
+
+    QString path() const;
+    QString fileName() const;
+    /// the text of @p line, counting from one, without the line break
+    QString lineText(int line) const;
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    QFile m_file;
+    uchar* m_data = nullptr;
+    // offset of every line in m_data, plus the end of the file
+    QVector<qint64> m_lineStarts;
+    QString m_fileName;
+    Data::Costs m_totalCosts;
+    // costs and the symbols they were measured in by line, counting from one
+    QHash<int, Data::LocationCost> m_lineCosts;
+    QHash<int, QVector<Data::Symbol>> m_lineSymbols;
+};
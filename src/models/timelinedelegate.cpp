@@ -42,6 +42,7 @@
 #include <KColorScheme>
 
 #include <algorithm>
+#include <iterator>
 
 TimeLineData::TimeLineData()
     : TimeLineData({}, 0, {}, {}, {})
@@ -103,6 +104,96 @@ Data::Events::const_iterator findEvent(Data::Events::const_iterator begin, Data:
 {
     return std::lower_bound(begin, end, time, [](const Data::Event& event, quint64 time) { return event.time < time; });
 }
+
+// the step that is in effect at @p time, or end when time lies before the first step
+QVector<Data::ParallelismStep>::const_iterator findStep(const QVector<Data::ParallelismStep>& steps, quint64 time)
+{
+    auto it = std::upper_bound(steps.constBegin(), steps.constEnd(), time,
+                               [](quint64 time, const Data::ParallelismStep& step) { return time < step.time; });
+    return it == steps.constBegin() ? steps.constEnd() : std::prev(it);
+}
+
+// the field values of the samples of @p tracePoint that the lane of @p index shows at @p mappedX
+QString describeTracePointSamples(const Data::TracePointSamples& tracePoint, const QModelIndex& index,
+                                  const TimeLineData& data, int mappedX)
+{
+    const auto tid = index.data(EventModel::ThreadIdRole).value<qint32>();
+    const auto cpuId = index.data(EventModel::CpuIdRole).value<quint32>();
+    const int maxShown = 5;
+
+    QStringList lines;
+    int numSamples = 0;
+    auto it = std::lower_bound(tracePoint.times.constBegin(), tracePoint.times.constEnd(),
+                               data.mapXToTime(std::max(0, mappedX - 1)));
+    for (; it != tracePoint.times.constEnd() && data.mapTimeToX(*it) <= mappedX; ++it) {
+        const int row = std::distance(tracePoint.times.constBegin(), it);
+        if (data.mapTimeToX(*it) != mappedX
+            || (tid != Data::INVALID_TID ? tracePoint.tids.at(row) != tid : tracePoint.cpuIds.at(row) != cpuId)) {
+            continue;
+        }
+        if (++numSamples > maxShown) {
+            continue;
+        }
+        QStringList values;
+        for (int field = 0, c = tracePoint.fields.size(); field < c; ++field) {
+            if (tracePoint.fields.at(field).type != Data::TracePointField::Unsupported) {
+                values.append(QStringLiteral("%1=%2").arg(tracePoint.fields.at(field).name,
+                                                         tracePoint.displayValue(field, row)));
+            }
+        }
+        lines.append(values.join(QLatin1String(", ")));
+    }
+    if (numSamples > maxShown) {
+        lines.append(TimeLineDelegate::tr("and %n more", nullptr, numSamples - maxShown));
+    }
+    return lines.join(QLatin1Char('\n'));
+}
+
+// the segments of @p path that the thread of @p index spent on it
+QVector<Data::CriticalPathSegment> threadSegments(const Data::CriticalPath& path, const QModelIndex& index)
+{
+    QVector<Data::CriticalPathSegment> segments;
+    if (path.isEmpty()) {
+        return segments;
+    }
+    const auto tid = index.data(EventModel::ThreadIdRole).value<qint32>();
+    const auto pid = index.data(EventModel::ProcessIdRole).value<qint32>();
+    if (tid == Data::INVALID_TID) {
+        return segments;
+    }
+    for (const auto& segment : path.segments) {
+        if (segment.tid == tid && segment.pid == pid) {
+            segments.append(segment);
+        }
+    }
+    return segments;
+}
+
+QString describeSegment(const Data::CriticalPathSegment& segment)
+{
+    const auto duration = Util::formatTimeString(segment.time.delta());
+    switch (segment.kind) {
+    case Data::CriticalPathSegment::Running: {
+        auto description = segment.cpuId == Data::INVALID_CPU_ID
+            ? TimeLineDelegate::tr("running for %1").arg(duration)
+            : TimeLineDelegate::tr("running for %1 on CPU #%2").arg(duration, QString::number(segment.cpuId));
+        if (segment.wokenTid != Data::INVALID_TID) {
+            description += QLatin1Char('\n')
+                + TimeLineDelegate::tr("then woke up thread #%1 in %2")
+                      .arg(QString::number(segment.wokenTid), Util::formatSymbol(segment.symbol));
+        }
+        return description;
+    }
+    case Data::CriticalPathSegment::Runnable:
+        return TimeLineDelegate::tr("woken up, but waiting for a free CPU for %1").arg(duration);
+    case Data::CriticalPathSegment::Blocked:
+        return TimeLineDelegate::tr("blocked for %1 in %2, not woken up by a recorded thread")
+            .arg(duration, Util::formatSymbol(segment.symbol));
+    case Data::CriticalPathSegment::Preempted:
+        return TimeLineDelegate::tr("preempted for %1 in %2").arg(duration, Util::formatSymbol(segment.symbol));
+    }
+    return {};
+}
 }
 
 TimeLineDelegate::TimeLineDelegate(FilterAndZoomStack* filterAndZoomStack, QAbstractItemView* view)
@@ -135,6 +226,33 @@ void TimeLineDelegate::paint(QPainter* painter, const QStyleOptionViewItem& opti
     // account for padding
     painter->translate(data.padding, data.padding);
 
+    // visualize how many threads ran at once, a full lane means that all CPUs were busy
+    const auto runningThreads = index.data(EventModel::RunningThreadsRole).value<QVector<Data::ParallelismStep>>();
+    if (!runningThreads.isEmpty()) {
+        const auto maxRunningThreads = std::max(index.data(EventModel::MaxRunningThreadsRole).toInt(), 1);
+        KColorScheme scheme(palette.currentColorGroup());
+        auto color = scheme.foreground(KColorScheme::PositiveText).color();
+        color.setAlpha(128);
+
+        // several steps may fall onto the same pixel, the highest of them stays visible
+        auto step = findStep(runningThreads, data.time.start);
+        if (step == runningThreads.constEnd()) {
+            step = runningThreads.constBegin();
+        }
+        for (; step != runningThreads.constEnd(); ++step) {
+            const auto x = data.mapTimeToX(step->time);
+            if (x > data.w) {
+                break;
+            }
+            const auto next = std::next(step);
+            const auto x2 = std::min(next == runningThreads.constEnd() ? x : data.mapTimeToX(next->time), data.w);
+            const auto height = data.h * std::min(step->runningThreads, maxRunningThreads) / maxRunningThreads;
+            if (height > 0) {
+                painter->fillRect(x, data.h - height, std::max(x2 - x, 1), height, color);
+            }
+        }
+    }
+
     // visualize the time where the thread was active
     // i.e. paint events for threads that have any in the selected time range
     auto threadTimeRect =
@@ -198,6 +316,41 @@ void TimeLineDelegate::paint(QPainter* painter, const QStyleOptionViewItem& opti
 
             last_x = x;
         }
+
+        // visualize where the cpu lost events, at least one pixel wide such that short losses don't disappear
+        const auto lostEvents = index.data(EventModel::LostEventsRole).value<QVector<Data::LostEvents>>();
+        if (!lostEvents.isEmpty()) {
+            const QBrush lostBrush(scheme.foreground(KColorScheme::NegativeText).color(), Qt::BDiagPattern);
+            for (const auto& lost : lostEvents) {
+                const auto x = data.mapTimeToX(lost.time.start);
+                const auto x2 = data.mapTimeToX(lost.time.end);
+                if (x2 < 0 || x > data.w) {
+                    continue;
+                }
+                painter->fillRect(x, 0, std::max(x2 - x, 1), data.h, lostBrush);
+            }
+        }
+    }
+
+    // mark the critical path in the lower third of the lanes of the threads on it
+    const auto criticalPath = threadSegments(m_criticalPath, index);
+    if (!criticalPath.isEmpty()) {
+        KColorScheme scheme(palette.currentColorGroup());
+        const auto runningColor = palette.highlight().color();
+        const auto runnableColor = scheme.foreground(KColorScheme::NeutralText).color();
+        const auto waitingColor = scheme.foreground(KColorScheme::NegativeText).color();
+        const auto y = data.h * 2 / 3;
+        for (const auto& segment : criticalPath) {
+            const auto x = data.mapTimeToX(segment.time.start);
+            const auto x2 = std::min(data.mapTimeToX(segment.time.end), data.w);
+            if (x2 < 0 || x > data.w) {
+                continue;
+            }
+            const auto& color = segment.kind == Data::CriticalPathSegment::Running
+                ? runningColor
+                : (segment.kind == Data::CriticalPathSegment::Runnable ? runnableColor : waitingColor);
+            painter->fillRect(x, y, std::max(x2 - x, 1), data.h - y, color);
+        }
     }
 
     if (m_timeSlice.isValid()) {
@@ -226,6 +379,35 @@ bool TimeLineDelegate::helpEvent(QHelpEvent* event, QAbstractItemView* view, con
         const auto localX = event->pos().x();
         const auto mappedX = localX - option.rect.x() - data.padding;
         const auto time = data.mapXToTime(mappedX);
+
+        const auto runningThreads = index.data(EventModel::RunningThreadsRole).value<QVector<Data::ParallelismStep>>();
+        if (!runningThreads.isEmpty()) {
+            const auto step = findStep(runningThreads, time);
+            QToolTip::showText(event->globalPos(),
+                               tr("time: %1\nrunning threads: %2\nthe lane is full when %3 threads run at once")
+                                   .arg(Util::formatTimeString(time - data.time.start),
+                                        QString::number(step == runningThreads.constEnd() ? 0 : step->runningThreads),
+                                        QString::number(index.data(EventModel::MaxRunningThreadsRole).toInt())));
+            return true;
+        }
+        for (const auto& segment : threadSegments(m_criticalPath, index)) {
+            if (data.mapTimeToX(segment.time.start) <= mappedX
+                && mappedX <= std::max(data.mapTimeToX(segment.time.end), data.mapTimeToX(segment.time.start) + 1)) {
+                QToolTip::showText(
+                    event->globalPos(),
+                    tr("time: %1\non the critical path of thread #%2: %3\nthe path spans %4 across %5 thread(s), "
+                       "%6 of it running, %7 waiting for a CPU and %8 waiting for something else")
+                        .arg(Util::formatTimeString(time - data.time.start), QString::number(m_criticalPath.tid),
+                             describeSegment(segment), Util::formatTimeString(m_criticalPath.time.delta()),
+                             QString::number(m_criticalPath.numThreads()),
+                             Util::formatTimeString(m_criticalPath.timeIn(Data::CriticalPathSegment::Running)),
+                             Util::formatTimeString(m_criticalPath.timeIn(Data::CriticalPathSegment::Runnable)),
+                             Util::formatTimeString(m_criticalPath.timeIn(Data::CriticalPathSegment::Blocked)
+                                                    + m_criticalPath.timeIn(Data::CriticalPathSegment::Preempted))));
+                return true;
+            }
+        }
+
         const auto start = findEvent(data.events.constBegin(), data.events.constEnd(), time);
         // find the maximum sample cost in the range spanned by one pixel
         struct FoundSamples
@@ -276,6 +458,22 @@ bool TimeLineDelegate::helpEvent(QHelpEvent* event, QAbstractItemView* view, con
         }
 
         const auto formattedTime = Util::formatTimeString(time - data.time.start);
+        const auto lostEvents = index.data(EventModel::LostEventsRole).value<QVector<Data::LostEvents>>();
+        quint64 numLost = 0;
+        for (const auto& lost : lostEvents) {
+            if (data.mapTimeToX(lost.time.start) <= mappedX && mappedX <= std::max(data.mapTimeToX(lost.time.end),
+                                                                                 data.mapTimeToX(lost.time.start) + 1)) {
+                numLost += lost.count;
+            }
+        }
+        if (numLost > 0) {
+            QToolTip::showText(event->globalPos(),
+                               tr("time: %1\nlost events: %2\nperf could not keep up with the events of this CPU, "
+                                  "samples are missing here")
+                                   .arg(formattedTime, QString::number(numLost)));
+            return true;
+        }
+
         const auto totalCosts = index.data(EventModel::TotalCostsRole).value<QVector<Data::CostSummary>>();
         if (found.numSamples > 0 && found.type == offCpuCostId) {
             QToolTip::showText(event->globalPos(),
@@ -284,11 +482,18 @@ bool TimeLineDelegate::helpEvent(QHelpEvent* event, QAbstractItemView* view, con
                                         Util::formatTimeString(found.totalCost),
                                         Util::formatTimeString(found.maxCost)));
         } else if (found.numSamples > 0) {
-            QToolTip::showText(event->globalPos(),
-                               tr("time: %1\n%5 samples: %2\ntotal sample cost: %3\nmax sample cost: %4")
-                                   .arg(formattedTime, QString::number(found.numSamples),
-                                        Util::formatCost(found.totalCost), Util::formatCost(found.maxCost),
-                                        totalCosts.value(found.type).label));
+            auto text = tr("time: %1\n%5 samples: %2\ntotal sample cost: %3\nmax sample cost: %4")
+                            .arg(formattedTime, QString::number(found.numSamples), Util::formatCost(found.totalCost),
+                                 Util::formatCost(found.maxCost), totalCosts.value(found.type).label);
+            const auto results = index.data(EventModel::EventResultsRole).value<Data::EventResults>();
+            const auto* tracePoint = results.findTracePoint(found.type);
+            if (tracePoint) {
+                const auto payloads = describeTracePointSamples(*tracePoint, index, data, mappedX);
+                if (!payloads.isEmpty()) {
+                    text += QLatin1Char('\n') + payloads;
+                }
+            }
+            QToolTip::showText(event->globalPos(), text);
         } else {
             QToolTip::showText(event->globalPos(),
                                tr("time: %1 (no %2 samples)").arg(formattedTime, totalCosts.value(m_eventType).label));
@@ -377,6 +582,20 @@ bool TimeLineDelegate::eventFilter(QObject* watched, QEvent* event)
                 [this, threadStartTime, threadEndTime]() { m_filterAndZoomStack->zoomIn({threadStartTime, threadEndTime}); });
         }
 
+        const auto offCpuCostId =
+            index.data(EventModel::EventResultsRole).value<Data::EventResults>().offCpuTimeCostId;
+        if (isTimeSpanSelected && threadId != Data::INVALID_TID && offCpuCostId != -1) {
+            contextMenu->addAction(QIcon::fromTheme(QStringLiteral("view-list-tree")),
+                                   tr("Show Critical Path Of Thread #%1 In Selection").arg(threadId), this,
+                                   [this, processId, threadId, timeSlice]() {
+                                       emit criticalPathRequested(processId, threadId, timeSlice);
+                                   });
+        }
+        if (isRightButtonEvent && !m_criticalPath.isEmpty()) {
+            contextMenu->addAction(QIcon::fromTheme(QStringLiteral("edit-clear")), tr("Hide Critical Path"), this,
+                                   [this]() { setCriticalPath({}); });
+        }
+
         if (isRightButtonEvent && isZoomed) {
             contextMenu->addAction(m_filterAndZoomStack->actions().zoomOut);
             contextMenu->addAction(m_filterAndZoomStack->actions().resetZoom);
@@ -482,6 +701,12 @@ void TimeLineDelegate::setEventType(int type)
     updateView();
 }
 
+void TimeLineDelegate::setCriticalPath(const Data::CriticalPath& path)
+{
+    m_criticalPath = path;
+    updateView();
+}
+
 void TimeLineDelegate::updateView()
 {
     m_view->viewport()->update();
@@ -79,6 +79,13 @@ public:
 
     void setEventType(int type);
 
+    // mark @p path on the lanes of its threads, an empty path hides the previous one
+    void setCriticalPath(const Data::CriticalPath& path);
+
+signals:
+    // the user asked for the critical path of a thread within the selected time, see PerfParser::requestCriticalPath
+    void criticalPathRequested(qint32 pid, qint32 tid, const Data::TimeRange& time);
+
 protected:
     bool eventFilter(QObject* watched, QEvent* event) override;
 
@@ -90,4 +97,5 @@ private:
     QAbstractItemView* m_view = nullptr;
     Data::TimeRange m_timeSlice;
     int m_eventType = 0;
+    Data::CriticalPath m_criticalPath;
 };
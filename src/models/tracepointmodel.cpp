@@ -0,0 +1,247 @@
+/*
+    tracepointmodel.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "tracepointmodel.h"
+
+#include "../util.h"
+
+#include <algorithm>
+
+TracePointSamplesModel::TracePointSamplesModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+TracePointSamplesModel::~TracePointSamplesModel() = default;
+
+void TracePointSamplesModel::setData(const Data::EventResults& events, int tracePoint)
+{
+    beginResetModel();
+    m_samples = events.tracePoints.value(tracePoint);
+    m_startTime = std::numeric_limits<quint64>::max();
+    m_threadNames.clear();
+    for (const auto& thread : events.threads) {
+        m_startTime = std::min(m_startTime, thread.time.start);
+        m_threadNames.insert(thread.tid, thread.name);
+    }
+    if (!m_samples.times.isEmpty()) {
+        m_startTime = std::min(m_startTime, m_samples.times.first());
+    }
+    endResetModel();
+}
+
+int TracePointSamplesModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_samples.size();
+}
+
+int TracePointSamplesModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : NUM_BASE_COLUMNS + m_samples.fields.size();
+}
+
+QVariant TracePointSamplesModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || section < 0 || section >= columnCount()) {
+        return {};
+    }
+
+    if (role == Qt::DisplayRole) {
+        switch (section) {
+        case Time:
+            return tr("Time");
+        case Thread:
+            return tr("Thread");
+        case Cpu:
+            return tr("CPU");
+        }
+        return m_samples.fields.at(section - NUM_BASE_COLUMNS).name;
+    } else if (role == Qt::ToolTipRole) {
+        switch (section) {
+        case Time:
+            return tr("The time of the sample, relative to the start of the recording.");
+        case Thread:
+            return tr("The thread in which the tracepoint was hit.");
+        case Cpu:
+            return tr("The CPU on which the tracepoint was hit.");
+        }
+        const auto& field = m_samples.fields.at(section - NUM_BASE_COLUMNS);
+        if (field.type == Data::TracePointField::Unsupported) {
+            return tr("The values of field %1 are of a type that is not supported.").arg(field.name);
+        }
+        return tr("The value of field %1 of the tracepoint payload.").arg(field.name);
+    }
+
+    return {};
+}
+
+QString TracePointSamplesModel::threadName(int row) const
+{
+    const auto tid = m_samples.tids.at(row);
+    return tr("%1 (#%2)").arg(m_threadNames.value(tid), QString::number(tid));
+}
+
+QVariant TracePointSamplesModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount()) {
+        return {};
+    }
+
+    const auto row = index.row();
+
+    if (role == FilterRole) {
+        QStringList values = {threadName(row)};
+        for (int field = 0, c = m_samples.fields.size(); field < c; ++field) {
+            values.append(m_samples.displayValue(field, row));
+        }
+        return values.join(QLatin1Char(' '));
+    } else if (role == SortRole) {
+        switch (index.column()) {
+        case Time:
+            return m_samples.times.at(row);
+        case Thread:
+            return m_samples.tids.at(row);
+        case Cpu:
+            return m_samples.cpuIds.at(row);
+        }
+        return m_samples.value(index.column() - NUM_BASE_COLUMNS, row);
+    } else if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case Time:
+            return Util::formatTimeString(m_samples.times.at(row) - m_startTime);
+        case Thread:
+            return threadName(row);
+        case Cpu:
+            return m_samples.cpuIds.at(row);
+        }
+        return m_samples.displayValue(index.column() - NUM_BASE_COLUMNS, row);
+    }
+
+    return {};
+}
+
+TracePointGroupsModel::TracePointGroupsModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+TracePointGroupsModel::~TracePointGroupsModel() = default;
+
+void TracePointGroupsModel::setData(const Data::TracePointSamples& samples, int field)
+{
+    beginResetModel();
+    m_groups.clear();
+    m_totalSamples = 0;
+    m_fieldName.clear();
+    if (field >= 0 && field < samples.fields.size()) {
+        m_fieldName = samples.fields.at(field).name;
+        m_totalSamples = samples.size();
+        QHash<QString, int> groups;
+        for (int row = 0, c = samples.size(); row < c; ++row) {
+            const auto displayValue = samples.displayValue(field, row);
+            auto it = groups.find(displayValue);
+            if (it == groups.end()) {
+                it = groups.insert(displayValue, m_groups.size());
+                Group group;
+                group.value = samples.value(field, row);
+                group.displayValue = displayValue;
+                m_groups.append(group);
+            }
+            ++m_groups[it.value()].samples;
+        }
+    }
+    endResetModel();
+}
+
+int TracePointGroupsModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_groups.size();
+}
+
+int TracePointGroupsModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : NUM_COLUMNS;
+}
+
+QVariant TracePointGroupsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || section < 0 || section >= NUM_COLUMNS) {
+        return {};
+    }
+
+    if (role == Qt::InitialSortOrderRole && section == Samples) {
+        return Qt::DescendingOrder;
+    } else if (role == Qt::DisplayRole) {
+        switch (static_cast<Columns>(section)) {
+        case Value:
+            return m_fieldName;
+        case Samples:
+            return tr("Samples");
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::ToolTipRole) {
+        switch (static_cast<Columns>(section)) {
+        case Value:
+            return tr("A value of field %1 of the tracepoint payload.").arg(m_fieldName);
+        case Samples:
+            return tr("How many samples had this value.");
+        case NUM_COLUMNS:
+            break;
+        }
+    }
+
+    return {};
+}
+
+QVariant TracePointGroupsModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount()) {
+        return {};
+    }
+
+    const auto& group = m_groups.at(index.row());
+
+    if (role == FilterRole) {
+        return group.displayValue;
+    } else if (role == SortRole) {
+        switch (static_cast<Columns>(index.column())) {
+        case Value:
+            return group.value;
+        case Samples:
+            return group.samples;
+        case NUM_COLUMNS:
+            break;
+        }
+    } else if (role == Qt::DisplayRole) {
+        switch (static_cast<Columns>(index.column())) {
+        case Value:
+            return group.displayValue;
+        case Samples:
+            return tr("%1 (%2%)").arg(QString::number(group.samples),
+                                      Util::formatCostRelative(group.samples, m_totalSamples));
+        case NUM_COLUMNS:
+            break;
+        }
+    }
+
+    return {};
+}
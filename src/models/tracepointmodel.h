@@ -0,0 +1,123 @@
+/*
+    tracepointmodel.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QVector>
+
+#include "data.h"
+
+/**
+ * The samples of one tracepoint with the values of their payload fields, one row per sample.
+ *
+ * The columns after NUM_BASE_COLUMNS are the fields of the tracepoint, see Data::TracePointSamples.
+ */
+class TracePointSamplesModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit TracePointSamplesModel(QObject* parent = nullptr);
+    ~TracePointSamplesModel();
+
+    enum Columns
+    {
+        Time = 0,
+        Thread,
+        Cpu,
+        NUM_BASE_COLUMNS
+    };
+    enum
+    {
+        InitialSortColumn = Time
+    };
+
+    enum Roles
+    {
+        SortRole = Qt::UserRole,
+        // all values of the row, to filter on them at once
+        FilterRole,
+    };
+
+    // the samples of events.tracePoints[tracePoint], an invalid index clears the model
+    void setData(const Data::EventResults& events, int tracePoint);
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    QString threadName(int row) const;
+
+    Data::TracePointSamples m_samples;
+    // the times are shown relative to it, like in the time line
+    quint64 m_startTime = 0;
+    QHash<qint32, QString> m_threadNames;
+};
+
+/**
+ * The samples of one tracepoint grouped by the value of one of their fields, one row per value.
+ */
+class TracePointGroupsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit TracePointGroupsModel(QObject* parent = nullptr);
+    ~TracePointGroupsModel();
+
+    enum Columns
+    {
+        Value = 0,
+        Samples,
+        NUM_COLUMNS
+    };
+    enum
+    {
+        InitialSortColumn = Samples
+    };
+
+    enum Roles
+    {
+        SortRole = Qt::UserRole,
+        FilterRole,
+    };
+
+    void setData(const Data::TracePointSamples& samples, int field);
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Group
+    {
+        QVariant value;
+        QString displayValue;
+        int samples = 0;
+    };
+
+    QString m_fieldName;
+    QVector<Group> m_groups;
+    int m_totalSamples = 0;
+};
@@ -29,21 +29,34 @@
 
 #include <QBuffer>
 #include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
+#include <QDir>
 #include <QEventLoop>
 #include <QFileInfo>
 #include <QLoggingCategory>
+#include <QMutex>
 #include <QProcess>
+#include <QTimer>
+#include <QVariant>
 #include <QtEndian>
 
 #include <ThreadWeaver/ThreadWeaver>
 
+#include <models/resultscache.h>
+#include <settings.h>
 #include <util.h>
 
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <numeric>
 
 Q_LOGGING_CATEGORY(LOG_PERFPARSER, "hotspot.perfparser", QtWarningMsg)
 
+// number of parsed files whose results are kept in the results cache
+const int MAX_CACHED_RESULTS = 8;
+
 namespace {
 
 struct Record
@@ -298,6 +311,8 @@ struct Sample : Record
 {
     QVector<qint32> frames;
     QVector<qint32> disasmFrames;
+    // from and to of the taken branches of the branch stack, most recent first
+    QVector<qint32> branchFrames;
     quint8 guessedFrames = 0;
     QVector<SampleCost> costs;
     bool isIncompleteCallchain = false;
@@ -305,8 +320,8 @@ struct Sample : Record
 
 QDataStream& operator>>(QDataStream& stream, Sample& sample)
 {
-    return stream >> static_cast<Record&>(sample) >> sample.frames >> sample.disasmFrames >> sample.guessedFrames >> sample.costs
-                  >> sample.isIncompleteCallchain;
+    return stream >> static_cast<Record&>(sample) >> sample.frames >> sample.disasmFrames >> sample.branchFrames
+                  >> sample.guessedFrames >> sample.costs >> sample.isIncompleteCallchain;
 }
 
 QDebug operator<<(QDebug stream, const Sample& sample)
@@ -314,6 +329,7 @@ QDebug operator<<(QDebug stream, const Sample& sample)
     stream.noquote().nospace() << "Sample{" << static_cast<const Record&>(sample) << ", "
                                << "frames=" << sample.frames << ", "
                                << "disasmFrames=" << sample.disasmFrames << ", "
+                               << "branchFrames=" << sample.branchFrames << ", "
                                << "guessedFrames=" << sample.guessedFrames << ", "
                                << "costs=" << sample.costs << "}";
     return stream;
@@ -322,17 +338,20 @@ QDebug operator<<(QDebug stream, const Sample& sample)
 struct ContextSwitchDefinition : Record
 {
     bool switchOut = false;
+    // the thread was still runnable when it got switched out, i.e. it did not block
+    bool preempted = false;
 };
 
 QDataStream& operator>>(QDataStream& stream, ContextSwitchDefinition& contextSwitch)
 {
-    return stream >> static_cast<Record&>(contextSwitch) >> contextSwitch.switchOut;
+    return stream >> static_cast<Record&>(contextSwitch) >> contextSwitch.switchOut >> contextSwitch.preempted;
 }
 
 QDebug operator<<(QDebug stream, const ContextSwitchDefinition& contextSwitch)
 {
     stream.noquote().nospace() << "ContextSwitchDefinition{" << static_cast<const Record&>(contextSwitch) << ", "
-                               << "switchOut=" << contextSwitch.switchOut << "}";
+                               << "switchOut=" << contextSwitch.switchOut << ", "
+                               << "preempted=" << contextSwitch.preempted << "}";
     return stream.space();
 }
 
@@ -355,18 +374,123 @@ QDebug operator<<(QDebug stream, const StringDefinition& stringDefinition)
     return stream;
 }
 
+struct TracePointFieldDefinition
+{
+    StringId name;
+    quint8 type = Data::TracePointField::Unsupported;
+    quint8 size = 0;
+};
+
+QDataStream& operator>>(QDataStream& stream, TracePointFieldDefinition& field)
+{
+    return stream >> field.name >> field.type >> field.size;
+}
+
+QDebug operator<<(QDebug stream, const TracePointFieldDefinition& field)
+{
+    stream.noquote().nospace() << "TracePointFieldDefinition{"
+                               << "name=" << field.name << ", "
+                               << "type=" << static_cast<int>(field.type) << ", "
+                               << "size=" << static_cast<int>(field.size) << "}";
+    return stream;
+}
+
+struct TracePointFormat
+{
+    qint32 id = 0;
+    StringId system;
+    StringId name;
+    quint32 flags = 0;
+    // in the order of their values in the payload of a TracePointSample
+    QVector<TracePointFieldDefinition> fields;
+};
+
+QDataStream& operator>>(QDataStream& stream, TracePointFormat& format)
+{
+    return stream >> format.id >> format.system >> format.name >> format.flags >> format.fields;
+}
+
+QDebug operator<<(QDebug stream, const TracePointFormat& format)
+{
+    stream.noquote().nospace() << "TracePointFormat{"
+                               << "id=" << format.id << ", "
+                               << "system=" << format.system << ", "
+                               << "name=" << format.name << ", "
+                               << "flags=" << format.flags << ", "
+                               << "fields=" << format.fields << "}";
+    return stream;
+}
+
+// the attributes of tracepoint events reference the format of their payload via their config
+const quint32 PERF_TYPE_TRACEPOINT = 2;
+
+template<typename Number>
+void readTracePointNumber(QDataStream& stream, QByteArray* column)
+{
+    Number number = 0;
+    stream >> number;
+    column->append(reinterpret_cast<const char*>(&number), sizeof(Number));
+}
+
+void readTracePointNumber(QDataStream& stream, const Data::TracePointField& field, QByteArray* column)
+{
+    const bool isSigned = field.type == Data::TracePointField::Signed;
+    switch (field.size) {
+    case 1:
+        return isSigned ? readTracePointNumber<qint8>(stream, column) : readTracePointNumber<quint8>(stream, column);
+    case 2:
+        return isSigned ? readTracePointNumber<qint16>(stream, column) : readTracePointNumber<quint16>(stream, column);
+    case 4:
+        return isSigned ? readTracePointNumber<qint32>(stream, column) : readTracePointNumber<quint32>(stream, column);
+    case 8:
+        return isSigned ? readTracePointNumber<qint64>(stream, column) : readTracePointNumber<quint64>(stream, column);
+    }
+}
+
+template<typename Number>
+QString readTracePointArray(QDataStream& stream)
+{
+    quint32 count = 0;
+    stream >> count;
+    QStringList elements;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        Number number = 0;
+        stream >> number;
+        elements.append(QString::number(number));
+    }
+    return QLatin1Char('[') + elements.join(QLatin1String(", ")) + QLatin1Char(']');
+}
+
+QString readTracePointArray(QDataStream& stream, const Data::TracePointField& field)
+{
+    const bool isSigned = field.type == Data::TracePointField::SignedArray;
+    switch (field.size) {
+    case 1:
+        return isSigned ? readTracePointArray<qint8>(stream) : readTracePointArray<quint8>(stream);
+    case 2:
+        return isSigned ? readTracePointArray<qint16>(stream) : readTracePointArray<quint16>(stream);
+    case 4:
+        return isSigned ? readTracePointArray<qint32>(stream) : readTracePointArray<quint32>(stream);
+    case 8:
+        return isSigned ? readTracePointArray<qint64>(stream) : readTracePointArray<quint64>(stream);
+    }
+    return {};
+}
+
 struct LostDefinition : Record
 {
+    quint64 lost = 0;
 };
 
 QDataStream& operator>>(QDataStream& stream, LostDefinition& lostDefinition)
 {
-    return stream >> static_cast<Record&>(lostDefinition);
+    return stream >> static_cast<Record&>(lostDefinition) >> lostDefinition.lost;
 }
 
 QDebug operator<<(QDebug stream, const LostDefinition& lostDefinition)
 {
-    stream.noquote().nospace() << "LostDefinition{" << static_cast<const Record&>(lostDefinition) << "}";
+    stream.noquote().nospace() << "LostDefinition{" << static_cast<const Record&>(lostDefinition) << ", "
+                               << "lost=" << lostDefinition.lost << "}";
     return stream;
 }
 
@@ -587,6 +711,53 @@ void addDisassemblyEvent(const Data::Symbol &symbol, const Data::Location &locat
         recursionGuard->insert(symbol);
     }
 }
+
+template<typename EventCallback>
+void foreachStackEvent(const Data::EventResults& events, EventCallback eventCallback)
+{
+    for (const auto& thread : events.threads) {
+        for (const auto& event : thread.events) {
+            if (event.type >= 0 && event.stackId >= 0) {
+                eventCallback(event, events.stacks.at(event.stackId));
+            }
+        }
+    }
+}
+
+// the source map of the caller/callee data needs the locations of every event
+void addCallerCalleeEvents(const Data::BottomUpResults& bottomUp, const Data::EventResults& events,
+                           Data::CallerCalleeResults* callerCalleeResult)
+{
+    const auto numCosts = bottomUp.costs.numTypes();
+    foreachStackEvent(events, [&](const Data::Event& event, const QVector<qint32>& stack) {
+        QSet<Data::Symbol> recursionGuard;
+        bottomUp.foreachFrame(stack, [&](const Data::Symbol& symbol, const Data::Location& location) {
+            addCallerCalleeEvent(symbol, location, event.type, event.cost, &recursionGuard, callerCalleeResult,
+                                 numCosts);
+            return true;
+        });
+    });
+}
+
+void addDisassemblyEvents(const Data::BottomUpResults& bottomUp, const Data::EventResults& events,
+                          Data::DisassemblyResult* disassemblyResult)
+{
+    const auto numCosts = bottomUp.costs.numTypes();
+    disassemblyResult->selfCosts.initializeCostsFrom(bottomUp.costs);
+    disassemblyResult->inclusiveCosts.initializeCostsFrom(bottomUp.costs);
+    foreachStackEvent(events, [&](const Data::Event& event, const QVector<qint32>& stack) {
+        // context switches don't contribute to the instruction costs
+        if (event.type == events.offCpuTimeCostId) {
+            return;
+        }
+        QSet<Data::Symbol> recursionGuard;
+        bottomUp.foreachFrame(stack, [&](const Data::Symbol& symbol, const Data::Location& location) {
+            addDisassemblyEvent(symbol, location, event.type, event.cost, &recursionGuard, disassemblyResult,
+                                numCosts);
+            return true;
+        });
+    });
+}
 }
 
 Q_DECLARE_TYPEINFO(AttributesDefinition, Q_MOVABLE_TYPE);
@@ -714,8 +885,9 @@ public:
             addRecord(sample);
             addSample(sample);
 
-            if (static_cast<EventType>(eventType) == EventType::TracePointSample)
-                return true; // TODO: read full data
+            if (static_cast<EventType>(eventType) == EventType::TracePointSample) {
+                addTracePointSample(sample);
+            }
             break;
         }
         case EventType::ThreadStart: {
@@ -808,9 +980,13 @@ public:
             emit progress(percent);
             break;
         }
-        case EventType::TracePointFormat:
-            // TODO: implement me
-            return true;
+        case EventType::TracePointFormat: {
+            TracePointFormat tracePointFormat;
+            stream >> tracePointFormat;
+            qCDebug(LOG_PERFPARSER) << "parsed:" << tracePointFormat;
+            tracePointFormats.insert(tracePointFormat.id, tracePointFormat);
+            break;
+        }
         case EventType::InvalidType:
             break;
         }
@@ -826,16 +1002,123 @@ public:
 
     void finalize()
     {
-        Data::BottomUp::initializeParents(&bottomUpResult.root);
+        finalize(&summaryResult, &bottomUpResult, &eventResult);
+    }
+
+    // the results parsed so far, finalized while the parsing goes on
+    void snapshot(Data::Summary* summary, Data::BottomUpResults* bottomUp, Data::EventResults* events) const
+    {
+        *summary = summaryResult;
+        *bottomUp = bottomUpResult;
+        *events = eventResult;
+        finalize(summary, bottomUp, events);
+    }
+
+    // drop the events older than @p time, to bound the memory of a live recording
+    void dropEventsBefore(quint64 time)
+    {
+        auto isOlder = [time](const Data::Event& event) { return event.time < time; };
+        for (auto& thread : eventResult.threads) {
+            thread.events.erase(std::remove_if(thread.events.begin(), thread.events.end(), isOlder),
+                                thread.events.end());
+            thread.futexWaits.erase(std::remove_if(thread.futexWaits.begin(), thread.futexWaits.end(),
+                                                   [time](const Data::FutexWait& wait) { return wait.time < time; }),
+                                    thread.futexWaits.end());
+            thread.wakeups.erase(std::remove_if(thread.wakeups.begin(), thread.wakeups.end(),
+                                                [time](const Data::Wakeup& wakeup) { return wakeup.time < time; }),
+                                 thread.wakeups.end());
+        }
+        for (auto& tracePoint : eventResult.tracePoints) {
+            const int first = std::lower_bound(tracePoint.times.begin(), tracePoint.times.end(), time)
+                - tracePoint.times.begin();
+            if (first > 0) {
+                QVector<int> rows(tracePoint.size() - first);
+                std::iota(rows.begin(), rows.end(), first);
+                tracePoint = tracePoint.selected(rows);
+            }
+        }
+        for (auto& cpu : eventResult.cpus) {
+            cpu.events.erase(std::remove_if(cpu.events.begin(), cpu.events.end(), isOlder), cpu.events.end());
+            cpu.lost.erase(std::remove_if(cpu.lost.begin(), cpu.lost.end(),
+                                          [time](const Data::LostEvents& lost) { return lost.time.end < time; }),
+                           cpu.lost.end());
+        }
+        dropUnusedStacks();
+    }
 
-        summaryResult.applicationRunningTime = applicationTime.delta();
-        summaryResult.threadCount = uniqueThreads.size();
-        summaryResult.processCount = uniqueProcess.size();
+    // remove the stacks that no event refers to anymore and number the remaining ones consecutively again
+    void dropUnusedStacks()
+    {
+        QVector<qint32> newIds(eventResult.stacks.size(), -1);
+        auto markUsed = [&newIds](qint32 stackId) {
+            if (stackId >= 0) {
+                newIds[stackId] = 0;
+            }
+        };
+        for (const auto& thread : eventResult.threads) {
+            for (const auto& event : thread.events) {
+                markUsed(event.stackId);
+            }
+            for (const auto& wakeup : thread.wakeups) {
+                markUsed(wakeup.stackId);
+            }
+            // the off-CPU time of the next switch gets attributed to this stack
+            markUsed(thread.lastSwitchStackId);
+        }
+        for (const auto& cpu : eventResult.cpus) {
+            for (const auto& event : cpu.events) {
+                markUsed(event.stackId);
+            }
+        }
 
-        buildTopDownResult();
-        buildCallerCalleeResult();
+        QVector<QVector<qint32>> usedStacks;
+        for (qint32 stackId = 0, c = newIds.size(); stackId < c; ++stackId) {
+            if (newIds[stackId] == 0) {
+                newIds[stackId] = usedStacks.size();
+                usedStacks.push_back(eventResult.stacks.at(stackId));
+            }
+        }
+        if (usedStacks.size() == eventResult.stacks.size()) {
+            return;
+        }
 
+        auto remap = [&newIds](qint32* stackId) {
+            if (*stackId >= 0) {
+                *stackId = newIds.at(*stackId);
+            }
+        };
         for (auto& thread : eventResult.threads) {
+            for (auto& event : thread.events) {
+                remap(&event.stackId);
+            }
+            for (auto& wakeup : thread.wakeups) {
+                remap(&wakeup.stackId);
+            }
+            remap(&thread.lastSwitchStackId);
+        }
+        for (auto& cpu : eventResult.cpus) {
+            for (auto& event : cpu.events) {
+                remap(&event.stackId);
+            }
+        }
+
+        eventResult.stacks = usedStacks;
+        stacks.clear();
+        for (qint32 stackId = 0, c = usedStacks.size(); stackId < c; ++stackId) {
+            // see internStack, the ids are stored off by one
+            stacks.insert(usedStacks.at(stackId), stackId + 1);
+        }
+    }
+
+    void finalize(Data::Summary* summary, Data::BottomUpResults* bottomUp, Data::EventResults* events) const
+    {
+        Data::BottomUp::initializeParents(&bottomUp->root);
+
+        summary->applicationRunningTime = applicationTime.delta();
+        summary->threadCount = uniqueThreads.size();
+        summary->processCount = uniqueProcess.size();
+
+        for (auto& thread : events->threads) {
             thread.time.start = std::max(thread.time.start, applicationTime.start);
             thread.time.end = std::min(thread.time.end, applicationTime.end);
             if (thread.name.isEmpty()) {
@@ -849,19 +1132,23 @@ public:
             }
 
             if (thread.offCpuTime > 0) {
-                summaryResult.offCpuTime += thread.offCpuTime;
-                summaryResult.onCpuTime += thread.time.delta() - thread.offCpuTime;
+                summary->offCpuTime += thread.offCpuTime;
+                summary->onCpuTime += thread.time.delta() - thread.offCpuTime;
             }
         }
 
         {
             uint cpuId = 0;
-            for (auto& cpu : eventResult.cpus) {
+            for (auto& cpu : events->cpus) {
                 cpu.cpuId = cpuId++;
             }
         }
 
-        eventResult.totalCosts = summaryResult.costs;
+        for (auto& losses : summary->lostPerCpu) {
+            losses.sampleCount = samplesPerCpu.value(losses.cpuId);
+        }
+
+        events->totalCosts = summary->costs;
     }
 
     qint32 addCostType(const QString& label, Data::Costs::Unit unit)
@@ -871,6 +1158,12 @@ public:
 
         if (label == QLatin1String("sched:sched_switch")) {
             m_schedSwitchCostId = costId;
+        } else if (label == QLatin1String("syscalls:sys_enter_futex")) {
+            m_futexEnterCostId = costId;
+        } else if (label == QLatin1String("sched:sched_wakeup")) {
+            m_wakeupCostId = costId;
+        } else if (label == QLatin1String("sched:sched_waking")) {
+            m_wakingCostId = costId;
         }
 
         Q_ASSERT(summaryResult.costs.size() == costId);
@@ -952,14 +1245,15 @@ public:
     {
         // empty symbol was added in addLocation already
         Q_ASSERT(bottomUpResult.symbols.size() > symbol.id);
-        // TODO: isKernel information
         const auto symbolString = strings.value(symbol.symbol.name.id);
         const auto mangledString = strings.value(symbol.symbol.mangled.id);
         const auto relAddrString = symbol.symbol.relAddr.id;
         const auto sizeString = symbol.symbol.size.id;
         const auto binaryString = strings.value(symbol.symbol.binary.id);
         const auto pathString = strings.value(symbol.symbol.path.id);        
-        bottomUpResult.symbols[symbol.id] = {symbolString, mangledString, relAddrString, sizeString, binaryString, pathString};
+        auto& newSymbol = bottomUpResult.symbols[symbol.id];
+        newSymbol = {symbolString, mangledString, relAddrString, sizeString, binaryString, pathString};
+        newSymbol.isKernel = symbol.symbol.isKernel;
         if (symbolString.isEmpty() && !binaryString.isEmpty()
             && !reportedMissingDebugInfoModules.contains(symbol.symbol.binary.id)) {
             reportedMissingDebugInfoModules.insert(symbol.symbol.binary.id);
@@ -988,6 +1282,20 @@ public:
             eventResult.cpus.resize(sample.cpu + 1);
         }
         auto& cpu = eventResult.cpus[sample.cpu];
+        if (static_cast<uint>(samplesPerCpu.size()) <= sample.cpu) {
+            samplesPerCpu.resize(sample.cpu + 1);
+        }
+        ++samplesPerCpu[sample.cpu];
+
+        if (!hasBranchStacks && !sample.disasmFrames.isEmpty()) {
+            // branch stacks are not part of the event data, so the disassembly costs can't be computed lazily,
+            // collect them while parsing from now on and catch up with the samples we have seen so far
+            hasBranchStacks = true;
+            addDisassemblyEvents(bottomUpResult, eventResult, &disassemblyResult);
+        }
+        // unlike the events, the branch counts are not dropped for live recordings, they are keyed by the code
+        // locations and thus bounded by the size of the profiled code, just like the bottom-up data
+        disassemblyResult.addBranchStack(sample.branchFrames);
 
         for (const auto& sampleCost : sample.costs) {
             Data::Event event;
@@ -998,12 +1306,160 @@ public:
             event.cpuId = sample.cpu;
             thread->events.push_back(event);
             cpu.events.push_back(event);
+            if (m_schedSwitchCostId != -1 && event.type == m_schedSwitchCostId) {
+                thread->lastSwitchStackId = event.stackId;
+            }
         }
 
         addSampleToBottomUp(sample);
         addSampleToSummary(sample);
     }
 
+    void addTracePointSample(const Sample& sample)
+    {
+        auto skipPayload = [this]() { stream.skipRawData(static_cast<int>(buffer.size() - buffer.pos())); };
+
+        auto sampleCost = std::find_if(sample.costs.begin(), sample.costs.end(), [this](const SampleCost& cost) {
+            return cost.attributeId >= 0 && cost.attributeId < attributes.size()
+                && attributes.at(cost.attributeId).type == PERF_TYPE_TRACEPOINT;
+        });
+        if (sampleCost == sample.costs.end()) {
+            skipPayload();
+            return;
+        }
+        const auto& attribute = attributes.at(sampleCost->attributeId);
+        const auto costId = attributeIdsToCostIds.value(sampleCost->attributeId, -1);
+
+        int index = tracePointIndices.value(costId, -1);
+        if (index == -1) {
+            auto format = tracePointFormats.constFind(static_cast<qint32>(attribute.config));
+            if (format == tracePointFormats.constEnd()) {
+                skipPayload();
+                return;
+            }
+            index = addTracePoint(costId, strings.value(attribute.name.id), *format);
+        }
+
+        auto& tracePoint = eventResult.tracePoints[index];
+        auto& state = tracePointStates[index];
+        const int row = tracePoint.size();
+        tracePoint.times.append(sample.time);
+        tracePoint.pids.append(sample.pid);
+        tracePoint.tids.append(sample.tid);
+        tracePoint.cpuIds.append(sample.cpu);
+
+        auto internString = [&tracePoint, &state](const QString& string) {
+            auto it = state.stringIds.constFind(string);
+            if (it == state.stringIds.constEnd()) {
+                it = state.stringIds.insert(string, tracePoint.strings.size());
+                tracePoint.strings.append(string);
+            }
+            const qint32 id = it.value();
+            return QByteArray(reinterpret_cast<const char*>(&id), sizeof(id));
+        };
+
+        for (int i = 0, c = tracePoint.fields.size(); i < c; ++i) {
+            const auto& field = tracePoint.fields.at(i);
+            auto& column = tracePoint.columns[i];
+            switch (field.type) {
+            case Data::TracePointField::Signed:
+            case Data::TracePointField::Unsigned:
+                readTracePointNumber(stream, field, &column);
+                break;
+            case Data::TracePointField::String: {
+                QByteArray string;
+                stream >> string;
+                column.append(internString(QString::fromUtf8(string)));
+                break;
+            }
+            case Data::TracePointField::SignedArray:
+            case Data::TracePointField::UnsignedArray:
+                column.append(internString(readTracePointArray(stream, field)));
+                break;
+            case Data::TracePointField::Unsupported:
+                break;
+            }
+        }
+
+        if (state.futexAddressField != -1 && state.futexOpField != -1) {
+            addFutexWait(sample, tracePoint.value(state.futexAddressField, row).toULongLong(),
+                         tracePoint.value(state.futexOpField, row).toInt());
+        } else if (state.wokenTidField != -1) {
+            addWakeup(sample, tracePoint.value(state.wokenTidField, row).toInt());
+        }
+    }
+
+    int addTracePoint(qint32 costId, const QString& name, const TracePointFormat& format)
+    {
+        Data::TracePointSamples tracePoint;
+        tracePoint.name = name;
+        tracePoint.costId = costId;
+        for (const auto& definition : format.fields) {
+            Data::TracePointField field;
+            field.name = strings.value(definition.name.id);
+            // no value is sent for types we don't know
+            if (definition.type <= Data::TracePointField::UnsignedArray) {
+                field.type = static_cast<Data::TracePointField::Type>(definition.type);
+            }
+            field.size = definition.size;
+            tracePoint.fields.append(field);
+        }
+        tracePoint.columns.resize(tracePoint.fields.size());
+
+        // the fields we extract while parsing are looked up once per tracepoint
+        TracePointState state;
+        if (costId == m_futexEnterCostId) {
+            state.futexAddressField = tracePoint.fieldIndex(QStringLiteral("uaddr"));
+            state.futexOpField = tracePoint.fieldIndex(QStringLiteral("op"));
+        } else if (costId == m_wakeupCostId || costId == m_wakingCostId) {
+            state.wokenTidField = tracePoint.fieldIndex(QStringLiteral("pid"));
+        }
+
+        const int index = eventResult.tracePoints.size();
+        eventResult.tracePoints.append(tracePoint);
+        tracePointStates.append(state);
+        tracePointIndices.insert(costId, index);
+        return index;
+    }
+
+    void addFutexWait(const Sample& sample, quint64 address, qint32 op)
+    {
+        // only the operations that may block, FUTEX_WAKE and friends never wait
+        // see FUTEX_WAIT, FUTEX_LOCK_PI, FUTEX_WAIT_BITSET, FUTEX_WAIT_REQUEUE_PI and FUTEX_LOCK_PI2 in linux/futex.h
+        switch (op & 0x7f) {
+        case 0:
+        case 6:
+        case 9:
+        case 11:
+        case 13:
+            break;
+        default:
+            return;
+        }
+
+        auto* thread = eventResult.findThread(sample.pid, sample.tid);
+        if (thread) {
+            Data::FutexWait wait;
+            wait.time = sample.time;
+            wait.address = address;
+            thread->futexWaits.push_back(wait);
+        }
+    }
+
+    void addWakeup(const Sample& sample, qint32 wokenTid)
+    {
+        // the tracepoint fires in the context of the waking thread, its stack shows why it woke up the other one
+        auto* thread = eventResult.findThread(sample.pid, sample.tid);
+        if (thread) {
+            Data::Wakeup wakeup;
+            wakeup.time = sample.time;
+            wakeup.wokenTid = wokenTid;
+            wakeup.stackId = internStack(sample.frames);
+            wakeup.cpuId = sample.cpu;
+            thread->wakeups.push_back(wakeup);
+        }
+    }
+
     void addString(const StringDefinition& string)
     {
         Q_ASSERT(string.id == strings.size());
@@ -1027,7 +1483,7 @@ public:
                               << strings.value(attributes.value(sampleCost.attributeId).name.id) << '\n';
         }
 
-        QSet<Data::Symbol> recursionGuard, recursionDisasmGuard;
+        QSet<Data::Symbol> recursionDisasmGuard;
         const auto type = attributeIdsToCostIds.value(sampleCost.attributeId, -1);
 
         if (type < 0) {
@@ -1036,18 +1492,18 @@ public:
             return;
         }
 
-        disassemblyResult.selfCosts.initializeCostsFrom(bottomUpResult.costs);
-        disassemblyResult.inclusiveCosts.initializeCostsFrom(bottomUpResult.costs);
+        if (hasBranchStacks) {
+            disassemblyResult.selfCosts.initializeCostsFrom(bottomUpResult.costs);
+            disassemblyResult.inclusiveCosts.initializeCostsFrom(bottomUpResult.costs);
+        }
 
         bool hasStackBranch = !sample.disasmFrames.empty();
         QVector<qint32> disasmFrames = hasStackBranch ? sample.disasmFrames : sample.frames;
 
-        auto frameCallback = [this, &hasStackBranch, &recursionGuard, &recursionDisasmGuard, &sampleCost, type](const Data::Symbol& symbol,
+        // the caller/callee data and, without branch stacks, the disassembly costs are computed lazily from the events
+        auto frameCallback = [this, &hasStackBranch, &recursionDisasmGuard, &sampleCost, type](const Data::Symbol& symbol,
                                                                         const Data::Location& location) {
-            addCallerCalleeEvent(symbol, location, type, sampleCost.cost, &recursionGuard, &callerCalleeResult,
-                                 bottomUpResult.costs.numTypes());
-
-            if (!hasStackBranch){
+            if (!hasStackBranch && hasBranchStacks) {
                 addDisassemblyEvent(symbol, location, type, sampleCost.cost, &recursionDisasmGuard, &disassemblyResult,
                                     bottomUpResult.costs.numTypes());
             }
@@ -1076,16 +1532,6 @@ public:
         }
     }
 
-    void buildTopDownResult()
-    {
-        topDownResult = Data::TopDownResults::fromBottomUp(bottomUpResult);
-    }
-
-    void buildCallerCalleeResult()
-    {
-        Data::callerCalleesFromBottomUpData(bottomUpResult, &callerCalleeResult);
-    }
-
     void addRecord(const Record& record)
     {
         uniqueProcess.insert(record.pid);
@@ -1135,23 +1581,11 @@ public:
             totalCost.sampleCount++;
             totalCost.totalPeriod += switchTime;
 
-            qint32 stackId = -1;
-            if (!thread->events.isEmpty() && m_schedSwitchCostId != -1) {
-                auto it = std::find_if(thread->events.rbegin(), thread->events.rend(),
-                                       [this](const Data::Event& event) { return event.type == m_schedSwitchCostId; });
-                if (it != thread->events.rend()) {
-                    stackId = it->stackId;
-                }
-            }
+            const auto stackId = thread->lastSwitchStackId;
             if (stackId != -1) {
                 const auto& frames = eventResult.stacks[stackId];
-                QSet<Data::Symbol> recursionGuard;
-                auto frameCallback = [this, &recursionGuard, switchTime](const Data::Symbol& symbol,
-                                                                         const Data::Location& location) {
-                    addCallerCalleeEvent(symbol, location, eventResult.offCpuTimeCostId, switchTime, &recursionGuard,
-                                         &callerCalleeResult, bottomUpResult.costs.numTypes());
-                };
-                bottomUpResult.addEvent(eventResult.offCpuTimeCostId, switchTime, frames, false, frameCallback);
+                bottomUpResult.addEvent(eventResult.offCpuTimeCostId, switchTime, frames, false,
+                                        [](const Data::Symbol&, const Data::Location&) {});
             }
 
             Data::Event event;
@@ -1160,16 +1594,54 @@ public:
             event.type = eventResult.offCpuTimeCostId;
             event.stackId = stackId;
             event.cpuId = contextSwitch.cpu;
+            event.preempted = thread->preempted;
             thread->events.push_back(event);
         }
 
         thread->lastSwitchTime = contextSwitch.time;
         thread->state = contextSwitch.switchOut ? Data::ThreadEvents::OffCpu : Data::ThreadEvents::OnCpu;
+        if (contextSwitch.switchOut) {
+            thread->preempted = contextSwitch.preempted;
+        }
     }
 
-    void addLost(const LostDefinition& /*lost*/)
+    void addLost(const LostDefinition& lost)
     {
         ++summaryResult.lostChunks;
+        summaryResult.lostEvents += lost.lost;
+
+        // older perf versions don't tell us on which cpu the events got lost
+        if (lost.cpu == Data::INVALID_CPU_ID) {
+            return;
+        }
+
+        auto& perCpu = summaryResult.lostPerCpu;
+        auto losses = std::lower_bound(perCpu.begin(), perCpu.end(), lost.cpu,
+                                       [](const Data::CpuLosses& entry, quint32 cpuId) { return entry.cpuId < cpuId; });
+        if (losses == perCpu.end() || losses->cpuId != lost.cpu) {
+            Data::CpuLosses newLosses;
+            newLosses.cpuId = lost.cpu;
+            losses = perCpu.insert(losses, newLosses);
+        }
+        ++losses->lostChunks;
+        losses->lostEvents += lost.lost;
+
+        if (static_cast<uint>(eventResult.cpus.size()) <= lost.cpu) {
+            eventResult.cpus.resize(lost.cpu + 1);
+        }
+        auto& cpu = eventResult.cpus[lost.cpu];
+        // the events got lost after the last one we got from this cpu and before perf noticed it
+        quint64 start = applicationTime.start;
+        if (!cpu.events.isEmpty()) {
+            start = std::max(start, cpu.events.constLast().time);
+        }
+        if (!cpu.lost.isEmpty()) {
+            start = std::max(start, cpu.lost.constLast().time.end);
+        }
+        Data::LostEvents lostEvents;
+        lostEvents.time = {std::min(start, lost.time), lost.time};
+        lostEvents.count = lost.lost;
+        cpu.lost.push_back(lostEvents);
     }
 
     void setFeatures(const FeaturesDefinition& features)
@@ -1193,6 +1665,9 @@ public:
         summaryResult.cpuSiblingCores = formatCpuList(features.siblingCores);
         summaryResult.cpuSiblingThreads = formatCpuList(features.siblingThreads);
         summaryResult.totalMemoryInKiB = features.totalMem;
+        for (const auto& buildId : features.buildIds) {
+            summaryResult.buildIds.insert(QString::fromUtf8(buildId.fileName), buildId.id);
+        }
 
         eventResult.cpus.resize(features.nrCpusAvailable);
         disassemblyResult.arch = QString::fromUtf8(features.arch);
@@ -1251,9 +1726,10 @@ public:
     QSet<quint32> uniqueThreads;
     QSet<quint32> uniqueProcess;
     Data::BottomUpResults bottomUpResult;
-    Data::TopDownResults topDownResult;
-    Data::CallerCalleeResults callerCalleeResult;
     Data::EventResults eventResult;
+    // samples by cpu, to put the lost events of a cpu into relation
+    QVector<quint64> samplesPerCpu;
+    bool hasBranchStacks = false;
     QHash<qint32, QHash<qint32, QString>> commands;
     QScopedPointer<QTextStream> perfScriptOutput;
     QSet<qint32> reportedMissingDebugInfoModules;
@@ -1264,6 +1740,21 @@ public:
     QHash<int, qint32> attributeNameToCostIds;
     qint32 m_nextCostId = 0;
     qint32 m_schedSwitchCostId = -1;
+    qint32 m_futexEnterCostId = -1;
+    qint32 m_wakeupCostId = -1;
+    qint32 m_wakingCostId = -1;
+    QHash<qint32, TracePointFormat> tracePointFormats;
+    // the index into eventResult.tracePoints by cost id
+    QHash<qint32, int> tracePointIndices;
+    // parser state of the entries of eventResult.tracePoints
+    struct TracePointState
+    {
+        QHash<QString, qint32> stringIds;
+        int futexAddressField = -1;
+        int futexOpField = -1;
+        int wokenTidField = -1;
+    };
+    QVector<TracePointState> tracePointStates;
 
 public slots:
     void stop()
@@ -1280,6 +1771,9 @@ PerfParser::PerfParser(QObject* parent)
     : QObject(parent)
     , m_isParsing(false)
     , m_stopRequested(false)
+    , m_watchedViews(AllViews)
+    , m_resultsGeneration(0)
+    , m_disassemblyGeneration(0)
 {
     // set data via signal/slot connection to ensure we don't introduce a data race
     connect(this, &PerfParser::bottomUpDataAvailable, this, [this](const Data::BottomUpResults& data) {
@@ -1287,70 +1781,285 @@ PerfParser::PerfParser(QObject* parent)
             m_bottomUpResults = data;
         }
     });
-    connect(this, &PerfParser::callerCalleeDataAvailable, this, [this](const Data::CallerCalleeResults& data) {
-        if (m_callerCalleeResults.entries.isEmpty()) {
-            m_callerCalleeResults = data;
-        }
+    connect(this, &PerfParser::summaryDataAvailable, this,
+            [this](const Data::Summary& data) { m_summary = data; });
+    // the views are up to date once their data arrived, see invalidateViews
+    connect(this, &PerfParser::topDownDataAvailable, this, [this]() {
+        m_upToDateViews |= TopDownView;
+        m_pendingViews &= ~TopDownView;
+    });
+    connect(this, &PerfParser::callerCalleeDataAvailable, this, [this]() {
+        m_upToDateViews |= CallerCalleeView;
+        m_pendingViews &= ~CallerCalleeView;
+    });
+    connect(this, &PerfParser::offCpuDataAvailable, this, [this]() {
+        m_upToDateViews |= OffCpuView;
+        m_pendingViews &= ~OffCpuView;
+    });
+    connect(this, &PerfParser::parallelismDataAvailable, this, [this]() {
+        m_upToDateViews |= ParallelismView;
+        m_pendingViews &= ~ParallelismView;
+    });
+    connect(this, &PerfParser::lockContentionDataAvailable, this, [this]() {
+        m_upToDateViews |= LockContentionView;
+        m_pendingViews &= ~LockContentionView;
     });
+    connect(this, &PerfParser::disassemblyCostsAvailable, this,
+            [this](const Data::Symbol& symbol, const Data::DisassemblyEntry& costs) {
+                if (m_pendingDisassemblyCosts.remove(symbol)) {
+                    m_disassemblyCosts.insert(symbol, costs);
+                }
+            });
     connect(this, &PerfParser::eventsAvailable, this, [this](const Data::EventResults& data) {
         if (m_events.threads.isEmpty()) {
             m_events = data;
         }
     });
+    // the results of a live recording replace the previous snapshot, the ones of appended files the previous costs
+    auto resetResults = [this]() {
+        m_bottomUpResults = {};
+        m_events = {};
+    };
+    connect(this, &PerfParser::liveSnapshotStarted, this, resetResults);
+    connect(this, &PerfParser::resultsReplaced, this, resetResults);
     connect(this, &PerfParser::parsingStarted, this, [this]() {
         m_isParsing = true;
         m_stopRequested = false;
     });
     connect(this, &PerfParser::parsingFailed, this, [this]() { m_isParsing = false; });
-    connect(this, &PerfParser::parsingFinished, this, [this]() { m_isParsing = false; });
+    connect(this, &PerfParser::parsingFinished, this, [this]() {
+        m_isParsing = false;
+        // views that got watched and disassembly costs that got requested while parsing
+        computeOutdatedViews();
+        for (const auto& symbol : m_pendingDisassemblyCosts) {
+            computeDisassemblyCosts(symbol);
+        }
+    });
 }
 
 PerfParser::~PerfParser() = default;
 
-void PerfParser::startParseFile(const QString& path, const QString& sysroot, const QString& kallsyms,
-                                const QString& debugPaths, const QString& extraLibPaths, const QString& appPath,
-                                const QString& targetRoot, const QString& arch, const QString& disasmApproach,
-                                const QString& verbose, const QString& maxStack, const QString& branchTraverse)
+void PerfParser::setWatchedViews(DerivedViews views)
 {
-    Q_ASSERT(!m_isParsing);
+    m_watchedViews = views;
+    computeOutdatedViews();
+}
 
-    QFileInfo info(path);
-    if (!info.exists()) {
-        emit parsingFailed(tr("File '%1' does not exist.").arg(path));
+PerfParser::DerivedViews PerfParser::watchedViews() const
+{
+    return DerivedViews(m_watchedViews.load());
+}
+
+void PerfParser::invalidateViews(DerivedViews views)
+{
+    m_upToDateViews &= ~views;
+    m_pendingViews &= ~views;
+    ++m_resultsGeneration;
+}
+
+void PerfParser::invalidateDisassemblyCosts()
+{
+    m_disassemblyCosts.clear();
+    m_pendingDisassemblyCosts.clear();
+    ++m_disassemblyGeneration;
+}
+
+void PerfParser::requestDisassemblyCosts(const Data::Symbol& symbol)
+{
+    auto it = m_disassemblyCosts.constFind(symbol);
+    if (it != m_disassemblyCosts.constEnd()) {
+        emit disassemblyCostsAvailable(symbol, it.value());
         return;
     }
-    if (!info.isFile()) {
-        emit parsingFailed(tr("'%1' is not a file.").arg(path));
+
+    if (m_pendingDisassemblyCosts.contains(symbol)) {
         return;
     }
-    if (!info.isReadable()) {
-        emit parsingFailed(tr("File '%1' is not readable.").arg(path));
-        return;
+    m_pendingDisassemblyCosts.insert(symbol);
+    if (!m_isParsing) {
+        // otherwise this is done once the parsing finished
+        computeDisassemblyCosts(symbol);
     }
+}
 
-    auto parserBinary = QString::fromLocal8Bit(qgetenv("HOTSPOT_PERFPARSER"));
-    if (parserBinary.isEmpty()) {
-        parserBinary = Util::findLibexecBinary(QStringLiteral("hotspot-perfparser"));
-    }
-    if (parserBinary.isEmpty()) {
-        emit parsingFailed(tr("Failed to find hotspot-perfparser binary."));
+void PerfParser::computeDisassemblyCosts(const Data::Symbol& symbol)
+{
+    QMutexLocker lock(&m_viewSourceMutex);
+    const auto bottomUp = m_disassemblyBottomUp;
+    const auto events = m_disassemblyEvents;
+    const auto disassembly = m_disassemblySource;
+    lock.unlock();
+
+    const uint generation = m_disassemblyGeneration;
+    using namespace ThreadWeaver;
+    stream() << make_job([this, symbol, bottomUp, events, disassembly, generation]() {
+        // with branch stacks, the costs had to be collected while parsing already
+        auto entry = disassembly.entries.isEmpty()
+            ? Data::disassemblyEntryFromEvents(symbol, bottomUp, events)
+            : disassembly.entries.value(symbol);
+        Data::addBranchCounts(symbol, bottomUp, disassembly, &entry);
+        if (generation != m_disassemblyGeneration) {
+            return;
+        }
+        emit disassemblyCostsAvailable(symbol, entry);
+    });
+}
+
+void PerfParser::requestCriticalPath(qint32 pid, qint32 tid, const Data::TimeRange& time)
+{
+    QMutexLocker lock(&m_viewSourceMutex);
+    const auto bottomUp = m_viewBottomUp;
+    const auto events = m_viewEvents;
+    lock.unlock();
+
+    const uint generation = m_resultsGeneration;
+    using namespace ThreadWeaver;
+    stream() << make_job([this, bottomUp, events, pid, tid, time, generation]() {
+        const auto path = Data::criticalPathFromEvents(bottomUp, events, pid, tid, time);
+        if (m_stopRequested || generation != m_resultsGeneration) {
+            return;
+        }
+        emit criticalPathAvailable(path);
+    });
+}
+
+void PerfParser::computeOutdatedViews()
+{
+    if (m_isParsing) {
+        // the new results will include the watched views
         return;
     }
 
-    QStringList parserArgs = {QStringLiteral("--input"), path, QStringLiteral("--max-frames"), QStringLiteral("1024")};
-    if (!sysroot.isEmpty()) {
-        parserArgs += {QStringLiteral("--sysroot"), sysroot};
+    const auto views = watchedViews() & ~m_upToDateViews & ~m_pendingViews;
+    if (!views) {
+        return;
     }
-    if (!kallsyms.isEmpty()) {
-        parserArgs += {QStringLiteral("--kallsyms"), kallsyms};
+    m_pendingViews |= views;
+
+    QMutexLocker lock(&m_viewSourceMutex);
+    const auto bottomUp = m_viewBottomUp;
+    const auto events = m_viewEvents;
+    lock.unlock();
+
+    const uint generation = m_resultsGeneration;
+    using namespace ThreadWeaver;
+    stream() << make_job([=]() { computeViews(bottomUp, events, views, generation); });
+}
+
+void PerfParser::computeViews(const Data::BottomUpResults& bottomUp, const Data::EventResults& events,
+                              DerivedViews views, uint generation)
+{
+    if (views & TopDownView) {
+        const auto topDown = Data::TopDownResults::fromBottomUp(bottomUp);
+        if (m_stopRequested || generation != m_resultsGeneration) {
+            return;
+        }
+        emit topDownDataAvailable(topDown);
     }
-    if (!debugPaths.isEmpty()) {
-        parserArgs += {QStringLiteral("--debug"), debugPaths};
+
+    if (views & CallerCalleeView) {
+        Data::CallerCalleeResults callerCallee;
+        addCallerCalleeEvents(bottomUp, events, &callerCallee);
+        Data::callerCalleesFromBottomUpData(bottomUp, &callerCallee);
+        if (m_stopRequested || generation != m_resultsGeneration) {
+            return;
+        }
+        emit callerCalleeDataAvailable(callerCallee);
     }
-    if (!extraLibPaths.isEmpty()) {
-        parserArgs += {QStringLiteral("--extra"), extraLibPaths};
+
+    if (views & OffCpuView) {
+        const auto offCpu = Data::offCpuResultsFromEvents(bottomUp, events);
+        if (m_stopRequested || generation != m_resultsGeneration) {
+            return;
+        }
+        emit offCpuDataAvailable(offCpu);
     }
-    if (!appPath.isEmpty()) {
+
+    if (views & ParallelismView) {
+        const auto parallelism = Data::parallelismResultsFromEvents(bottomUp, events);
+        if (m_stopRequested || generation != m_resultsGeneration) {
+            return;
+        }
+        emit parallelismDataAvailable(parallelism);
+    }
+
+    if (views & LockContentionView) {
+        const auto lockContention = Data::lockContentionFromEvents(bottomUp, events);
+        if (m_stopRequested || generation != m_resultsGeneration) {
+            return;
+        }
+        emit lockContentionDataAvailable(lockContention);
+    }
+}
+
+Data::DisassemblyResult PerfParser::disassemblySettings(const Data::BottomUpResults& bottomUp,
+                                                        const Data::DisassemblyResult& branchStackDisassembly) const
+{
+    // the costs get requested per symbol, see requestDisassemblyCosts
+    auto disassembly = branchStackDisassembly;
+    disassembly.entries.clear();
+    disassembly.branchEdges.clear();
+    disassembly.branchRanges.clear();
+    disassembly.copy(m_disassemblyResult);
+    disassembly.selfCosts.initializeCostsFrom(bottomUp.costs);
+    disassembly.inclusiveCosts.initializeCostsFrom(bottomUp.costs);
+    for (const auto& symbol : bottomUp.symbols) {
+        if (symbol.isValid()) {
+            disassembly.symbols.insert(symbol);
+        }
+    }
+    return disassembly;
+}
+
+void PerfParser::setViewSource(const Data::BottomUpResults& bottomUp, const Data::EventResults& events)
+{
+    QMutexLocker lock(&m_viewSourceMutex);
+    m_viewBottomUp = bottomUp;
+    m_viewEvents = events;
+}
+
+void PerfParser::setDisassemblySource(const Data::BottomUpResults& bottomUp, const Data::EventResults& events)
+{
+    QMutexLocker lock(&m_viewSourceMutex);
+    m_disassemblyBottomUp = bottomUp;
+    m_disassemblyEvents = events;
+}
+
+void PerfParser::setBranchStackDisassembly(const Data::DisassemblyResult& disassembly)
+{
+    QMutexLocker lock(&m_viewSourceMutex);
+    m_disassemblySource = disassembly;
+}
+
+namespace {
+QString findParserBinary()
+{
+    auto parserBinary = QString::fromLocal8Bit(qgetenv("HOTSPOT_PERFPARSER"));
+    if (parserBinary.isEmpty()) {
+        parserBinary = Util::findLibexecBinary(QStringLiteral("hotspot-perfparser"));
+    }
+    return parserBinary;
+}
+
+// the arguments of hotspot-perfparser except for its input
+QStringList parserArguments(const QString& sysroot, const QString& kallsyms, const QString& debugPaths,
+                            const QString& extraLibPaths, const QString& appPath, const QString& arch,
+                            const QString& verbose, const QString& maxStack, const QString& branchTraverse)
+{
+    QStringList parserArgs = {QStringLiteral("--max-frames"), QStringLiteral("1024")};
+    if (!sysroot.isEmpty()) {
+        parserArgs += {QStringLiteral("--sysroot"), sysroot};
+    }
+    if (!kallsyms.isEmpty()) {
+        parserArgs += {QStringLiteral("--kallsyms"), kallsyms};
+    }
+    if (!debugPaths.isEmpty()) {
+        parserArgs += {QStringLiteral("--debug"), debugPaths};
+    }
+    if (!extraLibPaths.isEmpty()) {
+        parserArgs += {QStringLiteral("--extra"), extraLibPaths};
+    }
+    if (!appPath.isEmpty()) {
         parserArgs += {QStringLiteral("--app"), appPath};
     }
     if (!arch.isEmpty()) {
@@ -1365,17 +2074,123 @@ void PerfParser::startParseFile(const QString& path, const QString& sysroot, con
     if (!branchTraverse.isEmpty()) {
         parserArgs += {QStringLiteral("--branch-traverse")};
     }
+    return parserArgs;
+}
+
+QString parserExitError(int exitCode)
+{
+    enum ErrorCodes
+    {
+        NoError,
+        TcpSocketError,
+        CannotOpen,
+        BadMagic,
+        HeaderError,
+        DataError,
+        MissingData,
+        InvalidOption
+    };
+    switch (exitCode) {
+    case NoError:
+        return {};
+    case TcpSocketError:
+        return PerfParser::tr("The hotspot-perfparser binary exited with code %1 (TCP socket error).").arg(exitCode);
+    case CannotOpen:
+        return PerfParser::tr("The hotspot-perfparser binary exited with code %1 (file could not be opened).")
+            .arg(exitCode);
+    case BadMagic:
+    case HeaderError:
+    case DataError:
+    case MissingData:
+        return PerfParser::tr("The hotspot-perfparser binary exited with code %1 (invalid perf data file).")
+            .arg(exitCode);
+    case InvalidOption:
+        return PerfParser::tr("The hotspot-perfparser binary exited with code %1 (invalid option).").arg(exitCode);
+    default:
+        return PerfParser::tr("The hotspot-perfparser binary exited with code %1.").arg(exitCode);
+    }
+}
+}
+
+void PerfParser::startParseFile(const QString& path, const QString& sysroot, const QString& kallsyms,
+                                const QString& debugPaths, const QString& extraLibPaths, const QString& appPath,
+                                const QString& targetRoot, const QString& arch, const QString& disasmApproach,
+                                const QString& verbose, const QString& maxStack, const QString& branchTraverse)
+{
+    Q_ASSERT(!m_isParsing);
+    m_aggregate.reset();
+    m_comparison.reset();
+
+    QFileInfo info(path);
+    if (!info.exists()) {
+        emit parsingFailed(tr("File '%1' does not exist.").arg(path));
+        return;
+    }
+    // perf record --threads writes a directory, with the header in its data file
+    if (!info.isFile() && !(info.isDir() && QFileInfo(QDir(path).filePath(QStringLiteral("data"))).isFile())) {
+        emit parsingFailed(tr("'%1' is not a file.").arg(path));
+        return;
+    }
+    if (!info.isReadable()) {
+        emit parsingFailed(tr("File '%1' is not readable.").arg(path));
+        return;
+    }
+
+    const auto parserBinary = findParserBinary();
+    if (parserBinary.isEmpty()) {
+        emit parsingFailed(tr("Failed to find hotspot-perfparser binary."));
+        return;
+    }
+
+    const auto parserArgs = QStringList {QStringLiteral("--input"), path}
+        + parserArguments(sysroot, kallsyms, debugPaths, extraLibPaths, appPath, arch, verbose, maxStack,
+                          branchTraverse);
 
     // reset the data to ensure filtering will pick up the new data
+    m_summary = {};
     m_bottomUpResults = {};
-    m_callerCalleeResults = {};
     m_events = {};
     m_disassemblyResult = {};
     m_disassemblyResult.setData(path, appPath, targetRoot, extraLibPaths, arch, disasmApproach, !branchTraverse.isEmpty());
+    invalidateViews(AllViews);
+    invalidateDisassemblyCosts();
+
+    // a new parser binary may resolve symbols differently, so it invalidates the cached results too
+    const auto cacheKey = parserArgs
+        + QStringList {parserBinary, QFileInfo(parserBinary).lastModified().toString(Qt::ISODate)};
+    const bool writeCache = m_writeResultsCache;
+
+    const auto views = watchedViews();
+    const uint generation = m_resultsGeneration;
+    // emits the derived views before parsingFinished, so that they are complete once the parsing finished
+    auto emitResults = [this, views, generation](const Data::Summary& summary, const Data::BottomUpResults& bottomUp,
+                                                 const Data::EventResults& events,
+                                                 const Data::DisassemblyResult& branchStackDisassembly) {
+        setViewSource(bottomUp, events);
+        setDisassemblySource(bottomUp, events);
+        setBranchStackDisassembly(branchStackDisassembly);
+
+        emit bottomUpDataAvailable(bottomUp);
+        emit summaryDataAvailable(summary);
+        computeViews(bottomUp, events, views, generation);
+        emit disassemblyDataAvailable(disassemblySettings(bottomUp, branchStackDisassembly));
+        emit eventsAvailable(events);
+        emit parsingFinished();
+    };
 
     emit parsingStarted();
     using namespace ThreadWeaver;
-    stream() << make_job([parserBinary, parserArgs, this]() {
+    stream() << make_job([parserBinary, parserArgs, path, cacheKey, writeCache, emitResults, this]() {
+        const auto cacheFile = ResultsCache::cacheFile(path, cacheKey);
+        if (!cacheFile.isEmpty()) {
+            ResultsCache::Results cached;
+            if (ResultsCache::read(cacheFile, &cached)) {
+                qCDebug(LOG_PERFPARSER) << "using cached results from" << cacheFile;
+                emitResults(cached.summary, cached.bottomUp, cached.events, cached.disassembly);
+                return;
+            }
+        }
+
         PerfParserPrivate d;
         connect(&d, &PerfParserPrivate::progress, this, &PerfParser::progress);
         connect(this, &PerfParser::stopRequested, &d, &PerfParserPrivate::stop);
@@ -1387,62 +2202,27 @@ void PerfParser::startParseFile(const QString& path, const QString& sysroot, con
         });
 
         connect(&d.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), &d.process,
-                [&d, this](int exitCode, QProcess::ExitStatus exitStatus) {
+                [&d, &cacheFile, writeCache, &emitResults, this](int exitCode, QProcess::ExitStatus exitStatus) {
                     if (m_stopRequested) {
                         emit parsingFailed(tr("Parsing stopped."));
                         return;
                     }
                     qCDebug(LOG_PERFPARSER) << exitCode << exitStatus;
 
-                    enum ErrorCodes
-                    {
-                        NoError,
-                        TcpSocketError,
-                        CannotOpen,
-                        BadMagic,
-                        HeaderError,
-                        DataError,
-                        MissingData,
-                        InvalidOption
-                    };
-                    switch (exitCode) {
-                    case NoError:
-                        d.finalize();
-                        emit bottomUpDataAvailable(d.bottomUpResult);
-                        emit topDownDataAvailable(d.topDownResult);
-                        emit summaryDataAvailable(d.summaryResult);
-
-                        d.disassemblyResult.copy(m_disassemblyResult);
-                        emit disassemblyDataAvailable(d.disassemblyResult);
-
-                        emit callerCalleeDataAvailable(d.callerCalleeResult);
-                        emit eventsAvailable(d.eventResult);
-                        emit parsingFinished();
-                        break;
-                    case TcpSocketError:
-                        emit parsingFailed(
-                            tr("The hotspot-perfparser binary exited with code %1 (TCP socket error).").arg(exitCode));
-                        break;
-                    case CannotOpen:
-                        emit parsingFailed(
-                            tr("The hotspot-perfparser binary exited with code %1 (file could not be opened).")
-                                .arg(exitCode));
-                        break;
-                    case BadMagic:
-                    case HeaderError:
-                    case DataError:
-                    case MissingData:
-                        emit parsingFailed(
-                            tr("The hotspot-perfparser binary exited with code %1 (invalid perf data file).")
-                                .arg(exitCode));
-                        break;
-                    case InvalidOption:
-                        emit parsingFailed(
-                            tr("The hotspot-perfparser binary exited with code %1 (invalid option).").arg(exitCode));
-                        break;
-                    default:
-                        emit parsingFailed(tr("The hotspot-perfparser binary exited with code %1.").arg(exitCode));
-                        break;
+                    const auto error = parserExitError(exitCode);
+                    if (!error.isEmpty()) {
+                        emit parsingFailed(error);
+                        return;
+                    }
+
+                    d.finalize();
+                    emitResults(d.summaryResult, d.bottomUpResult, d.eventResult, d.disassemblyResult);
+
+                    // only the disassembly costs of branch stacks get cached, the rest is cheap to derive
+                    if (writeCache && !cacheFile.isEmpty()
+                        && ResultsCache::write(cacheFile, {d.summaryResult, d.bottomUpResult, d.eventResult,
+                                                           d.disassemblyResult})) {
+                        ResultsCache::prune(MAX_CACHED_RESULTS);
                     }
                 });
 
@@ -1470,17 +2250,451 @@ void PerfParser::startParseFile(const QString& path, const QString& sysroot, con
     });
 }
 
+void PerfParser::startParseLive(const QString& sysroot, const QString& kallsyms, const QString& debugPaths,
+                                const QString& extraLibPaths, const QString& appPath, const QString& targetRoot,
+                                const QString& arch, const QString& disasmApproach, const QString& verbose,
+                                const QString& maxStack, const QString& branchTraverse)
+{
+    Q_ASSERT(!m_isParsing);
+    m_aggregate.reset();
+    m_comparison.reset();
+
+    const auto parserBinary = findParserBinary();
+    if (parserBinary.isEmpty()) {
+        emit parsingFailed(tr("Failed to find hotspot-perfparser binary."));
+        return;
+    }
+
+    // without an input file the parser reads the perf data from its stdin
+    const auto parserArgs = parserArguments(sysroot, kallsyms, debugPaths, extraLibPaths, appPath, arch, verbose,
+                                            maxStack, branchTraverse);
+
+    m_summary = {};
+    m_bottomUpResults = {};
+    m_events = {};
+    m_disassemblyResult = {};
+    m_disassemblyResult.setData({}, appPath, targetRoot, extraLibPaths, arch, disasmApproach,
+                                !branchTraverse.isEmpty());
+    invalidateViews(AllViews);
+    invalidateDisassemblyCosts();
+    {
+        QMutexLocker lock(&m_liveInputMutex);
+        m_liveInput.clear();
+        m_liveInputFinished = false;
+    }
+
+    const int updateInterval = Settings::instance()->liveUpdateInterval();
+    const quint64 window = Settings::instance()->liveWindow() * 1000000000ull;
+    const quint64 costWindow = Settings::instance()->liveCostWindow() * 1000000000ull;
+    const uint generation = m_resultsGeneration;
+    // like the results of startParseFile, but the views are computed for the views watched at the time
+    auto emitResults = [this, generation](const Data::Summary& summary, const Data::BottomUpResults& bottomUp,
+                                          const Data::EventResults& events,
+                                          const Data::DisassemblyResult& branchStackDisassembly) {
+        setViewSource(bottomUp, events);
+        setDisassemblySource(bottomUp, events);
+        setBranchStackDisassembly(branchStackDisassembly);
+
+        emit liveSnapshotStarted();
+        emit bottomUpDataAvailable(bottomUp);
+        emit summaryDataAvailable(summary);
+        computeViews(bottomUp, events, watchedViews(), generation);
+        emit disassemblyDataAvailable(disassemblySettings(bottomUp, branchStackDisassembly));
+        emit eventsAvailable(events);
+    };
+
+    emit parsingStarted();
+    using namespace ThreadWeaver;
+    stream() << make_job([parserBinary, parserArgs, updateInterval, window, costWindow, emitResults, this]() {
+        PerfParserPrivate d;
+        // the costs are evicted in slices of a tenth of the window
+        Data::RollingCosts rollingCosts(costWindow / 10, 10);
+        connect(this, &PerfParser::stopRequested, &d, &PerfParserPrivate::stop);
+
+        connect(&d.process, &QProcess::readyRead, &d.process, [&d] {
+            while (d.tryParse()) {
+                // just call tryParse until it fails
+            }
+        });
+
+        // the input is queued by addLiveInput from the main thread and written to the parser from this one
+        auto writeInput = [&d, this]() {
+            QMutexLocker lock(&m_liveInputMutex);
+            if (!m_liveInput.isEmpty()) {
+                d.process.write(m_liveInput);
+                m_liveInput.clear();
+            }
+            if (m_liveInputFinished) {
+                d.process.closeWriteChannel();
+            }
+        };
+        connect(this, &PerfParser::liveInputAvailable, &d.process, writeInput);
+
+        QTimer snapshotTimer;
+        snapshotTimer.setInterval(updateInterval);
+        quint64 snapshotSamples = 0;
+        auto takeSnapshot = [&d, &snapshotSamples, &rollingCosts, window, emitResults]() {
+            if (d.summaryResult.sampleCount == snapshotSamples) {
+                // nothing new since the last snapshot
+                return;
+            }
+            snapshotSamples = d.summaryResult.sampleCount;
+            rollingCosts.update(d.applicationTime.end, &d.bottomUpResult);
+
+            Data::Summary summary;
+            Data::BottomUpResults bottomUp;
+            Data::EventResults events;
+            d.snapshot(&summary, &bottomUp, &events);
+            emitResults(summary, bottomUp, events, d.disassemblyResult);
+
+            // the events only cover the most recent window, see Settings::liveWindow
+            if (d.applicationTime.end > window) {
+                d.dropEventsBefore(d.applicationTime.end - window);
+            }
+        };
+        connect(&snapshotTimer, &QTimer::timeout, &d.process, takeSnapshot);
+
+        connect(&d.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), &d.process,
+                [&d, &snapshotTimer, &emitResults, this](int exitCode, QProcess::ExitStatus exitStatus) {
+                    snapshotTimer.stop();
+                    if (m_stopRequested) {
+                        emit parsingFailed(tr("Parsing stopped."));
+                        return;
+                    }
+                    qCDebug(LOG_PERFPARSER) << exitCode << exitStatus;
+
+                    const auto error = parserExitError(exitCode);
+                    if (!error.isEmpty()) {
+                        emit parsingFailed(error);
+                        return;
+                    }
+
+                    d.finalize();
+                    emitResults(d.summaryResult, d.bottomUpResult, d.eventResult, d.disassemblyResult);
+                    emit parsingFinished();
+                });
+
+        connect(&d.process, &QProcess::errorOccurred, &d.process, [&d, this](QProcess::ProcessError error) {
+            if (m_stopRequested) {
+                emit parsingFailed(tr("Parsing stopped."));
+                return;
+            }
+
+            qCWarning(LOG_PERFPARSER) << error << d.process.errorString();
+
+            emit parsingFailed(d.process.errorString());
+        });
+
+        d.process.start(parserBinary, parserArgs);
+        if (!d.process.waitForStarted()) {
+            emit parsingFailed(tr("Failed to start the hotspot-perfparser process"));
+            return;
+        }
+        // input that got queued before the connection above was made
+        writeInput();
+        snapshotTimer.start();
+
+        QEventLoop loop;
+        connect(&d.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), &loop,
+                &QEventLoop::quit);
+        loop.exec();
+    });
+}
+
+void PerfParser::addLiveInput(const QByteArray& data)
+{
+    {
+        QMutexLocker lock(&m_liveInputMutex);
+        m_liveInput.append(data);
+    }
+    emit liveInputAvailable();
+}
+
+void PerfParser::finishLiveInput()
+{
+    {
+        QMutexLocker lock(&m_liveInputMutex);
+        m_liveInputFinished = true;
+    }
+    emit liveInputAvailable();
+}
+
+namespace {
+/**
+ * Map symbols of the same binary to a single symbol, even when the binary was found at different paths.
+ */
+class SymbolUnifier
+{
+public:
+    Data::Symbol unify(const Data::Symbol& symbol, const QHash<QString, QByteArray>& buildIds)
+    {
+        const auto buildId = buildIds.value(symbol.path);
+        if (buildId.isEmpty()) {
+            return symbol;
+        }
+        const auto key = qMakePair(buildId, symbol.symbol);
+        auto it = m_symbols.constFind(key);
+        if (it == m_symbols.constEnd()) {
+            it = m_symbols.insert(key, symbol);
+        }
+        return it.value();
+    }
+
+private:
+    QHash<QPair<QByteArray, QString>, Data::Symbol> m_symbols;
+};
+
+void mergeSummary(const Data::Summary& summary, bool isFirst, Data::Summary* aggregated)
+{
+    if (isFirst) {
+        // the system information of the first file is used for the aggregate
+        const auto errors = aggregated->errors;
+        *aggregated = summary;
+        aggregated->errors = errors + summary.errors;
+        return;
+    }
+
+    aggregated->applicationRunningTime += summary.applicationRunningTime;
+    aggregated->threadCount += summary.threadCount;
+    aggregated->processCount += summary.processCount;
+    aggregated->lostChunks += summary.lostChunks;
+    aggregated->lostEvents += summary.lostEvents;
+    for (const auto& losses : summary.lostPerCpu) {
+        auto it = std::lower_bound(
+            aggregated->lostPerCpu.begin(), aggregated->lostPerCpu.end(), losses.cpuId,
+            [](const Data::CpuLosses& entry, quint32 cpuId) { return entry.cpuId < cpuId; });
+        if (it == aggregated->lostPerCpu.end() || it->cpuId != losses.cpuId) {
+            aggregated->lostPerCpu.insert(it, losses);
+        } else {
+            it->lostChunks += losses.lostChunks;
+            it->lostEvents += losses.lostEvents;
+            it->sampleCount += losses.sampleCount;
+        }
+    }
+    aggregated->onCpuTime += summary.onCpuTime;
+    aggregated->offCpuTime += summary.offCpuTime;
+    aggregated->sampleCount += summary.sampleCount;
+    for (const auto& cost : summary.costs) {
+        auto it = std::find_if(aggregated->costs.begin(), aggregated->costs.end(),
+                               [&cost](const Data::CostSummary& c) { return c.label == cost.label; });
+        if (it == aggregated->costs.end()) {
+            aggregated->costs.append(cost);
+        } else {
+            it->sampleCount += cost.sampleCount;
+            it->totalPeriod += cost.totalPeriod;
+        }
+    }
+    for (const auto& error : summary.errors) {
+        if (!aggregated->errors.contains(error)) {
+            aggregated->errors.append(error);
+        }
+    }
+}
+}
+
+struct PerfParser::FileAggregate
+{
+    QMutex mutex;
+    int pending = 0;
+    int merged = 0;
+    QVector<float> progress;
+    Data::Summary summary;
+    Data::BottomUpResults bottomUp;
+    // shared by all files, so that the symbols of a binary are the same in every one of them
+    SymbolUnifier symbols;
+    // of the latest files, their results include the views that were watched then
+    DerivedViews views;
+    uint generation = 0;
+};
+
+struct PerfParser::Comparison
+{
+    Data::BottomUpResults bottomUp;
+    Data::Summary summary;
+    Data::DiffNormalization normalization;
+};
+
+void PerfParser::startParseFiles(const QStringList& paths, const QString& sysroot, const QString& kallsyms,
+                                 const QString& debugPaths, const QString& extraLibPaths, const QString& appPath,
+                                 const QString& targetRoot, const QString& arch, const QString& disasmApproach,
+                                 const QString& verbose, const QString& maxStack, const QString& branchTraverse)
+{
+    Q_ASSERT(!m_isParsing);
+
+    if (paths.size() == 1) {
+        startParseFile(paths.first(), sysroot, kallsyms, debugPaths, extraLibPaths, appPath, targetRoot, arch,
+                       disasmApproach, verbose, maxStack, branchTraverse);
+        return;
+    }
+
+    m_summary = {};
+    m_bottomUpResults = {};
+    m_events = {};
+    m_disassemblyResult = {};
+    m_aggregate = std::make_shared<FileAggregate>();
+    parseFiles(paths, sysroot, kallsyms, debugPaths, extraLibPaths, appPath, targetRoot, arch, disasmApproach,
+               verbose, maxStack, branchTraverse);
+}
+
+void PerfParser::appendParseFiles(const QStringList& paths, const QString& sysroot, const QString& kallsyms,
+                                  const QString& debugPaths, const QString& extraLibPaths, const QString& appPath,
+                                  const QString& targetRoot, const QString& arch, const QString& disasmApproach,
+                                  const QString& verbose, const QString& maxStack, const QString& branchTraverse)
+{
+    if (!m_aggregate) {
+        m_summary = {};
+        m_bottomUpResults = {};
+        m_events = {};
+        m_disassemblyResult = {};
+        m_aggregate = std::make_shared<FileAggregate>();
+    }
+    parseFiles(paths, sysroot, kallsyms, debugPaths, extraLibPaths, appPath, targetRoot, arch, disasmApproach,
+               verbose, maxStack, branchTraverse);
+}
+
+void PerfParser::parseFiles(const QStringList& paths, const QString& sysroot, const QString& kallsyms,
+                            const QString& debugPaths, const QString& extraLibPaths, const QString& appPath,
+                            const QString& targetRoot, const QString& arch, const QString& disasmApproach,
+                            const QString& verbose, const QString& maxStack, const QString& branchTraverse)
+{
+    if (paths.isEmpty()) {
+        return;
+    }
+
+    invalidateViews(AllViews);
+    invalidateDisassemblyCosts();
+    m_comparison.reset();
+
+    if (!m_mergeQueue) {
+        // the results of a file are only freed once they got merged, queued behind the parses of all other files
+        // they would all stay in memory at once
+        m_mergeQueue.reset(new ThreadWeaver::Queue);
+        m_mergeQueue->setMaximumNumberOfThreads(1);
+    }
+    auto mergeQueue = m_mergeQueue.get();
+
+    auto aggregate = m_aggregate;
+    bool isRunning = false;
+    int firstProgress = 0;
+    {
+        QMutexLocker lock(&aggregate->mutex);
+        // files appended while others are still parsed get merged into the same results
+        isRunning = aggregate->pending > 0;
+        if (!isRunning) {
+            aggregate->progress.clear();
+        }
+        firstProgress = aggregate->progress.size();
+        aggregate->pending += paths.size();
+        aggregate->progress.resize(firstProgress + paths.size());
+        aggregate->views = watchedViews();
+        aggregate->generation = m_resultsGeneration;
+    }
+
+    // called from a background job once all files got merged, with the aggregate locked
+    auto finish = [this, aggregate]() {
+        if (m_stopRequested) {
+            emit parsingFailed(tr("Parsing stopped."));
+            return;
+        } else if (!aggregate->merged) {
+            emit parsingFailed(aggregate->summary.errors.join(QLatin1Char('\n')));
+            return;
+        }
+        auto summary = aggregate->summary;
+        if (aggregate->merged > 1) {
+            summary.command = tr("%1 (aggregated from %2 files)").arg(summary.command).arg(aggregate->merged);
+        }
+
+        // without events there are no per-instruction costs
+        setViewSource(aggregate->bottomUp, {});
+        setDisassemblySource(aggregate->bottomUp, {});
+        setBranchStackDisassembly({});
+        // the costs of appended files replace the previous results
+        emit resultsReplaced();
+        emit bottomUpDataAvailable(aggregate->bottomUp);
+        emit summaryDataAvailable(summary);
+        computeViews(aggregate->bottomUp, {}, aggregate->views, aggregate->generation);
+        emit eventsAvailable({});
+        emit parsingFinished();
+    };
+
+    if (!isRunning) {
+        emit parsingStarted();
+    }
+    for (int i = 0; i < paths.size(); ++i) {
+        // every parser runs its own job, so the files get parsed in parallel
+        auto parser = new PerfParser(this);
+        parser->setWatchedViews({});
+        // only the aggregate is shown, caching every file would just evict the results of the files opened on their own
+        parser->m_writeResultsCache = false;
+        connect(this, &PerfParser::stopRequested, parser, &PerfParser::stop);
+        const int progressIndex = firstProgress + i;
+        connect(parser, &PerfParser::progress, this, [this, aggregate, progressIndex](float progress) {
+            if (progressIndex < aggregate->progress.size()) {
+                aggregate->progress[progressIndex] = progress;
+            }
+            emit this->progress(std::accumulate(aggregate->progress.begin(), aggregate->progress.end(), 0.f)
+                                / aggregate->progress.size());
+        });
+
+        auto summary = std::make_shared<Data::Summary>();
+        auto bottomUp = std::make_shared<Data::BottomUpResults>();
+        connect(parser, &PerfParser::summaryDataAvailable, this,
+                [summary](const Data::Summary& data) { *summary = data; });
+        connect(parser, &PerfParser::bottomUpDataAvailable, this,
+                [bottomUp](const Data::BottomUpResults& data) { *bottomUp = data; });
+
+        auto merge = [parser, mergeQueue, aggregate, summary, bottomUp, finish](const QString& errorMessage) {
+            parser->deleteLater();
+            using namespace ThreadWeaver;
+            QueueStream(mergeQueue) << make_job([aggregate, summary, bottomUp, finish, errorMessage]() {
+                QMutexLocker lock(&aggregate->mutex);
+                if (errorMessage.isEmpty()) {
+                    mergeSummary(*summary, aggregate->merged++ == 0, &aggregate->summary);
+                    const auto& buildIds = summary->buildIds;
+                    aggregate->bottomUp.merge(*bottomUp, [aggregate, &buildIds](const Data::Symbol& symbol) {
+                        return aggregate->symbols.unify(symbol, buildIds);
+                    });
+                    // free the per-file data early, we only need the aggregate from here on
+                    *bottomUp = {};
+                } else {
+                    aggregate->summary.errors.append(errorMessage);
+                }
+                if (--aggregate->pending == 0) {
+                    finish();
+                }
+            });
+        };
+        connect(parser, &PerfParser::parsingFinished, this, [merge]() { merge({}); });
+        const auto path = paths.at(i);
+        connect(parser, &PerfParser::parsingFailed, this, [merge, path](const QString& errorMessage) {
+            merge(PerfParser::tr("Failed to parse %1: %2").arg(path, errorMessage));
+        });
+
+        parser->startParseFile(paths.at(i), sysroot, kallsyms, debugPaths, extraLibPaths, appPath, targetRoot, arch,
+                               disasmApproach, verbose, maxStack, branchTraverse);
+    }
+}
+
 void PerfParser::filterResults(const Data::FilterAction& filter)
 {
     Q_ASSERT(!m_isParsing);
 
+    // the filtered costs are rebuilt from the events, without them e.g. for aggregated files we keep the costs as is
+    if (m_events.threads.isEmpty()) {
+        return;
+    }
+
+    invalidateViews(AllViews);
+    invalidateDisassemblyCosts();
+    const auto views = watchedViews();
+    const uint generation = m_resultsGeneration;
+    const auto comparison = m_comparison;
+
     emit parsingStarted();
     using namespace ThreadWeaver;
-    stream() << make_job([this, filter]() {
+    stream() << make_job([this, filter, views, generation, comparison]() {
         Data::BottomUpResults bottomUp;
         Data::EventResults events = m_events;
-        Data::CallerCalleeResults callerCallee;
-        Data::DisassemblyResult disassembly = m_disassemblyResult;
         const bool filterByTime = filter.time.isValid();
         const bool filterByCpu = filter.cpuId != std::numeric_limits<quint32>::max();
         const bool excludeByCpu = !filter.excludeCpuIds.isEmpty();
@@ -1490,19 +2704,23 @@ void PerfParser::filterResults(const Data::FilterAction& filter)
 
         if (!filter.isValid()) {
             bottomUp = m_bottomUpResults;
-            callerCallee = m_callerCalleeResults;
         } else {
             bottomUp.symbols = m_bottomUpResults.symbols;
             bottomUp.locations = m_bottomUpResults.locations;
             bottomUp.costs.initializeCostsFrom(m_bottomUpResults.costs);
             bottomUp.costs.clearTotalCost();
-            const int numCosts = m_bottomUpResults.costs.numTypes();
 
             bottomUp.incompleteCallchains.initializeFrom(m_bottomUpResults.incompleteCallchains);
 
             // rebuild per-CPU data, i.e. wipe all the events and then re-add them
             for (auto& cpu : events.cpus) {
                 cpu.events.clear();
+                if (filterByTime) {
+                    auto it = std::remove_if(cpu.lost.begin(), cpu.lost.end(), [filter](const Data::LostEvents& lost) {
+                        return lost.time.end < filter.time.start || lost.time.start > filter.time.end;
+                    });
+                    cpu.lost.erase(it, cpu.lost.end());
+                }
             }
 
             // we filter all available stacks and then remember the stack ids that should be
@@ -1567,21 +2785,37 @@ void PerfParser::filterResults(const Data::FilterAction& filter)
                     return;
                 }
 
-                // add event data to cpus, bottom up and caller callee sets
+                // add event data to cpus and bottom up, the caller callee data is derived on demand
                 for (const auto& event : thread.events) {
                     // only add non-time events to the cpu line, context switches shouldn't show up there
                     if (event.type != events.offCpuTimeCostId) {
                         events.cpus[event.cpuId].events.push_back(event);
                     }
 
-                    QSet<Data::Symbol> recursionGuard;
-                    auto frameCallback = [&callerCallee, &recursionGuard, &event, numCosts](const Data::Symbol& symbol, const Data::Location& location) {
-                        addCallerCalleeEvent(symbol, location, event.type, event.cost, &recursionGuard, &callerCallee,
-                                             numCosts);
-                    };
+                    bottomUp.addEvent(event.type, event.cost, events.stacks.at(event.stackId), false,
+                                      [](const Data::Symbol&, const Data::Location&) {});
+                }
+            }
 
-                    bottomUp.addEvent(event.type, event.cost, events.stacks.at(event.stackId), false, frameCallback);
+            // the tracepoint samples don't keep their stacks, the symbol filters don't apply to them
+            for (auto& tracePoint : events.tracePoints) {
+                QVector<int> rows;
+                rows.reserve(tracePoint.size());
+                for (int row = 0, c = tracePoint.size(); row < c; ++row) {
+                    const auto pid = tracePoint.pids.at(row);
+                    const auto tid = tracePoint.tids.at(row);
+                    const auto cpuId = tracePoint.cpuIds.at(row);
+                    if ((filterByTime && !filter.time.contains(tracePoint.times.at(row)))
+                        || (filter.processId != Data::INVALID_PID && pid != filter.processId)
+                        || (filter.threadId != Data::INVALID_TID && tid != filter.threadId)
+                        || filter.excludeProcessIds.contains(pid) || filter.excludeThreadIds.contains(tid)
+                        || (filterByCpu && cpuId != filter.cpuId)
+                        || (excludeByCpu && filter.excludeCpuIds.contains(cpuId))) {
+                        continue;
+                    }
+                    rows.append(row);
                 }
+                tracePoint = tracePoint.selected(rows);
             }
 
             // remove threads that have no events within the selected time span
@@ -1590,14 +2824,6 @@ void PerfParser::filterResults(const Data::FilterAction& filter)
             events.threads.erase(it, events.threads.end());
 
             Data::BottomUp::initializeParents(&bottomUp.root);
-
-            if (m_stopRequested) {
-                emit parsingFailed(tr("Parsing stopped."));
-                return;
-            }
-
-            // TODO: parallelize
-            Data::callerCalleesFromBottomUpData(bottomUp, &callerCallee);
         }
 
         if (m_stopRequested) {
@@ -1605,23 +2831,71 @@ void PerfParser::filterResults(const Data::FilterAction& filter)
             return;
         }
 
-        const auto topDown = Data::TopDownResults::fromBottomUp(bottomUp);
+        setDisassemblySource(bottomUp, events);
+        if (comparison) {
+            // keep comparing, now with the filtered costs of the parsed file
+            const auto diff = Data::BottomUpResults::diff(bottomUp, comparison->bottomUp, comparison->normalization,
+                                                          m_summary.costs, comparison->summary.costs);
+            setViewSource(diff, {});
+            emit bottomUpDataAvailable(diff);
+            computeViews(diff, {}, views, generation);
+        } else {
+            setViewSource(bottomUp, events);
+            emit bottomUpDataAvailable(bottomUp);
+            computeViews(bottomUp, events, views, generation);
+        }
+        emit eventsAvailable(events);
+        emit parsingFinished();
+    });
+}
+
+void PerfParser::compareWith(const Data::BottomUpResults& compared, const Data::Summary& comparedSummary,
+                             Data::DiffNormalization normalization)
+{
+    Q_ASSERT(!m_isParsing);
 
+    // the disassembly keeps showing the costs of the parsed file
+    invalidateViews(AllViews);
+    const auto views = watchedViews();
+    const uint generation = m_resultsGeneration;
+
+    // filterResults applies the comparison again to the newly filtered costs
+    auto comparison = std::make_shared<Comparison>();
+    comparison->bottomUp = compared;
+    comparison->summary = comparedSummary;
+    comparison->normalization = normalization;
+    m_comparison = comparison;
+
+    emit parsingStarted();
+    using namespace ThreadWeaver;
+    stream() << make_job([this, comparison, views, generation]() {
+        // the disassembly source holds the costs of the parsed file after the latest filter
+        Data::BottomUpResults filtered;
+        {
+            QMutexLocker lock(&m_viewSourceMutex);
+            filtered = m_disassemblyBottomUp;
+        }
+        const auto bottomUp = Data::BottomUpResults::diff(filtered, comparison->bottomUp, comparison->normalization,
+                                                          m_summary.costs, comparison->summary.costs);
         if (m_stopRequested) {
             emit parsingFailed(tr("Parsing stopped."));
             return;
         }
 
+        // the events refer to the ids of the parsed file and thus can't contribute to the differences, which
+        // leaves the views derived from them empty, as well as the source maps of the caller/callee data
+        setViewSource(bottomUp, {});
         emit bottomUpDataAvailable(bottomUp);
-        emit topDownDataAvailable(topDown);
-        emit callerCalleeDataAvailable(callerCallee);
-        emit eventsAvailable(events);
+        computeViews(bottomUp, {}, views, generation);
         emit parsingFinished();
     });
 }
 
 void PerfParser::stop()
 {
+    // files appended later on start over rather than joining the stopped ones
+    m_aggregate.reset();
+    m_comparison.reset();
     m_stopRequested = true;
     emit stopRequested();
 }
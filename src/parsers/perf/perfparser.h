@@ -29,10 +29,15 @@
 
 #include <atomic>
 #include <memory>
+#include <QMutex>
 #include <QObject>
 
 #include <models/data.h>
 
+namespace ThreadWeaver {
+class Queue;
+}
+
 // TODO: create a parser interface
 class PerfParser : public QObject
 {
@@ -41,13 +46,97 @@ public:
     explicit PerfParser(QObject* parent = nullptr);
     ~PerfParser();
 
+    /**
+     * The data of these views is derived from the bottom-up data and only computed while someone watches it.
+     *
+     * Results that arrive while a view is watched include its data, other views are computed in the background
+     * once they get watched, their data then gets emitted through the usual signals. By default all views
+     * are watched.
+     */
+    enum DerivedView
+    {
+        TopDownView = 0x1,
+        CallerCalleeView = 0x2,
+        // the off-CPU time split by why the threads waited, needs the events
+        OffCpuView = 0x4,
+        // how many threads ran at once, needs the events
+        ParallelismView = 0x8,
+        // the off-CPU time spent waiting for locks, needs the events
+        LockContentionView = 0x10,
+        AllViews = TopDownView | CallerCalleeView | OffCpuView | ParallelismView | LockContentionView
+    };
+    Q_DECLARE_FLAGS(DerivedViews, DerivedView)
+
+    void setWatchedViews(DerivedViews views);
+    DerivedViews watchedViews() const;
+
     void startParseFile(const QString& path, const QString& sysroot, const QString& kallsyms, const QString& debugPaths,
                         const QString& extraLibPaths, const QString& appPath, const QString& targetRoot,
                         const QString& arch, const QString& disasmApproach, const QString& verbose,
                         const QString& maxStack, const QString& branchTraverse);
 
+    // parse all files in parallel and aggregate their costs, the per-event data is not available then
+    void startParseFiles(const QStringList& paths, const QString& sysroot, const QString& kallsyms,
+                         const QString& debugPaths, const QString& extraLibPaths, const QString& appPath,
+                         const QString& targetRoot, const QString& arch, const QString& disasmApproach,
+                         const QString& verbose, const QString& maxStack, const QString& branchTraverse);
+
+    /**
+     * Parse more files and merge their costs into the ones of the files parsed by previous calls, e.g. the segments
+     * that 'perf record --switch-output' rotates out while recording.
+     *
+     * Files added while others are still parsed join their batch. The merged results of all files so far are emitted
+     * through the usual signals, preceded by resultsReplaced, the symbols stay the same across the files.
+     * Starts a new aggregate when none of the previous parses was started by startParseFiles or appendParseFiles.
+     */
+    void appendParseFiles(const QStringList& paths, const QString& sysroot, const QString& kallsyms,
+                          const QString& debugPaths, const QString& extraLibPaths, const QString& appPath,
+                          const QString& targetRoot, const QString& arch, const QString& disasmApproach,
+                          const QString& verbose, const QString& maxStack, const QString& branchTraverse);
+
+    /**
+     * Parse perf data while it is recorded, e.g. the output of 'perf record -o -' fed in through addLiveInput.
+     *
+     * Snapshots of the results are emitted through the usual signals every Settings::liveUpdateInterval, each one
+     * preceded by liveSnapshotStarted. The costs cover the whole recording or the last Settings::liveCostWindow
+     * seconds, see Data::RollingCosts, the events only the last Settings::liveWindow seconds to bound the memory.
+     * parsingFinished is emitted once finishLiveInput got called and all input got parsed.
+     */
+    void startParseLive(const QString& sysroot, const QString& kallsyms, const QString& debugPaths,
+                        const QString& extraLibPaths, const QString& appPath, const QString& targetRoot,
+                        const QString& arch, const QString& disasmApproach, const QString& verbose,
+                        const QString& maxStack, const QString& branchTraverse);
+    void addLiveInput(const QByteArray& data);
+    void finishLiveInput();
+
+    // does nothing when no events are available, e.g. for the aggregated costs of startParseFiles
     void filterResults(const Data::FilterAction& filter);
 
+    /**
+     * Replace the results with the difference between the parsed file and the given compared data.
+     *
+     * The costs of the parsed file are the ones of the current filter, later calls to filterResults keep comparing
+     * until the next parse. The difference has no events, so the views derived from them stay empty and the
+     * caller/callee data has no source maps.
+     */
+    void compareWith(const Data::BottomUpResults& compared, const Data::Summary& comparedSummary,
+                     Data::DiffNormalization normalization);
+
+    /**
+     * Compute the per-instruction costs of @p symbol for the current filter, emitted via disassemblyCostsAvailable.
+     *
+     * The costs are cached until the next parse or filter, repeated requests are answered immediately.
+     */
+    void requestDisassemblyCosts(const Data::Symbol& symbol);
+
+    /**
+     * Compute what held up thread @p tid of process @p pid within @p time, emitted via criticalPathAvailable.
+     *
+     * The path follows the latest results, i.e. the events that remain after filtering.
+     * See Data::criticalPathFromEvents.
+     */
+    void requestCriticalPath(qint32 pid, qint32 tid, const Data::TimeRange& time);
+
     void stop();
 
 signals:
@@ -56,19 +145,86 @@ signals:
     void bottomUpDataAvailable(const Data::BottomUpResults& data);
     void topDownDataAvailable(const Data::TopDownResults& data);
     void callerCalleeDataAvailable(const Data::CallerCalleeResults& data);
+    void offCpuDataAvailable(const Data::OffCpuResults& data);
+    void parallelismDataAvailable(const Data::ParallelismResults& data);
+    void lockContentionDataAvailable(const Data::LockContentionResults& data);
     void eventsAvailable(const Data::EventResults& events);
     void disassemblyDataAvailable(const Data::DisassemblyResult& disassemblyResult);
+    void disassemblyCostsAvailable(const Data::Symbol& symbol, const Data::DisassemblyEntry& costs);
+    void criticalPathAvailable(const Data::CriticalPath& path);
+    void liveSnapshotStarted();
+    // the results emitted next replace the previous ones, e.g. the costs merged from more files, see appendParseFiles
+    void resultsReplaced();
     void parsingFinished();
     void parsingFailed(const QString& errorMessage);
     void progress(float progress);
     void stopRequested();
+    void liveInputAvailable();
 
 private:
+    // called from the background jobs, the data is dropped when newer results got requested meanwhile
+    void computeViews(const Data::BottomUpResults& bottomUp, const Data::EventResults& events, DerivedViews views,
+                      uint generation);
+    void parseFiles(const QStringList& paths, const QString& sysroot, const QString& kallsyms,
+                    const QString& debugPaths, const QString& extraLibPaths, const QString& appPath,
+                    const QString& targetRoot, const QString& arch, const QString& disasmApproach,
+                    const QString& verbose, const QString& maxStack, const QString& branchTraverse);
+    void computeDisassemblyCosts(const Data::Symbol& symbol);
+    Data::DisassemblyResult disassemblySettings(const Data::BottomUpResults& bottomUp,
+                                                const Data::DisassemblyResult& branchStackDisassembly) const;
+    void setViewSource(const Data::BottomUpResults& bottomUp, const Data::EventResults& events);
+    void setDisassemblySource(const Data::BottomUpResults& bottomUp, const Data::EventResults& events);
+    void setBranchStackDisassembly(const Data::DisassemblyResult& disassembly);
+
+    void invalidateViews(DerivedViews views);
+    void invalidateDisassemblyCosts();
+    void computeOutdatedViews();
+
     // only set once after the initial startParseFile finished
+    Data::Summary m_summary;
     Data::BottomUpResults m_bottomUpResults;
-    Data::CallerCalleeResults m_callerCalleeResults;
     Data::DisassemblyResult m_disassemblyResult;
     Data::EventResults m_events;
     std::atomic<bool> m_isParsing;
     std::atomic<bool> m_stopRequested;
+    // whether startParseFile stores its results in the ResultsCache, the files of an aggregate don't
+    bool m_writeResultsCache = true;
+
+    // the latest results, i.e. after filtering or comparing, the derived views are computed from these
+    QMutex m_viewSourceMutex;
+    Data::BottomUpResults m_viewBottomUp;
+    Data::EventResults m_viewEvents;
+    // the disassembly costs are computed from the filtered events of the parsed file, unlike the views
+    // they are not affected by comparing
+    Data::BottomUpResults m_disassemblyBottomUp;
+    Data::EventResults m_disassemblyEvents;
+    // the disassembly costs that had to be collected while parsing, i.e. for samples with branch stacks
+    Data::DisassemblyResult m_disassemblySource;
+
+    std::atomic<int> m_watchedViews;
+    // bumped whenever new results get requested, for the top-down and caller/callee views or the disassembly costs
+    std::atomic<uint> m_resultsGeneration;
+    std::atomic<uint> m_disassemblyGeneration;
+    // only accessed from the main thread
+    DerivedViews m_upToDateViews;
+    DerivedViews m_pendingViews;
+    QHash<Data::Symbol, Data::DisassemblyEntry> m_disassemblyCosts;
+    QSet<Data::Symbol> m_pendingDisassemblyCosts;
+
+    // perf data of a live recording that was not yet written to the parser, see startParseLive
+    QMutex m_liveInputMutex;
+    QByteArray m_liveInput;
+    bool m_liveInputFinished = false;
+
+    // costs merged from the files of startParseFiles and appendParseFiles so far
+    struct FileAggregate;
+    std::shared_ptr<FileAggregate> m_aggregate;
+    // merges the results of the files as soon as they got parsed, see parseFiles
+    std::unique_ptr<ThreadWeaver::Queue> m_mergeQueue;
+
+    // the data the results got compared with, see compareWith, only accessed from the main thread
+    struct Comparison;
+    std::shared_ptr<const Comparison> m_comparison;
 };
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(PerfParser::DerivedViews)
@@ -171,31 +171,46 @@ void PerfRecord::startRecording(const QStringList& perfOptions, const QString& o
         m_perfRecordProcess->deleteLater();
     }
     m_perfRecordProcess = new QProcess(this);
-    m_perfRecordProcess->setProcessChannelMode(QProcess::MergedChannels);
-
-    QFileInfo outputFileInfo(outputPath);
-    QString folderPath = outputFileInfo.dir().path();
-    QFileInfo folderInfo(folderPath);
-    if (!folderInfo.exists()) {
-        emit recordingFailed(tr("Folder '%1' does not exist.").arg(folderPath));
-        return;
-    }
-    if (!folderInfo.isDir()) {
-        emit recordingFailed(tr("'%1' is not a folder.").arg(folderPath));
-        return;
-    }
-    if (!folderInfo.isWritable()) {
-        emit recordingFailed(tr("Folder '%1' is not writable.").arg(folderPath));
-        return;
+    // when recording live, perf writes the data to its stdout and its messages to stderr
+    const bool isLive = outputPath == QLatin1String("-");
+    m_perfRecordProcess->setProcessChannelMode(isLive ? QProcess::SeparateChannels : QProcess::MergedChannels);
+
+    if (!isLive) {
+        QFileInfo outputFileInfo(outputPath);
+        QString folderPath = outputFileInfo.dir().path();
+        QFileInfo folderInfo(folderPath);
+        if (!folderInfo.exists()) {
+            emit recordingFailed(tr("Folder '%1' does not exist.").arg(folderPath));
+            return;
+        }
+        if (!folderInfo.isDir()) {
+            emit recordingFailed(tr("'%1' is not a folder.").arg(folderPath));
+            return;
+        }
+        if (!folderInfo.isWritable()) {
+            emit recordingFailed(tr("Folder '%1' is not writable.").arg(folderPath));
+            return;
+        }
     }
 
     connect(m_perfRecordProcess.data(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
-            this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
+            this, [this, isLive](int exitCode, QProcess::ExitStatus exitStatus) {
                 Q_UNUSED(exitStatus)
 
                 QFileInfo outputFileInfo(m_outputPath);
-                if ((exitCode == EXIT_SUCCESS || (exitCode == SIGTERM && m_userTerminated) || outputFileInfo.size() > 0)
-                    && outputFileInfo.exists()) {
+                if (isLive) {
+                    const auto data = m_perfRecordProcess->readAllStandardOutput();
+                    if (!data.isEmpty()) {
+                        emit recordingData(data);
+                    }
+                    if (exitCode == EXIT_SUCCESS || (exitCode == SIGTERM && m_userTerminated)) {
+                        emit recordingFinished(m_outputPath);
+                    } else {
+                        emit recordingFailed(tr("Failed to record perf data, error code %1.").arg(exitCode));
+                    }
+                } else if ((exitCode == EXIT_SUCCESS || (exitCode == SIGTERM && m_userTerminated)
+                            || outputFileInfo.size() > 0)
+                           && outputFileInfo.exists()) {
                     emit recordingFinished(m_outputPath);
                 } else {
                     emit recordingFailed(tr("Failed to record perf data, error code %1.").arg(exitCode));
@@ -210,10 +225,19 @@ void PerfRecord::startRecording(const QStringList& perfOptions, const QString& o
         }
     });
 
-    connect(m_perfRecordProcess.data(), &QProcess::readyRead, this, [this]() {
-        QString output = QString::fromUtf8(m_perfRecordProcess->readAll());
-        emit recordingOutput(output);
-    });
+    if (isLive) {
+        connect(m_perfRecordProcess.data(), &QProcess::readyReadStandardOutput, this,
+                [this]() { emit recordingData(m_perfRecordProcess->readAllStandardOutput()); });
+        connect(m_perfRecordProcess.data(), &QProcess::readyReadStandardError, this, [this]() {
+            QString output = QString::fromUtf8(m_perfRecordProcess->readAllStandardError());
+            emit recordingOutput(output);
+        });
+    } else {
+        connect(m_perfRecordProcess.data(), &QProcess::readyRead, this, [this]() {
+            QString output = QString::fromUtf8(m_perfRecordProcess->readAll());
+            emit recordingOutput(output);
+        });
+    }
 
     m_outputPath = outputPath;
     auto perfBinary = QStringLiteral("perf");
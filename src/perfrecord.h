@@ -39,6 +39,7 @@ public:
     explicit PerfRecord(QObject* parent = nullptr);
     ~PerfRecord();
 
+    // an @p outputPath of "-" records live, the perf data is emitted through recordingData then
     void record(const QStringList& perfOptions, const QString& outputPath, bool elevatePrivileges,
                 const QString& exePath, const QStringList& exeOptions, const QString& workingDirectory = QString());
     void record(const QStringList& perfOptions, const QString& outputPath, bool elevatePrivileges,
@@ -67,6 +68,7 @@ signals:
     void recordingFinished(const QString& fileLocation);
     void recordingFailed(const QString& errorMessage);
     void recordingOutput(const QString& errorMessage);
+    void recordingData(const QByteArray& data);
 
 private:
     QPointer<QProcess> m_perfRecordProcess;
@@ -171,6 +171,7 @@ RecordPage::RecordPage(QWidget* parent)
     , ui(new Ui::RecordPage)
     , m_perfRecord(new PerfRecord(this))
     , m_updateRuntimeTimer(new QTimer(this))
+    , m_isLive(false)
     , m_watcher(new QFutureWatcher<ProcDataList>(this))
 {
     ui->setupUi(this);
@@ -271,20 +272,31 @@ RecordPage::RecordPage(QWidget* parent)
                 appendOutput(QLatin1String("$ ") + perfBinary + QLatin1Char(' ') + arguments.join(QLatin1Char(' '))
                              + QLatin1Char('\n'));
                 ui->perfInputEdit->setEnabled(true);
+                if (m_isLive) {
+                    emit liveRecordingStarted();
+                }
             });
 
     connect(m_perfRecord, &PerfRecord::recordingFinished, this, [this](const QString& fileLocation) {
         appendOutput(tr("\nrecording finished after %1").arg(Util::formatTimeString(m_recordTimer.nsecsElapsed())));
-        m_resultsFile = fileLocation;
         setError({});
         recordingStopped();
-        ui->viewPerfRecordResultsButton->setEnabled(true);
+        if (m_isLive) {
+            emit liveRecordingFinished();
+        } else {
+            m_resultsFile = fileLocation;
+            ui->viewPerfRecordResultsButton->setEnabled(true);
+        }
     });
 
     connect(m_perfRecord, &PerfRecord::recordingFailed, this, [this](const QString& errorMessage) {
         if (m_recordTimer.isValid()) {
             appendOutput(tr("\nrecording failed after %1: %2")
                              .arg(Util::formatTimeString(m_recordTimer.nsecsElapsed()), errorMessage));
+            if (m_isLive) {
+                // show what got recorded until then
+                emit liveRecordingFinished();
+            }
         } else {
             appendOutput(tr("\nrecording failed: %1").arg(errorMessage));
         }
@@ -294,6 +306,18 @@ RecordPage::RecordPage(QWidget* parent)
     });
 
     connect(m_perfRecord, &PerfRecord::recordingOutput, this, &RecordPage::appendOutput);
+    connect(m_perfRecord, &PerfRecord::recordingData, this, &RecordPage::liveRecordingData);
+
+    connect(ui->liveCheckBox, &QCheckBox::toggled, this, [this](bool live) {
+        // no output file is written when recording live
+        ui->outputFile->setEnabled(!live);
+        if (live) {
+            setError({});
+            updateStartRecordingButtonState(ui);
+        } else {
+            onOutputFileNameChanged(ui->outputFile->text());
+        }
+    });
 
     connect(ui->perfInputEdit, &QLineEdit::returnPressed, this, [this]() {
         m_perfRecord->sendInput(ui->perfInputEdit->text().toUtf8());
@@ -342,6 +366,7 @@ RecordPage::RecordPage(QWidget* parent)
     ui->mmapPagesSpinBox->setValue(config().readEntry(QStringLiteral("mmapPages"), 0));
     ui->mmapPagesUnitComboBox->setCurrentIndex(config().readEntry(QStringLiteral("mmapPagesUnit"), 2));
     ui->useAioCheckBox->setChecked(config().readEntry(QStringLiteral("useAio"), PerfRecord::canUseAio()));
+    ui->liveCheckBox->setChecked(config().readEntry(QStringLiteral("live"), false));
 
     const auto callGraph = config().readEntry("callGraph", ui->callGraphComboBox->currentData());
     const auto callGraphIdx = ui->callGraphComboBox->findData(callGraph);
@@ -399,6 +424,71 @@ void RecordPage::showRecordPage()
     ui->viewPerfRecordResultsButton->setEnabled(false);
 }
 
+void RecordPage::reduceLostEvents(double lostFraction)
+{
+    QStringList changes;
+
+    // perf uses 512 KiB per cpu by default, quadruple the buffer
+    int mmapPages = ui->mmapPagesSpinBox->value();
+    int mmapPagesUnit = ui->mmapPagesUnitComboBox->currentIndex();
+    if (mmapPages == 0) {
+        mmapPages = 2;
+        mmapPagesUnit = 2; // MiB
+    } else {
+        mmapPages *= 4;
+        // switch to the next byte unit when the size gets too large for the spin box
+        while (mmapPages > ui->mmapPagesSpinBox->maximum() && mmapPagesUnit < 3) {
+            mmapPages = (mmapPages + 1023) / 1024;
+            ++mmapPagesUnit;
+        }
+        mmapPages = std::min(mmapPages, ui->mmapPagesSpinBox->maximum());
+    }
+    if (mmapPages != ui->mmapPagesSpinBox->value() || mmapPagesUnit != ui->mmapPagesUnitComboBox->currentIndex()) {
+        ui->mmapPagesSpinBox->setValue(mmapPages);
+        ui->mmapPagesUnitComboBox->setCurrentIndex(mmapPagesUnit);
+        changes << tr("buffer size: %1 %2").arg(QString::number(mmapPages), ui->mmapPagesUnitComboBox->currentText());
+    }
+
+    if (PerfRecord::canUseAio() && !ui->useAioCheckBox->isChecked()) {
+        ui->useAioCheckBox->setChecked(true);
+        changes << tr("asynchronous writes");
+    }
+
+    // when more than a tenth got lost, the buffer alone won't do, sample less often
+    if (lostFraction > 0.1) {
+        auto args = KShell::splitArgs(ui->perfParams->currentText());
+        bool adjusted = false;
+        for (int i = 0; i < args.size() && !adjusted; ++i) {
+            const auto& arg = args.at(i);
+            const bool isFrequency = arg == QLatin1String("-F") || arg == QLatin1String("--freq");
+            const bool isPeriod = arg == QLatin1String("-c") || arg == QLatin1String("--count");
+            if ((!isFrequency && !isPeriod) || i + 1 == args.size()) {
+                continue;
+            }
+            bool isNumber = false;
+            const auto value = args.at(i + 1).toULongLong(&isNumber);
+            if (isNumber && value > 0) {
+                args[i + 1] = QString::number(isFrequency ? std::max<quint64>(value / 2, 1) : value * 2);
+                changes << (isFrequency ? tr("sampling frequency: %1 Hz") : tr("sampling period: %1 events"))
+                               .arg(args.at(i + 1));
+            }
+            // frequencies like "max" are left alone
+            adjusted = true;
+        }
+        if (!adjusted) {
+            // half of perf's default frequency
+            args << QStringLiteral("-F") << QStringLiteral("2000");
+            changes << tr("sampling frequency: %1 Hz").arg(2000);
+        }
+        ui->perfParams->setEditText(KShell::joinArgs(args));
+    }
+
+    ui->perfOptionsBox2->setExpanded(true);
+    if (!changes.isEmpty()) {
+        appendOutput(tr("Adjusted the options to lose fewer events: %1\n").arg(changes.join(QStringLiteral(", "))));
+    }
+}
+
 void RecordPage::onStartRecordingButtonClicked(bool checked)
 {
     const auto recordType = selectedRecordType(ui);
@@ -490,7 +580,9 @@ void RecordPage::onStartRecordingButtonClicked(bool checked)
         config().writeEntry(QStringLiteral("mmapPages"), mmapPages);
         config().writeEntry(QStringLiteral("mmapPagesUnit"), mmapPagesUnit);
 
-        const auto outputFile = ui->outputFile->url().toLocalFile();
+        m_isLive = ui->liveCheckBox->isChecked();
+        config().writeEntry(QStringLiteral("live"), m_isLive);
+        const auto outputFile = m_isLive ? QStringLiteral("-") : ui->outputFile->url().toLocalFile();
 
         switch (recordType) {
         case LaunchApplication: {
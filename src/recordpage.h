@@ -61,10 +61,20 @@ public:
 
     void showRecordPage();
     void stopRecording();
+    /**
+     * Adjust the recording options such that perf loses fewer events than in a recording
+     * that lost @p lostFraction of its events: a larger buffer, asynchronous writes and,
+     * when a lot got lost, a lower sampling frequency.
+     */
+    void reduceLostEvents(double lostFraction);
 
 signals:
     void homeButtonClicked();
     void openFile(QString filePath);
+    // a live recording streams its perf data rather than writing it to a file, see PerfParser::startParseLive
+    void liveRecordingStarted();
+    void liveRecordingData(const QByteArray& data);
+    void liveRecordingFinished();
 
 private slots:
     void onApplicationNameChanged(const QString& filePath);
@@ -91,6 +101,7 @@ private:
     QString m_resultsFile;
     QElapsedTimer m_recordTimer;
     QTimer* m_updateRuntimeTimer;
+    bool m_isLive;
 
     ProcessModel* m_processModel;
     ProcessFilterModel* m_processProxyModel;
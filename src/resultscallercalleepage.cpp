@@ -31,6 +31,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QHeaderView>
 #include <QMenu>
 #include <QSortFilterProxyModel>
 
@@ -38,6 +39,7 @@
 #include "resultsutil.h"
 
 #include "models/callercalleemodel.h"
+#include "models/sourcecodemodel.h"
 #include "models/costdelegate.h"
 #include "models/hashmodel.h"
 #include "models/treemodel.h"
@@ -68,6 +70,20 @@ void connectCallerOrCalleeModel(QTreeView* view, CallerCalleeModel* callerCallee
         handler(sourceIndex);
     });
 }
+
+QString hottestLocation(const Data::LocationCostMap& sourceMap)
+{
+    QString hottest;
+    qint64 maxCost = -1;
+    for (auto it = sourceMap.cbegin(), end = sourceMap.cend(); it != end; ++it) {
+        const auto cost = it->inclusiveCost.size() ? it->inclusiveCost[0] : 0;
+        if (cost > maxCost) {
+            maxCost = cost;
+            hottest = it.key();
+        }
+    }
+    return hottest;
+}
 }
 
 ResultsCallerCalleePage::ResultsCallerCalleePage(FilterAndZoomStack* filterStack, PerfParser* parser, QWidget* parent)
@@ -87,7 +103,18 @@ ResultsCallerCalleePage::ResultsCallerCalleePage(FilterAndZoomStack* filterStack
     ResultsUtil::stretchFirstColumn(ui->callerCalleeTableView);
     ResultsUtil::setupCostDelegate(m_callerCalleeCostModel, ui->callerCalleeTableView);
 
+    m_sourceCodeModel = new SourceCodeModel(this);
+    ui->sourceCodeView->setModel(m_sourceCodeModel);
+    ui->sourceCodeView->header()->setStretchLastSection(false);
+    ui->sourceCodeView->header()->setSectionResizeMode(SourceCodeModel::SourceCode, QHeaderView::Stretch);
+    ResultsUtil::setupCostDelegate(m_sourceCodeModel, ui->sourceCodeView);
+    ui->sourceCodeView->hide();
+
     connect(parser, &PerfParser::callerCalleeDataAvailable, this, [this](const Data::CallerCalleeResults& data) {
+        m_callerCalleeResults = data;
+        if (!m_sourceCodeModel->path().isEmpty()) {
+            updateSourceCodeCosts();
+        }
         m_callerCalleeCostModel->setResults(data);
         ResultsUtil::hideEmptyColumns(data.inclusiveCosts, ui->callerCalleeTableView,
                                       CallerCalleeModel::NUM_BASE_COLUMNS);
@@ -95,7 +122,11 @@ ResultsCallerCalleePage::ResultsCallerCalleePage(FilterAndZoomStack* filterStack
                                       CallerCalleeModel::NUM_BASE_COLUMNS + data.inclusiveCosts.numTypes());
         auto view = ui->callerCalleeTableView;
         view->sortByColumn(CallerCalleeModel::InitialSortColumn, view->header()->sortIndicatorOrder());
-        view->setCurrentIndex(view->model()->index(0, 0, {}));
+        if (m_pendingJumpSymbol.isValid()) {
+            jumpToCallerCallee(m_pendingJumpSymbol);
+        } else {
+            view->setCurrentIndex(view->model()->index(0, 0, {}));
+        }
         ResultsUtil::hideEmptyColumns(data.inclusiveCosts, ui->callersView, CallerModel::NUM_BASE_COLUMNS);
         ResultsUtil::hideEmptyColumns(data.inclusiveCosts, ui->calleesView, CalleeModel::NUM_BASE_COLUMNS);
         ResultsUtil::hideEmptyColumns(data.inclusiveCosts, ui->sourceMapView, SourceMapModel::NUM_BASE_COLUMNS);
@@ -116,6 +147,8 @@ ResultsCallerCalleePage::ResultsCallerCalleePage(FilterAndZoomStack* filterStack
         if (index.model() == m_callerCalleeCostModel) {
             ui->callerCalleeTableView->setCurrentIndex(m_callerCalleeProxy->mapFromSource(index));
         }
+        // show the hottest line right away, jumping to a symbol needs no external editor
+        showSourceCode(toSourceMapLocation(hottestLocation(sourceMap)));
     };
     connectCallerOrCalleeModel<CalleeModel>(ui->calleesView, m_callerCalleeCostModel, selectCallerCaleeeIndex);
     connectCallerOrCalleeModel<CallerModel>(ui->callersView, m_callerCalleeCostModel, selectCallerCaleeeIndex);
@@ -137,36 +170,46 @@ ResultsCallerCalleePage::ResultsCallerCalleePage(FilterAndZoomStack* filterStack
 
 ResultsCallerCalleePage::~ResultsCallerCalleePage() = default;
 
-ResultsCallerCalleePage::SourceMapLocation ResultsCallerCalleePage::toSourceMapLocation(const QModelIndex& index)
+ResultsCallerCalleePage::SourceMapLocation ResultsCallerCalleePage::toSourceMapLocation(const QString& location)
 {
-    const auto location = index.data(SourceMapModel::LocationRole).toString();
     const auto separator = location.lastIndexOf(QLatin1Char(':'));
     if (separator <= 0) {
         return {};
     }
 
-    const auto fileName = location.leftRef(separator);
+    const auto fileName = location.left(separator);
     const auto lineNumber = location.midRef(separator + 1).toInt();
 
     SourceMapLocation ret;
-    auto resolvePath = [&ret, fileName, lineNumber](const QString& pathName) -> bool {
-        const QString path = pathName + fileName;
+    auto resolvePath = [&ret, fileName, lineNumber](const QString& pathName, const QString& mappedFileName) -> bool {
+        const QString path = pathName + mappedFileName;
         if (QFileInfo::exists(path)) {
             ret.path = path;
+            ret.fileName = fileName;
             ret.lineNumber = lineNumber;
             return true;
         }
         return false;
     };
 
+    // sources that were built elsewhere are found by replacing the prefix of their path
+    for (const auto& mapping : m_sourcePathMap) {
+        if (fileName.startsWith(mapping.first)) {
+            const QString mappedFileName = mapping.second + fileName.mid(mapping.first.size());
+            if (resolvePath(m_sysroot, mappedFileName) || resolvePath({}, mappedFileName)) {
+                return ret;
+            }
+        }
+    }
+
     // also try to resolve paths relative to the module output folder
     // fixes a common issue with qmake builds that use relative paths
     const auto symbol =
         ui->callerCalleeTableView->currentIndex().data(CallerCalleeModel::SymbolRole).value<Data::Symbol>();
     const QString modulePath = QFileInfo(symbol.path).path() + QLatin1Char('/');
 
-    resolvePath(m_sysroot) || resolvePath(m_sysroot + modulePath) || resolvePath(m_appPath)
-        || resolvePath(m_appPath + modulePath);
+    resolvePath(m_sysroot, fileName) || resolvePath(m_sysroot + modulePath, fileName)
+        || resolvePath(m_appPath, fileName) || resolvePath(m_appPath + modulePath, fileName);
 
     return ret;
 }
@@ -178,25 +221,55 @@ void ResultsCallerCalleePage::onSourceMapContextMenu(const QPoint& point)
         return;
     }
 
-    const auto location = toSourceMapLocation(index);
+    const auto location = toSourceMapLocation(index.data(SourceMapModel::LocationRole).toString());
     if (!location) {
         return;
     }
 
     QMenu contextMenu;
+    auto* showSource = contextMenu.addAction(tr("Show source code"));
     auto* viewCallerCallee = contextMenu.addAction(tr("Open in editor"));
     auto* action = contextMenu.exec(QCursor::pos());
-    if (action == viewCallerCallee) {
+    if (action == showSource) {
+        showSourceCode(location);
+    } else if (action == viewCallerCallee) {
         emit navigateToCode(location.path, location.lineNumber, 0);
     }
 }
 
 void ResultsCallerCalleePage::onSourceMapActivated(const QModelIndex& index)
 {
-    const auto location = toSourceMapLocation(index);
-    if (location) {
-        emit navigateToCode(location.path, location.lineNumber, 0);
+    showSourceCode(toSourceMapLocation(index.data(SourceMapModel::LocationRole).toString()));
+}
+
+void ResultsCallerCalleePage::showSourceCode(const SourceMapLocation& location)
+{
+    if (!location) {
+        ui->sourceCodeView->hide();
+        return;
     }
+
+    // the file stays mapped while its lines are shown, switching between its locations is free
+    if (location.path != m_sourceCodeModel->path() || location.fileName != m_sourceCodeModel->fileName()) {
+        if (!m_sourceCodeModel->setSourceFile(location.path, location.fileName)) {
+            ui->sourceCodeView->hide();
+            return;
+        }
+        updateSourceCodeCosts();
+    }
+
+    const auto index = m_sourceCodeModel->index(location.lineNumber - 1, SourceCodeModel::SourceCode);
+    ui->sourceCodeView->show();
+    ui->sourceCodeView->setCurrentIndex(index);
+    ui->sourceCodeView->scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
+void ResultsCallerCalleePage::updateSourceCodeCosts()
+{
+    m_sourceCodeModel->setCosts(m_callerCalleeResults);
+    const auto& costs = m_callerCalleeResults.selfCosts;
+    ResultsUtil::hideEmptyColumns(costs, ui->sourceCodeView, SourceCodeModel::NUM_BASE_COLUMNS);
+    ResultsUtil::hideEmptyColumns(costs, ui->sourceCodeView, SourceCodeModel::NUM_BASE_COLUMNS + costs.numTypes());
 }
 
 void ResultsCallerCalleePage::setSysroot(const QString& path)
@@ -209,13 +282,30 @@ void ResultsCallerCalleePage::setAppPath(const QString& path)
     m_appPath = path;
 }
 
+void ResultsCallerCalleePage::setSourcePathMap(const QString& pathMap)
+{
+    m_sourcePathMap.clear();
+    for (const auto& mapping : pathMap.split(QLatin1Char(':'), QString::SkipEmptyParts)) {
+        const auto separator = mapping.indexOf(QLatin1Char('='));
+        if (separator > 0) {
+            m_sourcePathMap.append(qMakePair(mapping.left(separator), mapping.mid(separator + 1)));
+        }
+    }
+}
+
 void ResultsCallerCalleePage::clear()
 {
     ui->callerCalleeFilter->setText({});
+    m_pendingJumpSymbol = {};
+    m_callerCalleeResults = {};
+    m_sourceCodeModel->clear();
+    ui->sourceCodeView->hide();
 }
 
 void ResultsCallerCalleePage::jumpToCallerCallee(const Data::Symbol& symbol)
 {
-    auto callerCalleeIndex = m_callerCalleeProxy->mapFromSource(m_callerCalleeCostModel->indexForSymbol(symbol));
+    const auto sourceIndex = m_callerCalleeCostModel->indexForSymbol(symbol);
+    m_pendingJumpSymbol = sourceIndex.isValid() ? Data::Symbol() : symbol;
+    auto callerCalleeIndex = m_callerCalleeProxy->mapFromSource(sourceIndex);
     ui->callerCalleeTableView->setCurrentIndex(callerCalleeIndex);
 }
@@ -29,19 +29,18 @@
 
 #include <QWidget>
 
+#include "data.h"
+
 namespace Ui {
 class ResultsCallerCalleePage;
 }
 
-namespace Data {
-struct Symbol;
-}
-
 class QSortFilterProxyModel;
 class QModelIndex;
 
 class PerfParser;
 class CallerCalleeModel;
+class SourceCodeModel;
 class FilterAndZoomStack;
 
 class ResultsCallerCalleePage : public QWidget
@@ -53,6 +52,8 @@ public:
 
     void setSysroot(const QString& path);
     void setAppPath(const QString& path);
+    // colon-separated list of old=new path prefixes, for sources that were built elsewhere
+    void setSourcePathMap(const QString& pathMap);
     void clear();
 
     void jumpToCallerCallee(const Data::Symbol& symbol);
@@ -73,15 +74,25 @@ private:
         }
 
         QString path;
+        // the file name as recorded in the debug information
+        QString fileName;
         int lineNumber = -1;
     };
-    SourceMapLocation toSourceMapLocation(const QModelIndex& index);
+    SourceMapLocation toSourceMapLocation(const QString& location);
+    void showSourceCode(const SourceMapLocation& location);
+    void updateSourceCodeCosts();
 
     QScopedPointer<Ui::ResultsCallerCalleePage> ui;
 
     CallerCalleeModel* m_callerCalleeCostModel;
     QSortFilterProxyModel* m_callerCalleeProxy;
 
+    SourceCodeModel* m_sourceCodeModel;
+    Data::CallerCalleeResults m_callerCalleeResults;
+
     QString m_sysroot;
     QString m_appPath;
+    QVector<QPair<QString, QString>> m_sourcePathMap;
+    // the caller/callee data is computed on demand, jumps may happen before it arrives
+    Data::Symbol m_pendingJumpSymbol;
 };
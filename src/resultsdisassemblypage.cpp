@@ -34,11 +34,17 @@
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QDateTime>
+#include <QFileInfo>
 
 #include <KRecursiveFilterProxyModel>
 
+#include <algorithm>
+#include <memory>
+
 #include "parsers/perf/perfparser.h"
 #include "resultsutil.h"
+#include "settings.h"
 
 #include "models/filterandzoomstack.h"
 #include "models/costdelegate.h"
@@ -52,9 +58,17 @@
 #include <QToolTip>
 #include <QTextEdit>
 #include <QShortcut>
-
-ResultsDisassemblyPage::ResultsDisassemblyPage(FilterAndZoomStack *filterStack, QWidget *parent)
-        : QWidget(parent), ui(new Ui::ResultsDisassemblyPage), m_noShowRawInsn(true), m_noShowAddress(false), m_intelSyntaxDisassembly(false) {
+#include <QSignalBlocker>
+#include <QTreeWidget>
+#include <QMap>
+
+ResultsDisassemblyPage::ResultsDisassemblyPage(FilterAndZoomStack *filterStack, PerfParser *parser, QWidget *parent)
+        : QWidget(parent), m_parser(parser), ui(new Ui::ResultsDisassemblyPage), m_disassemblyShown(false),
+          m_noShowRawInsn(true), m_noShowAddress(false), m_intelSyntaxDisassembly(false), m_process(nullptr),
+          m_pendingRow(-1), m_costsChanged(false), m_showCosts(false), m_showBlockCosts(false), m_branchColumn(-1),
+          m_isSymBinary(false), m_hasEmptyOutput(false),
+          m_outputCache(Settings::instance()->disassemblyCacheSize() * 1024),
+          m_binaryIndexes(Settings::instance()->disassemblyCacheSize() * 1024) {
     ui->setupUi(this);
 
     ui->searchTextEdit->setPlaceholderText(QLatin1String("Search"));
@@ -67,13 +81,57 @@ ResultsDisassemblyPage::ResultsDisassemblyPage(FilterAndZoomStack *filterStack,
     m_searchDelegate = new SearchDelegate(ui->asmView);
     ui->asmView->setItemDelegate(m_searchDelegate);
 
+    ui->loopsView->hide();
+    connect(ui->loopsView, &QTreeWidget::itemClicked, this, [this](QTreeWidgetItem *item) {
+        selectRow(item->data(0, Qt::UserRole).toInt());
+    });
+    ui->branchesView->hide();
+    connect(ui->branchesView, &QTreeWidget::itemClicked, this, [this](QTreeWidgetItem *item) {
+        selectRow(item->data(0, Qt::UserRole).toInt());
+    });
+
     connect(ui->searchTextEdit, &QTextEdit::textChanged, this, &ResultsDisassemblyPage::searchTextAndHighlight);
     connect(ui->backButton, &QToolButton::clicked, this, &ResultsDisassemblyPage::backButtonClicked);
     m_action = Action::Disassembly;
     model = new DisassemblyModel();
+
+    connect(parser, &PerfParser::disassemblyCostsAvailable, this,
+            [this](const Data::Symbol &symbol, const Data::DisassemblyEntry &costs) {
+                if (symbol != m_curSymbol) {
+                    return;
+                }
+                m_curCosts = costs;
+                if (m_action != Action::Disassembly) {
+                    return;
+                }
+                if (m_process) {
+                    // Join the costs once the output is complete
+                    m_costsChanged = true;
+                } else if (m_disassemblyShown) {
+                    refreshDisassembly();
+                }
+            });
+    // Costs depend on the filter, so request them again for the new results
+    connect(parser, &PerfParser::parsingFinished, this, [this]() {
+        if (!m_curSymbol.symbol.isEmpty()) {
+            m_parser->requestDisassemblyCosts(m_curSymbol);
+        }
+        prefetchDisassembly();
+    });
+    connect(parser, &PerfParser::bottomUpDataAvailable, this, &ResultsDisassemblyPage::setPrefetchSymbols);
+    connect(parser, &PerfParser::parsingStarted, this, &ResultsDisassemblyPage::cancelPrefetch);
+    connect(Settings::instance(), &Settings::disassemblyCacheSizeChanged, this, [this](int cacheSize) {
+        m_outputCache.setMaxCost(cacheSize * 1024);
+        m_binaryIndexes.setMaxCost(cacheSize * 1024);
+    });
+    connect(Settings::instance(), &Settings::prefetchProcessesChanged, this,
+            &ResultsDisassemblyPage::startPrefetchProcesses);
 }
 
-ResultsDisassemblyPage::~ResultsDisassemblyPage() = default;
+ResultsDisassemblyPage::~ResultsDisassemblyPage() {
+    cancelOutput();
+    cancelPrefetch();
+}
 
 /**
  *  Search text (taken from text editor Search) in Disassembly output and highlight found.
@@ -171,6 +229,8 @@ void ResultsDisassemblyPage::setOpcodes(bool intelSyntax) {
  * @return
  */
 int ResultsDisassemblyPage::selectedRow() {
+    if (m_pendingRow >= 0)
+        return m_pendingRow;
     return (model->rowCount() > 0) ? ui->asmView->currentIndex().row() : 0;
 }
 
@@ -179,7 +239,13 @@ int ResultsDisassemblyPage::selectedRow() {
  * @param row
  */
 void ResultsDisassemblyPage::selectRow(int row) {
+    // Output is still loading, select the row once it is complete
+    if (m_process) {
+        m_pendingRow = row;
+        return;
+    }
     ui->asmView->setCurrentIndex(model->index(row, 0));
+    ui->asmView->scrollTo(model->index(row, 0));
 }
 
 /**
@@ -230,6 +296,16 @@ void ResultsDisassemblyPage::switchDisassemblyMethod(bool disasmMethod) {
     resetDisassembly();
 }
 
+/**
+ *  Show costs of basic blocks and loops instead of instructions
+ * @param show
+ */
+void ResultsDisassemblyPage::showBasicBlockCosts(bool show) {
+    m_showBlockCosts = show;
+    if (m_disassemblyShown)
+        refreshDisassembly();
+}
+
 /**
  *  Clear
  */
@@ -278,15 +354,19 @@ void ResultsDisassemblyPage::setAsmViewModel(QStandardItemModel *model, int numT
  *  Produce and show disassembly with 'objdump' depending on passed value through option --disasm-approach=<value>
  */
 void ResultsDisassemblyPage::showDisassembly() {
-    if (m_disasmApproach.isEmpty() || m_disasmApproach.startsWith(QLatin1String("symbol"))) {
-        showDisassemblyBySymbol();
-    } else {
+    if (isAddressRangeApproach()) {
         showDisassemblyByAddressRange();
+    } else {
+        showDisassemblyBySymbol();
     }
-    if (!m_calleesProcessed) {
-        m_searchDelegate->setCallees(m_callees);
-        m_calleesProcessed = true;
-    }
+}
+
+/**
+ *  Return true when Disassembly is produced by addresses range rather than by symbol name
+ * @return
+ */
+bool ResultsDisassemblyPage::isAddressRangeApproach() const {
+    return !m_disasmApproach.isEmpty() && !m_disasmApproach.startsWith(QLatin1String("symbol"));
 }
 
 /**
@@ -298,11 +378,7 @@ void ResultsDisassemblyPage::showDisassemblyBySymbol() {
         clear();
     }
 
-    // Call objdump with arguments: mangled name of function and binary file
-    QString processName =
-            m_objdump + QLatin1String(" --disassemble=") + m_curSymbol.mangled + QLatin1String(" ") + m_curAppPath;
-
-    showDisassembly(processName);
+    showDisassembly(objdumpCommand(m_curSymbol, m_curAppPath, false));
 }
 
 /**
@@ -314,221 +390,610 @@ void ResultsDisassemblyPage::showDisassemblyByAddressRange() {
         clear();
     }
 
-    // Call objdump with arguments: addresses range and binary file
-    QString processName =
-            m_objdump + QLatin1String(" -d --start-address=0x") + QString::number(m_curSymbol.relAddr, 16) +
-            QLatin1String(" --stop-address=0x") +
-            QString::number(m_curSymbol.relAddr + m_curSymbol.size, 16) +
-            QLatin1String(" ") + m_curAppPath;
+    showDisassembly(objdumpCommand(m_curSymbol, m_curAppPath, true));
+}
 
+/**
+ *  Build 'objdump' command for symbol from binary at appPath considering the options of the view
+ * @param symbol
+ * @param appPath
+ * @param byAddressRange
+ * @return
+ */
+QString ResultsDisassemblyPage::objdumpCommand(const Data::Symbol &symbol, const QString &appPath,
+                                               bool byAddressRange) const {
+    QString processName;
     // Workaround for the case when symbol size is equal to zero
-    if (m_curSymbol.size == 0) {
-        processName =
-                m_objdump + QLatin1String(" --disassemble=") + m_curSymbol.mangled + QLatin1String(" ") +
-                m_curAppPath;
+    if (byAddressRange && symbol.size != 0) {
+        // Call objdump with arguments: addresses range and binary file
+        processName = m_objdump + QLatin1String(" -d --start-address=0x") + QString::number(symbol.relAddr, 16) +
+                      QLatin1String(" --stop-address=0x") + QString::number(symbol.relAddr + symbol.size, 16) +
+                      QLatin1String(" ") + appPath;
+    } else {
+        // Call objdump with arguments: mangled name of function and binary file
+        processName = m_objdump + QLatin1String(" --disassemble=") + symbol.mangled + QLatin1String(" ") + appPath;
     }
-    showDisassembly(processName);
+    return processName + objdumpOptions();
 }
 
 /**
- *  Compute installed objdump version. If it is less than required 2.32 then Disassembly item is disabled.
+ *  Build 'objdump' command for the whole text section of binary at appPath considering the options of the view
+ * @param appPath
  * @return
  */
-void ResultsDisassemblyPage::getObjdumpVersion() {
-    QProcess versionProcess;
-    QString processVersionName = m_objdump + QLatin1String(" -v");
-    versionProcess.start(processVersionName);
-    if (versionProcess.waitForStarted() && versionProcess.waitForFinished()) {
-        QByteArray versionLine = versionProcess.readLine();
-        QString version = QString::fromStdString(versionLine.toStdString());
-
-        QRegExp rx(QLatin1String("\\d+\\.\\d+"));
-        int pos = rx.lastIndexIn(version);
-        m_objdumpVersion = rx.capturedTexts().at(0);
-        if (m_objdumpVersion.toFloat() < 2.32) {
-            m_filterAndZoomStack->actions().disassembly->setEnabled(false);
-        }
-    }    
+QString ResultsDisassemblyPage::objdumpBinaryCommand(const QString &appPath) const {
+    return m_objdump + QLatin1String(" -d -j .text ") + appPath + objdumpOptions();
 }
 
 /**
- *  Call 'perf annotate -v --stdio' when 'perf annotate' returned empty output
+ *  Options of 'objdump' commands that follow the options of the view
+ * @return
+ */
+QString ResultsDisassemblyPage::objdumpOptions() const {
+    QString options;
+    if (m_noShowRawInsn)
+        options += QLatin1String(" --no-show-raw-insn ");
+
+    if (m_intelSyntaxDisassembly)
+        options += QLatin1String(" -M intel ");
+
+    return options;
+}
+
+/**
+ *  Take installed objdump version from the output of 'objdump -v'. If it is less than required 2.32 then
+ *  Disassembly item is disabled.
+ * @param versionOutput
+ */
+void ResultsDisassemblyPage::setObjdumpVersion(const QByteArray &versionOutput) {
+    const QString version = QString::fromLocal8Bit(versionOutput.left(versionOutput.indexOf('\n')));
+
+    QRegExp rx(QLatin1String("\\d+\\.\\d+"));
+    if (rx.lastIndexIn(version) == -1)
+        return;
+    m_objdumpVersion = rx.capturedTexts().at(0);
+    if (m_objdumpVersion.toFloat() < 2.32) {
+        m_filterAndZoomStack->actions().disassembly->setEnabled(false);
+    }
+}
+
+/**
+ *  Diagnose why processName command could not be started
+ * @return
+ */
+QByteArray ResultsDisassemblyPage::processNotStartedDiag() {
+    m_searchDelegate->setDiagnosticStyle(true);
+    if (m_action == Action::Annotate) {
+        return QByteArray(
+                "Process was not started. Probably command 'perf' not found, but can be installed with 'apt install linux-tools-common'");
+    } else if (!m_arch.startsWith(QLatin1String("arm"))) {
+        return QByteArray(
+                "Process was not started. Probably command 'objdump' not found, but can be installed with 'apt install binutils'");
+    }
+    return QByteArray(
+            "Process was not started. Probably command 'arm-linux-gnueabi-objdump' not found, but can be installed with 'apt install binutils-arm-linux-gnueabi'");
+}
+
+/**
+ *  Diagnose why processName command returned empty output
  * @param processName
  * @return
  */
-QByteArray ResultsDisassemblyPage::processPerfAnnotateDiag(QString processName) {
-    QByteArray processOutput = QByteArray();
-    QProcess asmProcess;
-    asmProcess.setReadChannelMode(QProcess::MergedChannels);
-    asmProcess.start(processName);
+QByteArray ResultsDisassemblyPage::processEmptyOutputDiag(const QString &processName) {
+    QByteArray processOutput = QByteArray("Empty output of command ");
+    processOutput += processName.toUtf8();
 
-    bool started = asmProcess.waitForStarted();
-    bool finished = asmProcess.waitForFinished(MSECS_PROCESS);
-    if (started && finished) {
-        QByteArray buffer;
-        buffer.append(asmProcess.readAll());
-        processOutput = buffer.data();
+    if (m_action == Action::Disassembly && !m_objdumpVersion.isEmpty() && m_objdumpVersion.toFloat() < 2.32) {
+        processOutput = QByteArray("Version of objdump should be >= 2.32. You use objdump with version ") +
+                        m_objdumpVersion.toUtf8();
     }
+    m_searchDelegate->setDiagnosticStyle(true);
     return processOutput;
 }
 
 /**
- * Run processName command in QProcess and diagnoses some cases
+ *  Diagnose why processName command returned empty output. Like the output itself, the diagnostic command
+ *  ('perf annotate -v --stdio' or 'objdump -v') runs in the background and the diagnosis is appended once it finished
  * @param processName
- * @return
  */
-QByteArray ResultsDisassemblyPage::processDisassemblyGenRun(QString processName) {
-    QByteArray processOutput = QByteArray();
-    if (m_curSymbol.symbol.isEmpty()) {
-        processOutput = "Empty symbol ?? is selected";
-    } else {
-        QProcess asmProcess;
-        asmProcess.start(processName);
-
-        bool started = asmProcess.waitForStarted();
-        bool finished = asmProcess.waitForFinished(MSECS_PROCESS);
-        if (!started || !finished) {
-            if (!started) {
-                if (m_action == Action::Disassembly) {
-                    if (!m_arch.startsWith(QLatin1String("arm"))) {
-                        processOutput = QByteArray(
-                                "Process was not started. Probably command 'objdump' not found, but can be installed with 'apt install binutils'");
-                    } else {
-                        processOutput = QByteArray(
-                                "Process was not started. Probably command 'arm-linux-gnueabi-objdump' not found, but can be installed with 'apt install binutils-arm-linux-gnueabi'");
-                    }
+void ResultsDisassemblyPage::startEmptyOutputDiag(const QString &processName) {
+    QString diagProcessName;
+    if (m_action == Action::Annotate)
+        diagProcessName = processName + QLatin1String(" -v --stdio ");
+    else if (m_objdumpVersion.isEmpty())
+        diagProcessName = m_objdump + QLatin1String(" -v");
+
+    if (diagProcessName.isEmpty()) {
+        appendOutput(processEmptyOutputDiag(processName));
+        finishOutput();
+        return;
+    }
+
+    m_process->disconnect(this);
+    m_process->deleteLater();
+    m_process = new QProcess(this);
+    m_process->setReadChannelMode(QProcess::MergedChannels);
+    connect(m_process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+            [this, processName](int /*exitCode*/, QProcess::ExitStatus /*exitStatus*/) {
+                const QByteArray diagOutput = m_process->readAll();
+                if (m_action == Action::Annotate) {
+                    appendOutput(processEmptyOutputDiag(processName) + QByteArray("\n") + diagOutput);
                 } else {
-                    processOutput = QByteArray(
-                            "Process was not started. Probably command 'perf' not found, but can be installed with 'apt install linux-tools-common'");
+                    setObjdumpVersion(diagOutput);
+                    appendOutput(processEmptyOutputDiag(processName));
                 }
-                m_searchDelegate->setDiagnosticStyle(true);
-            } else {
-                return processOutput;
-            }
-        } else {
-            processOutput = asmProcess.readAllStandardOutput();
+                finishOutput();
+            });
+    connect(m_process, &QProcess::errorOccurred, this, [this, processName](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            appendOutput(processEmptyOutputDiag(processName));
+            finishOutput();
         }
+    });
+    m_process->start(diagProcessName);
+}
 
-        if (processOutput.isEmpty()) {
-            processOutput = QByteArray("Empty output of command ");
-            processOutput += processName.toUtf8();
+/**
+ *  Key of the output cache: the command contains binary, symbol and syntax options,
+ *  the modification time of the binary invalidates the output of rebuilt binaries.
+ *  The output of 'perf annotate' depends on the recording too, so size and modification time of perfDataPath
+ *  invalidate it once the file got recorded again
+ * @param processName
+ * @param appPath
+ * @param perfDataPath
+ * @return
+ */
+QString ResultsDisassemblyPage::outputCacheKey(const QString &processName, const QString &appPath,
+                                               const QString &perfDataPath) const {
+    QString key = processName + QLatin1Char('\n') + QFileInfo(appPath).lastModified().toString(Qt::ISODate);
+    if (!perfDataPath.isEmpty()) {
+        const QFileInfo perfData(perfDataPath);
+        key += QLatin1Char('\n') + QString::number(perfData.size()) + QLatin1Char('\n') +
+               QString::number(perfData.lastModified().toMSecsSinceEpoch());
+    }
+    return key;
+}
 
-            if (m_action == Action::Disassembly) {
-                if (m_objdumpVersion.isEmpty())
-                    getObjdumpVersion();
+/**
+ *  Show output of processName command in Disassembly tab. Cached output is shown at once, otherwise the process
+ *  runs in the background and its output is streamed into the model
+ * @param processName
+ * @param headerList
+ */
+void ResultsDisassemblyPage::startOutput(const QString &processName, const QStringList &headerList) {
+    cancelOutput();
+    m_pendingRow = -1;
+    m_costsChanged = false;
+    m_disassemblyShown = false;
+    m_addressRows.clear();
+    m_instructions.clear();
+    m_instructionRows.clear();
+    m_instructionCosts.clear();
+    ui->loopsView->hide();
+    ui->branchesView->hide();
+    model->setRows(headerList, {});
+    setAsmViewModel(model, headerList.size() - 1);
+
+    if (m_curSymbol.symbol.isEmpty()) {
+        appendOutput("Empty symbol ?? is selected");
+        finishOutput();
+        return;
+    }
+
+    const QString key =
+            outputCacheKey(processName, m_curAppPath, m_action == Action::Annotate ? m_perfDataPath : QString());
+    if (const QByteArray *output = m_outputCache.object(key)) {
+        appendOutput(*output);
+        finishOutput();
+        return;
+    }
+    const QByteArray indexed = indexedOutput();
+    if (!indexed.isEmpty()) {
+        appendOutput(indexed);
+        finishOutput();
+        return;
+    }
 
-                if (!m_objdumpVersion.isEmpty() && m_objdumpVersion.toFloat() < 2.32) {
-                    processOutput = QByteArray("Version of objdump should be >= 2.32. You use objdump with version ") +
-                                    m_objdumpVersion.toUtf8();
+    m_process = new QProcess(this);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, [this]() {
+        const QByteArray output = m_process->readAllStandardOutput();
+        m_processOutput += output;
+        appendOutput(output);
+    });
+    connect(m_process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+            [this, key, processName](int /*exitCode*/, QProcess::ExitStatus exitStatus) {
+                const QByteArray output = m_process->readAllStandardOutput();
+                m_processOutput += output;
+                appendOutput(output);
+                if (m_processOutput.isEmpty()) {
+                    startEmptyOutputDiag(processName);
+                    return;
                 }
-            }
-            if (m_action == Action::Annotate) {
-                QByteArray subProcessOutput = processPerfAnnotateDiag(processName + QLatin1String(" -v --stdio "));
-                processOutput += QByteArray("\n") + subProcessOutput;
-            }
-            m_searchDelegate->setDiagnosticStyle(true);
+                if (exitStatus == QProcess::NormalExit) {
+                    m_outputCache.insert(key, new QByteArray(m_processOutput), m_processOutput.size() / 1024 + 1);
+                }
+                finishOutput();
+            });
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            appendOutput(processNotStartedDiag());
+            finishOutput();
         }
+    });
+    m_process->start(processName);
+}
+
+/**
+ *  Output of the current symbol served from the index of its binary, empty when the binary is not indexed
+ * @return
+ */
+QByteArray ResultsDisassemblyPage::indexedOutput() const {
+    if (m_action != Action::Disassembly || !isAddressRangeApproach() || m_curSymbol.size == 0)
+        return QByteArray();
+
+    const DisassemblyIndex *index =
+            m_binaryIndexes.object(outputCacheKey(objdumpBinaryCommand(m_curAppPath), m_curAppPath));
+    if (!index || !index->contains(m_curSymbol.relAddr))
+        return QByteArray();
+
+    // Symbol header like the one 'objdump' prints for an address range
+    return QByteArray::number(m_curSymbol.relAddr, 16).rightJustified(16, '0') + QByteArray(" <") +
+           m_curSymbol.mangled.toUtf8() + QByteArray(">:\n") +
+           index->lines(m_curSymbol.relAddr, m_curSymbol.relAddr + m_curSymbol.size);
+}
+
+/**
+ *  Parse complete lines of output and append them to the model
+ * @param output
+ */
+void ResultsDisassemblyPage::appendOutput(const QByteArray &output) {
+    m_outputTail += output;
+    QVector<QStringList> rows;
+    int lineStart = 0;
+    int lineEnd;
+    while ((lineEnd = m_outputTail.indexOf('\n', lineStart)) != -1) {
+        parseOutputLine(QString::fromLocal8Bit(m_outputTail.constData() + lineStart, lineEnd - lineStart), &rows);
+        lineStart = lineEnd + 1;
+    }
+    m_outputTail.remove(0, lineStart);
+    model->appendRows(rows);
+}
+
+/**
+ *  Append the last line of output, then apply callees and the selection requested while the output was loading
+ */
+void ResultsDisassemblyPage::finishOutput() {
+    if (!m_outputTail.isEmpty()) {
+        QVector<QStringList> rows;
+        parseOutputLine(QString::fromLocal8Bit(m_outputTail), &rows);
+        model->appendRows(rows);
+        m_outputTail.clear();
+    }
+    if (m_process) {
+        m_process->disconnect(this);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+    m_processOutput.clear();
+    showControlFlowCosts();
+    showBranchCounts();
+
+    if (!m_calleesProcessed) {
+        m_searchDelegate->setCallees(m_callees);
+        m_calleesProcessed = true;
+    }
+    m_disassemblyShown = true;
+    if (m_pendingRow >= 0) {
+        selectRow(m_pendingRow);
+        m_pendingRow = -1;
+    }
+    if (m_costsChanged) {
+        // The output is cached now, so this is instantaneous
+        m_costsChanged = false;
+        refreshDisassembly();
     }
-    return processOutput;
+}
+
+/**
+ *  Stop the running process, its output is not needed anymore
+ */
+void ResultsDisassemblyPage::cancelOutput() {
+    if (m_process) {
+        m_process->disconnect(this);
+        m_process->kill();
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+    m_processOutput.clear();
+    m_outputTail.clear();
+}
+
+/**
+ *  Parse a line of output into a row of the model
+ * @param line
+ * @param rows
+ */
+void ResultsDisassemblyPage::parseOutputLine(QString line, QVector<QStringList> *rows) {
+    if (line.endsWith(QLatin1Char('\r')))
+        line.chop(1);
+
+    if (m_action == Action::Disassembly) {
+        parseDisassemblyLine(line, rows);
+    } else {
+        parseAnnotateLine(line, rows);
+    }
+}
+
+/**
+ *  Return true when text is a hexadecimal address
+ * @param text
+ * @return
+ */
+static bool isHexAddress(const QString &text) {
+    static const QRegExp hexMatcher(QLatin1String("[0-9A-F]+$"), Qt::CaseInsensitive);
+    return hexMatcher.exactMatch(text.trimmed());
 }
 
 /**
  *  Produce disassembler with 'objdump' and output to Disassembly tab
  */
-void ResultsDisassemblyPage::showDisassembly(QString processName) {
+void ResultsDisassemblyPage::showDisassembly(const QString &processName) {
     m_action = Action::Disassembly;
-    if (m_noShowRawInsn)
-        processName += QLatin1String(" --no-show-raw-insn ");
 
-    if (m_intelSyntaxDisassembly)
-        processName += QLatin1String(" -M intel ");
+    const int numTypes = m_disasmResult.selfCosts.numTypes();
 
-    QTemporaryFile m_tmpFile;
+    QStringList headerList;
+    headerList.append(QLatin1String("Assembly"));
+    for (int i = 0; i < numTypes; i++) {
+        headerList.append(m_disasmResult.selfCosts.typeName(i));
+    }
+    // LBR branch stacks tell how often the instructions were executed and their branches were taken
+    m_branchColumn = -1;
+    if (!m_curCosts.branchEdges.isEmpty() || !m_curCosts.branchRanges.isEmpty()) {
+        m_branchColumn = headerList.size();
+        headerList.append(QLatin1String("Executions"));
+        headerList.append(QLatin1String("Taken Branches"));
+    }
 
-    if (m_tmpFile.open()) {
-        QTextStream stream(&m_tmpFile);
-        stream << processDisassemblyGenRun(processName);
-        m_tmpFile.close();
+    // Index the costs by address once, so that every line is joined with its costs in O(1)
+    m_showCosts = !m_disasmResult.branchTraverse ||
+                  !m_disasmResult.unwindMethod.startsWith(QLatin1String("lbr"));
+    m_addressCosts.clear();
+    m_totalCosts = Data::ItemCost(numTypes);
+    if (m_showCosts) {
+        m_addressCosts.reserve(m_curCosts.relSourceMap.size());
+        for (auto i = m_curCosts.relSourceMap.constBegin(); i != m_curCosts.relSourceMap.constEnd(); i++) {
+            const auto &selfCost = i.value().selfCost;
+            auto &cost = m_addressCosts[i.key().relAddr];
+            if (cost.size() == 0) {
+                cost.resize(numTypes);
+            }
+            for (int event = 0; event < numTypes && event < static_cast<int>(selfCost.size()); event++) {
+                cost[event] += selfCost[event];
+                m_totalCosts[event] += selfCost[event];
+            }
+        }
     }
 
-    if (m_tmpFile.open()) {
-        int row = 0;
-        model->clear();
+    startOutput(processName, headerList);
+}
 
-        QStringList headerList;
-        headerList.append(QLatin1String("Assembly"));
-        for (int i = 0; i < m_disasmResult.selfCosts.numTypes(); i++) {
-            headerList.append(m_disasmResult.selfCosts.typeName(i));
+/**
+ *  Parse a line of 'objdump' output and join it with the costs of its address
+ * @param asmLine
+ * @param rows
+ */
+void ResultsDisassemblyPage::parseDisassemblyLine(QString asmLine, QVector<QStringList> *rows) {
+    if (asmLine.isEmpty() || asmLine.startsWith(QLatin1String("Disassembly"))) return;
+
+    QStringList asmTokens = asmLine.split(QLatin1Char(':'));
+    QString addrLine = asmTokens.value(0);
+    // Instruction follows the address and the optional instruction bytes, separated by tabs
+    const QString instructionText = asmLine.section(QLatin1Char('\t'), -1);
+
+    if (m_noShowAddress) {
+        if (isHexAddress(addrLine)) {
+            asmTokens.removeFirst();
+            asmLine = asmTokens.join(QLatin1Char(':')).trimmed();
         }
-        model->setHorizontalHeaderLabels(headerList);
-
-        QTextStream stream(&m_tmpFile);
-        while (!stream.atEnd()) {
-            QString asmLine = stream.readLine();
-            if (asmLine.isEmpty() || asmLine.startsWith(QLatin1String("Disassembly"))) continue;
-
-            QStringList asmTokens = asmLine.split(QLatin1Char(':'));
-            QString addrLine = asmTokens.value(0);
-            QString costLine = QString();
-
-            if (m_noShowAddress) {
-                QRegExp hexMatcher(QLatin1String("[0-9A-F]+$"), Qt::CaseInsensitive);
-                if (hexMatcher.exactMatch(addrLine.trimmed())) {
-                    asmTokens.removeFirst();
-                    asmLine = asmTokens.join(QLatin1Char(':')).trimmed();
-                }
+    }
+
+    if (!m_calleesProcessed) {
+        Data::Symbol calleeSymbol = getCalleeSymbol(asmLine);
+        if (calleeSymbol.isValid())
+            m_callees.insert(model->rowCount() + rows->size(), calleeSymbol);
+    }
+
+    bool isAddress = false;
+    const quint64 address = addrLine.trimmed().toULongLong(&isAddress, 16);
+    if (isAddress) {
+        const int rowIndex = model->rowCount() + rows->size();
+        m_addressRows.insert(address, rowIndex);
+        m_instructions.append(ControlFlow::parseInstruction(address, instructionText,
+                                                            m_arch.startsWith(QLatin1String("arm"))));
+        m_instructionRows.append(rowIndex);
+    }
+
+    QStringList row;
+    row.append(asmLine);
+
+    // Calculate event times and add them in red to corresponding columns of the current disassembly row
+    if (m_showCosts) {
+        const auto cost = isAddress ? m_addressCosts.constFind(address) : m_addressCosts.constEnd();
+        const bool hasCost = cost != m_addressCosts.constEnd();
+        for (int event = 0; event < static_cast<int>(m_totalCosts.size()); event++) {
+            row.append(formatCost(hasCost ? (*cost)[event] : 0, event));
+        }
+        if (isAddress)
+            m_instructionCosts.append(hasCost ? *cost : Data::ItemCost(m_totalCosts.size()));
+    }
+    rows->append(row);
+}
+
+/**
+ *  Format cost as percentage of the total cost of the event, zero cost is not shown
+ * @param cost
+ * @param event
+ * @return
+ */
+QString ResultsDisassemblyPage::formatCost(qint64 cost, int event) const {
+    if (!cost)
+        return QString();
+    return QString::number(cost * 100.f / m_totalCosts[event], 'f', 2) + QLatin1String("%");
+}
+
+/**
+ *  Replace the costs of instructions by the costs of their basic blocks, shown on the first instruction of each
+ *  block, and list the loops of the function with their costs in loopsView
+ */
+void ResultsDisassemblyPage::showControlFlowCosts() {
+    if (!m_showBlockCosts || m_action != Action::Disassembly || !m_showCosts || m_instructions.isEmpty() ||
+        m_instructionCosts.size() != m_instructions.size() || m_totalCosts.size() == 0) {
+        return;
+    }
+    const int numTypes = static_cast<int>(m_totalCosts.size());
+    auto sumCosts = [this, numTypes](int first, int last) {
+        Data::ItemCost sum(numTypes);
+        for (int i = first; i <= last; i++) {
+            for (int event = 0; event < numTypes; event++) {
+                sum[event] += m_instructionCosts.at(i)[event];
             }
-            QStandardItem *asmItem = new QStandardItem();
-            asmItem->setText(asmLine);
-            model->setItem(row, 0, asmItem);
-
-            if (!m_calleesProcessed) {
-                Data::Symbol calleeSymbol = getCalleeSymbol(asmLine);
-                if (calleeSymbol.isValid())
-                    m_callees.insert(row, calleeSymbol);
+        }
+        return sum;
+    };
+
+    {
+        // Update all cells at once
+        const QSignalBlocker blocker(model);
+        for (const auto &block : ControlFlow::basicBlocks(m_instructions)) {
+            const Data::ItemCost blockCost = sumCosts(block.first, block.last);
+            for (int i = block.first; i <= block.last; i++) {
+                for (int event = 0; event < numTypes; event++) {
+                    model->setData(model->index(m_instructionRows.at(i), event + 1),
+                                   i == block.first ? formatCost(blockCost[event], event) : QString());
+                }
             }
+        }
+    }
+    emit model->dataChanged(model->index(0, 0), model->index(model->rowCount() - 1, model->columnCount() - 1));
 
-            // Calculate event times and add them in red to corresponding columns of the current disassembly row
-            if (!m_disasmResult.branchTraverse ||
-                !m_disasmResult.unwindMethod.startsWith(QLatin1String("lbr"))) {
-                for (int event = 0; event < m_disasmResult.selfCosts.numTypes(); event++) {
-                    float totalCost = 0;
-                    auto &entry = m_disasmResult.entry(m_curSymbol);
-                    QHash<Data::Location, Data::LocationCost>::iterator i = entry.relSourceMap.begin();
-                    while (i != entry.relSourceMap.end()) {
-                        Data::Location location = i.key();
-                        Data::LocationCost locationCost = i.value();
-                        float cost = locationCost.selfCost[event];
-                        if (QString::number(location.relAddr, 16) == addrLine.trimmed()) {
-                            costLine = QString::number(cost);
-                        }
-                        totalCost += cost;
-                        i++;
-                    }
+    const auto loops = ControlFlow::loops(m_instructions);
+    if (loops.isEmpty())
+        return;
 
-                    float costInstruction = costLine.toFloat();
-                    costLine = costInstruction ? QString::number(costInstruction * 100 / totalCost, 'f', 2) +
-                                                 QLatin1String("%") : QString();
+    QStringList headerLabels;
+    headerLabels.append(QLatin1String("Loop"));
+    for (int event = 0; event < numTypes; event++) {
+        headerLabels.append(m_disasmResult.selfCosts.typeName(event));
+    }
+    ui->loopsView->clear();
+    ui->loopsView->setHeaderLabels(headerLabels);
 
-                    QStandardItem *costItem = new QStandardItem(costLine);
-                    model->setItem(row, event + 1, costItem);
-                }
+    // Most expensive loops by the first event first
+    QVector<QPair<Data::ItemCost, ControlFlow::Loop>> loopCosts;
+    for (const auto &loop : loops) {
+        loopCosts.append(qMakePair(sumCosts(loop.header, loop.latch), loop));
+    }
+    std::stable_sort(loopCosts.begin(), loopCosts.end(),
+                     [](const QPair<Data::ItemCost, ControlFlow::Loop> &lhs,
+                        const QPair<Data::ItemCost, ControlFlow::Loop> &rhs) {
+                         return lhs.first[0] > rhs.first[0];
+                     });
+    for (const auto &loopCost : loopCosts) {
+        const auto &loop = loopCost.second;
+        auto *item = new QTreeWidgetItem(ui->loopsView);
+        item->setText(0, QString::number(m_instructions.at(loop.header).address, 16) + QLatin1String(" - ") +
+                         QString::number(m_instructions.at(loop.latch).address, 16) + QLatin1String(" (") +
+                         QString::number(loop.latch - loop.header + 1) + QLatin1String(" instructions)"));
+        item->setData(0, Qt::UserRole, m_instructionRows.at(loop.header));
+        for (int event = 0; event < numTypes; event++) {
+            item->setText(event + 1, formatCost(loopCost.first[event], event));
+        }
+    }
+    ui->loopsView->show();
+}
+
+/**
+ *  Show how often every instruction was executed and where its branches went according to the LBR branch stacks,
+ *  and list the hot paths of the function, i.e. its executed instruction ranges and taken branches, in branchesView
+ */
+void ResultsDisassemblyPage::showBranchCounts() {
+    if (m_branchColumn < 0 || m_action != Action::Disassembly || m_instructions.isEmpty())
+        return;
+
+    // An instruction is executed once per execution of every range covering it, sum them up in a single sweep
+    QMap<quint64, qint64> executionDeltas;
+    for (auto it = m_curCosts.branchRanges.constBegin(); it != m_curCosts.branchRanges.constEnd(); ++it) {
+        executionDeltas[it.key().first] += it.value();
+        executionDeltas[it.key().second + 1] -= it.value();
+    }
+    QHash<quint64, QStringList> takenBranches;
+    for (auto it = m_curCosts.branchEdges.constBegin(); it != m_curCosts.branchEdges.constEnd(); ++it) {
+        takenBranches[it.key().first].append(QChar(0x2192) + QLatin1Char(' ') + QString::number(it.key().second, 16) +
+                                             QLatin1Char(' ') + QChar(0xd7) + QString::number(it.value()));
+    }
+
+    {
+        // Update all cells at once
+        const QSignalBlocker blocker(model);
+        qint64 executions = 0;
+        auto delta = executionDeltas.constBegin();
+        for (int i = 0; i < m_instructions.size(); i++) {
+            const quint64 address = m_instructions.at(i).address;
+            for (; delta != executionDeltas.constEnd() && delta.key() <= address; ++delta) {
+                executions += delta.value();
             }
-            row++;
+            const int row = m_instructionRows.at(i);
+            model->setData(model->index(row, m_branchColumn), executions > 0 ? QString::number(executions) : QString());
+            model->setData(model->index(row, m_branchColumn + 1),
+                           takenBranches.value(address).join(QLatin1String(", ")));
+        }
+    }
+    emit model->dataChanged(model->index(0, 0), model->index(model->rowCount() - 1, model->columnCount() - 1));
+
+    struct HotPath
+    {
+        QString text;
+        quint64 executions;
+        int row;
+    };
+    QVector<HotPath> hotPaths;
+    for (auto it = m_curCosts.branchRanges.constBegin(); it != m_curCosts.branchRanges.constEnd(); ++it) {
+        const int row = m_addressRows.value(it.key().first, -1);
+        if (row >= 0) {
+            hotPaths.append({QString::number(it.key().first, 16) + QLatin1String(" - ") +
+                             QString::number(it.key().second, 16), it.value(), row});
+        }
+    }
+    for (auto it = m_curCosts.branchEdges.constBegin(); it != m_curCosts.branchEdges.constEnd(); ++it) {
+        const int row = m_addressRows.value(it.key().first, -1);
+        if (row >= 0) {
+            hotPaths.append({QString::number(it.key().first, 16) + QLatin1Char(' ') + QChar(0x2192) +
+                             QLatin1Char(' ') + QString::number(it.key().second, 16), it.value(), row});
         }
-        setAsmViewModel(model, m_disasmResult.selfCosts.numTypes());
     }
+    if (hotPaths.isEmpty())
+        return;
+
+    // Most executed paths first, ties by address
+    std::stable_sort(hotPaths.begin(), hotPaths.end(), [](const HotPath &lhs, const HotPath &rhs) {
+        return lhs.executions > rhs.executions || (lhs.executions == rhs.executions && lhs.row < rhs.row);
+    });
+    const int MAX_HOT_PATHS = 100;
+    ui->branchesView->clear();
+    for (int i = 0; i < hotPaths.size() && i < MAX_HOT_PATHS; i++) {
+        auto *item = new QTreeWidgetItem(ui->branchesView);
+        item->setText(0, hotPaths.at(i).text);
+        item->setText(1, QString::number(hotPaths.at(i).executions));
+        item->setData(0, Qt::UserRole, hotPaths.at(i).row);
+    }
+    ui->branchesView->show();
 }
 
 /**
  * Produce disassembler with 'perf annotate' and output to Disassembly tab
  */
 void ResultsDisassemblyPage::showAnnotate() {
-    // Show empty tab when selected symbol is not valid
-    if (m_curSymbol.symbol.isEmpty()) {
-        clear();
-    }
-
     m_action = Action::Annotate;
 
     QString bareSymbol = m_curSymbol.symbol.split(QLatin1Char('('))[0];
@@ -542,97 +1007,83 @@ void ResultsDisassemblyPage::showAnnotate() {
     if (m_intelSyntaxDisassembly)
         processName += QLatin1String(" -M intel ");
 
-    QTemporaryFile m_tmpFile;
-    if (m_tmpFile.open()) {
-        QTextStream stream(&m_tmpFile);
-        stream << processDisassemblyGenRun(processName);
-        m_tmpFile.close();
-    }
-
-    model->clear();
-
     QStringList headerList;
     headerList.append(QLatin1String("Assembly"));
     headerList.append(QLatin1String("Event Time"));
-    model->setHorizontalHeaderLabels(headerList);
-    int row = 0;
-    bool isSymBinary = false;
-    bool hasEmptyOutput = false;
-
-    if (m_tmpFile.open()) {
-        QTextStream stream(&m_tmpFile);
-        while (!stream.atEnd()) {
-            QString annotateLine = stream.readLine();
-
-            if (annotateLine.isEmpty()) continue;
-
-            if (!isSymBinary && !hasEmptyOutput)
-                hasEmptyOutput = (annotateLine.startsWith(QLatin1String("Empty output of command")) ||
-                                  annotateLine.startsWith(QLatin1String("Process was not started")) ||
-                                  annotateLine.startsWith(QLatin1String("Empty symbol")));
-
-            if (hasEmptyOutput) {
-                QStandardItem *annotateItem = new QStandardItem(annotateLine);
-                model->setItem(row++, 0, annotateItem);
-                continue;
-            }
+    m_isSymBinary = false;
+    m_hasEmptyOutput = false;
 
-            if (annotateLine.trimmed().startsWith(QLatin1String("Percent"))) {
-                if (annotateLine.contains(m_curSymbol.binary)) {
-                    isSymBinary = true;
+    startOutput(processName, headerList);
+}
 
-                    QStandardItem *annotateItem = new QStandardItem(annotateLine);
-                    model->setItem(row++, 0, annotateItem);
-                    continue;
-                } else {
-                    isSymBinary = false;
-                }
-            }
+/**
+ *  Parse a line of 'perf annotate' output, only the annotation of the binary of the current symbol is shown
+ * @param annotateLine
+ * @param rows
+ */
+void ResultsDisassemblyPage::parseAnnotateLine(const QString &annotateLine, QVector<QStringList> *rows) {
+    if (annotateLine.isEmpty()) return;
 
-            if (!isSymBinary)
-                continue;
+    if (!m_isSymBinary && !m_hasEmptyOutput)
+        m_hasEmptyOutput = (annotateLine.startsWith(QLatin1String("Empty output of command")) ||
+                            annotateLine.startsWith(QLatin1String("Process was not started")) ||
+                            annotateLine.startsWith(QLatin1String("Empty symbol")));
 
-            QStringList asmTokens = annotateLine.split(QLatin1Char(':'));
-            QString cpuLine = asmTokens.value(0);
-            QString addrLine = asmTokens.value(1);
+    if (m_hasEmptyOutput) {
+        rows->append(QStringList(annotateLine));
+        return;
+    }
 
-            asmTokens.removeAt(0);
-            if (asmTokens.size() > 1) {
-                QString prefix = m_noShowAddress ? QString() : QLatin1String("\t");
-                asmTokens[1] = prefix + asmTokens.at(1).trimmed();
-            }
+    if (annotateLine.trimmed().startsWith(QLatin1String("Percent"))) {
+        if (annotateLine.contains(m_curSymbol.binary)) {
+            m_isSymBinary = true;
 
-            if (m_noShowAddress) {
-                QRegExp hexMatcher(QLatin1String("[0-9A-F]+$"), Qt::CaseInsensitive);
-                if (hexMatcher.exactMatch(addrLine.trimmed())) {
-                    asmTokens.removeFirst();
-                }
-            }
-            QString asmLine = asmTokens.join(QLatin1Char(':'));
+            rows->append(QStringList(annotateLine));
+            return;
+        } else {
+            m_isSymBinary = false;
+        }
+    }
 
-            if (!addrLine.isEmpty()) {
+    if (!m_isSymBinary)
+        return;
 
-                if (!cpuLine.isEmpty() && cpuLine.toDouble() != 0) {
-                    QStandardItem *cpuItem = new QStandardItem(cpuLine.trimmed() + QLatin1String("%"));
-                    model->setItem(row, 1, cpuItem);
-                }
+    QStringList asmTokens = annotateLine.split(QLatin1Char(':'));
+    QString cpuLine = asmTokens.value(0);
+    QString addrLine = asmTokens.value(1);
 
-                if (!m_calleesProcessed) {
-                    Data::Symbol calleeSymbol = getCalleeSymbol(asmLine);
-                    if (calleeSymbol.isValid())
-                        m_callees.insert(row, calleeSymbol);
-                }
+    asmTokens.removeAt(0);
+    if (asmTokens.size() > 1) {
+        QString prefix = m_noShowAddress ? QString() : QLatin1String("\t");
+        asmTokens[1] = prefix + asmTokens.at(1).trimmed();
+    }
 
-                QStandardItem *asmItem = new QStandardItem(asmLine);
-                model->setItem(row, 0, asmItem);
-                row++;
-            }
+    if (m_noShowAddress) {
+        if (isHexAddress(addrLine)) {
+            asmTokens.removeFirst();
         }
     }
-    setAsmViewModel(model, 1);
-    if (!m_calleesProcessed) {
-        m_searchDelegate->setCallees(m_callees);
-        m_calleesProcessed = true;
+    QString asmLine = asmTokens.join(QLatin1Char(':'));
+
+    if (!addrLine.isEmpty()) {
+        bool isAddress = false;
+        const quint64 address = addrLine.trimmed().toULongLong(&isAddress, 16);
+        if (isAddress)
+            m_addressRows.insert(address, model->rowCount() + rows->size());
+
+        QStringList row;
+        row.append(asmLine);
+        if (!cpuLine.isEmpty() && cpuLine.toDouble() != 0) {
+            row.append(cpuLine.trimmed() + QLatin1String("%"));
+        }
+
+        if (!m_calleesProcessed) {
+            Data::Symbol calleeSymbol = getCalleeSymbol(asmLine);
+            if (calleeSymbol.isValid())
+                m_callees.insert(model->rowCount() + rows->size(), calleeSymbol);
+        }
+
+        rows->append(row);
     }
 }
 
@@ -641,50 +1092,212 @@ void ResultsDisassemblyPage::showAnnotate() {
  */
 void ResultsDisassemblyPage::setData(const Data::Symbol &symbol) {
     m_curSymbol = symbol;
+    m_curCosts = {};
+    m_disassemblyShown = false;
 
     if (m_curSymbol.symbol.isEmpty()) {
         return;
     }
+    m_parser->requestDisassemblyCosts(m_curSymbol);
 
     m_symfs.clear();
-    m_curAppPath = m_curSymbol.path;
+    m_curAppPath = resolveAppPath(m_curSymbol);
+    if (!m_curSymbol.path.isEmpty() && !QFile::exists(m_curSymbol.path)) {
+        if (m_targetRoot.isEmpty()) m_targetRoot = QLatin1String("/tmp");
+
+        QString linkPath = m_targetRoot + m_curSymbol.path;
+        if (!QFile::exists(linkPath)) {
+            QDir dir(QDir::root());
+            QFileInfo linkPathInfo = QFileInfo(linkPath);
+            dir.mkpath(linkPathInfo.absolutePath());
+            QFile::copy(m_curAppPath, linkPath);
+
+            m_tmpAppList.push_back(linkPath);
+        }
+        m_symfs = QLatin1String(" --symfs=") + m_targetRoot;
+    }
+    m_searchDelegate->setDiagnosticStyle(false);
+    m_callees.clear();
+    m_calleesProcessed = false;
+}
+
+/**
+ *  Find the binary of symbol: at its recorded path, at the application path or in extraLibPaths
+ * @param symbol
+ * @return
+ */
+QString ResultsDisassemblyPage::resolveAppPath(const Data::Symbol &symbol) const {
+    QString appPath = symbol.path;
     // If binary is not found at the specified path, use current binary file located at the application path
-    if (!QFile::exists(m_curAppPath) || m_arch.startsWith(QLatin1String("arm"))) {
-        m_curAppPath = m_appPath + QDir::separator() + m_curSymbol.binary;
+    if (!QFile::exists(appPath) || m_arch.startsWith(QLatin1String("arm"))) {
+        appPath = m_appPath + QDir::separator() + symbol.binary;
     }
     // If binary is still not found, trying to find it in extraLibPaths
-    if (!QFile::exists(m_curAppPath) || m_arch.startsWith(QLatin1String("arm"))) {
+    if (!QFile::exists(appPath) || m_arch.startsWith(QLatin1String("arm"))) {
         QStringList dirs = m_extraLibPaths.split(QLatin1String(":"));
         foreach (QString dir, dirs) {
             QDirIterator it(dir, QDir::Dirs, QDirIterator::Subdirectories);
 
             while (it.hasNext()) {
                 QString dirName = it.next();
-                QString fileName = dirName + QDir::separator() + m_curSymbol.binary;
+                QString fileName = dirName + QDir::separator() + symbol.binary;
                 if (QFile::exists(fileName)) {
-                    m_curAppPath = fileName;
+                    appPath = fileName;
                     break;
                 }
             }
         }
     }
-    if (!m_curSymbol.path.isEmpty() && !QFile::exists(m_curSymbol.path)) {
-        if (m_targetRoot.isEmpty()) m_targetRoot = QLatin1String("/tmp");
+    return appPath;
+}
 
-        QString linkPath = m_targetRoot + m_curSymbol.path;
-        if (!QFile::exists(linkPath)) {
-            QDir dir(QDir::root());
-            QFileInfo linkPathInfo = QFileInfo(linkPath);
-            dir.mkpath(linkPathInfo.absolutePath());
-            QFile::copy(m_curAppPath, linkPath);
+/**
+ *  Remember the hottest symbols by self cost, limited by the prefetch setting
+ * @param bottomUp
+ */
+void ResultsDisassemblyPage::setPrefetchSymbols(const Data::BottomUpResults &bottomUp) {
+    // The direct children of the bottom-up root carry the self cost of each symbol
+    QVector<const Data::BottomUp *> rows;
+    rows.reserve(bottomUp.root.children.size());
+    for (const auto &row : bottomUp.root.children) {
+        if (!row.symbol.symbol.isEmpty() && !row.symbol.binary.isEmpty())
+            rows.append(&row);
+    }
+    const auto &costs = bottomUp.costs;
+    const int count = costs.numTypes() ? std::min(rows.size(), Settings::instance()->prefetchSymbols()) : 0;
+    std::partial_sort(rows.begin(), rows.begin() + count, rows.end(),
+                      [&costs](const Data::BottomUp *lhs, const Data::BottomUp *rhs) {
+                          return costs.cost(0, lhs->id) > costs.cost(0, rhs->id);
+                      });
+
+    m_prefetchSymbols.clear();
+    for (int i = 0; i < count; i++) {
+        m_prefetchSymbols.append(rows.at(i)->symbol);
+    }
+}
 
-            m_tmpAppList.push_back(linkPath);
+/**
+ *  Disassemble the hottest symbols in the background, so that their Disassembly is shown at once.
+ *  Their costs are requested too, the parser keeps them until the results change
+ */
+void ResultsDisassemblyPage::prefetchDisassembly() {
+    cancelPrefetch();
+    // 'perf annotate' covers the whole perf.data file, only 'objdump' output is worth to prefetch
+    if (m_action != Action::Disassembly || m_objdump.isEmpty())
+        return;
+
+    const bool byAddressRange = isAddressRangeApproach();
+    QHash<QString, QString> appPaths;
+    QSet<QString> indexedBinaries;
+    for (const auto &symbol : m_prefetchSymbols) {
+        // Costs of the current symbol are requested already
+        if (symbol != m_curSymbol)
+            m_parser->requestDisassemblyCosts(symbol);
+
+        // Look for each binary once, extraLibPaths are searched recursively
+        const QString binaryKey = symbol.path + QLatin1Char('\n') + symbol.binary;
+        auto appPath = appPaths.find(binaryKey);
+        if (appPath == appPaths.end())
+            appPath = appPaths.insert(binaryKey, resolveAppPath(symbol));
+        if (!QFile::exists(*appPath))
+            continue;
+
+        PrefetchCommand command;
+        command.appPath = *appPath;
+        // By address range each binary is disassembled once, symbols without size still need their own command
+        command.indexBinary = byAddressRange && symbol.size != 0;
+        if (command.indexBinary) {
+            if (indexedBinaries.contains(*appPath))
+                continue;
+            indexedBinaries.insert(*appPath);
+            command.processName = objdumpBinaryCommand(*appPath);
+            if (!m_binaryIndexes.contains(outputCacheKey(command.processName, command.appPath)))
+                m_prefetchQueue.append(command);
+        } else {
+            command.processName = objdumpCommand(symbol, *appPath, byAddressRange);
+            if (!m_outputCache.contains(outputCacheKey(command.processName, command.appPath)))
+                m_prefetchQueue.append(command);
         }
-        m_symfs = QLatin1String(" --symfs=") + m_targetRoot;
     }
-    m_searchDelegate->setDiagnosticStyle(false);
-    m_callees.clear();
-    m_calleesProcessed = false;
+    startPrefetchProcesses();
+}
+
+/**
+ *  Start queued prefetch commands while fewer processes than allowed by the prefetch setting are running
+ */
+void ResultsDisassemblyPage::startPrefetchProcesses() {
+    const int maxProcesses = Settings::instance()->prefetchProcesses();
+    while (!m_prefetchQueue.isEmpty() && m_prefetchProcesses.size() < maxProcesses) {
+        const PrefetchCommand command = m_prefetchQueue.takeFirst();
+        const QString key = outputCacheKey(command.processName, command.appPath);
+
+        auto *process = new QProcess(this);
+        m_prefetchProcesses.append(process);
+        if (command.indexBinary) {
+            // Index the output while it arrives, so that it is never held twice
+            std::shared_ptr<DisassemblyIndex> index = std::make_shared<DisassemblyIndex>();
+            const int maxSize = m_binaryIndexes.maxCost() * 1024;
+            connect(process, &QProcess::readyReadStandardOutput, this, [process, index, maxSize]() {
+                index->append(process->readAllStandardOutput());
+                // The index would not fit into the cache anyway
+                if (index->size() > maxSize)
+                    process->kill();
+            });
+            connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+                    [this, process, index, key](int /*exitCode*/, QProcess::ExitStatus exitStatus) {
+                        index->append(process->readAllStandardOutput());
+                        index->finish();
+                        const int cost = index->size() / 1024 + 1;
+                        if (exitStatus == QProcess::NormalExit && index->instructionCount() > 0 &&
+                            cost <= m_binaryIndexes.maxCost()) {
+                            m_binaryIndexes.insert(key, new DisassemblyIndex(*index), cost);
+                        }
+                        finishPrefetchProcess(process);
+                    });
+        } else {
+            connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+                    [this, process, key](int /*exitCode*/, QProcess::ExitStatus exitStatus) {
+                        const QByteArray output = process->readAllStandardOutput();
+                        const int cost = output.size() / 1024 + 1;
+                        // Prefetched output must not evict output that was shown already
+                        if (exitStatus == QProcess::NormalExit && !output.isEmpty() && !m_outputCache.contains(key) &&
+                            m_outputCache.totalCost() + cost <= m_outputCache.maxCost()) {
+                            m_outputCache.insert(key, new QByteArray(output), cost);
+                        }
+                        finishPrefetchProcess(process);
+                    });
+        }
+        connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                finishPrefetchProcess(process);
+            }
+        });
+        process->start(command.processName);
+    }
+}
+
+/**
+ *  Dispose of finished prefetch process and start the next queued command
+ * @param process
+ */
+void ResultsDisassemblyPage::finishPrefetchProcess(QProcess *process) {
+    m_prefetchProcesses.removeOne(process);
+    process->disconnect(this);
+    process->deleteLater();
+    startPrefetchProcesses();
+}
+
+/**
+ *  Stop the prefetching, e.g. when new results are coming
+ */
+void ResultsDisassemblyPage::cancelPrefetch() {
+    m_prefetchQueue.clear();
+    for (auto *process : m_prefetchProcesses) {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+    }
+    m_prefetchProcesses.clear();
 }
 
 /**
@@ -699,6 +1312,15 @@ void ResultsDisassemblyPage::setData(const Data::DisassemblyResult &data) {
     m_disasmApproach = data.disasmApproach;
     m_disasmResult = data;
 
+    m_symbolsByAddress.clear();
+    m_unsizedSymbols.clear();
+    for (const auto &symbol : data.symbols) {
+        if (symbol.size == 0 && symbol.relAddr == 0)
+            m_unsizedSymbols.append(symbol);
+        else
+            m_symbolsByAddress.insert(symbol.relAddr, symbol);
+    }
+
     m_objdump = m_arch.startsWith(QLatin1String("arm")) ? QLatin1String("arm-linux-gnueabi-objdump") : QLatin1String(
             "objdump");
     if (m_arch.startsWith(QLatin1String("armv8")) || m_arch.startsWith(QLatin1String("aarch64"))) {
@@ -744,17 +1366,25 @@ Data::Symbol ResultsDisassemblyPage::getCalleeSymbol(QString asmLine) {
         if (sym.size() >= 2) {
             calcFunction(sym, &offset, &symName);
 
-            QHash<Data::Symbol, Data::DisassemblyEntry>::iterator i = m_disasmResult.entries.begin();
-            while (i != m_disasmResult.entries.end()) {
-                QString relAddr = QString::number(i.key().relAddr, 16);
-                if (!i.key().mangled.isEmpty() &&
-                    (symName.contains(i.key().mangled) || symName.contains(i.key().symbol) ||
-                     i.key().mangled.contains(symName) || i.key().symbol.contains(symName)) &&
-                    ((relAddr == offset) ||
-                     (i.key().size == 0 && i.key().relAddr == 0))) {
-                    return i.key();
+            auto matchesName = [&symName](const Data::Symbol &symbol) {
+                return !symbol.mangled.isEmpty() &&
+                       (symName.contains(symbol.mangled) || symName.contains(symbol.symbol) ||
+                        symbol.mangled.contains(symName) || symbol.symbol.contains(symName));
+            };
+            // Look up the call target by its address, symbols without address can only be matched by name
+            bool isAddress = false;
+            const quint64 address = offset.toULongLong(&isAddress, 16);
+            if (isAddress) {
+                auto i = m_symbolsByAddress.constFind(address);
+                while (i != m_symbolsByAddress.constEnd() && i.key() == address) {
+                    if (matchesName(*i))
+                        return *i;
+                    i++;
                 }
-                i++;
+            }
+            for (const auto &symbol : m_unsizedSymbols) {
+                if (matchesName(symbol))
+                    return symbol;
             }
         }
     }
@@ -776,15 +1406,14 @@ void ResultsDisassemblyPage::navigateToAddressInstruction(QModelIndex index, QSt
     while (matchIterator.hasNext()) {
         QRegularExpressionMatch match = matchIterator.next();
         address = asmLine.mid(match.capturedStart(), match.capturedLength() - 1);
-        for (int i = 0; i < model->rowCount(); i++) {
-            QStandardItem *asmItem = model->item(i, 0);
-            if (asmItem->text().trimmed().startsWith(address.trimmed())) {
-                selectedIndex = model->index(i, 0);
-                isScrollTo = true;
-                m_addressStack.push(index.row());
-                ui->backButton->setEnabled(true);
-                break;
-            }
+        // Rows of the shown instructions are indexed by address while the output is parsed
+        bool isAddress = false;
+        const auto row = m_addressRows.constFind(address.trimmed().toULongLong(&isAddress, 16));
+        if (isAddress && row != m_addressRows.constEnd()) {
+            selectedIndex = model->index(*row, 0);
+            isScrollTo = true;
+            m_addressStack.push(index.row());
+            ui->backButton->setEnabled(true);
         }
     }    
     ui->asmView->setCurrentIndex(selectedIndex);
@@ -808,7 +1437,7 @@ void ResultsDisassemblyPage::jumpToAsmCallee(QModelIndex index) {
         resetDisassembly();
 
         m_addressStack.clear();
-        ui->asmView->scrollTo(model->index(0, 0));
+        selectRow(0);
         ui->backButton->setEnabled(true);
     } else if (asmLine.contains(opCodeReturn) && !m_callStack.isEmpty()) {
         returnToCaller();
@@ -843,8 +1472,7 @@ void ResultsDisassemblyPage::returnToCaller() {
         int callerIndex = caller.value(callerSymbol);
         setData(callerSymbol);
         resetDisassembly();
-        ui->asmView->setCurrentIndex(model->index(callerIndex, 0));
-        ui->asmView->scrollTo(model->index(callerIndex, 0));    
+        selectRow(callerIndex);
 
         m_addressStack.clear();
     }
@@ -873,6 +1501,15 @@ void ResultsDisassemblyPage::resetDisassembly() {
     }
 }
 
+/**
+ *  Show Disassembly again, e.g. with new costs, and keep the selected row
+ */
+void ResultsDisassemblyPage::refreshDisassembly() {
+    int row = selectedRow();
+    resetDisassembly();
+    selectRow(row);
+}
+
 /**
  *  Setter for m_noShowRawInsn
  * @param noShowRawInsn
@@ -23,15 +23,18 @@
 #pragma once
 
 #include <QWidget>
-#include <QTemporaryFile>
+#include <QCache>
 #include <QStandardItemModel>
 #include <QStack>
 #include "data.h"
 #include "models/searchdelegate.h"
 #include "models/disassemblymodel.h"
+#include "models/disassemblyindex.h"
+#include "models/controlflow.h"
 #include <QItemSelection>
 
 class QMenu;
+class QProcess;
 
 namespace Ui {
 class ResultsDisassemblyPage;
@@ -48,8 +51,6 @@ class FilterAndZoomStack;
 
 class ResultsDisassemblyPage : public QWidget
 {
-    static const int MSECS_PROCESS = 3600000;
-
     Q_OBJECT
     Q_ENUMS(Action)
 public:
@@ -58,7 +59,7 @@ public:
         Annotate
     };
 
-    explicit ResultsDisassemblyPage(FilterAndZoomStack* filterStack, QWidget* parent = nullptr);
+    explicit ResultsDisassemblyPage(FilterAndZoomStack* filterStack, PerfParser* parser, QWidget* parent = nullptr);
     ~ResultsDisassemblyPage();
 
     void clear();
@@ -67,24 +68,35 @@ public:
     void filterDisassemblyAddress(bool filtered);
     void switchOnIntelSyntax(bool intelSyntax);
     void switchDisassemblyMethod(bool disasmMethod);
-    QByteArray processDisassemblyGenRun(QString processName);
+    void showBasicBlockCosts(bool show);
+    QByteArray processNotStartedDiag();
+    QByteArray processEmptyOutputDiag(const QString &processName);
+    void startEmptyOutputDiag(const QString &processName);
     void setAsmViewModel(QStandardItemModel *model, int numTypes);
     void showDisassembly();
     void showDisassemblyBySymbol();
     void showDisassemblyByAddressRange();
+    // Command that disassembles symbol from the binary at appPath with the current options
+    QString objdumpCommand(const Data::Symbol &symbol, const QString &appPath, bool byAddressRange) const;
+    // Command that disassembles the whole text section of the binary at appPath with the current options
+    QString objdumpBinaryCommand(const QString &appPath) const;
     // Output Disassembly that is the result of running 'processName' command on tab Disassembly
-    void showDisassembly(QString processName);
+    void showDisassembly(const QString &processName);
     void showAnnotate();
+    void parseDisassemblyLine(QString asmLine, QVector<QStringList> *rows);
+    void parseAnnotateLine(const QString &annotateLine, QVector<QStringList> *rows);
     void resetDisassembly();
+    void refreshDisassembly();
     void setAppPath(const QString& path);
     void setData(const Data::Symbol& data);
     void setData(const Data::DisassemblyResult& data);
+    void setPrefetchSymbols(const Data::BottomUpResults& bottomUp);
+    void prefetchDisassembly();
     void resetCallStack();
     void zoomFont(QWheelEvent *event);
     void wheelEvent(QWheelEvent *event) override;
-    void getObjdumpVersion();
+    void setObjdumpVersion(const QByteArray &versionOutput);
     void searchTextAndHighlight();
-    QByteArray processPerfAnnotateDiag(QString processName);
     Data::Symbol getCalleeSymbol(QString asmLine);
     void returnToCaller();
     void returnToJump();
@@ -105,9 +117,10 @@ public slots:
 
 private:
     FilterAndZoomStack* m_filterAndZoomStack;
+    PerfParser* m_parser;
     QScopedPointer<Ui::ResultsDisassemblyPage> ui;
     // Asm view model
-    QStandardItemModel *model;
+    DisassemblyModel *model;
     // Call stack
     QStack<QMap<Data::Symbol, int>> m_callStack;
     // Perf.data path
@@ -132,8 +145,12 @@ private:
     QString m_disasmApproach;
     // Objdump binary name
     QString m_objdump;
-    // Map of symbols and its locations with costs
+    // Disassembly settings and symbols with samples
     Data::DisassemblyResult m_disasmResult;
+    // Locations of the current symbol with costs, requested from the parser on demand
+    Data::DisassemblyEntry m_curCosts;
+    // Disassembly of the current symbol is shown and has to be updated when its costs arrive
+    bool m_disassemblyShown;
     // Disassembly action: Disassembly or Annotate
     Action m_action;
     // Not to show machine codes of Disassembly
@@ -158,6 +175,71 @@ private:
     bool m_calleesProcessed;
     // Jump instruction source
     QStack<int> m_addressStack;
+    // Rows of the shown instructions by address, to resolve jump targets
+    QHash<quint64, int> m_addressRows;
+    // Symbols with samples by relative address, symbols without address and size can only be matched by name
+    QMultiHash<quint64, Data::Symbol> m_symbolsByAddress;
+    QVector<Data::Symbol> m_unsizedSymbols;
+    // Running objdump or perf annotate, its output is streamed into the model
+    QProcess *m_process;
+    // Output of m_process so far, cached once it finished
+    QByteArray m_processOutput;
+    // Incomplete last line of the output
+    QByteArray m_outputTail;
+    // Row to select once the output is complete
+    int m_pendingRow;
+    // Costs of the current symbol arrived while the output was loading
+    bool m_costsChanged;
+    // Self costs of the current symbol by relative address and their totals
+    QHash<quint64, Data::ItemCost> m_addressCosts;
+    Data::ItemCost m_totalCosts;
+    bool m_showCosts;
+    QString formatCost(qint64 cost, int event) const;
+    // Instructions of the shown function with their rows and self costs, to sum up costs by basic block and loop
+    QVector<ControlFlow::Instruction> m_instructions;
+    QVector<int> m_instructionRows;
+    QVector<Data::ItemCost> m_instructionCosts;
+    // Show costs of basic blocks instead of instructions and costs of loops in loopsView
+    bool m_showBlockCosts;
+    void showControlFlowCosts();
+    // First of the columns with the executions and taken branches of the instructions counted in LBR branch stacks,
+    // -1 when the current symbol has no branch counts
+    int m_branchColumn;
+    void showBranchCounts();
+    // perf annotate parsing state: within the annotation of the current binary, or showing diagnostics
+    bool m_isSymBinary;
+    bool m_hasEmptyOutput;
+    // Output by command, see outputCacheKey. Least recently shown output is dropped first
+    QCache<QString, QByteArray> m_outputCache;
+    // Command of a symbol whose output is fetched into m_outputCache in the background
+    struct PrefetchCommand
+    {
+        QString processName;
+        QString appPath;
+        // Output goes into m_binaryIndexes rather than m_outputCache
+        bool indexBinary;
+    };
+    // Hottest symbols by self cost, their disassembly is prefetched once the parsing finished
+    QVector<Data::Symbol> m_prefetchSymbols;
+    // Commands not started yet and running processes of the prefetching
+    QVector<PrefetchCommand> m_prefetchQueue;
+    QVector<QProcess *> m_prefetchProcesses;
+    // Whole binaries disassembled once by address range approach, by the key of objdumpBinaryCommand
+    QCache<QString, DisassemblyIndex> m_binaryIndexes;
+    QByteArray indexedOutput() const;
+    QString resolveAppPath(const Data::Symbol &symbol) const;
+    bool isAddressRangeApproach() const;
+    QString objdumpOptions() const;
+    QString outputCacheKey(const QString &processName, const QString &appPath,
+                           const QString &perfDataPath = QString()) const;
+    void startPrefetchProcesses();
+    void finishPrefetchProcess(QProcess *process);
+    void cancelPrefetch();
+    void startOutput(const QString &processName, const QStringList &headerList);
+    void appendOutput(const QByteArray &output);
+    void finishOutput();
+    void cancelOutput();
+    void parseOutputLine(QString line, QVector<QStringList> *rows);
     // Setter for m_noShowRawInsn
     void setNoShowRawInsn(bool noShowRawInsn);
     // Setter for m_noShowAddress
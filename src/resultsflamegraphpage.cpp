@@ -28,11 +28,13 @@
 #include "resultsflamegraphpage.h"
 #include "ui_resultsflamegraphpage.h"
 
+#include "flamegraphexport.h"
 #include "parsers/perf/perfparser.h"
 
 #include <QMenu>
 #include <QAction>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QImageWriter>
 #include <QTextStream>
 #include <QMessageBox>
@@ -63,12 +65,33 @@ ResultsFlameGraphPage::ResultsFlameGraphPage(FilterAndZoomStack* filterStack, Pe
                 ui->flameGraph->setBottomUpData(data);
                 m_exportAction = exportMenu->addAction(QIcon::fromTheme(QStringLiteral("image-x-generic")), tr("Flamegraph"));
                 connect(m_exportAction, &QAction::triggered, this, [this]() {
-                    const auto filter = tr("Images (%1);;SVG (*.svg)").arg(imageFormatFilter());
+                    const auto completeSvgFilter = tr("Complete SVG (*.svg)");
+                    const auto collapsedFilter = tr("Collapsed Stacks (*.collapsed *.folded)");
+                    const auto filter = tr("Images (%1);;SVG (*.svg)").arg(imageFormatFilter())
+                        + QLatin1String(";;") + completeSvgFilter + QLatin1String(";;") + collapsedFilter;
                     QString selectedFilter;
                     const auto fileName = QFileDialog::getSaveFileName(this, tr("Export Flamegraph"), {}, filter, &selectedFilter);
                     if (fileName.isEmpty())
                         return;
-                    if (selectedFilter.contains(QStringLiteral("svg"))) {
+                    if (selectedFilter == completeSvgFilter || selectedFilter == collapsedFilter) {
+                        QString errorMessage;
+                        bool success = false;
+                        if (selectedFilter == collapsedFilter) {
+                            success = ui->flameGraph->saveCollapsedStacks(fileName, &errorMessage);
+                        } else {
+                            bool ok = false;
+                            const auto minWidth = QInputDialog::getDouble(
+                                this, tr("Export Flamegraph"), tr("Skip frames narrower than (pixels):"),
+                                FlameGraphExport::SvgOptions().minWidth, 0, 1000, 2, &ok);
+                            if (!ok)
+                                return;
+                            success = ui->flameGraph->saveCompleteSvg(fileName, minWidth, &errorMessage);
+                        }
+                        if (!success) {
+                            QMessageBox::warning(this, tr("Export Failed"),
+                                                tr("Failed to export flamegraph: %1").arg(errorMessage));
+                        }
+                    } else if (selectedFilter.contains(QStringLiteral("svg"))) {
                         ui->flameGraph->saveSvg(fileName);
                     } else {
                         QImageWriter writer(fileName);
@@ -0,0 +1,70 @@
+/*
+    resultslockspage.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "resultslockspage.h"
+#include "ui_resultslockspage.h"
+
+#include "parsers/perf/perfparser.h"
+#include "resultsutil.h"
+
+#include "models/lockcontentionmodel.h"
+
+ResultsLocksPage::ResultsLocksPage(FilterAndZoomStack* filterStack, PerfParser* parser, QWidget* parent)
+    : QWidget(parent)
+    , ui(new Ui::ResultsLocksPage)
+{
+    ui->setupUi(this);
+    ui->noDataLabel->setVisible(false);
+    ui->noAddressesLabel->setVisible(false);
+
+    auto sitesModel = new LockContentionModel(this);
+    ResultsUtil::setupTreeView(ui->sitesView, ui->sitesSearch, sitesModel);
+    ResultsUtil::setupContextMenu(ui->sitesView, sitesModel, filterStack,
+                                  [this](const Data::Symbol& symbol) { emit jumpToCallerCallee(symbol); });
+
+    auto histogramModel = new LockWaitHistogramModel(this);
+    ui->histogramView->setModel(histogramModel);
+    ResultsUtil::setupCostDelegate(histogramModel, ui->histogramView);
+    ResultsUtil::stretchFirstColumn(ui->histogramView);
+
+    connect(ui->sitesView->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            [histogramModel](const QModelIndex& current) {
+                histogramModel->setSite(current.data(LockContentionModel::SiteRole).value<Data::LockWaitSite>());
+            });
+
+    connect(parser, &PerfParser::lockContentionDataAvailable, this,
+            [this, sitesModel, histogramModel](const Data::LockContentionResults& data) {
+                const bool hasData = !data.sites.isEmpty();
+                ui->noDataLabel->setVisible(!hasData);
+                ui->noAddressesLabel->setVisible(hasData && !data.hasLockAddresses);
+                ui->splitter->setVisible(hasData);
+
+                sitesModel->setData(data);
+                histogramModel->setSite({});
+            });
+}
+
+ResultsLocksPage::~ResultsLocksPage() = default;
+
+void ResultsLocksPage::clear()
+{
+    ui->sitesSearch->setText({});
+}
@@ -0,0 +1,64 @@
+/*
+    resultsoffcpupage.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "resultsoffcpupage.h"
+#include "ui_resultsoffcpupage.h"
+
+#include "parsers/perf/perfparser.h"
+#include "resultsutil.h"
+
+#include "models/offcpumodel.h"
+
+ResultsOffCpuPage::ResultsOffCpuPage(FilterAndZoomStack* filterStack, PerfParser* parser, QWidget* parent)
+    : QWidget(parent)
+    , ui(new Ui::ResultsOffCpuPage)
+{
+    ui->setupUi(this);
+    ui->flameGraph->setFilterStack(filterStack);
+    ui->noDataLabel->setVisible(false);
+
+    auto callSitesModel = new OffCpuModel(this);
+    ResultsUtil::setupTreeView(ui->callSitesView, ui->callSitesSearch, callSitesModel);
+    ResultsUtil::setupContextMenu(ui->callSitesView, callSitesModel, filterStack,
+                                  [this](const Data::Symbol& symbol) { emit jumpToCallerCallee(symbol); });
+
+    connect(parser, &PerfParser::offCpuDataAvailable, this,
+            [this, callSitesModel](const Data::OffCpuResults& data) {
+                const bool hasData = data.bottomUp.costs.totalCost(Data::OffCpuResults::BlockedTime) > 0
+                    || data.bottomUp.costs.totalCost(Data::OffCpuResults::PreemptedTime) > 0;
+                ui->noDataLabel->setVisible(!hasData);
+                ui->splitter->setVisible(hasData);
+
+                ui->flameGraph->setBottomUpData(data.bottomUp);
+                ui->flameGraph->setTopDownData(data.topDown);
+                callSitesModel->setData(data);
+            });
+
+    connect(ui->flameGraph, &FlameGraph::jumpToCallerCallee, this, &ResultsOffCpuPage::jumpToCallerCallee);
+}
+
+ResultsOffCpuPage::~ResultsOffCpuPage() = default;
+
+void ResultsOffCpuPage::clear()
+{
+    ui->flameGraph->clear();
+    ui->callSitesSearch->setText({});
+}
@@ -34,6 +34,10 @@
 #include "resultsdisassemblypage.h"
 #include "resultscallercalleepage.h"
 #include "resultsflamegraphpage.h"
+#include "resultsoffcpupage.h"
+#include "resultsparallelismpage.h"
+#include "resultslockspage.h"
+#include "resultstracepointspage.h"
 #include "resultssummarypage.h"
 #include "resultstopdownpage.h"
 #include "resultsutil.h"
@@ -55,6 +59,7 @@ static const int SUMMARY_TABINDEX = 0;
 ResultsPage::ResultsPage(PerfParser* parser, QWidget* parent)
     : QWidget(parent)
     , ui(new Ui::ResultsPage)
+    , m_parser(parser)
     , m_filterAndZoomStack(new FilterAndZoomStack(this))
     , m_filterMenu(new QMenu(this))
     , m_exportMenu(new QMenu(tr("Export"), this))
@@ -63,10 +68,15 @@ ResultsPage::ResultsPage(PerfParser* parser, QWidget* parent)
     , m_resultsTopDownPage(new ResultsTopDownPage(m_filterAndZoomStack, parser, this))
     , m_resultsFlameGraphPage(new ResultsFlameGraphPage(m_filterAndZoomStack, parser, m_exportMenu, this))
     , m_resultsCallerCalleePage(new ResultsCallerCalleePage(m_filterAndZoomStack, parser, this))
-    , m_resultsDisassemblyPage(new ResultsDisassemblyPage(m_filterAndZoomStack, this))
+    , m_resultsOffCpuPage(new ResultsOffCpuPage(m_filterAndZoomStack, parser, this))
+    , m_resultsParallelismPage(new ResultsParallelismPage(m_filterAndZoomStack, parser, this))
+    , m_resultsLocksPage(new ResultsLocksPage(m_filterAndZoomStack, parser, this))
+    , m_resultsTracePointsPage(new ResultsTracePointsPage(parser, this))
+    , m_resultsDisassemblyPage(new ResultsDisassemblyPage(m_filterAndZoomStack, parser, this))
     , m_timeLineDelegate(nullptr)
     , m_filterBusyIndicator(nullptr) // create after we setup the UI to keep it on top
     , m_timelineVisible(true)
+    , m_hasDisassemblyData(false)
 {
     m_exportMenu->setIcon(QIcon::fromTheme(QStringLiteral("document-export")));
     {
@@ -89,6 +99,10 @@ ResultsPage::ResultsPage(PerfParser* parser, QWidget* parent)
     ui->resultsTabWidget->addTab(m_resultsTopDownPage, tr("Top Down"));
     ui->resultsTabWidget->addTab(m_resultsFlameGraphPage, tr("Flame Graph"));
     ui->resultsTabWidget->addTab(m_resultsCallerCalleePage, tr("Caller / Callee"));
+    ui->resultsTabWidget->addTab(m_resultsOffCpuPage, tr("Off-CPU"));
+    ui->resultsTabWidget->addTab(m_resultsParallelismPage, tr("Parallelism"));
+    ui->resultsTabWidget->addTab(m_resultsLocksPage, tr("Locks"));
+    ui->resultsTabWidget->addTab(m_resultsTracePointsPage, tr("Tracepoints"));
     ui->resultsTabWidget->addTab(m_resultsDisassemblyPage, tr("Disassembly"));
 
     int tabsCount = ui->resultsTabWidget->count();
@@ -129,10 +143,17 @@ ResultsPage::ResultsPage(PerfParser* parser, QWidget* parent)
 
     connect(parser, &PerfParser::disassemblyDataAvailable, this, [this](const Data::DisassemblyResult& data) {
         this->setData(data);
+        m_hasDisassemblyData = true;
+        if (ui->resultsTabWidget->currentWidget() == m_resultsDisassemblyPage) {
+            // the disassembly was requested before its data arrived
+            m_resultsDisassemblyPage->resetDisassembly();
+        }
     });
 
     connect(parser, &PerfParser::eventsAvailable, this, [this, eventModel](const Data::EventResults& data) {
         eventModel->setData(data);
+        // the path got computed from the previous events
+        m_timeLineDelegate->setCriticalPath({});
         if (data.offCpuTimeCostId != -1) {
             // remove the off-CPU time event source, we only want normal sched switches
             for (int i = 0, c = ui->timeLineEventSource->count(); i < c; ++i) {
@@ -143,7 +164,12 @@ ResultsPage::ResultsPage(PerfParser* parser, QWidget* parent)
             }
         }
     });
+    connect(parser, &PerfParser::parallelismDataAvailable, eventModel, &EventModel::setParallelism);
+    // the lane would not match the new events, until their parallelism arrives
+    connect(parser, &PerfParser::parsingStarted, eventModel, [eventModel]() { eventModel->setParallelism({}); });
     connect(m_filterAndZoomStack, &FilterAndZoomStack::filterChanged, parser, &PerfParser::filterResults);
+    connect(m_timeLineDelegate, &TimeLineDelegate::criticalPathRequested, parser, &PerfParser::requestCriticalPath);
+    connect(parser, &PerfParser::criticalPathAvailable, m_timeLineDelegate, &TimeLineDelegate::setCriticalPath);
 
     connect(ui->timeLineEventSource, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
             [this](int index) {
@@ -152,8 +178,11 @@ ResultsPage::ResultsPage(PerfParser* parser, QWidget* parent)
             });
 
     ui->timeLineArea->hide();
-    connect(ui->resultsTabWidget, &QTabWidget::currentChanged, this,
-            [this](int index) { ui->timeLineArea->setVisible(index != SUMMARY_TABINDEX && m_timelineVisible); });
+    connect(ui->resultsTabWidget, &QTabWidget::currentChanged, this, [this](int index) {
+        ui->timeLineArea->setVisible(index != SUMMARY_TABINDEX && m_timelineVisible);
+        updateWatchedViews();
+    });
+    updateWatchedViews();
     connect(parser, &PerfParser::parsingStarted, this, [this]() {
         // disable when we apply a filter
         // TODO: show some busy indicator?
@@ -166,6 +195,10 @@ ResultsPage::ResultsPage(PerfParser* parser, QWidget* parent)
         ui->timeLineArea->setEnabled(true);
         m_filterBusyIndicator->setVisible(false);
     });
+    connect(parser, &PerfParser::liveSnapshotStarted, this, [this]() {
+        // the results of a live recording are shown while parsing, filtering waits until the recording stopped
+        m_filterBusyIndicator->setVisible(false);
+    });
 
     connect(m_resultsCallerCalleePage, &ResultsCallerCalleePage::navigateToCode, this, &ResultsPage::onNavigateToCode);
 
@@ -178,10 +211,16 @@ ResultsPage::ResultsPage(PerfParser* parser, QWidget* parent)
             });
 
     connect(m_resultsSummaryPage, &ResultsSummaryPage::jumpToCallerCallee, this, &ResultsPage::onJumpToCallerCallee);
+    connect(m_resultsSummaryPage, &ResultsSummaryPage::recordWithFewerLosses, this,
+            &ResultsPage::recordWithFewerLosses);
     connect(m_resultsBottomUpPage, &ResultsBottomUpPage::jumpToCallerCallee, this, &ResultsPage::onJumpToCallerCallee);
     connect(m_resultsTopDownPage, &ResultsTopDownPage::jumpToCallerCallee, this, &ResultsPage::onJumpToCallerCallee);
     connect(m_resultsFlameGraphPage, &ResultsFlameGraphPage::jumpToCallerCallee, this,
             &ResultsPage::onJumpToCallerCallee);
+    connect(m_resultsOffCpuPage, &ResultsOffCpuPage::jumpToCallerCallee, this, &ResultsPage::onJumpToCallerCallee);
+    connect(m_resultsParallelismPage, &ResultsParallelismPage::jumpToCallerCallee, this,
+            &ResultsPage::onJumpToCallerCallee);
+    connect(m_resultsLocksPage, &ResultsLocksPage::jumpToCallerCallee, this, &ResultsPage::onJumpToCallerCallee);
 
     {
         // create a busy indicator
@@ -217,6 +256,11 @@ void ResultsPage::setAppPath(const QString& path)
     m_resultsCallerCalleePage->setAppPath(path);
 }
 
+void ResultsPage::setSourcePathMap(const QString& pathMap)
+{
+    m_resultsCallerCalleePage->setSourcePathMap(pathMap);
+}
+
 void ResultsPage::onJumpToCallerCallee(const Data::Symbol& symbol)
 {
     m_resultsCallerCalleePage->jumpToCallerCallee(symbol);
@@ -238,7 +282,9 @@ void ResultsPage::onJumpToDisassembly()
 {
     ui->resultsTabWidget->addTab(m_resultsDisassemblyPage, tr("Disassembly"));
     ui->resultsTabWidget->setCurrentWidget(m_resultsDisassemblyPage);
-    m_resultsDisassemblyPage->resetDisassembly();
+    if (m_hasDisassemblyData) {
+        m_resultsDisassemblyPage->resetDisassembly();
+    }
 }
 
 void ResultsPage::selectSummaryTab()
@@ -252,9 +298,14 @@ void ResultsPage::clear()
     m_resultsTopDownPage->clear();
     m_resultsCallerCalleePage->clear();
     m_resultsFlameGraphPage->clear();
+    m_resultsOffCpuPage->clear();
+    m_resultsParallelismPage->clear();
+    m_resultsLocksPage->clear();
+    m_resultsTracePointsPage->clear();
     m_exportMenu->clear();
 
     m_filterAndZoomStack->clear();
+    m_hasDisassemblyData = false;
 }
 
 /**
@@ -298,6 +349,14 @@ void ResultsPage::switchDisassemblyMethod(bool disasmMethod) {
     m_resultsDisassemblyPage->switchDisassemblyMethod(disasmMethod);
 }
 
+/**
+ *  Show costs of basic blocks and loops instead of instructions in Disassembly
+ * @param show
+ */
+void ResultsPage::showBasicBlockCosts(bool show) {
+    m_resultsDisassemblyPage->showBasicBlockCosts(show);
+}
+
 QMenu* ResultsPage::filterMenu() const
 {
     return m_filterMenu;
@@ -326,9 +385,35 @@ void ResultsPage::repositionFilterBusyIndicator()
     m_filterBusyIndicator->setGeometry(mapped);
 }
 
+/**
+ * Only compute the results shown in the current tab, the others follow once their tab gets selected.
+ */
+void ResultsPage::updateWatchedViews()
+{
+    const auto* tab = ui->resultsTabWidget->currentWidget();
+    PerfParser::DerivedViews views;
+    if (tab == m_resultsTopDownPage || tab == m_resultsFlameGraphPage) {
+        views = PerfParser::TopDownView;
+    } else if (tab == m_resultsCallerCalleePage) {
+        views = PerfParser::CallerCalleeView;
+    } else if (tab == m_resultsOffCpuPage) {
+        views = PerfParser::OffCpuView;
+    } else if (tab == m_resultsParallelismPage) {
+        views = PerfParser::ParallelismView;
+    } else if (tab == m_resultsLocksPage) {
+        views = PerfParser::LockContentionView;
+    }
+    if (m_timelineVisible && ui->resultsTabWidget->currentIndex() != SUMMARY_TABINDEX) {
+        // for the running threads lane
+        views |= PerfParser::ParallelismView;
+    }
+    m_parser->setWatchedViews(views);
+}
+
 void ResultsPage::setTimelineVisible(bool visible) {
     m_timelineVisible = visible;
     ui->timeLineArea->setVisible(visible && ui->resultsTabWidget->currentIndex() != SUMMARY_TABINDEX);
+    updateWatchedViews();
 }
 
 QAction* ResultsPage::getFullUnwind()
@@ -47,6 +47,10 @@ class ResultsBottomUpPage;
 class ResultsTopDownPage;
 class ResultsFlameGraphPage;
 class ResultsCallerCalleePage;
+class ResultsOffCpuPage;
+class ResultsParallelismPage;
+class ResultsLocksPage;
+class ResultsTracePointsPage;
 class ResultsDisassemblyPage;
 class TimeLineDelegate;
 class FilterAndZoomStack;
@@ -67,6 +71,7 @@ public:
 public slots:
     void setSysroot(const QString& path);
     void setAppPath(const QString& path);
+    void setSourcePathMap(const QString& pathMap);
     void onNavigateToCode(const QString& url, int lineNumber, int columnNumber);
     void onJumpToCallerCallee(const Data::Symbol& symbol);
     void onJumpToDisassembly();
@@ -81,17 +86,22 @@ public slots:
     void switchOnIntelSyntax(bool intelSyntax);
     // Method to switch Disassembly generation method
     void switchDisassemblyMethod(bool disasmMethod);
+    // Method to show costs of basic blocks and loops instead of instructions
+    void showBasicBlockCosts(bool show);
     QAction* getFullUnwind();
     QWidget* getCurrentTab() const;
 
 signals:
     void navigateToCode(const QString &url, int lineNumber, int columnNumber);
+    void recordWithFewerLosses(double lostFraction);
 private:
     bool eventFilter(QObject *watched, QEvent *event) override;
     void repositionFilterBusyIndicator();
+    void updateWatchedViews();
 
     QScopedPointer<Ui::ResultsPage> ui;
 
+    PerfParser* m_parser;
     FilterAndZoomStack* m_filterAndZoomStack;
     QMenu* m_filterMenu;
     QMenu* m_exportMenu;
@@ -100,8 +110,13 @@ private:
     ResultsTopDownPage* m_resultsTopDownPage;
     ResultsFlameGraphPage* m_resultsFlameGraphPage;
     ResultsCallerCalleePage* m_resultsCallerCalleePage;
+    ResultsOffCpuPage* m_resultsOffCpuPage;
+    ResultsParallelismPage* m_resultsParallelismPage;
+    ResultsLocksPage* m_resultsLocksPage;
+    ResultsTracePointsPage* m_resultsTracePointsPage;
     ResultsDisassemblyPage* m_resultsDisassemblyPage;
     TimeLineDelegate* m_timeLineDelegate;
     QWidget* m_filterBusyIndicator;
     bool m_timelineVisible;
+    bool m_hasDisassemblyData;
 };
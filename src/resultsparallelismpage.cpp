@@ -0,0 +1,89 @@
+/*
+    resultsparallelismpage.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "resultsparallelismpage.h"
+#include "ui_resultsparallelismpage.h"
+
+#include "parsers/perf/perfparser.h"
+#include "resultsutil.h"
+#include "util.h"
+
+#include "models/parallelismmodel.h"
+
+ResultsParallelismPage::ResultsParallelismPage(FilterAndZoomStack* filterStack, PerfParser* parser, QWidget* parent)
+    : QWidget(parent)
+    , ui(new Ui::ResultsParallelismPage)
+{
+    ui->setupUi(this);
+    ui->flameGraph->setFilterStack(filterStack);
+
+    auto histogramModel = new ParallelismModel(this);
+    ui->histogramView->setModel(histogramModel);
+    ResultsUtil::setupCostDelegate(histogramModel, ui->histogramView);
+    ResultsUtil::stretchFirstColumn(ui->histogramView);
+
+    // show the samples of the selected column that got taken while the selected number of threads ran at once
+    connect(ui->histogramView->selectionModel(), &QItemSelectionModel::currentChanged, this,
+            [this](const QModelIndex& current) {
+                const auto costType = current.data(ParallelismModel::CostTypeRole).toInt();
+                if (costType != -1) {
+                    ui->flameGraph->selectCostType(costType);
+                }
+            });
+
+    connect(parser, &PerfParser::parallelismDataAvailable, this,
+            [this, histogramModel](const Data::ParallelismResults& data) {
+                histogramModel->setData(data);
+                ui->flameGraph->setBottomUpData(data.bottomUp);
+                ui->flameGraph->setTopDownData(data.topDown);
+
+                const auto busyTime = data.busyTime();
+                if (!busyTime) {
+                    ui->summaryLabel->setText(tr("This recording has no data on which threads ran when."));
+                    return;
+                }
+
+                auto summary = tr("On average %1 threads ran at once while any did, at most %2 on %3 CPUs.")
+                                   .arg(QString::number(data.averageParallelism(), 'f', 1),
+                                        QString::number(data.maxParallelism()), QString::number(data.numCpus));
+                const auto serialFraction = data.serialFraction();
+                if (serialFraction > 0) {
+                    // Amdahl's law: no number of cores can speed up the serial part
+                    summary += QLatin1Char(' ')
+                        + tr("Only one thread ran for %1 (%2% of that time), which limits the speedup from more "
+                             "cores to %3x at most.")
+                              .arg(Util::formatTimeString(data.timeAtParallelism.value(1)),
+                                   Util::formatCostRelative(data.timeAtParallelism.value(1), busyTime),
+                                   QString::number(1. / serialFraction, 'f', 1));
+                }
+                ui->summaryLabel->setText(summary);
+            });
+
+    connect(ui->flameGraph, &FlameGraph::jumpToCallerCallee, this, &ResultsParallelismPage::jumpToCallerCallee);
+}
+
+ResultsParallelismPage::~ResultsParallelismPage() = default;
+
+void ResultsParallelismPage::clear()
+{
+    ui->flameGraph->clear();
+    ui->summaryLabel->clear();
+}
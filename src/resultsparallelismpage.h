@@ -0,0 +1,56 @@
+/*
+    resultsparallelismpage.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QWidget>
+
+namespace Ui {
+class ResultsParallelismPage;
+}
+
+namespace Data {
+struct Symbol;
+}
+
+class PerfParser;
+class FilterAndZoomStack;
+
+/**
+ * How many threads ran at once: a histogram of the parallelism and a flame graph of the samples per row of it.
+ *
+ * The data is a derived view of the parser, see PerfParser::ParallelismView.
+ */
+class ResultsParallelismPage : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ResultsParallelismPage(FilterAndZoomStack* filterStack, PerfParser* parser, QWidget* parent = nullptr);
+    ~ResultsParallelismPage();
+
+    void clear();
+
+signals:
+    void jumpToCallerCallee(const Data::Symbol& symbol);
+
+private:
+    QScopedPointer<Ui::ResultsParallelismPage> ui;
+};
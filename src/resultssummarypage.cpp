@@ -28,6 +28,7 @@
 #include "resultssummarypage.h"
 #include "ui_resultssummarypage.h"
 
+#include <QAction>
 #include <QSortFilterProxyModel>
 #include <QStringListModel>
 #include <QTextStream>
@@ -55,6 +56,13 @@ ResultsSummaryPage::ResultsSummaryPage(FilterAndZoomStack* filterStack, PerfPars
     ui->lostMessage->setVisible(false);
     ui->parserErrorsBox->setVisible(false);
 
+    auto recordAgain = new QAction(QIcon::fromTheme(QStringLiteral("media-record")),
+                                   tr("Record Again With Fewer Losses"), this);
+    recordAgain->setToolTip(tr("Open the recording page with a larger buffer and, for heavy losses, "
+                               "a lower sampling frequency."));
+    connect(recordAgain, &QAction::triggered, this, [this]() { emit recordWithFewerLosses(m_lostFraction); });
+    ui->lostMessage->addAction(recordAgain);
+
     auto bottomUpCostModel = new BottomUpModel(false, this);
 
     auto topHotspotsProxy = new TopProxy(this);
@@ -133,7 +141,22 @@ ResultsSummaryPage::ResultsSummaryPage(FilterAndZoomStack* filterStack, PerfPars
                     stream << formatSummaryText(indent + tr("<b>WARNING</b>"), tr("Sampling frequency below 100Hz"));
                 }
             }
-            stream << formatSummaryText(tr("Lost Chunks"), QString::number(data.lostChunks)) << "</table></qt>";
+            stream << formatSummaryText(tr("Lost Chunks"), QString::number(data.lostChunks));
+            if (data.lostEvents > 0) {
+                stream << formatSummaryText(
+                    tr("Lost Events"),
+                    tr("%1 (%2% of all events)")
+                        .arg(QString::number(data.lostEvents),
+                             Util::formatCostRelative(data.lostEvents, data.lostEvents + data.sampleCount)));
+                for (const auto& losses : data.lostPerCpu) {
+                    stream << formatSummaryText(
+                        indent + tr("CPU #%1").arg(losses.cpuId),
+                        tr("%1 in %2 chunks (%3% of the events of this CPU)")
+                            .arg(QString::number(losses.lostEvents), QString::number(losses.lostChunks),
+                                 Util::formatCostRelative(losses.lostEvents, losses.lostEvents + losses.sampleCount)));
+                }
+            }
+            stream << "</table></qt>";
         }
         ui->summaryLabel->setText(summaryText);
 
@@ -162,6 +185,7 @@ ResultsSummaryPage::ResultsSummaryPage(FilterAndZoomStack* filterStack, PerfPars
         if (data.lostChunks > 0) {
             ui->lostMessage->setText(i18np("Lost one chunk - Check IO/CPU overload!",
                                            "Lost %1 chunks - Check IO/CPU overload!", data.lostChunks));
+            m_lostFraction = data.lostEvents ? double(data.lostEvents) / (data.lostEvents + data.sampleCount) : 0;
             ui->lostMessage->setVisible(true);
         } else {
             ui->lostMessage->setVisible(false);
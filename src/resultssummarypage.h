@@ -49,7 +49,10 @@ public:
 
 signals:
     void jumpToCallerCallee(const Data::Symbol& symbol);
+    // @p lostFraction is the share of the events that perf lost in the shown recording
+    void recordWithFewerLosses(double lostFraction);
 
 private:
     QScopedPointer<Ui::ResultsSummaryPage> ui;
+    double m_lostFraction = 0;
 };
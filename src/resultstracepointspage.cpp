@@ -0,0 +1,115 @@
+/*
+    resultstracepointspage.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "resultstracepointspage.h"
+#include "ui_resultstracepointspage.h"
+
+#include "parsers/perf/perfparser.h"
+#include "resultsutil.h"
+
+#include "models/tracepointmodel.h"
+
+#include <QSignalBlocker>
+
+#include <algorithm>
+
+ResultsTracePointsPage::ResultsTracePointsPage(PerfParser* parser, QWidget* parent)
+    : QWidget(parent)
+    , ui(new Ui::ResultsTracePointsPage)
+    , m_samplesModel(new TracePointSamplesModel(this))
+    , m_groupsModel(new TracePointGroupsModel(this))
+{
+    ui->setupUi(this);
+    ui->noDataLabel->setVisible(false);
+
+    ResultsUtil::setupTreeView(ui->samplesView, ui->samplesSearch, m_samplesModel);
+    // oldest first, unlike the costs of the other views
+    ui->samplesView->sortByColumn(TracePointSamplesModel::Time, Qt::AscendingOrder);
+    ResultsUtil::setupTreeView(ui->groupsView, ui->groupsSearch, m_groupsModel);
+
+    connect(ui->tracePointBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
+            &ResultsTracePointsPage::showTracePoint);
+    connect(ui->groupByBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
+            &ResultsTracePointsPage::groupBy);
+
+    connect(parser, &PerfParser::eventsAvailable, this, &ResultsTracePointsPage::setEvents);
+}
+
+ResultsTracePointsPage::~ResultsTracePointsPage() = default;
+
+void ResultsTracePointsPage::clear()
+{
+    ui->samplesSearch->setText({});
+    ui->groupsSearch->setText({});
+}
+
+void ResultsTracePointsPage::setEvents(const Data::EventResults& events)
+{
+    m_events = events;
+
+    const bool hasData = !m_events.tracePoints.isEmpty();
+    ui->noDataLabel->setVisible(!hasData);
+    ui->contentWidget->setVisible(hasData);
+
+    // keep showing the same tracepoint after filtering
+    const auto current = ui->tracePointBox->currentText();
+    {
+        QSignalBlocker blocker(ui->tracePointBox);
+        ui->tracePointBox->clear();
+        for (const auto& tracePoint : m_events.tracePoints) {
+            ui->tracePointBox->addItem(tracePoint.name);
+        }
+        ui->tracePointBox->setCurrentIndex(std::max(0, ui->tracePointBox->findText(current)));
+    }
+    showTracePoint(ui->tracePointBox->currentIndex());
+}
+
+void ResultsTracePointsPage::showTracePoint(int index)
+{
+    m_samplesModel->setData(m_events, index);
+
+    const auto current = ui->groupByBox->currentText();
+    {
+        QSignalBlocker blocker(ui->groupByBox);
+        ui->groupByBox->clear();
+        ui->groupByBox->addItem(tr("No Grouping"), -1);
+        const auto fields = m_events.tracePoints.value(index).fields;
+        for (int field = 0, c = fields.size(); field < c; ++field) {
+            if (fields.at(field).type != Data::TracePointField::Unsupported) {
+                ui->groupByBox->addItem(fields.at(field).name, field);
+            }
+        }
+        ui->groupByBox->setCurrentIndex(std::max(0, ui->groupByBox->findText(current)));
+    }
+    groupBy(ui->groupByBox->currentIndex());
+}
+
+void ResultsTracePointsPage::groupBy(int index)
+{
+    const auto field = ui->groupByBox->itemData(index).toInt();
+    if (field == -1 || index == -1) {
+        ui->viewStack->setCurrentWidget(ui->samplesPage);
+        m_groupsModel->setData({}, -1);
+    } else {
+        ui->viewStack->setCurrentWidget(ui->groupsPage);
+        m_groupsModel->setData(m_events.tracePoints.value(ui->tracePointBox->currentIndex()), field);
+    }
+}
@@ -0,0 +1,59 @@
+/*
+    resultstracepointspage.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QWidget>
+
+#include "models/data.h"
+
+namespace Ui {
+class ResultsTracePointsPage;
+}
+
+class PerfParser;
+class TracePointSamplesModel;
+class TracePointGroupsModel;
+
+/**
+ * The payloads of the tracepoint samples: every sample with its field values, or the samples grouped by a field.
+ *
+ * The data follows the events of the parser, see Data::EventResults::tracePoints.
+ */
+class ResultsTracePointsPage : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ResultsTracePointsPage(PerfParser* parser, QWidget* parent = nullptr);
+    ~ResultsTracePointsPage();
+
+    void clear();
+
+private:
+    void setEvents(const Data::EventResults& events);
+    void showTracePoint(int index);
+    void groupBy(int index);
+
+    QScopedPointer<Ui::ResultsTracePointsPage> ui;
+    TracePointSamplesModel* m_samplesModel;
+    TracePointGroupsModel* m_groupsModel;
+    Data::EventResults m_events;
+};
@@ -0,0 +1,97 @@
+/*
+    segmentwatcher.cpp
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "segmentwatcher.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QRegularExpression>
+
+SegmentWatcher::SegmentWatcher(QObject* parent)
+    : QObject(parent)
+    , m_watcher(new QFileSystemWatcher(this))
+{
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &SegmentWatcher::scan);
+}
+
+SegmentWatcher::~SegmentWatcher() = default;
+
+bool SegmentWatcher::watch(const QString& directory)
+{
+    stop();
+
+    const QFileInfo info(directory);
+    if (!info.isDir()) {
+        return false;
+    }
+
+    m_directory = info.absoluteFilePath();
+    if (!m_watcher->addPath(m_directory)) {
+        m_directory.clear();
+        return false;
+    }
+    scan();
+    return true;
+}
+
+void SegmentWatcher::stop()
+{
+    if (!m_directory.isEmpty()) {
+        m_watcher->removePath(m_directory);
+    }
+    m_directory.clear();
+    m_segments.clear();
+}
+
+QString SegmentWatcher::directory() const
+{
+    return m_directory;
+}
+
+bool SegmentWatcher::isSegment(const QString& fileName)
+{
+    // perf appends the time of the switch as YYYYmmddHHMMSSss
+    static const QRegularExpression pattern(QStringLiteral("\\.[0-9]{14,}$"));
+    return pattern.match(fileName).hasMatch();
+}
+
+void SegmentWatcher::scan()
+{
+    if (m_directory.isEmpty()) {
+        return;
+    }
+
+    const QDir dir(m_directory);
+    QStringList added;
+    // sorted by name, which is the order of the timestamps
+    const auto fileNames = dir.entryList(QDir::Files, QDir::Name);
+    for (const auto& fileName : fileNames) {
+        if (isSegment(fileName) && !m_segments.contains(fileName)) {
+            m_segments.insert(fileName);
+            added.append(dir.filePath(fileName));
+        }
+    }
+
+    if (!added.isEmpty()) {
+        emit segmentsAdded(added);
+    }
+}
@@ -0,0 +1,63 @@
+/*
+    segmentwatcher.h
+
+    This file is part of Hotspot, the Qt GUI for performance analysis.
+
+    Copyright (C) 2020
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+class QFileSystemWatcher;
+
+/**
+ * Watches a directory for the segments that 'perf record --switch-output' rotates out, e.g. perf.data.2020061512345678.
+ *
+ * perf writes into perf.data and renames it once it switches to the next segment, so a segment is complete as soon as
+ * it shows up. Every segment is reported once, in the order of its timestamp.
+ */
+class SegmentWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SegmentWatcher(QObject* parent = nullptr);
+    ~SegmentWatcher();
+
+    /// watch @p directory instead of the current one, the segments that are already there get reported at once
+    bool watch(const QString& directory);
+    void stop();
+
+    QString directory() const;
+
+    /// whether @p fileName is the name of a rotated segment, i.e. ends on the timestamp of the switch
+    static bool isSegment(const QString& fileName);
+
+public slots:
+    void scan();
+
+signals:
+    void segmentsAdded(const QStringList& paths);
+
+private:
+    QFileSystemWatcher* m_watcher;
+    QString m_directory;
+    // file names of the segments reported so far
+    QSet<QString> m_segments;
+};
@@ -34,3 +34,51 @@ void Settings::setPrettifySymbols(bool prettifySymbols)
         emit prettifySymbolsChanged(m_prettifySymbols);
     }
 }
+
+void Settings::setPrefetchSymbols(int prefetchSymbols)
+{
+    if (m_prefetchSymbols != prefetchSymbols) {
+        m_prefetchSymbols = prefetchSymbols;
+        emit prefetchSymbolsChanged(m_prefetchSymbols);
+    }
+}
+
+void Settings::setPrefetchProcesses(int prefetchProcesses)
+{
+    if (m_prefetchProcesses != prefetchProcesses) {
+        m_prefetchProcesses = prefetchProcesses;
+        emit prefetchProcessesChanged(m_prefetchProcesses);
+    }
+}
+
+void Settings::setDisassemblyCacheSize(int disassemblyCacheSize)
+{
+    if (m_disassemblyCacheSize != disassemblyCacheSize) {
+        m_disassemblyCacheSize = disassemblyCacheSize;
+        emit disassemblyCacheSizeChanged(m_disassemblyCacheSize);
+    }
+}
+
+void Settings::setLiveUpdateInterval(int liveUpdateInterval)
+{
+    if (m_liveUpdateInterval != liveUpdateInterval) {
+        m_liveUpdateInterval = liveUpdateInterval;
+        emit liveUpdateIntervalChanged(m_liveUpdateInterval);
+    }
+}
+
+void Settings::setLiveWindow(int liveWindow)
+{
+    if (m_liveWindow != liveWindow) {
+        m_liveWindow = liveWindow;
+        emit liveWindowChanged(m_liveWindow);
+    }
+}
+
+void Settings::setLiveCostWindow(int liveCostWindow)
+{
+    if (m_liveCostWindow != liveCostWindow) {
+        m_liveCostWindow = liveCostWindow;
+        emit liveCostWindowChanged(m_liveCostWindow);
+    }
+}
@@ -36,15 +36,69 @@ public:
         return m_prettifySymbols;
     }
 
+    int prefetchSymbols() const
+    {
+        return m_prefetchSymbols;
+    }
+
+    int prefetchProcesses() const
+    {
+        return m_prefetchProcesses;
+    }
+
+    int disassemblyCacheSize() const
+    {
+        return m_disassemblyCacheSize;
+    }
+
+    int liveUpdateInterval() const
+    {
+        return m_liveUpdateInterval;
+    }
+
+    int liveWindow() const
+    {
+        return m_liveWindow;
+    }
+
+    int liveCostWindow() const
+    {
+        return m_liveCostWindow;
+    }
+
 signals:
     void prettifySymbolsChanged(bool);
+    void prefetchSymbolsChanged(int);
+    void prefetchProcessesChanged(int);
+    void disassemblyCacheSizeChanged(int);
+    void liveUpdateIntervalChanged(int);
+    void liveWindowChanged(int);
+    void liveCostWindowChanged(int);
 
 public slots:
     void setPrettifySymbols(bool prettifySymbols);
+    void setPrefetchSymbols(int prefetchSymbols);
+    void setPrefetchProcesses(int prefetchProcesses);
+    void setDisassemblyCacheSize(int disassemblyCacheSize);
+    void setLiveUpdateInterval(int liveUpdateInterval);
+    void setLiveWindow(int liveWindow);
+    void setLiveCostWindow(int liveCostWindow);
 
 private:
     Settings() = default;
     ~Settings() = default;
 
     bool m_prettifySymbols = true;
+    // number of the hottest symbols to disassemble in the background, 0 disables the prefetching
+    int m_prefetchSymbols = 10;
+    // number of disassembler processes the prefetching may run at once
+    int m_prefetchProcesses = 2;
+    // size of the disassembly output cache and of the whole-binary disassembly cache in MiB, each
+    int m_disassemblyCacheSize = 32;
+    // milliseconds between the snapshots of the results while recording live
+    int m_liveUpdateInterval = 1000;
+    // seconds of the most recent events kept for the timeline while recording live
+    int m_liveWindow = 60;
+    // seconds of the most recent costs kept while recording live, 0 keeps the costs of the whole recording
+    int m_liveCostWindow = 0;
 };
@@ -30,6 +30,7 @@
 #include <QProcess>
 #include <QSignalSpy>
 #include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QTest>
 #include <QTextStream>
@@ -37,6 +38,7 @@
 #include "data.h"
 #include "perfparser.h"
 #include "perfrecord.h"
+#include "segmentwatcher.h"
 #include "unistd.h"
 #include "util.h"
 
@@ -228,6 +230,28 @@ private slots:
         QTest::newRow("leader-sampling") << QStringLiteral("{cycles,instructions}:S");
     }
 
+    void testCppInliningThreads()
+    {
+        QTemporaryDir tempDir;
+        QVERIFY(tempDir.isValid());
+        if (QProcess::execute(QStringLiteral("perf"),
+                              {QStringLiteral("record"), QStringLiteral("--threads"), QStringLiteral("-o"),
+                               tempDir.filePath(QStringLiteral("probe.data")), QStringLiteral("true")})
+            != 0) {
+            QSKIP("perf record --threads is not supported.");
+        }
+
+        const QString exePath = qApp->applicationDirPath() + "/../tests/test-clients/cpp-inlining/cpp-inlining";
+        // perf writes a directory with a data.N file per recording thread
+        const QString fileName = tempDir.filePath(QStringLiteral("perf.data"));
+
+        perfRecord({QStringLiteral("--threads")}, exePath, {}, fileName);
+        QVERIFY(QFileInfo(fileName).isDir());
+        testPerfData(Data::Symbol{"hypot", "libm"}, {}, fileName);
+        QVERIFY(!m_bottomUpData.root.children.isEmpty());
+        QVERIFY(!m_topDownData.root.children.isEmpty());
+    }
+
     void testCppRecursionNoOptions()
     {
         const QStringList perfOptions;
@@ -337,6 +361,90 @@ private slots:
         QCOMPARE(recordingFinishedSpy.count(), 1);
     }
 
+    void testLiveRecording()
+    {
+        const QString exePath = qApp->applicationDirPath() + "/../tests/test-clients/cpp-inlining/cpp-inlining";
+
+        PerfRecord perf;
+        PerfParser parser;
+        QSignalSpy recordingFailedSpy(&perf, &PerfRecord::recordingFailed);
+        QSignalSpy parsingFinishedSpy(&parser, &PerfParser::parsingFinished);
+        QSignalSpy parsingFailedSpy(&parser, &PerfParser::parsingFailed);
+        QSignalSpy summaryDataSpy(&parser, &PerfParser::summaryDataAvailable);
+        QSignalSpy bottomUpDataSpy(&parser, &PerfParser::bottomUpDataAvailable);
+
+        connect(&perf, &PerfRecord::recordingStarted, &parser,
+                [&parser]() { parser.startParseLive("", "", "", "", "", "", "", "", "", "", ""); });
+        connect(&perf, &PerfRecord::recordingData, &parser, &PerfParser::addLiveInput);
+        connect(&perf, &PerfRecord::recordingFinished, &parser, &PerfParser::finishLiveInput);
+
+        perf.record({QStringLiteral("-c"), QStringLiteral("1000000")}, QStringLiteral("-"), false, exePath, {});
+        QVERIFY(parsingFinishedSpy.wait(10000));
+
+        QCOMPARE(recordingFailedSpy.count(), 0);
+        QCOMPARE(parsingFailedSpy.count(), 0);
+        // the last results are the complete ones, earlier snapshots may have been emitted meanwhile
+        QVERIFY(summaryDataSpy.count() >= 1);
+        QCOMPARE(summaryDataSpy.count(), bottomUpDataSpy.count());
+        const auto summary = summaryDataSpy.last().at(0).value<Data::Summary>();
+        QVERIFY(summary.sampleCount > 0);
+        const auto bottomUp = bottomUpDataSpy.last().at(0).value<Data::BottomUpResults>();
+        QVERIFY(!bottomUp.root.children.isEmpty());
+    }
+
+    void testSegmentWatcher()
+    {
+        const QString exePath = qApp->applicationDirPath() + "/../tests/test-clients/cpp-inlining/cpp-inlining";
+
+        QTemporaryDir recordDir;
+        QTemporaryDir watchedDir;
+        QVERIFY(recordDir.isValid() && watchedDir.isValid());
+        // perf renames the segments into place once they are complete, just like this
+        auto addSegment = [this, &exePath, &recordDir, &watchedDir](const QString& timestamp) {
+            const auto fileName = recordDir.filePath(QStringLiteral("perf.data"));
+            perfRecord({}, exePath, {}, fileName);
+            return QFile::rename(fileName, watchedDir.filePath(QStringLiteral("perf.data.") + timestamp));
+        };
+        QVERIFY(addSegment(QStringLiteral("2020061512000000")));
+        QVERIFY(addSegment(QStringLiteral("2020061512000100")));
+
+        QVERIFY(SegmentWatcher::isSegment(QStringLiteral("perf.data.2020061512000000")));
+        QVERIFY(!SegmentWatcher::isSegment(QStringLiteral("perf.data")));
+        QVERIFY(!SegmentWatcher::isSegment(QStringLiteral("perf.data.old")));
+
+        PerfParser parser;
+        SegmentWatcher watcher;
+        QSignalSpy segmentsAddedSpy(&watcher, &SegmentWatcher::segmentsAdded);
+        QSignalSpy parsingFinishedSpy(&parser, &PerfParser::parsingFinished);
+        QSignalSpy parsingFailedSpy(&parser, &PerfParser::parsingFailed);
+        QSignalSpy summaryDataSpy(&parser, &PerfParser::summaryDataAvailable);
+        QSignalSpy bottomUpDataSpy(&parser, &PerfParser::bottomUpDataAvailable);
+        connect(&watcher, &SegmentWatcher::segmentsAdded, &parser, [&parser](const QStringList& paths) {
+            parser.appendParseFiles(paths, "", "", "", "", "", "", "", "", "", "", "");
+        });
+
+        QVERIFY(watcher.watch(watchedDir.path()));
+        QCOMPARE(segmentsAddedSpy.count(), 1);
+        QCOMPARE(segmentsAddedSpy.first().at(0).toStringList().size(), 2);
+        QVERIFY(parsingFinishedSpy.wait(10000));
+        QCOMPARE(parsingFailedSpy.count(), 0);
+        const auto summary = summaryDataSpy.last().at(0).value<Data::Summary>();
+        QVERIFY(summary.command.endsWith(QLatin1String("(aggregated from 2 files)")));
+        const auto bottomUp = bottomUpDataSpy.last().at(0).value<Data::BottomUpResults>();
+
+        // only the new segment gets parsed, its costs are added to the ones of the earlier segments
+        QVERIFY(addSegment(QStringLiteral("2020061512000200")));
+        QVERIFY(parsingFinishedSpy.wait(10000));
+        QCOMPARE(segmentsAddedSpy.count(), 2);
+        QCOMPARE(segmentsAddedSpy.last().at(0).toStringList().size(), 1);
+        QCOMPARE(parsingFailedSpy.count(), 0);
+        const auto grownSummary = summaryDataSpy.last().at(0).value<Data::Summary>();
+        QVERIFY(grownSummary.command.endsWith(QLatin1String("(aggregated from 3 files)")));
+        QVERIFY(grownSummary.sampleCount > summary.sampleCount);
+        const auto grownBottomUp = bottomUpDataSpy.last().at(0).value<Data::BottomUpResults>();
+        QVERIFY(grownBottomUp.costs.totalCost(0) > bottomUp.costs.totalCost(0));
+    }
+
     void testSwitchEvents()
     {
         const QStringList perfOptions = {"--call-graph", "dwarf", "--switch-events"};
@@ -25,14 +25,26 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <QBuffer>
 #include <QDebug>
+#include <QFont>
 #include <QObject>
+#include <QTemporaryFile>
 #include <QTest>
 #include <QTextStream>
 
 #include "modeltest.h"
 
+#include <models/controlflow.h>
+#include <models/disassemblyindex.h>
+#include <models/disassemblymodel.h>
 #include <models/eventmodel.h>
+#include <models/lockcontentionmodel.h>
+#include <models/offcpumodel.h>
+#include <models/parallelismmodel.h>
+#include <models/resultscache.h>
+#include <models/sourcecodemodel.h>
+#include <models/tracepointmodel.h>
 
 #include "../testutils.h"
 
@@ -81,6 +93,50 @@ Data::BottomUpResults generateTree1()
         C
     )");
 }
+
+template<typename Number>
+void appendColumnValue(QByteArray* column, Number number)
+{
+    column->append(reinterpret_cast<const char*>(&number), sizeof(Number));
+}
+
+Data::TracePointSamples generateTracePoint()
+{
+    Data::TracePointSamples tracePoint;
+    tracePoint.name = QStringLiteral("sched:sched_wakeup");
+    tracePoint.costId = 1;
+    auto addField = [&tracePoint](const char* name, Data::TracePointField::Type type, quint8 size) {
+        Data::TracePointField field;
+        field.name = QString::fromLatin1(name);
+        field.type = type;
+        field.size = size;
+        tracePoint.fields.append(field);
+    };
+    addField("comm", Data::TracePointField::String, 1);
+    addField("pid", Data::TracePointField::Signed, 4);
+    addField("ptr", Data::TracePointField::Unsigned, 8);
+    addField("args", Data::TracePointField::UnsignedArray, 8);
+    addField("blob", Data::TracePointField::Unsupported, 0);
+    tracePoint.columns.resize(tracePoint.fields.size());
+    tracePoint.strings = {QStringLiteral("worker"), QStringLiteral("[1, 2]"), QStringLiteral("[3]"),
+                          QStringLiteral("main"), QStringLiteral("[]")};
+
+    auto addRow = [&tracePoint](quint64 time, qint32 tid, quint32 cpuId, qint32 comm, qint32 pid, quint64 ptr,
+                                qint32 args) {
+        tracePoint.times.append(time);
+        tracePoint.pids.append(1);
+        tracePoint.tids.append(tid);
+        tracePoint.cpuIds.append(cpuId);
+        appendColumnValue(&tracePoint.columns[0], comm);
+        appendColumnValue(&tracePoint.columns[1], pid);
+        appendColumnValue(&tracePoint.columns[2], ptr);
+        appendColumnValue(&tracePoint.columns[3], args);
+    };
+    addRow(10, 1, 0, 0, 7, 0x1000, 1);
+    addRow(20, 2, 1, 0, -8, 0x2000, 2);
+    addRow(30, 1, 0, 3, 7, std::numeric_limits<quint64>::max(), 4);
+    return tracePoint;
+}
 }
 
 class TestModels : public QObject
@@ -198,6 +254,801 @@ private slots:
         }
     }
 
+    void testDiffBottomUp()
+    {
+        const auto baseline = generateTree1();
+        const auto compared = buildBottomUpTree(R"(
+            A;B;C
+            A;B;D
+            C
+            F
+        )");
+
+        const auto diff =
+            Data::BottomUpResults::diff(baseline, compared, Data::DiffNormalization::None, {}, {});
+        QCOMPARE(diff.costs.numTypes(), 3);
+        QCOMPARE(diff.costs.typeName(0), QStringLiteral("samples (baseline)"));
+        QCOMPARE(diff.costs.typeName(1), QStringLiteral("samples (compared)"));
+        QCOMPARE(diff.costs.typeName(2), QStringLiteral("samples (delta)"));
+        for (int i = 0; i < 3; ++i) {
+            QCOMPARE(diff.costs.deltaType(i), 2);
+        }
+        QCOMPARE(diff.costs.totalCost(0), qint64(9));
+        QCOMPARE(diff.costs.totalCost(1), qint64(4));
+        QCOMPARE(diff.costs.totalCost(2), qint64(-5));
+
+        const QStringList expectedTree = {
+            "C=5, 2, -3",          " B=1, 1, 0",      "  A=1, 1, 0",      " E=1, 0, -1",    "  C=1, 0, -1",
+            "   B=1, 0, -1",       "    A=1, 0, -1",  " C=1, 0, -1",      "  B=1, 0, -1",   "   A=1, 0, -1",
+            "D=2, 1, -1",          " B=2, 1, -1",     "  A=2, 1, -1",     "E=2, 0, -2",     " C=2, 0, -2",
+            "  B=1, 0, -1",        "   A=1, 0, -1",   "  E=1, 0, -1",     "   C=1, 0, -1",  "    B=1, 0, -1",
+            "     A=1, 0, -1",     "F=0, 1, 1"};
+        QTextStream(stdout) << "Actual:\n"
+                            << printTree(diff).join("\n") << "\nExpected:\n"
+                            << expectedTree.join("\n") << "\n";
+        QCOMPARE(printTree(diff), expectedTree);
+
+        // symbols that vanished from the compared data must still show up as leaves
+        const auto topDown = Data::TopDownResults::fromBottomUp(diff);
+        const QStringList expectedTopDown = {"A=s:0,i:7",    " B=s:0,i:7",    "  C=s:1,i:5",
+                                             "   E=s:1,i:3", "    C=s:1,i:2", "     E=s:1,i:1",
+                                             "   C=s:1,i:1", "  D=s:2,i:2",   "C=s:2,i:2", "F=s:0,i:0"};
+        QCOMPARE(printTree(topDown), expectedTopDown);
+
+        const auto normalized =
+            Data::BottomUpResults::diff(baseline, compared, Data::DiffNormalization::TotalCost, {}, {});
+        QCOMPARE(normalized.costs.totalCost(0), qint64(9));
+        QCOMPARE(normalized.costs.totalCost(1), qint64(9));
+        QCOMPARE(normalized.costs.totalCost(2), qint64(0));
+    }
+
+    void testMergeBottomUp()
+    {
+        Data::BottomUpResults merged;
+        merged.merge(generateTree1());
+        QCOMPARE(printTree(merged), printTree(generateTree1()));
+
+        // the mapper unifies symbols across the merged data sets
+        merged.merge(buildBottomUpTree(R"(
+            a;b;c
+            f
+        )"),
+                     [](const Data::Symbol& symbol) { return Data::Symbol {symbol.symbol.toUpper(), {}}; });
+        QCOMPARE(merged.costs.numTypes(), 1);
+        QCOMPARE(merged.costs.totalCost(0), qint64(11));
+
+        const QStringList expectedTree = {"C=6",  " B=2",  "  A=2",  " E=1",  "  C=1",  "   B=1",  "    A=1",
+                                          " C=1", "  B=1", "   A=1", "D=2",   " B=2",   "  A=2",   "E=2",
+                                          " C=2", "  B=1", "   A=1", "  E=1", "   C=1", "    B=1", "     A=1",
+                                          "F=1"};
+        QCOMPARE(printTree(merged), expectedTree);
+    }
+
+    void testRollingCosts()
+    {
+        Data::BottomUpResults tree;
+        tree.merge(buildBottomUpTree(R"(
+            A;B
+            C
+        )"));
+
+        Data::RollingCosts rolling(10, 2);
+        rolling.update(0, &tree);
+        QCOMPARE(rolling.numSlices(), 1);
+
+        tree.merge(buildBottomUpTree(R"(
+            A;B
+            D
+        )"));
+        rolling.update(5, &tree);
+        QCOMPARE(rolling.numSlices(), 1);
+        rolling.update(10, &tree);
+        QCOMPARE(rolling.numSlices(), 2);
+        QCOMPARE(tree.costs.totalCost(0), qint64(4));
+
+        // the third slice evicts the first one, with all entries that only had costs in it
+        tree.merge(buildBottomUpTree("E"));
+        rolling.update(20, &tree);
+        QCOMPARE(rolling.numSlices(), 2);
+        QCOMPARE(rolling.windowStart(), quint64(10));
+        QCOMPARE(printTree(tree), QStringList({"E=1"}));
+        QCOMPARE(tree.costs.totalCost(0), qint64(1));
+
+        // entries added after the eviction get ids next to the remaining ones
+        tree.merge(buildBottomUpTree("A;B"));
+        rolling.update(30, &tree);
+        QCOMPARE(rolling.windowStart(), quint64(20));
+        QCOMPARE(printTree(tree), QStringList({"B=1", " A=1"}));
+        QCOMPARE(tree.costs.totalCost(0), qint64(1));
+        QCOMPARE(tree.costs.cost(0, tree.root.children.first().id), qint64(1));
+        QCOMPARE(tree.root.children.first().id, quint32(0));
+    }
+
+    void testResultsCache()
+    {
+        ResultsCache::Results results;
+        results.bottomUp = generateTree1();
+        results.bottomUp.symbols = {{"A"}, {"B"}};
+        results.bottomUp.locations = {{-1, {0x10, 0x1, "a.cpp:1"}}, {0, {0x20, 0x2, "b.cpp:2"}}};
+        results.bottomUp.incompleteCallchains.markAsIncomplete(2);
+        results.summary.command = QStringLiteral("foo --bar");
+        results.summary.sampleCount = 9;
+        results.summary.costs = {{"samples", 9, 9, Data::Costs::Unit::Unknown}};
+        results.summary.buildIds.insert(QStringLiteral("/usr/bin/foo"), QByteArray("abc123"));
+        results.events.threads.resize(1);
+        results.events.threads[0].pid = 42;
+        results.events.threads[0].tid = 43;
+        results.events.threads[0].name = QStringLiteral("foo");
+        for (quint64 time : {1, 4}) {
+            Data::Event event;
+            event.time = time;
+            event.cost = time + 1;
+            event.type = 0;
+            event.stackId = time % 2;
+            event.cpuId = 3;
+            results.events.threads[0].events.append(event);
+        }
+        results.events.cpus.resize(1);
+        results.events.cpus[0].cpuId = 3;
+        results.events.cpus[0].events = results.events.threads[0].events;
+        results.events.stacks = {{0, 1}, {1}};
+        results.events.totalCosts = results.summary.costs;
+        results.events.tracePoints = {generateTracePoint()};
+        results.disassembly.disasmApproach = QStringLiteral("symbol");
+        results.disassembly.selfCosts.addType(0, "samples", Data::Costs::Unit::Unknown);
+        auto& source = results.disassembly.entry({"A"}).source({0x10, 0x1, "a.cpp:1"}, 1);
+        source.selfCost[0] = 7;
+        results.disassembly.addBranchStack({1, 0});
+
+        QBuffer buffer;
+        QVERIFY(buffer.open(QIODevice::ReadWrite));
+        QVERIFY(ResultsCache::write(&buffer, results));
+
+        buffer.seek(0);
+        ResultsCache::Results cached;
+        QVERIFY(ResultsCache::read(&buffer, &cached));
+        QCOMPARE(printTree(cached.bottomUp), printTree(results.bottomUp));
+        QCOMPARE(cached.bottomUp.costs.totalCost(0), qint64(9));
+        QCOMPARE(cached.bottomUp.costs.typeName(0), QStringLiteral("samples"));
+        QCOMPARE(cached.bottomUp.symbols.size(), 2);
+        QCOMPARE(cached.bottomUp.symbols[1], Data::Symbol {"B"});
+        QCOMPARE(cached.bottomUp.locations.size(), 2);
+        QCOMPARE(cached.bottomUp.locations[1].parentLocationId, 0);
+        QCOMPARE(cached.bottomUp.locations[1].location, results.bottomUp.locations[1].location);
+        QVERIFY(cached.bottomUp.incompleteCallchains.isIncomplete(2));
+        QVERIFY(!cached.bottomUp.incompleteCallchains.isIncomplete(1));
+        QCOMPARE(cached.summary.command, results.summary.command);
+        QCOMPARE(cached.summary.costs, results.summary.costs);
+        QCOMPARE(cached.summary.buildIds, results.summary.buildIds);
+        QVERIFY(cached.events == results.events);
+        QCOMPARE(cached.disassembly.disasmApproach, QStringLiteral("symbol"));
+        QCOMPARE(cached.disassembly.entries.size(), 1);
+        const auto& cachedSource = cached.disassembly.entries.value({"A"}).relSourceMap;
+        QCOMPARE(cachedSource.size(), 1);
+        QCOMPARE(cachedSource.begin()->selfCost[0], qint64(7));
+        QCOMPARE(cached.disassembly.branchEdges, results.disassembly.branchEdges);
+
+        // truncated or otherwise corrupt caches must be rejected
+        buffer.buffer().chop(10);
+        buffer.seek(0);
+        QVERIFY(!ResultsCache::read(&buffer, &cached));
+        buffer.seek(20);
+        QVERIFY(!ResultsCache::read(&buffer, &cached));
+    }
+
+    void testDisassemblyEntryFromEvents()
+    {
+        Data::BottomUpResults bottomUp;
+        bottomUp.costs.addType(0, "cycles", Data::Costs::Unit::Unknown);
+        bottomUp.costs.addType(1, "off-CPU", Data::Costs::Unit::Time);
+        bottomUp.symbols = {{"A"}, {"A"}, {"B"}};
+        bottomUp.locations = {{-1, {0x10, 0x1, "a.cpp:1"}}, {-1, {0x11, 0x2, "a.cpp:2"}}, {-1, {0x20, 0x3, "b.cpp:1"}}};
+
+        Data::EventResults events;
+        events.offCpuTimeCostId = 1;
+        events.stacks = {{0, 2}, {1, 2}, {2, 0}};
+        events.threads.resize(1);
+        const int stackIds[] = {0, 1, 0, 2, 0};
+        const int types[] = {0, 0, 0, 0, 1};
+        for (int i = 0; i < 5; ++i) {
+            Data::Event event;
+            event.cost = 1 << i;
+            event.type = types[i];
+            event.stackId = stackIds[i];
+            events.threads[0].events.append(event);
+        }
+
+        // only the leaf frames contribute, context switches are ignored
+        const auto entryA = Data::disassemblyEntryFromEvents({"A"}, bottomUp, events);
+        QCOMPARE(entryA.relSourceMap.size(), 2);
+        QCOMPARE(entryA.relSourceMap.value(bottomUp.locations[0].location).selfCost[0], qint64(5));
+        QCOMPARE(entryA.relSourceMap.value(bottomUp.locations[0].location).selfCost[1], qint64(0));
+        QCOMPARE(entryA.relSourceMap.value(bottomUp.locations[1].location).selfCost[0], qint64(2));
+
+        const auto entryB = Data::disassemblyEntryFromEvents({"B"}, bottomUp, events);
+        QCOMPARE(entryB.relSourceMap.size(), 1);
+        QCOMPARE(entryB.relSourceMap.value(bottomUp.locations[2].location).selfCost[0], qint64(8));
+
+        QVERIFY(Data::disassemblyEntryFromEvents({"C"}, bottomUp, events).relSourceMap.isEmpty());
+    }
+
+    void testOffCpuResults()
+    {
+        Data::BottomUpResults bottomUp;
+        bottomUp.costs.addType(0, "cycles", Data::Costs::Unit::Unknown);
+        bottomUp.costs.addType(1, "off-CPU", Data::Costs::Unit::Time);
+        bottomUp.symbols = {{"schedule"}, {"lock"}, {"main"}, {"kthread"}};
+        bottomUp.symbols[0].isKernel = true;
+        bottomUp.symbols[3].isKernel = true;
+        bottomUp.locations = {{-1, {0x10, 0x1, {}}}, {-1, {0x20, 0x2, {}}}, {-1, {0x30, 0x3, {}}}, {-1, {0x40, 0x4, {}}}};
+
+        Data::EventResults events;
+        events.offCpuTimeCostId = 1;
+        events.stacks = {{0, 1, 2}, {3}, {1, 2}};
+        events.threads.resize(1);
+        const int stackIds[] = {0, 0, 0, 1, -1, 2};
+        const int types[] = {1, 1, 1, 1, 1, 0};
+        const quint64 costs[] = {10, 30, 5, 7, 3, 100};
+        const bool preempted[] = {false, false, true, false, false, false};
+        for (int i = 0; i < 6; ++i) {
+            Data::Event event;
+            event.cost = costs[i];
+            event.type = types[i];
+            event.stackId = stackIds[i];
+            event.preempted = preempted[i];
+            events.threads[0].events.append(event);
+        }
+
+        const auto results = Data::offCpuResultsFromEvents(bottomUp, events);
+        QCOMPARE(results.bottomUp.costs.numTypes(), 2);
+        QCOMPARE(results.bottomUp.costs.totalCost(Data::OffCpuResults::BlockedTime), qint64(50));
+        QCOMPARE(results.bottomUp.costs.totalCost(Data::OffCpuResults::PreemptedTime), qint64(5));
+        QCOMPARE(results.topDown.inclusiveCosts.totalCost(Data::OffCpuResults::BlockedTime), qint64(50));
+
+        // the kernel frames are skipped, unless there is nothing else
+        QCOMPARE(results.callSites.size(), 3);
+        QCOMPARE(results.callSites[0].symbol, Data::Symbol("lock"));
+        QCOMPARE(results.callSites[0].blockedTime, quint64(40));
+        QCOMPARE(results.callSites[0].blockedCount, quint64(2));
+        QCOMPARE(results.callSites[0].longestBlockedTime, quint64(30));
+        QCOMPARE(results.callSites[0].preemptedTime, quint64(5));
+        QCOMPARE(results.callSites[1].symbol, Data::Symbol("kthread"));
+        QCOMPARE(results.callSites[1].blockedTime, quint64(7));
+        QVERIFY(!results.callSites[2].symbol.isValid());
+        QCOMPARE(results.callSites[2].blockedTime, quint64(3));
+
+        OffCpuModel model;
+        ModelTest tester(&model);
+        model.setData(results);
+        QCOMPARE(model.rowCount(), 3);
+        QCOMPARE(model.columnCount(), static_cast<int>(OffCpuModel::NUM_COLUMNS));
+        QCOMPARE(model.index(0, OffCpuModel::Symbol).data(OffCpuModel::SymbolRole).value<Data::Symbol>(),
+                 Data::Symbol("lock"));
+        QCOMPARE(model.index(0, OffCpuModel::BlockedTime).data(OffCpuModel::SortRole).value<quint64>(), quint64(40));
+        QCOMPARE(model.index(0, OffCpuModel::BlockedCount).data().value<quint64>(), quint64(2));
+
+        // without context switches, there is nothing to show
+        events.offCpuTimeCostId = -1;
+        const auto noResults = Data::offCpuResultsFromEvents(bottomUp, events);
+        QVERIFY(noResults.callSites.isEmpty());
+        QCOMPARE(noResults.bottomUp.costs.totalCost(Data::OffCpuResults::BlockedTime), qint64(0));
+    }
+
+    void testParallelismResults()
+    {
+        Data::BottomUpResults bottomUp;
+        bottomUp.costs.addType(0, "cycles", Data::Costs::Unit::Unknown);
+        bottomUp.costs.addType(1, "off-CPU", Data::Costs::Unit::Time);
+        bottomUp.symbols = {{"A"}, {"B"}};
+        bottomUp.locations = {{-1, {0x10, 0x1, {}}}, {-1, {0x20, 0x2, {}}}};
+
+        auto event = [](quint64 time, quint64 cost, qint32 type, qint32 stackId) {
+            Data::Event event;
+            event.time = time;
+            event.cost = cost;
+            event.type = type;
+            event.stackId = stackId;
+            return event;
+        };
+
+        Data::EventResults events;
+        events.offCpuTimeCostId = 1;
+        events.stacks = {{0}, {1}};
+        events.totalCosts = {{"cycles", 3, 3, Data::Costs::Unit::Unknown}};
+        events.threads.resize(2);
+        events.threads[0].time = {0, 100};
+        events.threads[0].events = {event(10, 1, 0, 0), event(20, 30, 1, 0), event(60, 1, 0, 1)};
+        events.threads[1].time = {0, 100};
+        events.threads[1].events = {event(30, 1, 0, 1), event(50, 50, 1, 1)};
+
+        // the first thread is off-CPU from 20 to 50, the second one from 50 on
+        auto results = Data::parallelismResultsFromEvents(bottomUp, events);
+        QCOMPARE(results.time, Data::TimeRange(10, 100));
+        QCOMPARE(results.steps.size(), 3);
+        QCOMPARE(results.steps[0].time, quint64(10));
+        QCOMPARE(results.steps[0].runningThreads, 2);
+        QCOMPARE(results.steps[1].time, quint64(20));
+        QCOMPARE(results.steps[1].runningThreads, 1);
+        QCOMPARE(results.steps[2].time, quint64(100));
+        QCOMPARE(results.steps[2].runningThreads, 0);
+        QCOMPARE(results.timeAtParallelism, QVector<quint64>({0, 80, 10}));
+        QCOMPARE(results.maxParallelism(), 2);
+        QCOMPARE(results.busyTime(), quint64(90));
+        QCOMPARE(results.averageParallelism(), 100. / 90);
+        QCOMPARE(results.serialFraction(), 80. / 90);
+
+        // the samples are split by the number of threads that ran when they got taken
+        QCOMPARE(results.sampleTypeNames, QStringList({"cycles"}));
+        QCOMPARE(results.bottomUp.costs.numTypes(), 2);
+        QCOMPARE(results.bottomUp.costs.totalCost(0), qint64(2));
+        QCOMPARE(results.bottomUp.costs.totalCost(1), qint64(1));
+        QCOMPARE(results.topDown.inclusiveCosts.totalCost(0), qint64(2));
+
+        ParallelismModel model;
+        ModelTest tester(&model);
+        model.setData(results);
+        QCOMPARE(model.rowCount(), 3);
+        QCOMPARE(model.index(0, ParallelismModel::RunningThreads).data(ParallelismModel::CostTypeRole).toInt(), -1);
+        QCOMPARE(model.index(1, ParallelismModel::RunningThreads).data(ParallelismModel::CostTypeRole).toInt(), 0);
+        QCOMPARE(model.index(1, ParallelismModel::Time).data(ParallelismModel::SortRole).value<quint64>(),
+                 quint64(80));
+        QCOMPARE(model.index(2, ParallelismModel::Samples).data(ParallelismModel::SortRole).value<qint64>(),
+                 qint64(1));
+
+        EventModel eventModel;
+        ModelTest eventTester(&eventModel);
+        eventModel.setData(events);
+        eventModel.setParallelism(results);
+        const auto processes = eventModel.index(1, EventModel::EventsColumn);
+        QCOMPARE(processes.data(EventModel::RunningThreadsRole).value<QVector<Data::ParallelismStep>>(),
+                 results.steps);
+        QCOMPARE(processes.data(EventModel::MaxRunningThreadsRole).toInt(), 2);
+        QVERIFY(!eventModel.index(0, EventModel::EventsColumn).data(EventModel::RunningThreadsRole).isValid());
+
+        // without context switches, each sample spans the typical time between the samples of a thread
+        events.offCpuTimeCostId = -1;
+        events.threads[0].events = {event(0, 1, 0, 0), event(10, 1, 0, 0), event(20, 1, 0, 0), event(30, 1, 0, 0)};
+        events.threads[1].events = {event(20, 1, 0, 1), event(30, 1, 0, 1)};
+        results = Data::parallelismResultsFromEvents(bottomUp, events);
+        QCOMPARE(results.time, Data::TimeRange(0, 40));
+        QCOMPARE(results.timeAtParallelism, QVector<quint64>({0, 20, 20}));
+        QCOMPARE(results.bottomUp.costs.totalCost(0), qint64(2));
+        QCOMPARE(results.bottomUp.costs.totalCost(1), qint64(4));
+
+        // every type but the off-CPU time is a sample type, e.g. when several events got recorded
+        events.threads[1].events.append(event(35, 5, 1, 1));
+        results = Data::parallelismResultsFromEvents(bottomUp, events);
+        QCOMPARE(results.sampleTypeNames, QStringList({"cycles", "off-CPU"}));
+        QCOMPARE(results.bottomUp.costs.numTypes(), 4);
+        QCOMPARE(results.costType(1, 2), 3);
+        QCOMPARE(results.costType(1, 3), -1);
+        QCOMPARE(results.bottomUp.costs.totalCost(results.costType(0, 2)), qint64(4));
+        QCOMPARE(results.bottomUp.costs.totalCost(results.costType(1, 2)), qint64(5));
+        model.setData(results);
+        QCOMPARE(model.columnCount(), ParallelismModel::Samples + 2);
+        QCOMPARE(model.index(2, ParallelismModel::Samples + 1).data(ParallelismModel::CostTypeRole).toInt(), 3);
+        QCOMPARE(model.index(2, ParallelismModel::Samples + 1).data(ParallelismModel::SortRole).value<qint64>(),
+                 qint64(5));
+    }
+
+    void testLockContention()
+    {
+        QCOMPARE(Data::LockContentionResults::bucketForDuration(999), 0);
+        QCOMPARE(Data::LockContentionResults::bucketForDuration(1000), 1);
+        QCOMPARE(Data::LockContentionResults::bucketForDuration(1999), 1);
+        QCOMPARE(Data::LockContentionResults::bucketForDuration(2000), 2);
+        QCOMPARE(Data::LockContentionResults::bucketStart(0), quint64(0));
+        QCOMPARE(Data::LockContentionResults::bucketStart(3), quint64(4000));
+
+        Data::BottomUpResults bottomUp;
+        bottomUp.costs.addType(0, "cycles", Data::Costs::Unit::Unknown);
+        bottomUp.costs.addType(1, "off-CPU", Data::Costs::Unit::Time);
+        bottomUp.symbols = {{"futex_wait_queue_me"}, {"__lll_lock_wait"}, {"pthread_mutex_lock"}, {"worker"},
+                            {"main"}, {"nanosleep"}, {"std::mutex::lock()"}};
+        bottomUp.symbols[0].isKernel = true;
+        for (int i = 0; i < bottomUp.symbols.size(); ++i) {
+            bottomUp.locations.append({-1, {quint64(0x10 * (i + 1)), quint64(i + 1), {}}});
+        }
+
+        auto event = [](quint64 time, quint64 cost, qint32 type, qint32 stackId) {
+            Data::Event event;
+            event.time = time;
+            event.cost = cost;
+            event.type = type;
+            event.stackId = stackId;
+            return event;
+        };
+        auto futexWait = [](quint64 time, quint64 address) {
+            Data::FutexWait wait;
+            wait.time = time;
+            wait.address = address;
+            return wait;
+        };
+
+        Data::EventResults events;
+        events.offCpuTimeCostId = 1;
+        events.stacks = {{0, 1, 2, 3, 4}, {5, 4}, {0, 6, 4}};
+        events.threads.resize(2);
+        // the third wait has no futex call of its own, the one before it belongs to the second wait
+        events.threads[0].events = {event(10, 1000, 1, 0), event(2000, 3000, 1, 1), event(6000, 1, 0, -1),
+                                    event(7000, 500, 1, 0), event(9000, 2000000, 1, 0)};
+        events.threads[0].futexWaits = {futexWait(5, 0xa), futexWait(6500, 0xa)};
+        events.threads[1].events = {event(100, 4000, 1, 2)};
+
+        const auto results = Data::lockContentionFromEvents(bottomUp, events);
+        QVERIFY(results.hasLockAddresses);
+        QCOMPARE(results.totalWaitTime, quint64(2005500));
+        QCOMPARE(results.sites.size(), 3);
+
+        QCOMPARE(results.sites[0].symbol, Data::Symbol("worker"));
+        QCOMPARE(results.sites[0].lockAddress, quint64(0));
+        QCOMPARE(results.sites[0].waitTime, quint64(2000000));
+        QCOMPARE(results.sites[0].histogram.size(), 12);
+        QCOMPARE(results.sites[0].histogram[11], quint64(1));
+
+        // the frames of the C++ standard library are part of the lock, too
+        QCOMPARE(results.sites[1].symbol, Data::Symbol("main"));
+        QCOMPARE(results.sites[1].waitTime, quint64(4000));
+        QCOMPARE(results.sites[1].histogram, QVector<quint64>({0, 0, 0, 1}));
+
+        QCOMPARE(results.sites[2].symbol, Data::Symbol("worker"));
+        QCOMPARE(results.sites[2].lockAddress, quint64(0xa));
+        QCOMPARE(results.sites[2].waitTime, quint64(1500));
+        QCOMPARE(results.sites[2].waitCount, quint64(2));
+        QCOMPARE(results.sites[2].longestWait, quint64(1000));
+        QCOMPARE(results.sites[2].p99Wait, quint64(1000));
+        QCOMPARE(results.sites[2].histogram, QVector<quint64>({1, 1}));
+
+        LockContentionModel model;
+        ModelTest tester(&model);
+        model.setData(results);
+        QCOMPARE(model.rowCount(), 3);
+        QCOMPARE(model.columnCount(), static_cast<int>(LockContentionModel::NUM_COLUMNS));
+        QCOMPARE(model.index(0, LockContentionModel::Lock).data().toString(), QString());
+        QCOMPARE(model.index(2, LockContentionModel::Lock).data().toString(), QStringLiteral("0xa"));
+        QCOMPARE(model.index(2, LockContentionModel::WaitTime).data(LockContentionModel::SortRole).value<quint64>(),
+                 quint64(1500));
+        QCOMPARE(model.index(2, 0).data(LockContentionModel::SiteRole).value<Data::LockWaitSite>(), results.sites[2]);
+
+        LockWaitHistogramModel histogramModel;
+        ModelTest histogramTester(&histogramModel);
+        histogramModel.setSite(results.sites[2]);
+        QCOMPARE(histogramModel.rowCount(), 2);
+        QCOMPARE(histogramModel.index(0, LockWaitHistogramModel::Waits).data().value<quint64>(), quint64(1));
+        QVERIFY(!histogramModel.index(0, LockWaitHistogramModel::Duration).data(Qt::FontRole).isValid());
+        QVERIFY(histogramModel.index(1, LockWaitHistogramModel::Duration).data(Qt::FontRole).value<QFont>().bold());
+
+        // the nearest rank of many short waits hides the rare long one
+        events.threads[0].events.clear();
+        events.threads[0].futexWaits.clear();
+        for (int i = 0; i < 100; ++i) {
+            events.threads[0].events.append(event(i * 10000, i == 99 ? 5000 : 100, 1, 0));
+        }
+        const auto manyWaits = Data::lockContentionFromEvents(bottomUp, events);
+        QVERIFY(!manyWaits.hasLockAddresses);
+        QCOMPARE(manyWaits.sites[0].symbol, Data::Symbol("worker"));
+        QCOMPARE(manyWaits.sites[0].p99Wait, quint64(100));
+        QCOMPARE(manyWaits.sites[0].longestWait, quint64(5000));
+
+        // without context switches, there is nothing to show
+        events.offCpuTimeCostId = -1;
+        QVERIFY(Data::lockContentionFromEvents(bottomUp, events).sites.isEmpty());
+    }
+
+    void testCriticalPath()
+    {
+        Data::BottomUpResults bottomUp;
+        bottomUp.costs.addType(0, "cycles", Data::Costs::Unit::Unknown);
+        bottomUp.costs.addType(1, "off-CPU", Data::Costs::Unit::Time);
+        bottomUp.symbols = {{"schedule"}, {"waitForResult"}, {"produce"}, {"sleep"}};
+        bottomUp.symbols[0].isKernel = true;
+        bottomUp.locations = {{-1, {0x10, 0x1, {}}}, {-1, {0x20, 0x2, {}}}, {-1, {0x30, 0x3, {}}}, {-1, {0x40, 0x4, {}}}};
+
+        auto offCpu = [](quint64 time, quint64 cost, qint32 stackId, quint32 cpuId) {
+            Data::Event event;
+            event.time = time;
+            event.cost = cost;
+            event.type = 1;
+            event.stackId = stackId;
+            event.cpuId = cpuId;
+            return event;
+        };
+
+        Data::EventResults events;
+        events.offCpuTimeCostId = 1;
+        events.stacks = {{0, 1}, {2}, {0, 3}};
+        events.threads.resize(2);
+        // the consumer waits for the producer, which sleeps first and then wakes up the consumer
+        auto& consumer = events.threads[0];
+        consumer.pid = 1;
+        consumer.tid = 1;
+        consumer.time = {0, 1000};
+        consumer.events = {offCpu(100, 400, 0, 1)};
+        auto& producer = events.threads[1];
+        producer.pid = 1;
+        producer.tid = 2;
+        producer.time = {0, 1000};
+        producer.events = {offCpu(50, 150, 2, 2)};
+        Data::Wakeup wakeup;
+        wakeup.time = 450;
+        wakeup.wokenTid = 1;
+        wakeup.stackId = 1;
+        wakeup.cpuId = 3;
+        producer.wakeups = {wakeup};
+
+        auto path = Data::criticalPathFromEvents(bottomUp, events, 1, 1, {0, 600});
+        QCOMPARE(path.segments.size(), 5);
+        QCOMPARE(path.numThreads(), 2);
+
+        QCOMPARE(path.segments[0].tid, 2);
+        QCOMPARE(path.segments[0].kind, Data::CriticalPathSegment::Running);
+        QCOMPARE(path.segments[0].time, Data::TimeRange(0, 50));
+
+        QCOMPARE(path.segments[1].tid, 2);
+        QCOMPARE(path.segments[1].kind, Data::CriticalPathSegment::Blocked);
+        QCOMPARE(path.segments[1].time, Data::TimeRange(50, 200));
+        QCOMPARE(path.segments[1].symbol, Data::Symbol("sleep"));
+        QCOMPARE(path.segments[1].cpuId, quint32(2));
+
+        QCOMPARE(path.segments[2].tid, 2);
+        QCOMPARE(path.segments[2].kind, Data::CriticalPathSegment::Running);
+        QCOMPARE(path.segments[2].time, Data::TimeRange(200, 450));
+        QCOMPARE(path.segments[2].symbol, Data::Symbol("produce"));
+        QCOMPARE(path.segments[2].cpuId, quint32(3));
+        QCOMPARE(path.segments[2].wokenTid, 1);
+
+        QCOMPARE(path.segments[3].tid, 1);
+        QCOMPARE(path.segments[3].kind, Data::CriticalPathSegment::Runnable);
+        QCOMPARE(path.segments[3].time, Data::TimeRange(450, 500));
+
+        QCOMPARE(path.segments[4].tid, 1);
+        QCOMPARE(path.segments[4].kind, Data::CriticalPathSegment::Running);
+        QCOMPARE(path.segments[4].time, Data::TimeRange(500, 600));
+        QCOMPARE(path.segments[4].wokenTid, Data::INVALID_TID);
+
+        QCOMPARE(path.timeIn(Data::CriticalPathSegment::Running), quint64(400));
+        QCOMPARE(path.timeIn(Data::CriticalPathSegment::Runnable), quint64(50));
+        QCOMPARE(path.timeIn(Data::CriticalPathSegment::Blocked), quint64(150));
+
+        // the path does not leave a thread that got preempted, nobody woke it up
+        consumer.events[0].preempted = true;
+        path = Data::criticalPathFromEvents(bottomUp, events, 1, 1, {0, 600});
+        QCOMPARE(path.segments.size(), 3);
+        QCOMPARE(path.numThreads(), 1);
+        QCOMPARE(path.segments[1].kind, Data::CriticalPathSegment::Preempted);
+        QCOMPARE(path.segments[1].time, Data::TimeRange(100, 500));
+        QCOMPARE(path.segments[1].symbol, Data::Symbol("waitForResult"));
+
+        // the path is clipped to the selected time
+        consumer.events[0].preempted = false;
+        path = Data::criticalPathFromEvents(bottomUp, events, 1, 1, {300, 600});
+        QCOMPARE(path.segments.size(), 3);
+        QCOMPARE(path.segments[0].time, Data::TimeRange(300, 450));
+        QCOMPARE(path.segments[0].tid, 2);
+
+        // without context switches, there is nothing to follow
+        events.offCpuTimeCostId = -1;
+        QVERIFY(Data::criticalPathFromEvents(bottomUp, events, 1, 1, {0, 600}).isEmpty());
+    }
+
+    void testTracePoints()
+    {
+        const auto tracePoint = generateTracePoint();
+        QCOMPARE(tracePoint.size(), 3);
+        QCOMPARE(tracePoint.fieldIndex(QStringLiteral("ptr")), 2);
+        QCOMPARE(tracePoint.fieldIndex(QStringLiteral("prio")), -1);
+        QCOMPARE(tracePoint.value(0, 2), QVariant(QStringLiteral("main")));
+        QCOMPARE(tracePoint.value(1, 1), QVariant(qint64(-8)));
+        QCOMPARE(tracePoint.value(2, 2), QVariant(std::numeric_limits<quint64>::max()));
+        QCOMPARE(tracePoint.displayValue(2, 0), QStringLiteral("0x1000"));
+        QCOMPARE(tracePoint.displayValue(3, 0), QStringLiteral("[1, 2]"));
+        QVERIFY(!tracePoint.value(4, 0).isValid());
+
+        const auto selected = tracePoint.selected({1, 2});
+        QCOMPARE(selected.times, QVector<quint64>({20, 30}));
+        QCOMPARE(selected.tids, QVector<qint32>({2, 1}));
+        QCOMPARE(selected.value(1, 0), QVariant(qint64(-8)));
+        QCOMPARE(selected.displayValue(3, 1), QStringLiteral("[]"));
+        QCOMPARE(selected.columns[2].size(), 2 * 8);
+        QCOMPARE(tracePoint.selected({}).size(), 0);
+
+        Data::EventResults events;
+        events.threads.resize(2);
+        events.threads[0].pid = 1;
+        events.threads[0].tid = 1;
+        events.threads[0].name = QStringLiteral("main");
+        events.threads[1].pid = 1;
+        events.threads[1].tid = 2;
+        events.threads[1].name = QStringLiteral("worker");
+        events.tracePoints = {tracePoint};
+        QCOMPARE(events.findTracePoint(1), &events.tracePoints.at(0));
+        QVERIFY(!events.findTracePoint(0));
+
+        TracePointSamplesModel model;
+        ModelTest tester(&model);
+        model.setData(events, 0);
+        QCOMPARE(model.rowCount(), 3);
+        QCOMPARE(model.columnCount(), TracePointSamplesModel::NUM_BASE_COLUMNS + 5);
+        QCOMPARE(model.headerData(TracePointSamplesModel::NUM_BASE_COLUMNS + 1, Qt::Horizontal).toString(),
+                 QStringLiteral("pid"));
+        QCOMPARE(model.index(1, TracePointSamplesModel::Thread).data().toString(), QStringLiteral("worker (#2)"));
+        QCOMPARE(model.index(1, TracePointSamplesModel::Time).data(TracePointSamplesModel::SortRole).value<quint64>(),
+                 quint64(20));
+        QCOMPARE(model.index(0, TracePointSamplesModel::NUM_BASE_COLUMNS + 2).data().toString(),
+                 QStringLiteral("0x1000"));
+        const auto filter = model.index(0, 0).data(TracePointSamplesModel::FilterRole).toString();
+        QVERIFY(filter.contains(QLatin1String("main")));
+        QVERIFY(filter.contains(QLatin1String("[1, 2]")));
+
+        model.setData(events, 1);
+        QCOMPARE(model.rowCount(), 0);
+        QCOMPARE(model.columnCount(), static_cast<int>(TracePointSamplesModel::NUM_BASE_COLUMNS));
+
+        TracePointGroupsModel groupsModel;
+        ModelTest groupsTester(&groupsModel);
+        groupsModel.setData(tracePoint, tracePoint.fieldIndex(QStringLiteral("pid")));
+        QCOMPARE(groupsModel.rowCount(), 2);
+        QCOMPARE(groupsModel.headerData(TracePointGroupsModel::Value, Qt::Horizontal).toString(),
+                 QStringLiteral("pid"));
+        QCOMPARE(groupsModel.index(0, TracePointGroupsModel::Value).data().toString(), QStringLiteral("7"));
+        QCOMPARE(groupsModel.index(0, TracePointGroupsModel::Samples).data(TracePointGroupsModel::SortRole).toInt(), 2);
+        QCOMPARE(groupsModel.index(1, TracePointGroupsModel::Value).data(TracePointGroupsModel::SortRole),
+                 QVariant(qint64(-8)));
+        groupsModel.setData(tracePoint, -1);
+        QCOMPARE(groupsModel.rowCount(), 0);
+    }
+
+    void testBranchCounts()
+    {
+        Data::BottomUpResults bottomUp;
+        bottomUp.symbols = {{"A"}, {"A"}, {"A"}, {"B"}, {"C"}};
+        bottomUp.locations = {{-1, {0x110, 0x10, "a.cpp:1"}}, {-1, {0x120, 0x20, "a.cpp:2"}},
+                              {-1, {0x130, 0x30, "a.cpp:3"}}, {-1, {0x190, 0x90, "b.cpp:1"}},
+                              {2, {0x130, 0x30, "c.h:1"}}};
+
+        // A loops twice from 0x30 back to 0x10, after being entered from B at 0x20
+        Data::DisassemblyResult disassembly;
+        disassembly.addBranchStack({4, 0, 2, 0, 3, 1});
+        QCOMPARE(disassembly.branchEdges.size(), 3);
+        QCOMPARE(disassembly.branchEdges.value(qMakePair(2, 0)), quint64(1));
+        QCOMPARE(disassembly.branchRanges.size(), 2);
+        QCOMPARE(disassembly.branchRanges.value(qMakePair(0, 4)), quint64(1));
+        QCOMPARE(disassembly.branchRanges.value(qMakePair(1, 2)), quint64(1));
+
+        // the inlined location 4 belongs to A through its parent, the call from B is not within A
+        Data::DisassemblyEntry entryA;
+        Data::addBranchCounts({"A"}, bottomUp, disassembly, &entryA);
+        QCOMPARE(entryA.branchEdges.size(), 1);
+        QCOMPARE(entryA.branchEdges.value(qMakePair(quint64(0x30), quint64(0x10))), quint64(2));
+        QCOMPARE(entryA.branchRanges.size(), 2);
+        QCOMPARE(entryA.branchRanges.value(qMakePair(quint64(0x10), quint64(0x30))), quint64(1));
+        QCOMPARE(entryA.branchRanges.value(qMakePair(quint64(0x20), quint64(0x30))), quint64(1));
+
+        Data::DisassemblyEntry entryB;
+        Data::addBranchCounts({"B"}, bottomUp, disassembly, &entryB);
+        QVERIFY(entryB.branchEdges.isEmpty());
+        QVERIFY(entryB.branchRanges.isEmpty());
+    }
+
+    void testDisassemblyModel()
+    {
+        DisassemblyModel model;
+        ModelTest tester(&model);
+
+        model.setRows({"Assembly", "cycles"}, {{"401000: push %rbp", "12.50%"}, {"401001: mov %rsp,%rbp"}});
+        QCOMPARE(model.rowCount(), 2);
+        QCOMPARE(model.columnCount(), 2);
+        QCOMPARE(model.headerData(1, Qt::Horizontal).toString(), QStringLiteral("cycles"));
+        QCOMPARE(model.item(1, 0)->text(), QStringLiteral("401001: mov %rsp,%rbp"));
+        QCOMPARE(model.data(model.index(0, 1), SortRole).toInt(), 13);
+        QVERIFY(!model.item(1, 1));
+
+        model.setRows({"Assembly"}, {{"foo"}});
+        QCOMPARE(model.rowCount(), 1);
+        QCOMPARE(model.columnCount(), 1);
+    }
+
+    void testDisassemblyIndex()
+    {
+        DisassemblyIndex index;
+        // the output arrives in chunks that split lines
+        index.append("\nabc:     file format elf64-x86-64\n\n\nDisassembly of section .text:\n\n"
+                     "0000000000401000 <main>:\n  401000:\tpush   %rbp\n  4010");
+        index.append("01:\tmov    %rsp,%rbp\n  401004:\tret    \n\n0000000000401010 <foo>:\n"
+                     "  401010:\tjmp    401000 <main>\r\n  401008:\tnop\n  401015:\tret    ");
+        QCOMPARE(index.instructionCount(), 4);
+        index.finish();
+        QCOMPARE(index.instructionCount(), 5);
+
+        QVERIFY(index.contains(0x401001));
+        QVERIFY(!index.contains(0x401002));
+        QVERIFY(!index.contains(0x401008)); // not in ascending order
+        QCOMPARE(index.lines(0x401000, 0x401005),
+                 QByteArray("  401000:\tpush   %rbp\n  401001:\tmov    %rsp,%rbp\n  401004:\tret    \n"));
+        QCOMPARE(index.lines(0x401010, 0x401020),
+                 QByteArray("  401010:\tjmp    401000 <main>\n  401015:\tret    \n"));
+        QCOMPARE(index.lines(0x401005, 0x401010), QByteArray());
+        QVERIFY(index.size() > 0);
+    }
+
+    void testControlFlow()
+    {
+        auto jne = ControlFlow::parseInstruction(0x10, "jne    1008 <main+0x8>", false);
+        QCOMPARE(jne.target, quint64(0x1008));
+        QVERIFY(jne.endsBlock);
+        QCOMPARE(ControlFlow::parseInstruction(0x10, "bnd jmp 1020 <main+0x20>", false).target, quint64(0x1020));
+        QCOMPARE(ControlFlow::parseInstruction(0x10, "jmp    QWORD PTR [rip+0x2fe2]        # 4018 <x>", false).target,
+                 quint64(0));
+        QVERIFY(ControlFlow::parseInstruction(0x10, "retq   ", false).endsBlock);
+        QVERIFY(!ControlFlow::parseInstruction(0x10, "callq  1000 <foo>", false).endsBlock);
+        QCOMPARE(ControlFlow::parseInstruction(0x10, "cbnz\tx0, 1008 <main+0x8>", true).target, quint64(0x1008));
+        QVERIFY(!ControlFlow::parseInstruction(0x10, "bl\t1000 <foo>", true).endsBlock);
+
+        // a loop 0x1004-0x100c with an inner loop 0x1008-0x100a
+        QVector<ControlFlow::Instruction> instructions;
+        instructions.append(ControlFlow::parseInstruction(0x1000, "push   %rbp", false));
+        instructions.append(ControlFlow::parseInstruction(0x1004, "add    $0x1,%eax", false));
+        instructions.append(ControlFlow::parseInstruction(0x1008, "add    $0x1,%ebx", false));
+        instructions.append(ControlFlow::parseInstruction(0x100a, "jne    1008 <main+0x8>", false));
+        instructions.append(ControlFlow::parseInstruction(0x100c, "jl     1004 <main+0x4>", false));
+        instructions.append(ControlFlow::parseInstruction(0x100e, "retq   ", false));
+
+        const auto blocks = ControlFlow::basicBlocks(instructions);
+        QCOMPARE(blocks.size(), 5);
+        const int expectedBlocks[][2] = {{0, 0}, {1, 1}, {2, 3}, {4, 4}, {5, 5}};
+        for (int i = 0; i < blocks.size(); ++i) {
+            QCOMPARE(blocks[i].first, expectedBlocks[i][0]);
+            QCOMPARE(blocks[i].last, expectedBlocks[i][1]);
+        }
+
+        const auto loops = ControlFlow::loops(instructions);
+        QCOMPARE(loops.size(), 2);
+        QCOMPARE(loops[0].header, 1);
+        QCOMPARE(loops[0].latch, 4);
+        QCOMPARE(loops[1].header, 2);
+        QCOMPARE(loops[1].latch, 3);
+    }
+
+    void testSourceCodeModel()
+    {
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        file.write("int main()\r\n{\n\treturn 0;\n}");
+        file.close();
+
+        Data::CallerCalleeResults results;
+        results.selfCosts.addType(0, "cycles", Data::Costs::Unit::Unknown);
+        results.selfCosts.addTotalCost(0, 10);
+        results.entry({"main"}).source(QStringLiteral("main.cpp:3"), 1).selfCost[0] = 4;
+        results.entry({"main"}).source(QStringLiteral("main.cpp:3"), 1).inclusiveCost[0] = 6;
+        results.entry({"inlined"}).source(QStringLiteral("main.cpp:3"), 1).inclusiveCost[0] = 2;
+        results.entry({"other"}).source(QStringLiteral("other.cpp:3"), 1).selfCost[0] = 5;
+
+        SourceCodeModel model;
+        ModelTest tester(&model);
+        QVERIFY(model.setSourceFile(file.fileName(), QStringLiteral("main.cpp")));
+        model.setCosts(results);
+        QCOMPARE(model.rowCount(), 4);
+        QCOMPARE(model.columnCount(), SourceCodeModel::NUM_BASE_COLUMNS + 2);
+        QCOMPARE(model.lineText(1), QStringLiteral("int main()"));
+        QCOMPARE(model.lineText(3), QStringLiteral("\treturn 0;"));
+        QCOMPARE(model.lineText(4), QStringLiteral("}"));
+        QCOMPARE(model.lineText(5), QString());
+        QCOMPARE(model.data(model.index(2, SourceCodeModel::LineNumber)).toInt(), 3);
+
+        // costs of the same line from an inlined function add up, other files are ignored
+        const int selfColumn = SourceCodeModel::NUM_BASE_COLUMNS;
+        QCOMPARE(model.data(model.index(2, selfColumn), SourceCodeModel::SortRole).toLongLong(), qint64(4));
+        QCOMPARE(model.data(model.index(2, selfColumn + 1), SourceCodeModel::SortRole).toLongLong(), qint64(8));
+        QCOMPARE(model.data(model.index(2, selfColumn), SourceCodeModel::TotalCostRole).toLongLong(), qint64(10));
+        QCOMPARE(model.data(model.index(0, selfColumn), SourceCodeModel::SortRole).toLongLong(), qint64(0));
+        const auto toolTip = model.data(model.index(2, SourceCodeModel::SourceCode), Qt::ToolTipRole).toString();
+        QVERIFY(toolTip.contains(QLatin1String("inlined")));
+
+        QVERIFY(!model.setSourceFile(file.fileName() + QLatin1String(".missing"), QStringLiteral("main.cpp")));
+        QCOMPARE(model.rowCount(), 0);
+    }
+
     void testEventModel()
     {
         Data::EventResults events;
@@ -347,6 +1198,49 @@ private slots:
         }
     }
 
+    void testEventModelLostEvents()
+    {
+        Data::EventResults events;
+        events.cpus.resize(3);
+        events.cpus[0].cpuId = 0;
+        events.cpus[1].cpuId = 1; // no samples, but lost events
+        events.cpus[2].cpuId = 2; // empty
+        Data::Event event;
+        event.time = 10;
+        event.cost = 1;
+        event.type = 0;
+        event.cpuId = 0;
+        events.cpus[0].events << event;
+        Data::LostEvents lost;
+        lost.time = {20, 30};
+        lost.count = 42;
+        events.cpus[1].lost << lost;
+        events.threads.resize(1);
+        events.threads[0].pid = 1;
+        events.threads[0].tid = 1;
+        events.threads[0].time = {0, 100};
+        events.threads[0].events << event;
+
+        EventModel model;
+        ModelTest tester(&model);
+        model.setData(events);
+
+        const auto cpusParent = model.index(0, EventModel::ThreadColumn);
+        QCOMPARE(model.rowCount(cpusParent), 2);
+        QVERIFY(model.index(0, EventModel::ThreadColumn, cpusParent)
+                    .data(EventModel::LostEventsRole)
+                    .value<QVector<Data::LostEvents>>()
+                    .isEmpty());
+        const auto lostIndex = model.index(1, EventModel::ThreadColumn, cpusParent);
+        QCOMPARE(lostIndex.data(EventModel::CpuIdRole).value<quint32>(), 1u);
+        QCOMPARE(lostIndex.data(EventModel::LostEventsRole).value<QVector<Data::LostEvents>>(),
+                 QVector<Data::LostEvents>({lost}));
+        QVERIFY(lostIndex.data(Qt::ToolTipRole).toString().contains(QLatin1String("42")));
+
+        const auto threadIndex = model.index(0, EventModel::ThreadColumn, model.index(0, 0, model.index(1, 0)));
+        QVERIFY(threadIndex.data(EventModel::LostEventsRole).value<QVector<Data::LostEvents>>().isEmpty());
+    }
+
     void testPrettySymbol_data()
     {
         QTest::addColumn<QString>("prettySymbol");